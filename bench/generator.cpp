@@ -0,0 +1,308 @@
+#include "generator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <QTextStream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+
+#include "libkoviz/trick_types.h"
+
+struct GenParam
+{
+    QString name;
+    QString unit;
+    int type;
+    int size;
+};
+
+Generator::Generator(const QString &dir, int nRuns, int nRows, int nCols,
+                     const QString &type, const QString &endian) :
+    _dir(dir),
+    _nRuns(nRuns),
+    _nRows(nRows),
+    _nCols(nCols),
+    _type(type),
+    _endian(endian)
+{
+}
+
+QStringList Generator::types()
+{
+    QStringList list;
+    list << "double" << "float" << "int" << "short" << "long_long";
+    return list;
+}
+
+QStringList Generator::paramNames() const
+{
+    QStringList names;
+    for ( int i = 0; i < _nCols; ++i ) {
+        names << QString("bench.x[%1]").arg(i);
+    }
+    return names;
+}
+
+QStringList Generator::runDirs(const QString &format) const
+{
+    QStringList dirs;
+    for ( int i = 0; i < _nRuns; ++i ) {
+        dirs << _runDir(format,i);
+    }
+    return dirs;
+}
+
+QString Generator::_runDir(const QString &format, int run) const
+{
+    return QString("%1/%2/RUN_%3").arg(_dir).arg(format)
+                                  .arg(run,5,10,QChar('0'));
+}
+
+void Generator::generate()
+{
+    for ( int run = 0; run < _nRuns; ++run ) {
+        QStringList formats;
+        formats << "trk" << "csv" << "mot" << "snap";
+        foreach ( QString format, formats ) {
+            QString runDir = _runDir(format,run);
+            if ( !QDir().mkpath(runDir) ) {
+                fprintf(stderr, "koviz-bench [error]: could not create "
+                                "dir %s\n", runDir.toLatin1().constData());
+                exit(-1);
+            }
+        }
+        _writeTrk(_runDir("trk",run) + "/log_bench.trk", run);
+        _writeCsv(_runDir("csv",run) + "/log_bench.csv", run);
+        _writeMot(_runDir("mot",run) + "/bench.mot", run);
+        _writeSnap(_runDir("snap",run), run);
+    }
+}
+
+double Generator::_value(int run, int row, int col) const
+{
+    double t = row*0.01;
+    double f = 0.1*(col+1);
+    double a = 100.0*(col+1);
+    return a*sin(2.0*M_PI*f*t + 0.01*run) + col;
+}
+
+static void _openDataStream(QFile& file, QDataStream& out,
+                            const QString& endian)
+{
+    if (!file.open(QIODevice::WriteOnly)) {
+        fprintf(stderr,"koviz-bench [error]: could not open %s\n",
+                file.fileName().toLatin1().constData());
+        exit(-1);
+    }
+    out.setDevice(&file);
+    if ( endian == "B" ) {
+        out.setByteOrder(QDataStream::BigEndian);
+    } else {
+        out.setByteOrder(QDataStream::LittleEndian);
+    }
+}
+
+static void _writeString(QDataStream& out, const QString& str)
+{
+    qint32 sz = (qint32)str.size();
+    out << sz;
+    out.writeRawData(str.toLatin1().constData(),str.size());
+}
+
+// Trick 07 header, in either byte order
+static void _writeHeader(QDataStream& out, const QString& endian,
+                         const QList<GenParam>& params)
+{
+    out.writeRawData("Trick-07-",9);
+    out.writeRawData(endian == "B" ? "B" : "L",1);
+    out << (qint32)params.size();
+    foreach ( GenParam p, params ) {
+        _writeString(out,p.name);
+        _writeString(out,p.unit);
+        out << (qint32)p.type;
+        out << (qint32)p.size;
+    }
+}
+
+static void _writeValue(QDataStream& out, int type, double val)
+{
+    switch (type) {
+    case TRICK_07_FLOAT:
+        out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        out << (float)val;
+        out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        break;
+    case TRICK_07_INTEGER: out << (qint32)val; break;
+    case TRICK_07_SHORT: out << (qint16)val; break;
+    case TRICK_07_LONG_LONG: out << (qint64)val; break;
+    default: out << val; break;
+    }
+}
+
+static GenParam _param(const QString& name, const QString& unit,
+                       int type=TRICK_07_DOUBLE)
+{
+    GenParam p;
+    p.name = name;
+    p.unit = unit;
+    p.type = type;
+    switch (type) {
+    case TRICK_07_FLOAT: p.size = sizeof(float); break;
+    case TRICK_07_INTEGER: p.size = sizeof(qint32); break;
+    case TRICK_07_SHORT: p.size = sizeof(qint16); break;
+    case TRICK_07_LONG_LONG: p.size = sizeof(qint64); break;
+    default: p.size = sizeof(double); break;
+    }
+    return p;
+}
+
+void Generator::_writeTrk(const QString &fileName, int run) const
+{
+    int type = TRICK_07_DOUBLE;
+    if ( _type == "float" ) {
+        type = TRICK_07_FLOAT;
+    } else if ( _type == "int" ) {
+        type = TRICK_07_INTEGER;
+    } else if ( _type == "short" ) {
+        type = TRICK_07_SHORT;
+    } else if ( _type == "long_long" ) {
+        type = TRICK_07_LONG_LONG;
+    }
+
+    QList<GenParam> params;
+    params << _param(timeName(),"s");
+    foreach ( QString name, paramNames() ) {
+        params << _param(name,"m",type);
+    }
+
+    QFile file(fileName);
+    QDataStream out;
+    _openDataStream(file,out,_endian);
+    _writeHeader(out,_endian,params);
+    for ( int row = 0; row < _nRows; ++row ) {
+        out << row*0.01;
+        for ( int col = 0; col < _nCols; ++col ) {
+            _writeValue(out,type,_value(run,row,col));
+        }
+    }
+    file.close();
+}
+
+void Generator::_writeCsv(const QString &fileName, int run) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fprintf(stderr,"koviz-bench [error]: could not open %s\n",
+                fileName.toLatin1().constData());
+        exit(-1);
+    }
+    QTextStream out(&file);
+    out.setRealNumberPrecision(15);
+
+    out << timeName() << " {s}";
+    foreach ( QString name, paramNames() ) {
+        out << "," << name << " {m}";
+    }
+    out << "\n";
+    for ( int row = 0; row < _nRows; ++row ) {
+        out << row*0.01;
+        for ( int col = 0; col < _nCols; ++col ) {
+            out << "," << _value(run,row,col);
+        }
+        out << "\n";
+    }
+    file.close();
+}
+
+void Generator::_writeMot(const QString &fileName, int run) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fprintf(stderr,"koviz-bench [error]: could not open %s\n",
+                fileName.toLatin1().constData());
+        exit(-1);
+    }
+    QTextStream out(&file);
+    out.setRealNumberPrecision(15);
+
+    out << "bench\n";
+    out << "nRows=" << _nRows << "\n";
+    out << "nColumns=" << _nCols+1 << "\n";
+    out << "inDegrees=yes\n";
+    out << "endheader\n";
+    out << "time";
+    for ( int col = 0; col < _nCols; ++col ) {
+        out << "\tbench_x" << col;
+    }
+    out << "\n";
+    for ( int row = 0; row < _nRows; ++row ) {
+        out << row*0.01;
+        for ( int col = 0; col < _nCols; ++col ) {
+            out << "\t" << _value(run,row,col);
+        }
+        out << "\n";
+    }
+    file.close();
+}
+
+// Realtime frame logs for snap, one 100Hz main thread with nCols user jobs
+// and an overrun every 97th frame
+void Generator::_writeSnap(const QString &runDir, int run) const
+{
+    const double advanceSimTime = 20.0;  // microsecs
+
+    QList<GenParam> frameParams;
+    frameParams << _param(timeName(),"s")
+                << _param("trick_real_time.rt_sync.frame_sched_time","s")
+                << _param("trick_real_time.rt_sync.frame_overrun_time","s");
+
+    QList<GenParam> trickParams;
+    trickParams << _param(timeName(),"s")
+                << _param("JOB_trick_sys.sched.advance_sim_time.1.00"
+                          "(end_of_frame)","s");
+
+    QList<GenParam> userParams;
+    userParams << _param(timeName(),"s");
+    for ( int col = 0; col < _nCols; ++col ) {
+        userParams << _param(QString("JOB_bench.obj%1.job%1.%2.00"
+                                     "(scheduled_0.010)").arg(col).arg(col+2),
+                             "s");
+    }
+
+    QFile frameFile(runDir + "/log_frame.trk");
+    QFile trickFile(runDir + "/log_trickjobs.trk");
+    QFile userFile(runDir + "/log_trick_frame_userjobs_main.trk");
+    QDataStream frameOut;
+    QDataStream trickOut;
+    QDataStream userOut;
+    _openDataStream(frameFile,frameOut,_endian);
+    _openDataStream(trickFile,trickOut,_endian);
+    _openDataStream(userFile,userOut,_endian);
+    _writeHeader(frameOut,_endian,frameParams);
+    _writeHeader(trickOut,_endian,trickParams);
+    _writeHeader(userOut,_endian,userParams);
+
+    for ( int row = 0; row < _nRows; ++row ) {
+        double t = row*0.01;
+        bool isSpike = ( (row+run)%97 == 96 );
+        double frameTime = advanceSimTime;
+        userOut << t;
+        for ( int col = 0; col < _nCols; ++col ) {
+            double rt = 50.0 + 10.0*col + fabs(_value(run,row,col))/10.0;
+            if ( isSpike && col == row%_nCols ) {
+                rt += 10000.0;
+            }
+            frameTime += rt;
+            userOut << rt;
+        }
+        trickOut << t << advanceSimTime;
+        double overrun = frameTime > 10000.0 ? frameTime-10000.0 : 0.0;
+        frameOut << t << frameTime << overrun;
+    }
+
+    frameFile.close();
+    trickFile.close();
+    userFile.close();
+}
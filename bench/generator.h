@@ -0,0 +1,52 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <QString>
+#include <QStringList>
+
+//
+// Synthetic Trick log generator for koviz-bench
+//
+// Writes nRuns RUN dirs for each data format under dir:
+//
+//     dir/trk/RUN_00000/log_bench.trk
+//     dir/csv/RUN_00000/log_bench.csv
+//     dir/mot/RUN_00000/bench.mot
+//     dir/snap/RUN_00000/log_frame.trk, log_trickjobs.trk,
+//                        log_trick_frame_userjobs_main.trk
+//
+// Each log has a sys.exec.out.time column followed by nCols params
+// named bench.x[i] logged at 100Hz.  Values are sine waves that differ
+// by param and run, so curves are neither flat nor identical.
+//
+class Generator
+{
+  public:
+    Generator(const QString& dir, int nRuns, int nRows, int nCols,
+              const QString& type, const QString& endian);
+
+    static QStringList types();  // valid types e.g. "double"
+
+    void generate();
+
+    QString timeName() const { return "sys.exec.out.time"; }
+    QStringList paramNames() const;
+    QStringList runDirs(const QString& format) const;
+
+  private:
+    QString _dir;
+    int _nRuns;
+    int _nRows;
+    int _nCols;
+    QString _type;
+    QString _endian;
+
+    double _value(int run, int row, int col) const;
+    QString _runDir(const QString& format, int run) const;
+    void _writeTrk(const QString& fileName, int run) const;
+    void _writeCsv(const QString& fileName, int run) const;
+    void _writeMot(const QString& fileName, int run) const;
+    void _writeSnap(const QString& runDir, int run) const;
+};
+
+#endif // GENERATOR_H
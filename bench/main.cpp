@@ -0,0 +1,780 @@
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QRegExp>
+#include <QVector>
+#include <QStandardItem>
+#include <stdio.h>
+#include <float.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "libkoviz/options.h"
+#include "libkoviz/runs.h"
+#include "libkoviz/bookmodel.h"
+#include "libkoviz/datamodel.h"
+#include "libkoviz/curvemodel.h"
+#include "libkoviz/convert.h"
+#include "libkoviz/snap.h"
+#include "libkoviz/varsmodel.h"
+#include "libkoviz/unit.h"
+#include "libkoviz/datamodel_kvz.h"
+
+#include "generator.h"
+
+#ifndef KOVIZ_VERSION
+#define KOVIZ_VERSION "unknown"
+#endif
+
+Option::FPresetQString presetType;
+Option::FPresetQString presetEndian;
+Option::FPresetQString presetFormat;
+
+class BenchOptions : public Options
+{
+  public:
+    bool isHelp;
+    QString dir;
+    unsigned int runs;
+    unsigned int rows;
+    unsigned int cols;
+    QString type;
+    QString endian;
+    unsigned int reps;
+    QString filter;
+    QString outFile;
+    QString format;
+    bool isGenerateOnly;
+};
+
+BenchOptions opts;
+
+//
+// A benchmark times run() reps times.  setup()/teardown() are not timed.
+//
+class Benchmark
+{
+  public:
+    Benchmark(const QString& name) : _name(name) {}
+    virtual ~Benchmark() {}
+    QString name() const { return _name; }
+    virtual void setup() {}
+    virtual void run() = 0;
+    virtual void teardown() {}
+  private:
+    QString _name;
+};
+
+struct BenchResult
+{
+    QString name;
+    int reps;
+    double min;     // millisecs
+    double median;
+    double mean;
+    double max;
+};
+
+static QStringList timeNames()
+{
+    QStringList names;
+    names << "sys.exec.out.time" << "time";
+    return names;
+}
+
+static QStringList dataFiles(const QStringList& runDirs, const QString& suffix)
+{
+    QStringList files;
+    foreach ( QString runDir, runDirs ) {
+        QDir dir(runDir);
+        QStringList filter;
+        filter << "*." + suffix;
+        foreach ( QString f, dir.entryList(filter,QDir::Files) ) {
+            files << runDir + "/" + f;
+        }
+    }
+    return files;
+}
+
+// Book with root items koviz main sets up, no pages yet
+static PlotBookModel* createBookModel(Runs* runs)
+{
+    PlotBookModel* bookModel = new PlotBookModel(timeNames(),runs,0,1);
+    QStandardItem *rootItem = bookModel->invisibleRootItem();
+    QStandardItem *citem;
+
+    citem = bookModel->addChild(rootItem, "DefaultPageTitles","");
+    bookModel->addChild(citem, "Title1","koviz-bench");
+    bookModel->addChild(citem, "Title2","");
+    bookModel->addChild(citem, "Title3","");
+    bookModel->addChild(citem, "Title4","");
+    bookModel->addChild(rootItem, "LiveCoordTime","");
+    bookModel->addChild(rootItem, "LiveCoordTimeIndex",0);
+    bookModel->addChild(rootItem, "StartTime",-DBL_MAX);
+    bookModel->addChild(rootItem, "StopTime",DBL_MAX);
+    bookModel->addChild(rootItem, "Presentation","compare");
+    bookModel->addChild(rootItem, "IsShowLiveCoord",true);
+    bookModel->addChild(rootItem, "RunToShiftHash",QHash<QString,QVariant>());
+
+    QStringList groups;
+    groups << "Label" << "Color" << "Linestyle" << "Symbolstyle" << "Group";
+    QStringList groupTags;
+    groupTags << "LegendLabels" << "LegendColors" << "Linestyles"
+              << "Symbolstyles" << "Groups";
+    for ( int i = 0; i < groups.size(); ++i ) {
+        citem = bookModel->addChild(rootItem, groupTags.at(i),"");
+        for ( int j = 1; j <= 7; ++j ) {
+            bookModel->addChild(citem,QString("%1%2").arg(groups.at(i)).arg(j),
+                                "");
+        }
+    }
+
+    bookModel->addChild(rootItem, "Orientation", "landscape");
+    bookModel->addChild(rootItem, "TimeMatchTolerance", DBL_MAX);
+    bookModel->addChild(rootItem, "Frequency", 0.0);
+    bookModel->addChild(rootItem, "IsLegend", true);
+    bookModel->addChild(rootItem, "ForegroundColor", "#000000");
+    bookModel->addChild(rootItem, "BackgroundColor", "#FFFFFF");
+    bookModel->addChild(rootItem, "StatusBarMessage", "");
+    bookModel->addChild(rootItem, "IsShowPageTitle", true);
+    bookModel->addChild(rootItem, "IsShowPlotLegend", "");
+    bookModel->addChild(rootItem, "PlotLegendPosition", "ne");
+    bookModel->addChild(rootItem, "ButtonSelectAndPan", "left");
+    bookModel->addChild(rootItem, "ButtonZoom", "middle");
+    bookModel->addChild(rootItem, "ButtonReset", "right");
+    bookModel->addChild(rootItem, "XAxisLabel", "");
+    bookModel->addChild(rootItem, "YAxisLabel", "");
+
+    return bookModel;
+}
+
+class LoadBench : public Benchmark
+{
+  public:
+    LoadBench(const QString& name, const QStringList& files) :
+        Benchmark(name), _files(files) {}
+    void run()
+    {
+        foreach ( QString f, _files ) {
+            DataModel* m = DataModel::createDataModel(timeNames(),f);
+            delete m;
+        }
+    }
+  private:
+    QStringList _files;
+};
+
+// With isCatalog, runs are opened from a catalog primed in setup
+class RunsInitBench : public Benchmark
+{
+  public:
+    RunsInitBench(const QStringList& runDirs, bool isCatalog=false) :
+        Benchmark(isCatalog ? "runs_init_catalog" : "runs_init"),
+        _runDirs(runDirs), _isCatalog(isCatalog) {}
+    void setup()
+    {
+        Runs::isCatalog = _isCatalog;
+        if ( _isCatalog ) {
+            delete new Runs(timeNames(),_runDirs,
+                            QHash<QString,QStringList>(),"","",false);
+        }
+    }
+    void run()
+    {
+        Runs* runs = new Runs(timeNames(),_runDirs,
+                              QHash<QString,QStringList>(),"","",false);
+        delete runs;
+    }
+    void teardown() { Runs::isCatalog = false; }
+  private:
+    QStringList _runDirs;
+    bool _isCatalog;
+};
+
+class CurveCreateBench : public Benchmark
+{
+  public:
+    CurveCreateBench(const QStringList& runDirs, const QStringList& vars) :
+        Benchmark("curve_create"), _runDirs(runDirs), _vars(vars), _runs(0) {}
+    void setup()
+    {
+        _runs = new Runs(timeNames(),_runDirs,
+                         QHash<QString,QStringList>(),"","",false);
+    }
+    void run()
+    {
+        for ( int i = 0; i < _runDirs.size(); ++i ) {
+            foreach ( QString var, _vars ) {
+                CurveModel* c = _runs->curveModel(i,timeNames().at(0),
+                                                  timeNames().at(0),var);
+                delete c;
+            }
+        }
+    }
+    void teardown() { delete _runs; _runs = 0; }
+  private:
+    QStringList _runDirs;
+    QStringList _vars;
+    Runs* _runs;
+};
+
+//
+// Page with one plot of var over the runs
+// Subclasses time painter path, error path and bbox calcs on the plot
+//
+class PlotBench : public Benchmark
+{
+  public:
+    PlotBench(const QString& name,
+              const QStringList& runDirs, const QString& var) :
+        Benchmark(name), _runDirs(runDirs), _var(var),
+        _runs(0), _bookModel(0) {}
+    void setup()
+    {
+        _runs = new Runs(timeNames(),_runDirs,
+                         QHash<QString,QStringList>(),"","",false);
+        _bookModel = createBookModel(_runs);
+        QStandardItem* pageItem = _bookModel->createPageItem();
+        QStandardItem* plotItem = _bookModel->createPlotItem(pageItem,
+                                                      timeNames().at(0),
+                                                      _var,QStringList(),0);
+        _plotIdx = plotItem->index();
+        _curvesIdx = _bookModel->getIndex(_plotIdx,"Curves","Plot");
+    }
+    void teardown()
+    {
+        delete _bookModel; _bookModel = 0;
+        delete _runs; _runs = 0;
+    }
+  protected:
+    QStringList _runDirs;
+    QString _var;
+    Runs* _runs;
+    PlotBookModel* _bookModel;
+    QModelIndex _plotIdx;
+    QModelIndex _curvesIdx;
+};
+
+class PainterPathBench : public PlotBench
+{
+  public:
+    PainterPathBench(const QStringList& runDirs, const QString& var) :
+        PlotBench("painter_path",runDirs,var) {}
+    void run()
+    {
+        // Setting start time rebuilds every curve's painter path
+        QModelIndex idx = _bookModel->getDataIndex(QModelIndex(),"StartTime");
+        _bookModel->setData(idx,-DBL_MAX);
+    }
+};
+
+class ErrorPathBench : public PlotBench
+{
+  public:
+    ErrorPathBench(const QStringList& runDirs, const QString& var) :
+        PlotBench("error_path",runDirs.mid(0,2),var) {}
+    void run()
+    {
+        QPainterPath* path = _bookModel->getCurvesErrorPath(_curvesIdx);
+        delete path;
+    }
+};
+
+class BBoxBench : public PlotBench
+{
+  public:
+    BBoxBench(const QStringList& runDirs, const QString& var) :
+        PlotBench("bbox",runDirs,var) {}
+    void run()
+    {
+        _bookModel->calcCurvesBBox(_curvesIdx);
+    }
+};
+
+// Book, page and plot settings changed with the plot change router on,
+// only the plot setting is routed to the plot's views
+class PlotChangeRouteBench : public PlotBench
+{
+  public:
+    PlotChangeRouteBench(const QStringList& runDirs, const QString& var) :
+        PlotBench("plot_change_route",runDirs,var) {}
+    void run()
+    {
+        QModelIndex pageIdx = _plotIdx.parent().parent();
+        QModelIndex liveIdx = _bookModel->getDataIndex(QModelIndex(),
+                                                       "LiveCoordTime");
+        QModelIndex titleIdx = _bookModel->getDataIndex(pageIdx,
+                                                        "PageTitle","Page");
+        QModelIndex rectIdx = _bookModel->getDataIndex(_plotIdx,
+                                                       "PlotMathRect","Plot");
+        for ( int i = 0; i < 1000; ++i ) {
+            _bookModel->setData(liveIdx,(double)i);
+            _bookModel->setData(titleIdx,QString("Page %1").arg(i));
+            _bookModel->setData(rectIdx,QRectF(i,0.0,10.0,1.0));
+        }
+    }
+};
+
+// Walks curve property rows as a tree view does (rowCount/hasChildren on
+// each property), checking that no items are created under the curves
+class CurvePropWalkBench : public PlotBench
+{
+  public:
+    CurvePropWalkBench(const QStringList& runDirs, const QString& var) :
+        PlotBench("curve_prop_walk",runDirs,var) {}
+    void run()
+    {
+        int nCurves = _bookModel->rowCount(_curvesIdx);
+        for ( int i = 0; i < nCurves; ++i ) {
+            QModelIndex curveIdx = _bookModel->index(i,0,_curvesIdx);
+            QStandardItem* curveItem = _bookModel->itemFromIndex(curveIdx);
+            int nProps = _bookModel->rowCount(curveIdx);
+            for ( int j = 0; j < nProps; ++j ) {
+                QModelIndex propIdx = _bookModel->index(j,0,curveIdx);
+                if ( _bookModel->rowCount(propIdx) != 0 ||
+                     _bookModel->hasChildren(propIdx) ||
+                     _bookModel->index(0,0,propIdx).isValid() ) {
+                    throw std::runtime_error("koviz-bench [error]: "
+                                             "curve property has children");
+                }
+            }
+            if ( curveItem->rowCount() != 0 ||
+                 _bookModel->rowCount(curveIdx) != nProps ) {
+                throw std::runtime_error("koviz-bench [error]: items were "
+                                         "created under a curve");
+            }
+        }
+    }
+};
+
+// Book with a plot of each var over the runs, six plots a page
+class BookCreateBench : public Benchmark
+{
+  public:
+    BookCreateBench(const QStringList& runDirs, const QStringList& vars) :
+        Benchmark("book_create"), _runDirs(runDirs), _vars(vars),
+        _runs(0), _bookModel(0) {}
+    void setup()
+    {
+        _runs = new Runs(timeNames(),_runDirs,
+                         QHash<QString,QStringList>(),"","",false);
+        _bookModel = createBookModel(_runs);
+    }
+    void run()
+    {
+        QStandardItem* pageItem = 0;
+        for ( int i = 0; i < _vars.size(); ++i ) {
+            if ( i%6 == 0 ) {
+                pageItem = _bookModel->createPageItem();
+            }
+            _bookModel->createPlotItem(pageItem,timeNames().at(0),
+                                       _vars.at(i),QStringList(),0);
+        }
+    }
+    void teardown()
+    {
+        delete _bookModel; _bookModel = 0;
+        delete _runs; _runs = 0;
+    }
+  private:
+    QStringList _runDirs;
+    QStringList _vars;
+    Runs* _runs;
+    PlotBookModel* _bookModel;
+};
+
+class CsvExportBench : public Benchmark
+{
+  public:
+    CsvExportBench(const QString& trk, const QString& csv) :
+        Benchmark("csv_export"), _trk(trk), _csv(csv) {}
+    void run()
+    {
+        convert2csv(timeNames(),_trk,_csv);
+    }
+    void teardown() { QFile::remove(_csv); }
+  private:
+    QString _trk;
+    QString _csv;
+};
+
+class SnapBench : public Benchmark
+{
+  public:
+    SnapBench(const QString& runDir) :
+        Benchmark("snap_stats"), _runDir(runDir) {}
+    void run()
+    {
+        Snap snap(_runDir,timeNames());
+    }
+  private:
+    QString _runDir;
+};
+
+// Typing a search into the vars list of a big sim, each keystroke
+// narrowing the last search
+class VarsSearchBench : public Benchmark
+{
+  public:
+    VarsSearchBench(int nvars) :
+        Benchmark("vars_search"), _nvars(nvars), _varsModel(0) {}
+    void setup()
+    {
+        QStringList names;
+        for ( int i = 0; i < _nvars; ++i ) {
+            names << QString("veh%1.dyn.body%2.state.out.position[%3]")
+                     .arg(i/1000).arg(i%100).arg(i%3);
+        }
+        _varsModel = new VarsModel(names);
+    }
+    void run()
+    {
+        QString typed("veh42.dyn.body7.*position");
+        QString rx;
+        QVector<int> rows;
+        for ( int i = 1; i <= typed.size(); ++i ) {
+            if ( i > 1 && VarsModel::isNarrowing(rx,typed.left(i)) ) {
+                rows = _varsModel->narrow(typed.left(i),rows);
+            } else {
+                rows = _varsModel->match(typed.left(i));
+            }
+            rx = typed.left(i);
+        }
+    }
+    void teardown() { delete _varsModel; _varsModel = 0; }
+  private:
+    int _nvars;
+    VarsModel* _varsModel;
+};
+
+// Reads a var from each trk, or from its kvz archive made in setup
+class CurveReadBench : public Benchmark
+{
+  public:
+    CurveReadBench(const QStringList& trks, const QString& var,
+                   const QString& kvzDir = QString()) :
+        Benchmark(kvzDir.isEmpty() ? "trk_curve_read" : "kvz_curve_read"),
+        _trks(trks), _var(var), _kvzDir(kvzDir) {}
+    void setup()
+    {
+        _files = _trks;
+        if ( _kvzDir.isEmpty() ) {
+            return;
+        }
+        _files.clear();
+        QDir().mkpath(_kvzDir);
+        for ( int i = 0; i < _trks.size(); ++i ) {
+            QString kvz = QString("%1/%2.kvz").arg(_kvzDir).arg(i);
+            if ( !QFileInfo(kvz).exists() ) {
+                TrickModel trk(timeNames(),_trks.at(i));
+                KvzModel::write(trk,kvz);
+            }
+            _files << kvz;
+        }
+    }
+    void run()
+    {
+        double sum = 0.0;
+        foreach ( QString f, _files ) {
+            DataModel* m = DataModel::createDataModel(timeNames(),f);
+            int tcol = m->paramColumn(timeNames().at(0));
+            int ycol = m->paramColumn(_var);
+            m->map();
+            ModelIterator* it = m->begin(tcol,tcol,ycol);
+            while ( !it->isDone() ) {
+                sum += it->y();
+                it->next();
+            }
+            delete it;
+            m->unmap();
+            delete m;
+        }
+        _sum = sum;
+    }
+  private:
+    QStringList _trks;
+    QString _var;
+    QString _kvzDir;
+    QStringList _files;
+    double _sum;
+};
+
+// Reads a var from each trk with the column kernel (see readColumn) in
+// the chunks painter path creation reads, compare with trk_curve_read
+class ColumnReadBench : public Benchmark
+{
+  public:
+    ColumnReadBench(const QStringList& trks, const QString& var) :
+        Benchmark("trk_column_read"), _trks(trks), _var(var) {}
+    void run()
+    {
+        double sum = 0.0;
+        QVector<double> ys(4096);
+        foreach ( QString f, _trks ) {
+            DataModel* m = DataModel::createDataModel(timeNames(),f);
+            int ycol = m->paramColumn(_var);
+            int rc = m->rowCount();
+            m->map();
+            for ( int beg = 0; beg < rc; beg += ys.size() ) {
+                int n = qMin(ys.size(),rc-beg);
+                m->readColumn(ycol,beg,n,ys.data());
+                for ( int i = 0; i < n; ++i ) {
+                    sum += ys.at(i);
+                }
+            }
+            m->unmap();
+            delete m;
+        }
+        _sum = sum;
+    }
+  private:
+    QStringList _trks;
+    QString _var;
+    double _sum;
+};
+
+// Unit conversions by name as done per curve and per table paint
+class UnitConvertBench : public Benchmark
+{
+  public:
+    UnitConvertBench(int n) : Benchmark("unit_convert"), _n(n) {}
+    void run()
+    {
+        QStringList from;
+        QStringList to;
+        from << "ft" << "d/s" << "C" << "psi" << "mph" << "km/hr";
+        to   << "m"  << "r/s" << "F" << "kPa" << "m/s" << "ft/s";
+        double sum = 0.0;
+        for ( int i = 0; i < _n; ++i ) {
+            int j = i%from.size();
+            UnitConversion uc = Unit::conversion(from.at(j),to.at(j));
+            sum += uc.convert(1.0);
+        }
+        _sum = sum;
+    }
+  private:
+    int _n;
+    double _sum;
+};
+
+static BenchResult runBenchmark(Benchmark* bench, int reps)
+{
+    QVector<double> ms;
+    for ( int i = 0; i < reps; ++i ) {
+        bench->setup();
+        QElapsedTimer timer;
+        timer.start();
+        bench->run();
+        ms.append(timer.nsecsElapsed()/1.0e6);
+        bench->teardown();
+    }
+    std::sort(ms.begin(),ms.end());
+
+    BenchResult r;
+    r.name = bench->name();
+    r.reps = reps;
+    r.min = ms.first();
+    r.max = ms.last();
+    r.median = ms.at(ms.size()/2);
+    r.mean = 0.0;
+    foreach ( double m, ms ) {
+        r.mean += m;
+    }
+    r.mean /= ms.size();
+    return r;
+}
+
+static void writeResults(QTextStream& out, const QList<BenchResult>& results)
+{
+    QString str;
+    if ( opts.format == "csv" ) {
+        out << "name,reps,min_ms,median_ms,mean_ms,max_ms\n";
+        foreach ( BenchResult r, results ) {
+            out << str.sprintf("%s,%d,%.6f,%.6f,%.6f,%.6f\n",
+                               r.name.toLatin1().constData(), r.reps,
+                               r.min, r.median, r.mean, r.max);
+        }
+        return;
+    }
+
+    out << "{\n";
+    out << "  \"version\": \"" << KOVIZ_VERSION << "\",\n";
+    out << "  \"qt\": \"" << qVersion() << "\",\n";
+    out << "  \"date\": \""
+        << QDateTime::currentDateTime().toString(Qt::ISODate) << "\",\n";
+    out << str.sprintf("  \"config\": {\"runs\": %d, \"rows\": %d, "
+                       "\"cols\": %d, \"type\": \"%s\", \"endian\": \"%s\"},\n",
+                       opts.runs, opts.rows, opts.cols,
+                       opts.type.toLatin1().constData(),
+                       opts.endian.toLatin1().constData());
+    out << "  \"results\": [\n";
+    for ( int i = 0; i < results.size(); ++i ) {
+        const BenchResult& r = results.at(i);
+        out << str.sprintf("    {\"name\": \"%s\", \"reps\": %d, "
+                           "\"min_ms\": %.6f, \"median_ms\": %.6f, "
+                           "\"mean_ms\": %.6f, \"max_ms\": %.6f}",
+                           r.name.toLatin1().constData(), r.reps,
+                           r.min, r.median, r.mean, r.max);
+        out << ( i < results.size()-1 ? ",\n" : "\n" );
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int main(int argc, char *argv[])
+{
+    bool ok;
+
+    opts.add("-h:{0,1}",&opts.isHelp,false, "print usage");
+    opts.add("-dir",&opts.dir,QDir::tempPath() + "/koviz-bench",
+             "directory for generated logs");
+    opts.add("-runs",&opts.runs,2,"number of RUNs to generate (2 or more)");
+    opts.add("-rows",&opts.rows,100000,"number of records per log");
+    opts.add("-cols",&opts.cols,10,"number of params per log (plus time)");
+    opts.add("-type",&opts.type,"double",
+             "trk param type double, float, int, short or long_long",
+             presetType);
+    opts.add("-endian",&opts.endian,"L","trk byte order L or B",
+             presetEndian);
+    opts.add("-reps",&opts.reps,5,"repetitions per benchmark");
+    opts.add("-filter",&opts.filter,"",
+             "only run benchmarks with names matching regexp");
+    opts.add("-o",&opts.outFile,"","results file (default stdout)");
+    opts.add("-format",&opts.format,"json","results format json or csv",
+             presetFormat);
+    opts.add("-generate:{0,1}",&opts.isGenerateOnly,false,
+             "generate logs and exit");
+
+    opts.parse(argc,argv, QString("koviz-bench"), &ok);
+
+    if ( opts.isHelp ) {
+        fprintf(stdout,"%s\n",opts.usage().toLatin1().constData());
+        return 0;
+    }
+    if ( !ok ) {
+        return -1;
+    }
+    if ( opts.runs < 2 || opts.rows < 2 || opts.cols < 1 || opts.reps < 1 ) {
+        fprintf(stderr,"koviz-bench [error]: need -runs >= 2, -rows >= 2, "
+                       "-cols >= 1 and -reps >= 1\n");
+        return -1;
+    }
+
+    // Csv loading shows a progress dialog, so a gui app is needed
+    // (use -platform offscreen when there is no display)
+    QApplication a(argc, argv);
+
+    Generator gen(opts.dir,opts.runs,opts.rows,opts.cols,
+                  opts.type,opts.endian);
+    fprintf(stderr,"koviz-bench: generating logs in %s\n",
+            opts.dir.toLatin1().constData());
+    gen.generate();
+    if ( opts.isGenerateOnly ) {
+        return 0;
+    }
+
+    // Benchmarks parse headers unless they say otherwise
+    Runs::isCatalog = false;
+
+    QStringList trkRuns = gen.runDirs("trk");
+    QString var = gen.paramNames().at(0);
+
+    QList<Benchmark*> benches;
+    benches << new LoadBench("trk_header_parse",dataFiles(trkRuns,"trk"))
+            << new LoadBench("csv_load",dataFiles(gen.runDirs("csv"),"csv"))
+            << new LoadBench("mot_load",dataFiles(gen.runDirs("mot"),"mot"))
+            << new RunsInitBench(trkRuns)
+            << new RunsInitBench(trkRuns,true)
+            << new CurveCreateBench(trkRuns,gen.paramNames())
+            << new PainterPathBench(trkRuns,var)
+            << new ErrorPathBench(trkRuns,var)
+            << new BBoxBench(trkRuns,var)
+            << new PlotChangeRouteBench(trkRuns,var)
+            << new CurvePropWalkBench(trkRuns,var)
+            << new BookCreateBench(trkRuns,gen.paramNames())
+            << new CsvExportBench(dataFiles(trkRuns.mid(0,1),"trk").at(0),
+                                  opts.dir + "/csv_export.csv")
+            << new SnapBench(gen.runDirs("snap").at(0))
+            << new VarsSearchBench(150000)
+            << new UnitConvertBench(100000)
+            << new CurveReadBench(dataFiles(trkRuns,"trk"),var)
+            << new ColumnReadBench(dataFiles(trkRuns,"trk"),var)
+            << new CurveReadBench(dataFiles(trkRuns,"trk"),var,
+                                  opts.dir + "/kvz");
+
+    QRegExp rx(opts.filter);
+    QList<BenchResult> results;
+    int ret = 0;
+    try {
+        foreach ( Benchmark* bench, benches ) {
+            if ( !opts.filter.isEmpty() && rx.indexIn(bench->name()) < 0 ) {
+                continue;
+            }
+            fprintf(stderr,"koviz-bench: %s\n",
+                    bench->name().toLatin1().constData());
+            results.append(runBenchmark(bench,opts.reps));
+        }
+    } catch (std::exception &e) {
+        fprintf(stderr,"\n%s\n",e.what());
+        ret = -1;
+    }
+
+    foreach ( Benchmark* bench, benches ) {
+        delete bench;
+    }
+
+    if ( opts.outFile.isEmpty() ) {
+        QTextStream out(stdout);
+        writeResults(out,results);
+    } else {
+        QFile file(opts.outFile);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            fprintf(stderr,"koviz-bench [error]: could not open %s\n",
+                    opts.outFile.toLatin1().constData());
+            return -1;
+        }
+        QTextStream out(&file);
+        writeResults(out,results);
+    }
+
+    return ret;
+}
+
+void presetType(QString* presVar, const QString& type, bool* ok)
+{
+    Q_UNUSED(presVar);
+
+    if ( !Generator::types().contains(type) ) {
+        fprintf(stderr,"koviz-bench [error] : option -type, set to \"%s\", "
+                "should be one of %s\n", type.toLatin1().constData(),
+                Generator::types().join(",").toLatin1().constData());
+        *ok = false;
+    }
+}
+
+void presetEndian(QString* presVar, const QString& endian, bool* ok)
+{
+    Q_UNUSED(presVar);
+
+    if ( endian != "L" && endian != "B" ) {
+        fprintf(stderr,"koviz-bench [error] : option -endian, set to \"%s\", "
+                "should be \"L\" or \"B\"\n", endian.toLatin1().constData());
+        *ok = false;
+    }
+}
+
+void presetFormat(QString* presVar, const QString& format, bool* ok)
+{
+    Q_UNUSED(presVar);
+
+    if ( format != "json" && format != "csv" ) {
+        fprintf(stderr,"koviz-bench [error] : option -format, set to \"%s\", "
+                "should be \"json\" or \"csv\"\n",
+                format.toLatin1().constData());
+        *ok = false;
+    }
+}
@@ -4,7 +4,8 @@ include (koviz.pri)
 CONFIG += ordered
 TEMPLATE = subdirs
 SUBDIRS = libkoviz \
-          koviz
+          koviz \
+          bench
 
 SOURCES += blender/koviz.py \
            blender/koviz-hello-world.py
@@ -13,6 +13,7 @@ using namespace std;
 #include <QFileInfo>
 #include <QTextStream>
 #include <stdio.h>
+#include <stdlib.h>
 #include <float.h>
 
 #include "libkoviz/options.h"
@@ -31,22 +32,27 @@ using namespace std;
 #include "libkoviz/curvemodel.h"
 #include "libkoviz/trick_types.h"
 #include "libkoviz/session.h"
-
-QStandardItemModel* createVarsModel(Runs* runs);
+#include "libkoviz/livetail.h"
+#include "libkoviz/snapmonitor.h"
+#include "libkoviz/convert.h"
+#include "libkoviz/trace.h"
+#include "libkoviz/features.h"
+#include "libkoviz/eventquery.h"
+#include "libkoviz/varsmodel.h"
+
+VarsModel* createVarsModel(Runs* runs);
 bool writeTrk(const QString& ftrk, const QString &timeName,
               double start, double stop, double timeShift,
               QStringList& paramList, Runs* runs);
 bool writeCsv(const QString& fcsv, const QStringList& timeNames,
               DPTable* dpTable, const QString &runDir,
               double startTime, double stopTime, double tolerance);
-bool convert2csv(const QStringList& timeNames,
-                 const QString& ftrk, const QString& fcsv);
-bool convert2trk(const QString& csvFileName, const QString &trkFileName);
 QHash<QString,QVariant> getShiftHash(const QString& shiftString,
                                 const QStringList &runDirs);
 QHash<QString,QStringList> getVarMap(const QString& mapString);
 QHash<QString,QStringList> getVarMapFromFile(const QString& mapFileName);
 QStringList getTimeNames(const QString& timeName);
+void writeProfile();
 QStandardItemModel* monteInputModel(const QString &monteDir,
                                     const QStringList &runs);
 QStandardItemModel* runsInputModel(const QStringList &runs);
@@ -61,6 +67,8 @@ QStringList runsSubset(const QStringList& runsList, const QString &filterPattern
 Option::FPresetQString presetExistsFile;
 Option::FPresetDouble preset_start;
 Option::FPresetDouble preset_stop;
+Option::FPresetDouble presetLiveRate;
+Option::FPresetQString presetRTFormat;
 Option::FPresetQStringList presetRunsDPs;
 Option::FPostsetQStringList postsetRunsDPs;
 Option::FPresetQString presetPresentation;
@@ -79,6 +87,10 @@ class SnapOptions : public Options
     double start;
     double stop;
     bool isReportRT;
+    bool isStreamRT;
+    QString rtFormat;
+    unsigned int rtWindow;
+    unsigned int rtTopJobs;
     QString presentation;
     unsigned int beginRun;
     unsigned int endRun;
@@ -92,10 +104,14 @@ class SnapOptions : public Options
     QString timeName;
     QString trk2csvFile;
     QString csv2trkFile;
+    QString trk2kvzFile;
+    QString kvz2trkFile;
     QString outputFileName;
     QString shiftString;
     QString map;
     QString mapFile;
+    QString features;
+    QString query;
     bool isDebug;
     bool isLegend;
     QString legend1;
@@ -160,6 +176,10 @@ class SnapOptions : public Options
     QString xaxislabel;
     QString yaxislabel;
     QString vars;
+    bool isLiveTail;
+    double liveRate;
+    bool isCatalog;
+    QString profileFile;
 };
 
 SnapOptions opts;
@@ -176,10 +196,19 @@ int main(int argc, char *argv[])
              "List of RUN dirs and DP files",
              presetRunsDPs, postsetRunsDPs);
     opts.add("-rt:{0,1}",&opts.isReportRT,false, "print realtime text report");
+    opts.add("-rtStream:{0,1}",&opts.isStreamRT,false,
+             "stream realtime frame stats (follows logs with -liveTail)");
+    opts.add("-rtFormat",&opts.rtFormat,"text",
+             "-rtStream output format, text or json", presetRTFormat);
+    opts.add("-rtWindow",&opts.rtWindow,1000,
+             "number of recent frames in -rtStream rolling stats");
+    opts.add("-rtTopJobs",&opts.rtTopJobs,5,
+             "number of top overrun jobs in -rtStream output");
     opts.add("-start", &opts.start, -DBL_MAX, "start time", preset_start);
     opts.add("-stop", &opts.stop, DBL_MAX, "stop time", preset_stop);
     opts.add("-pres",&opts.presentation,"",
-             "present plot with two curves as compare,error or error+compare",
+             "present plot with two curves as compare,error or error+compare,"
+             " or plots with more curves (e.g. MONTE) as envelope",
              presetPresentation);
     opts.add("-beginRun",&opts.beginRun,0,
              "begin run (inclusive) in set of Monte carlo RUNs",
@@ -207,16 +236,31 @@ int main(int argc, char *argv[])
     opts.add("-csv2trk", &opts.csv2trkFile, QString(""),
              "Name of csv file to convert to trk (fname subs csv with trk)",
              presetExistsFile);
+    opts.add("-trk2kvz", &opts.trk2kvzFile, QString(""),
+             "Name of trk file to archive as kvz (fname subs trk with kvz)",
+             presetExistsFile);
+    opts.add("-kvz2trk", &opts.kvz2trkFile, QString(""),
+             "Name of kvz archive to convert to trk (fname subs kvz with trk)",
+             presetExistsFile);
     opts.add("-o", &opts.outputFileName, QString(""),
-             "Name of file to output with trk2csv and csv2trk options",
+             "Name of file to output with trk2csv, csv2trk, trk2kvz and "
+             "kvz2trk options",
              presetOutputFile);
     opts.add("-shift", &opts.shiftString, QString(""),
              "time shift run curves by value "
              "(e.g. -shift \"RUN_a:1.075,RUN_b:2.0\")");
     opts.add("-map", &opts.map, QString(""),
-             "variable mapping (e.g. -map trick.x=spots.x)");
+             "variable mapping (e.g. -map trick.x=spots.x) or derived "
+             "var (e.g. -map \"r=@hypot(trick.x,trick.y)\")");
     opts.add("-mapFile", &opts.mapFile, QString(""),
              "variable mapping file (e.g. -mapFile myMapFile.txt)");
+    opts.add("-features", &opts.features, QString(""),
+             "per run features added as monte input columns "
+             "(e.g. -features \"max(qbar),tcross(alt,1000)\"), "
+             "cached in .koviz_features alongside the runs");
+    opts.add("-query", &opts.query, QString(""),
+             "print run and start/end time of intervals where predicate "
+             "holds (e.g. -query \"|q| > 1500\") and exit");
     opts.add("-debug:{0,1}",&opts.isDebug,false, "Show book model tree etc.");
     opts.add("-legend:{0,1}",&opts.isLegend,true, "Show legend");
     opts.add("-l1",&opts.legend1,"", "Curve label 1");
@@ -309,6 +353,16 @@ int main(int argc, char *argv[])
     opts.add("-vars",
              &opts.vars,"","List variables to plot. "
                         "Use @var to place var on same plot as prev variable.");
+    opts.add("-liveTail:{0,1}",&opts.isLiveTail,false,
+             "Follow RUN logs while sim is writing them");
+    opts.add("-liveRate",&opts.liveRate,2.0,
+             "Max plot refreshes per second with -liveTail",
+             presetLiveRate);
+    opts.add("-catalog:{0,1}",&opts.isCatalog,true,
+             "Open runs from run list/header cache in .koviz_catalog "
+             "alongside the runs");
+    opts.add("-profile",&opts.profileFile,"",
+             "Write timings to file, Chrome trace if *.json else summary");
 
     opts.parse(argc,argv, QString("koviz"), &ok);
 
@@ -327,6 +381,15 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    if ( !opts.profileFile.isEmpty() ) {
+        // Written at exit since koviz exits from many places
+        Trace::setEnabled(true);
+        atexit(writeProfile);
+    }
+
+    TrickModel::isLiveTail = opts.isLiveTail;
+    Runs::isCatalog = opts.isCatalog;
+
     QStringList dps;
     QStringList runDirs;
     foreach ( QString f, opts.rundps ) {
@@ -356,13 +419,15 @@ int main(int argc, char *argv[])
     }
 
     if ( opts.rundps.isEmpty() && opts.sessionFile.isEmpty() ) {
-        if ( opts.trk2csvFile.isEmpty() && opts.csv2trkFile.isEmpty() ) {
+        if ( opts.trk2csvFile.isEmpty() && opts.csv2trkFile.isEmpty() &&
+             opts.trk2kvzFile.isEmpty() && opts.kvz2trkFile.isEmpty() ) {
             fprintf(stderr,"koviz [error] : no RUNs specified.\n");
             exit(-1);
         }
     }
     if ( runDirs.isEmpty() &&
-         opts.trk2csvFile.isEmpty() && opts.csv2trkFile.isEmpty()) {
+         opts.trk2csvFile.isEmpty() && opts.csv2trkFile.isEmpty() &&
+         opts.trk2kvzFile.isEmpty() && opts.kvz2trkFile.isEmpty() ) {
         fprintf(stderr, "koviz [error]: no RUNs specified.\n"
                 "       Possible causes:\n"
                 "         1) RUNs not specified on commandline\n"
@@ -473,6 +538,46 @@ int main(int argc, char *argv[])
         }
     }
 
+    if ( !opts.trk2kvzFile.isEmpty() ) {
+        QString kvzOutFile = opts.outputFileName;
+        if ( kvzOutFile.isEmpty() ) {
+            QFileInfo fi(opts.trk2kvzFile);
+            kvzOutFile = fi.absolutePath() + "/" +
+                         QString("%1.kvz").arg(fi.baseName());
+        }
+        bool ret;
+        try {
+            ret = convert2kvz(timeNames,opts.trk2kvzFile, kvzOutFile);
+        } catch (std::exception &e) {
+            fprintf(stderr,"\n%s\n",e.what());
+            exit(-1);
+        }
+        if ( !ret )  {
+            fprintf(stderr, "koviz [error]: Aborting trk to kvz conversion!\n");
+            return -1;
+        }
+    }
+
+    if ( !opts.kvz2trkFile.isEmpty() ) {
+        QString trkOutFile = opts.outputFileName;
+        if ( trkOutFile.isEmpty() ) {
+            QFileInfo fi(opts.kvz2trkFile);
+            trkOutFile = fi.absolutePath() + "/" +
+                         QString("%1.trk").arg(fi.baseName());
+        }
+        bool ret;
+        try {
+            ret = convertKvz2trk(timeNames,opts.kvz2trkFile, trkOutFile);
+        } catch (std::exception &e) {
+            fprintf(stderr,"\n%s\n",e.what());
+            exit(-1);
+        }
+        if ( !ret )  {
+            fprintf(stderr, "koviz [error]: Aborting kvz to trk conversion!\n");
+            return -1;
+        }
+    }
+
     try {
         if ( opts.isReportRT ) {
             foreach ( QString run, runDirs ) {
@@ -490,9 +595,33 @@ int main(int argc, char *argv[])
         exit(-1);
     }
 
+    if ( opts.isStreamRT ) {
+        if ( runDirs.size() != 1 ) {
+            fprintf(stderr, "koviz [error]: -rtStream takes a single RUN\n");
+            return -1;
+        }
+        try {
+            QCoreApplication a(argc, argv);
+            SnapMonitor monitor(runDirs.at(0),timeNames,
+                                opts.rtWindow,opts.rtTopJobs,
+                                opts.rtFormat == "json");
+            if ( opts.isLiveTail ) {
+                monitor.update();
+                monitor.start(opts.liveRate);
+                return a.exec();
+            } else {
+                monitor.update(false);
+            }
+        } catch (std::exception &e) {
+            fprintf(stderr,"\n%s\n",e.what());
+            exit(-1);
+        }
+        return 0;
+    }
 
     if ( opts.isReportRT || !opts.csv2trkFile.isEmpty()
-         || !opts.trk2csvFile.isEmpty() ) {
+         || !opts.trk2csvFile.isEmpty() || !opts.trk2kvzFile.isEmpty()
+         || !opts.kvz2trkFile.isEmpty() ) {
         return 0;
     }
 
@@ -504,7 +633,7 @@ int main(int argc, char *argv[])
         QApplication a(argc, argv);
 
         Runs* runs = 0;
-        QStandardItemModel* varsModel = 0;
+        VarsModel* varsModel = 0;
         QStandardItemModel* monteInputsModel = 0;
 
         bool isTrk = false;
@@ -623,6 +752,39 @@ int main(int argc, char *argv[])
                             isShowProgress);
             monteInputsModel = runsInputModel(runsList);
         }
+        if ( !opts.features.isEmpty() ) {
+            try {
+                FeatureCache::addColumns(monteInputsModel,runs,
+                                         timeNames.at(0),
+                                         Feature::splitSpecs(opts.features));
+            } catch (std::exception &e) {
+                fprintf(stderr,"%s\n",e.what());
+                exit(-1);
+            }
+        }
+        if ( !opts.query.isEmpty() ) {
+            QStringList runDirs = runs->runDirs();
+            QString summariesFile = EventQuery::summariesFileName(runDirs);
+            EventQuery::Summaries summaries;
+            EventQuery::loadSummaries(summariesFile,&summaries);
+            QList<QueryEvent> events;
+            try {
+                EventQuery query(opts.query);
+                events = query.run(runs,timeNames.at(0),&summaries);
+            } catch (std::exception &e) {
+                fprintf(stderr,"%s\n",e.what());
+                exit(-1);
+            }
+            EventQuery::saveSummaries(summariesFile,summaries);
+            foreach ( QueryEvent event, events ) {
+                fprintf(stdout,"%s %.9g %.9g\n",
+                        runDirs.at(event.run).toLatin1().constData(),
+                        event.start,event.end);
+            }
+            delete monteInputsModel;
+            delete runs;
+            return 0;
+        }
         varsModel = createVarsModel(runs);
 
         // Make a list of titles
@@ -1332,11 +1494,15 @@ int main(int argc, char *argv[])
                                                                "Curves","Plot");
                     QModelIndexList curveIdxs = bookModel->getIndexList(
                                                     curvesIdx,"Curve","Curves");
-                    if ( curveIdxs.size() == 2 && !presentation.isEmpty()) {
+                    if ( curveIdxs.size() == 2 && !presentation.isEmpty() &&
+                         presentation != "envelope" ) {
                         bookModel->setData(presIdx,presentation);
                         QRectF bbox = bookModel->calcCurvesBBox(curvesIdx);
                         bookModel->setPlotMathRect(bbox,plotIdx);
                     }
+                } else if ( runs->runDirs().size() > 2 &&
+                            presentation == "envelope" ) {
+                    bookModel->setData(presIdx,presentation);
                 }
             }
 
@@ -1344,8 +1510,13 @@ int main(int argc, char *argv[])
                 w.savePdf(pdfOutFile);
                 ret = 0;
             } else {
+                LiveTail* liveTail = 0;
+                if ( opts.isLiveTail ) {
+                    liveTail = new LiveTail(runs,bookModel,opts.liveRate);
+                }
                 w.show();
                 ret = a.exec();
+                delete liveTail;
             }
         }
 
@@ -1397,22 +1568,14 @@ void postsetRunsDPs (QStringList* rundps, bool* ok)
     Q_UNUSED(dirs);
 }
 
-QStandardItemModel* createVarsModel(Runs* runs)
+VarsModel* createVarsModel(Runs* runs)
 {
     if ( runs == 0 ) return 0;
 
-    QStandardItemModel* varsModel = new QStandardItemModel(0,1);
-
     QStringList params = runs->params();
-    params.sort();
-    QStandardItem *rootItem = varsModel->invisibleRootItem();
-    foreach (QString param, params) {
-        if ( param == "sys.exec.out.time" ) continue;
-        QStandardItem *varItem = new QStandardItem(param);
-        rootItem->appendRow(varItem);
-    }
+    params.removeAll("sys.exec.out.time");
 
-    return varsModel;
+    return new VarsModel(params);
 }
 
 void presetBeginRun(uint* beginRunId, uint runId, bool* ok)
@@ -1446,9 +1609,10 @@ void presetPresentation(QString* presVar, const QString& pres, bool* ok)
     Q_UNUSED(presVar);
 
     if ( !pres.isEmpty() && pres != "compare" && pres != "error" &&
-         pres != "error+compare" ) {
+         pres != "error+compare" && pres != "envelope" ) {
         fprintf(stderr,"koviz [error] : option -presentation, set to \"%s\", "
-                "should be \"compare\", \"error\" or \"error+compare\"\n",
+                "should be \"compare\", \"error\", \"error+compare\" "
+                "or \"envelope\"\n",
                 pres.toLatin1().constData());
         *ok = false;
     }
@@ -1818,182 +1982,41 @@ void preset_stop(double* time, double new_time, bool* ok)
     }
 }
 
-void presetExistsFile(QString* ignoreMe, const QString& fname, bool* ok)
+void presetLiveRate(double* rate, double new_rate, bool* ok)
 {
-    Q_UNUSED(ignoreMe);
+    Q_UNUSED(rate);
 
-    QFileInfo fi(fname);
-    if ( !fi.exists() ) {
-        fprintf(stderr,
-                "koviz [error] : Couldn't find file: \"%s\".\n",
-                fname.toLatin1().constData());
+    if ( new_rate <= 0.0 ) {
+        fprintf(stderr,"koviz [error] : option -liveRate, set to %g, "
+                "must be greater than zero\n", new_rate);
         *ok = false;
-        return;
     }
 }
 
-bool convert2csv(const QStringList& timeNames,
-                 const QString& ftrk, const QString& fcsv)
+void presetRTFormat(QString* presVar, const QString& format, bool* ok)
 {
-    TrickModel m(timeNames, ftrk);
-
-    QFileInfo fcsvi(fcsv);
-    if ( fcsvi.exists() ) {
-        fprintf(stderr, "koviz [error]: Will not overwrite %s\n",
-                fcsv.toLatin1().constData());
-        return false;
-    }
-
-    // Open csv file stream
-    QFile csv(fcsv);
-    if (!csv.open(QIODevice::WriteOnly)) {
-        fprintf(stderr,"koviz: [error] could not open %s\n",
-                fcsv.toLatin1().constData());
-        return false;
-    }
-    QTextStream out(&csv);
-
-    // Write csv param list (top line in csv file)
-    int cc = m.columnCount();
-    for ( int i = 0; i < cc; ++i) {
-        QString pName = m.param(i)->name();
-        QString pUnit = m.param(i)->unit();
-        out << pName << " {" << pUnit << "}";
-        if ( i < cc-1 ) {
-            out << ",";
-        }
-    }
-    out << "\n";
+    Q_UNUSED(presVar);
 
-    //
-    // Write param values
-    //
-    int rc = m.rowCount();
-    for ( int r = 0 ; r < rc; ++r ) {
-        for ( int c = 0 ; c < cc; ++c ) {
-            QModelIndex idx = m.index(r,c);
-            out << m.data(idx).toString();
-            if ( c < cc-1 ) {
-                out << ",";
-            } else {
-                out << "\n";
-            }
-        }
+    if ( format != "text" && format != "json" ) {
+        fprintf(stderr,"koviz [error] : option -rtFormat, set to \"%s\", "
+                "should be \"text\" or \"json\"\n",
+                format.toLatin1().constData());
+        *ok = false;
     }
-
-    // Clean up
-    csv.close();
-
-    return true;
 }
 
-bool convert2trk(const QString& csvFileName, const QString& trkFileName)
+void presetExistsFile(QString* ignoreMe, const QString& fname, bool* ok)
 {
-    QFile file(csvFileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)){
-        fprintf(stderr, "koviz [error]: Cannot read file %s!",
-                csvFileName.toLatin1().constData());
-    }
-    CSV csv(&file);
-
-    // Parse first line to get param list
-    QList<TrickParameter> params;
-    QStringList list = csv.parseLine() ;
-    if ( list.isEmpty() ) {
-        fprintf(stderr, "koviz [error]: Empty csv file \"%s\"",
-                csvFileName.toLatin1().constData());
-        return false;
-    }
-    foreach ( QString s, list ) {
-        TrickParameter p;
-        QStringList plist = s.split(" ", QString::SkipEmptyParts);
-        p.setName(plist.at(0));
-        if ( plist.size() > 1 ) {
-            QString unitString = plist.at(1);
-            if ( unitString.startsWith('{') ) {
-                unitString = unitString.remove(0,1);
-            }
-            if ( unitString.endsWith('}') ) {
-                unitString.chop(1);
-            }
-            Unit u;
-            if ( u.isUnit(unitString.toLatin1().constData()) ) {
-                p.setUnit(unitString);
-            }
-        }
-        p.setType(TRICK_07_DOUBLE);
-        p.setSize(sizeof(double));
-        params.append(p);
-    }
-
-    QFileInfo ftrki(trkFileName);
-    if ( ftrki.exists() ) {
-        fprintf(stderr, "koviz [error]: Will not overwrite %s\n",
-                trkFileName.toLatin1().constData());
-        return false;
-    }
-
-    QFile trk(trkFileName);
-
-    if (!trk.open(QIODevice::WriteOnly)) {
-        fprintf(stderr,"koviz [error]: could not open %s\n",
-                trkFileName.toLatin1().constData());
-        return false;
-    }
-    QDataStream out(&trk);
-
-    // Write trk header
-    TrickModel::writeTrkHeader(out,params);
+    Q_UNUSED(ignoreMe);
 
-    //
-    // Write param values
-    //
-    int line = 1;
-    while ( 1 ) {
-        ++line;
-        QStringList list = csv.parseLine() ;
-        if ( list.isEmpty() ) break;  // end of file, hopefully!!!
-        foreach ( QString s, list ) {
-            bool ok;
-            double val = s.toDouble(&ok);
-            if ( !ok ) {
-                QStringList vals = s.split(":");
-                if (vals.length() == 3 ) {
-                    // Try converting to a utc timestamp
-                    val = 3600.0*vals.at(0).toDouble(&ok);
-                    if ( ok ) {
-                        val += 60.0*vals.at(1).toDouble(&ok);
-                        if ( ok ) {
-                            val += vals.at(2).toDouble(&ok);
-                        }
-                    }
-                }
-            }
-            if ( !ok ) {
-                // If a single char, convert to unicode numeric value
-                if ( s.size() == 1 ) {
-                    val = s.at(0).unicode();
-                    ok = true;
-                }
-            }
-            if ( !ok ) {
-                QFileInfo fi(csvFileName);
-                fprintf(stderr,
-                 "koviz [error]: Bad value \"%s\" on line %d in file %s\n",
-                        s.toLatin1().constData(),
-                        line,
-                        fi.absoluteFilePath().toLatin1().constData());
-                file.close();
-                trk.remove();
-                return false;
-            }
-            out << val;
-        }
+    QFileInfo fi(fname);
+    if ( !fi.exists() ) {
+        fprintf(stderr,
+                "koviz [error] : Couldn't find file: \"%s\".\n",
+                fname.toLatin1().constData());
+        *ok = false;
+        return;
     }
-
-    file.close();
-
-    return true;
 }
 
 // shiftString has the form "[RUN_0:]val0[,RUN_1:val1,...]"
@@ -2093,13 +2116,38 @@ QHash<QString,QVariant> getShiftHash(const QString& shiftString,
 // In this example, getVarMap would return the following hash:
 //                 px->[trick.pos[0],spots.posx]
 //                 trick.pos[1]->[spots.posy]
+// A value may also be an expression, see expression.h
+//                 "r=@hypot(trick.pos[0],trick.pos[1]){m}"
 QHash<QString,QStringList> getVarMap(const QString& mapString)
 {
     QHash<QString,QStringList> varMap;
 
     if (mapString.isEmpty() ) return varMap; // empty map
 
-    QStringList maps = mapString.split(',',QString::SkipEmptyParts);
+    // Split on commas outside of parens, expression values may have
+    // function args e.g. "angle=@atan2(trick.pos[1],trick.pos[0])"
+    QStringList maps;
+    QString map;
+    int depth = 0;
+    foreach ( QChar c, mapString ) {
+        if ( c == '(' ) {
+            ++depth;
+        } else if ( c == ')' ) {
+            --depth;
+        }
+        if ( c == ',' && depth <= 0 ) {
+            if ( !map.isEmpty() ) {
+                maps << map;
+            }
+            map.clear();
+        } else {
+            map += c;
+        }
+    }
+    if ( !map.isEmpty() ) {
+        maps << map;
+    }
+
     foreach ( QString s, maps ) {
         s = s.trimmed();
         if ( s.contains('=') ) {
@@ -2168,6 +2216,11 @@ QHash<QString,QStringList> getVarMapFromFile(const QString& mapFileName)
     return varMap;
 }
 
+void writeProfile()
+{
+    Trace::write(opts.profileFile);
+}
+
 QStringList getTimeNames(const QString& timeName)
 {
     QStringList timeNames;
@@ -1,12 +1,16 @@
 #include "bookmodel.h"
 #include <float.h>
 #include "unit.h"
+#include "trace.h"
 
 PlotBookModel::PlotBookModel(const QStringList& timeNames,
                              Runs *runs, QObject *parent) :
     QStandardItemModel(parent),
     _timeNames(timeNames),
-    _runs(runs)
+    _runs(runs),
+    _pageLoader(0),
+    _curveProps(new CurvePropTable),
+    _plotChangeRouter(new PlotChangeRouter(this))
 {
     _initModel();
 }
@@ -16,7 +20,10 @@ PlotBookModel::PlotBookModel(const QStringList& timeNames,
                              int rows, int columns, QObject *parent) :
     QStandardItemModel(rows,columns,parent),
     _timeNames(timeNames),
-    _runs(runs)
+    _runs(runs),
+    _pageLoader(0),
+    _curveProps(new CurvePropTable),
+    _plotChangeRouter(new PlotChangeRouter(this))
 {
     _initModel();
 }
@@ -29,6 +36,7 @@ PlotBookModel::~PlotBookModel()
         }
     }
     _curve2path.clear();
+    _curve2pathState.clear();
 
     foreach ( QModelIndex pageIdx, pageIdxs() ) {
         foreach ( QModelIndex plotIdx, plotIdxs(pageIdx) ) {
@@ -141,9 +149,153 @@ bool PlotBookModel::setData(const QModelIndex &idx,
         }
     }
 
+    CurveItem* curveItem = _propCurveItem(idx);
+    if ( curveItem ) {
+        if ( idx.column() != 1 ||
+             (role != Qt::EditRole && role != Qt::DisplayRole) ) {
+            return false;
+        }
+        int tag = curveItem->table()->tag(curveItem->id(),idx.row());
+        if ( curveItem->table()->value(curveItem->id(),tag) != value ) {
+            curveItem->table()->setValue(curveItem->id(),tag,value);
+            emit dataChanged(idx,idx);
+        }
+        return true;
+    }
+
     return QStandardItemModel::setData(idx,value,role);
 }
 
+// Returns curve item if idx is a curve's index
+//
+// The item is looked up from its parent item (the internal pointer of a
+// QStandardItemModel index) since itemFromIndex() would create a missing
+// item, e.g. under a curve for one of its property indexes.
+CurveItem *PlotBookModel::_curveItem(const QModelIndex &idx) const
+{
+    if ( !idx.isValid() || idx.column() != 0 || idx.model() != this ||
+         _propCurveItem(idx) ) {
+        return 0;
+    }
+    QStandardItem* parentItem = static_cast<QStandardItem*>(
+                                                       idx.internalPointer());
+    if ( !parentItem ) {
+        return 0;
+    }
+    QStandardItem* item = parentItem->child(idx.row(),idx.column());
+    if ( item && item->type() == CurveItem::Type ) {
+        return static_cast<CurveItem*>(item);
+    }
+    return 0;
+}
+
+// Returns curve item if idx is the index of one of its properties
+CurveItem *PlotBookModel::_propCurveItem(const QModelIndex &idx) const
+{
+    if ( !idx.isValid() || idx.model() != this ) {
+        return 0;
+    }
+    QStandardItem* parentItem = static_cast<QStandardItem*>(
+                                                       idx.internalPointer());
+    if ( parentItem && parentItem->type() == CurveItem::Type ) {
+        return static_cast<CurveItem*>(parentItem);
+    }
+    return 0;
+}
+
+QModelIndex PlotBookModel::index(int row, int column,
+                                 const QModelIndex &pidx) const
+{
+    if ( _propCurveItem(pidx) ) {
+        return QModelIndex();
+    }
+    CurveItem* curveItem = _curveItem(pidx);
+    if ( curveItem ) {
+        if ( row < 0 || column < 0 || column > 1 ||
+             row >= curveItem->table()->rowCount(curveItem->id()) ) {
+            return QModelIndex();
+        }
+        return createIndex(row,column,curveItem);
+    }
+    return QStandardItemModel::index(row,column,pidx);
+}
+
+QModelIndex PlotBookModel::sibling(int row, int column,
+                                   const QModelIndex &idx) const
+{
+    if ( _propCurveItem(idx) ) {
+        return index(row,column,idx.parent());
+    }
+    return QStandardItemModel::sibling(row,column,idx);
+}
+
+int PlotBookModel::rowCount(const QModelIndex &pidx) const
+{
+    if ( _propCurveItem(pidx) ) {
+        return 0;
+    }
+    CurveItem* curveItem = _curveItem(pidx);
+    if ( curveItem ) {
+        return curveItem->table()->rowCount(curveItem->id());
+    }
+    return QStandardItemModel::rowCount(pidx);
+}
+
+int PlotBookModel::columnCount(const QModelIndex &pidx) const
+{
+    if ( _propCurveItem(pidx) ) {
+        return 0;
+    } else if ( _curveItem(pidx) ) {
+        return 2;
+    }
+    return QStandardItemModel::columnCount(pidx);
+}
+
+bool PlotBookModel::hasChildren(const QModelIndex &pidx) const
+{
+    if ( _propCurveItem(pidx) ) {
+        return false;
+    }
+    CurveItem* curveItem = _curveItem(pidx);
+    if ( curveItem ) {
+        return curveItem->table()->rowCount(curveItem->id()) > 0;
+    }
+    return QStandardItemModel::hasChildren(pidx);
+}
+
+QVariant PlotBookModel::data(const QModelIndex &idx, int role) const
+{
+    CurveItem* curveItem = _propCurveItem(idx);
+    if ( curveItem ) {
+        if ( role != Qt::DisplayRole && role != Qt::EditRole ) {
+            return QVariant();
+        }
+        int tag = curveItem->table()->tag(curveItem->id(),idx.row());
+        if ( idx.column() == 0 ) {
+            return CurvePropTable::tags().at(tag);
+        }
+        return curveItem->table()->value(curveItem->id(),tag);
+    }
+    return QStandardItemModel::data(idx,role);
+}
+
+Qt::ItemFlags PlotBookModel::flags(const QModelIndex &idx) const
+{
+    if ( _propCurveItem(idx) ) {
+        return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable |
+               Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled;
+    }
+    return QStandardItemModel::flags(idx);
+}
+
+QMap<int, QVariant> PlotBookModel::itemData(const QModelIndex &idx) const
+{
+    if ( _propCurveItem(idx) ) {
+        return QAbstractItemModel::itemData(idx);
+    }
+    return QStandardItemModel::itemData(idx);
+}
+
 void PlotBookModel::setPlotMathRect(const QRectF& mathRect,
                                     const QModelIndex& plotIdx)
 {
@@ -162,7 +314,18 @@ QStandardItem *PlotBookModel::addChild(QStandardItem *parentItem,
                                        const QString &childTitle,
                                        const QVariant &childValue)
 {
-    QStandardItem *columnZeroItem = new QStandardItem(childTitle);
+    if ( parentItem->type() == CurveItem::Type ) {
+        _addCurveProp(static_cast<CurveItem*>(parentItem),
+                      childTitle,childValue);
+        return 0;
+    }
+
+    QStandardItem *columnZeroItem;
+    if ( childTitle == "Curve" ) {
+        columnZeroItem = new CurveItem(_curveProps);
+    } else {
+        columnZeroItem = new QStandardItem(childTitle);
+    }
     QStandardItem *columnOneItem = new QStandardItem(childValue.toString());
 
     QList<QStandardItem*> items;
@@ -175,6 +338,37 @@ QStandardItem *PlotBookModel::addChild(QStandardItem *parentItem,
     return columnZeroItem;
 }
 
+void PlotBookModel::_addCurveProp(CurveItem *curveItem,
+                                  const QString &tagName,
+                                  const QVariant &value)
+{
+    CurvePropTable* table = curveItem->table();
+    int id = curveItem->id();
+    int tag = CurvePropTable::tagIndex(tagName);
+    if ( tag < 0 ) {
+        fprintf(stderr,"koviz [bad scoobs]: PlotBookModel::addChild() "
+                       "unknown curve property \"%s\"\n",
+                       tagName.toLatin1().constData());
+        exit(-1);
+    }
+
+    QModelIndex curveIdx = indexFromItem(curveItem);
+    if ( !curveIdx.isValid() ) {
+        // Not in model yet, so no views to tell
+        table->addTag(id,tag);
+        table->setValue(id,tag,value);
+        return;
+    }
+
+    int row = table->row(id,tag);
+    if ( !table->hasTag(id,tag) ) {
+        beginInsertRows(curveIdx,row,row);
+        table->addTag(id,tag);
+        endInsertRows();
+    }
+    setData(index(row,1,curveIdx),value);
+}
+
 // Returns page index for idx
 // If idx is a child of a page, it will return the parent page index
 QModelIndex PlotBookModel::_pageIdx(const QModelIndex& idx) const
@@ -259,8 +453,7 @@ QModelIndex PlotBookModel::_ancestorIdx(const QModelIndex &startIdx,
 
     if ( !expectedStartIdxText.isEmpty() ) {
         if ( !isIndex(startIdx, expectedStartIdxText) ) {
-            QStandardItem* startItem = itemFromIndex(startIdx);
-            QString startText = startItem->text();
+            QString startText = data(startIdx).toString();
             fprintf(stderr, "koviz [bad scoobies]: _ancestorIdx() received a "
                             "startIdx with tag=\"%s\". The expected start "
                             "item text was \"%s\".  The ancestor tag to "
@@ -443,8 +636,7 @@ QModelIndex PlotBookModel::getIndex(const QModelIndex &startIdx,
     if ( !expectedStartIdxText.isEmpty() ) {
         if ( startIdx.isValid() ) {
             if ( !isIndex(startIdx, expectedStartIdxText) ) {
-                QStandardItem* startItem = itemFromIndex(startIdx);
-                QString startText = startItem->text();
+                QString startText = data(startIdx).toString();
                 fprintf(stderr,"koviz [bad scoobs]:1: getIndex() received a "
                                "startIdx with tag=\"%s\".  The expected start "
                                "item text was \"%s\".\n",
@@ -529,13 +721,26 @@ QModelIndex PlotBookModel::getIndex(const QModelIndex &startIdx,
                            searchItemText.toLatin1().constData());
             exit(-1);
         }
+    } else if ( _curveItem(startIdx) ) {
+        CurveItem* curveItem = _curveItem(startIdx);
+        int tag = CurvePropTable::tagIndex(searchItemText);
+        if ( tag >= 0 && curveItem->table()->hasTag(curveItem->id(),tag) ) {
+            int row = curveItem->table()->row(curveItem->id(),tag);
+            idx = createIndex(row,0,curveItem);
+        } else {
+            fprintf(stderr,
+                    "koviz [bad scoobs]:4:PlotBookModel::getIndex()\n"
+                    "Curve has no \"%s\"\n",
+                    searchItemText.toLatin1().constData());
+            exit(-1);
+        }
     } else {
         QStringList cStrings;
-        int rc = itemFromIndex(startIdx)->rowCount();
+        int rc = rowCount(startIdx);
         bool isFound = false;
         for ( int i = 0; i < rc; ++i ) {
             QModelIndex cIdx = index(i,0,startIdx);
-            QString cText = itemFromIndex(cIdx)->text();
+            QString cText = data(cIdx).toString();
             cStrings << cText;
             if ( cText == searchItemText ) {
                 idx = cIdx;
@@ -756,6 +961,77 @@ QPainterPath* PlotBookModel::getPainterPath(const QModelIndex &curveIdx) const
     return path;
 }
 
+// Same as getPainterPath(curveIdx)->boundingRect() without walking the path
+QRectF PlotBookModel::getPainterPathBBox(const QModelIndex &curveIdx) const
+{
+    CurveModel* curveModel = getCurveModel(curveIdx);
+
+    if ( !_curve2pathState.contains(curveModel) ) {
+        fprintf(stderr,"koviz [bad scoobs]: "
+                       "PlotBookModel::getPainterPathBBox()\n");
+        exit(-1);
+    }
+
+    return _curve2pathState.value(curveModel).bbox;
+}
+
+// Append newly logged points to cached curve paths (see LiveTail)
+//
+// Only points past the last row consumed are added to a path, so the cost
+// is in the new points and not the whole curve.  If a plot is showing its
+// whole data (not zoomed/panned), its math rect grows to follow the data.
+// Returns true if any curve grew
+bool PlotBookModel::extendCurves()
+{
+    bool isExtended = false;
+
+    foreach ( QModelIndex pageIdx, pageIdxs() ) {
+        foreach ( QModelIndex plotIdx, plotIdxs(pageIdx) ) {
+            if ( !isChildIndex(plotIdx,"Plot","Curves") ) {
+                continue;
+            }
+            QModelIndex curvesIdx = getIndex(plotIdx,"Curves","Plot");
+            QModelIndex lastCurveIdx;
+            bool isFit = false;
+            foreach ( QModelIndex curveIdx, curveIdxs(curvesIdx) ) {
+                CurveModel* curveModel = getCurveModel(curveIdx);
+                if ( !curveModel || !_curve2pathState.contains(curveModel) ) {
+                    continue;
+                }
+                PainterPathState state = _curve2pathState.value(curveModel);
+                if ( state.nrows >= curveModel->rowCount() ) {
+                    continue;
+                }
+                if ( !lastCurveIdx.isValid() ) {
+                    QRectF bbox = calcCurvesBBox(curvesIdx);
+                    if ( bbox.top() < bbox.bottom() ) {
+                        bbox = QRectF(bbox.bottomLeft(),bbox.topRight());
+                    }
+                    isFit = ( getPlotMathRect(plotIdx) == bbox );
+                }
+                __appendPainterPath(_curve2path.value(curveModel),
+                                    curveModel,&state);
+                _curve2pathState.insert(curveModel,state);
+                lastCurveIdx = curveIdx;
+            }
+
+            if ( lastCurveIdx.isValid() ) {
+                isExtended = true;
+                if ( isFit ) {
+                    // Setting rect triggers a view refresh
+                    setPlotMathRect(calcCurvesBBox(curvesIdx),plotIdx);
+                } else {
+                    QModelIndex curveDataIdx = getDataIndex(lastCurveIdx,
+                                                           "CurveData","Curve");
+                    emit dataChanged(curveDataIdx,curveDataIdx);
+                }
+            }
+        }
+    }
+
+    return isExtended;
+}
+
 // TODO: cache error path if it's not changing
 QPainterPath *PlotBookModel::getCurvesErrorPath(const QModelIndex &curvesIdx)
 {
@@ -772,7 +1048,7 @@ QModelIndexList PlotBookModel::getIndexList(const QModelIndex &startIdx,
 
     QString startItemText;
     if ( startIdx.isValid() ) {
-        startItemText = itemFromIndex(startIdx)->text();
+        startItemText = data(startIdx).toString();
     }
 
     //
@@ -824,6 +1100,12 @@ bool PlotBookModel::isChildIndex(const QModelIndex &pidx,
 
     if (!isIndex(pidx,expectedParentItemText)) return false;
 
+    CurveItem* curveItem = _curveItem(pidx);
+    if ( curveItem ) {
+        int tag = CurvePropTable::tagIndex(childItemText);
+        return ( tag >= 0 && curveItem->table()->hasTag(curveItem->id(),tag) );
+    }
+
     int rc = rowCount(pidx);
     for ( int i = 0; i < rc; ++i ) {
         QModelIndex cIdx = index(i,0,pidx);
@@ -990,17 +1272,19 @@ double PlotBookModel::yBias(const QModelIndex &curveIdx) const
 
 QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
 {
+    KOVIZ_TRACE("bbox");
+
     QRectF bbox;
 
     QModelIndex plotIdx = curvesIdx.parent();
     QString plotXScale = getDataString(plotIdx,"PlotXScale","Plot");
     QString plotYScale = getDataString(plotIdx,"PlotYScale","Plot");
     QString presentation = getDataString(plotIdx,"PlotPresentation","Plot");
-    if ( presentation == "compare" || presentation == "error+compare" ) {
+    if ( presentation == "compare" || presentation == "error+compare" ||
+         presentation == "envelope" ) {
         int rc = rowCount(curvesIdx);
         for (int i = 0; i < rc; ++i) {
             QModelIndex curveIdx = index(i,0,curvesIdx);
-            QPainterPath* path = getPainterPath(curveIdx);
             double xb = 0.0;
             double yb = 0.0;
             double xs = 1.0;
@@ -1013,7 +1297,7 @@ QRectF PlotBookModel::calcCurvesBBox(const QModelIndex &curvesIdx) const
                 yb = yBias(curveIdx);
                 ys = yScale(curveIdx);
             }
-            QRectF pathBox = path->boundingRect();
+            QRectF pathBox = getPainterPathBBox(curveIdx);
             double w = pathBox.width();
             double h = pathBox.height();
             QPointF topLeft(xs*pathBox.topLeft().x()+xb,
@@ -1145,121 +1429,188 @@ QPainterPath* PlotBookModel::__createPainterPath(CurveModel *curveModel,
 {
     QPainterPath* path = new QPainterPath;
 
-    curveModel->map();
+    PainterPathState state;
+    state.nrows = 0;
+    state.cntNANs = 0;
+    state.startTime = startTime;
+    state.stopTime = stopTime;
+    state.xs = xs;
+    state.xb = xb;
+    state.ys = ys;
+    state.yb = yb;
+    state.isXLogScale = ( plotXScale == "log" ) ? true : false;
+    state.isYLogScale = ( plotYScale == "log" ) ? true : false;
+    state.bbox = QRectF();
+
+    __appendPainterPath(path,curveModel,&state);
+    _curve2pathState.insert(curveModel,state);
 
-    ModelIterator* it = curveModel->begin();
+    return path;
+}
 
-    bool isXLogScale = ( plotXScale == "log" ) ? true : false;
-    bool isYLogScale = ( plotYScale == "log" ) ? true : false;
+// Append curve model rows from state->nrows on to the end of path
+// Live data (see LiveTail) grows paths this way instead of rebuilding them
+void PlotBookModel::__appendPainterPath(QPainterPath *path,
+                                        CurveModel *curveModel,
+                                        PainterPathState *state)
+{
+    KOVIZ_TRACE("path append");
+
+    int rc = curveModel->rowCount();
+    if ( state->nrows >= rc ) {
+        return;
+    }
+
+    curveModel->map();
+
+    double startTime = state->startTime;
+    double stopTime = state->stopTime;
+    double xs = state->xs;
+    double xb = state->xb;
+    double ys = state->ys;
+    double yb = state->yb;
+    bool isXLogScale = state->isXLogScale;
+    bool isYLogScale = state->isYLogScale;
 
     double f = getDataDouble(QModelIndex(),"Frequency");
-    bool isFirst = true;
-    int cntNANs = 0;
-    while ( !it->isDone() ) {
-        double t = it->t();
-        if ( f > 0.0 ) {
-            if ( fabs(t-round(t/f)*f) > 1.0e-9 ) { // t not divisible by f?
-                it->next();
+    int nElements = path->elementCount();
+    bool isFirst = ( nElements == 0 );
+    int cntNANs = state->cntNANs;
+
+    // Rows are read a chunk of columns at a time (see CurveModel::read)
+    const int chunkSize = 4096;
+    QVector<double> ts(chunkSize);
+    QVector<double> xv(chunkSize);
+    QVector<double> yv(chunkSize);
+    for ( int beg = state->nrows; beg < rc; beg += chunkSize ) {
+        int nChunk = qMin(chunkSize,rc-beg);
+        curveModel->read(beg,nChunk,ts.data(),xv.data(),yv.data());
+        for ( int r = 0; r < nChunk; ++r ) {
+            double t = ts.at(r);
+            if ( f > 0.0 ) {
+                if ( fabs(t-round(t/f)*f) > 1.0e-9 ) { // t not divisible by f?
+                    continue;
+                }
+            }
+            if ( t < startTime || t > stopTime ) {
                 continue;
             }
-        }
-        if ( t < startTime || t > stopTime ) {
-            it->next();
-            continue;
-        }
 
-        double x = it->x();
-        double y = it->y();
+            double x = xv.at(r);
+            double y = yv.at(r);
 
-        if ( isXLogScale ) {
-            x = x*xs + xb;
-            if ( x > 0 ) {
-                x = log10(x);
-            } else if ( x < 0 ) {
-                x = log10(-x);
-            } else if ( x == 0 ) {
-                it->next();
-                continue; // skip log(0) since -inf
+            if ( isXLogScale ) {
+                x = x*xs + xb;
+                if ( x > 0 ) {
+                    x = log10(x);
+                } else if ( x < 0 ) {
+                    x = log10(-x);
+                } else if ( x == 0 ) {
+                    continue; // skip log(0) since -inf
+                }
             }
-        }
 
-        if ( isYLogScale ) {
-            y = y*ys + yb;
-            if ( y > 0 ) {
-                y = log10(y);
-            } else if ( y < 0 ) {
-                y = log10(-y);
-            } else if ( y == 0 ) {
-                it->next();
-                continue; // skip log(0) since -inf
+            if ( isYLogScale ) {
+                y = y*ys + yb;
+                if ( y > 0 ) {
+                    y = log10(y);
+                } else if ( y < 0 ) {
+                    y = log10(-y);
+                } else if ( y == 0 ) {
+                    continue; // skip log(0) since -inf
+                }
             }
-        }
 
-        if ( isFirst ) {
-            path->moveTo(x,y);
-            if ( path->elementCount() == 1 ) {
-                isFirst = false;
-                for ( int i = 0; i < cntNANs; ++i ) {
-                    // Beginning of path was nans
-                    // Add first good point to beginning of path cntNANs times
-                    int m = path->elementCount();
-                    path->lineTo(x+1.0,y+1.0); // see Note 2 at top of method
-                    int n = path->elementCount();
-                    if ( n > m ) {
-                        path->setElementPositionAt(n-1,x,y);
-                    } else {
-                        fprintf(stderr, "koviz [error]: __createPainterPath:1: "
-                                "could not add point (%g,%g)\n", x,y);
+            if ( isFirst ) {
+                path->moveTo(x,y);
+                if ( path->elementCount() == 1 ) {
+                    isFirst = false;
+                    for ( int i = 0; i < cntNANs; ++i ) {
+                        // Beginning of path was nans
+                        // Add first good point to beginning of path
+                        // cntNANs times
+                        int m = path->elementCount();
+                        path->lineTo(x+1.0,y+1.0); // see Note 2 at top
+                        int n = path->elementCount();
+                        if ( n > m ) {
+                            path->setElementPositionAt(n-1,x,y);
+                        } else {
+                            fprintf(stderr,
+                                    "koviz [error]: __createPainterPath:1: "
+                                    "could not add point (%g,%g)\n", x,y);
+                        }
                     }
+                } else {
+                    // Point not added, probably a nan
+                    // Count number nans that are at beginning of path
+                    ++cntNANs;
                 }
             } else {
-                // Point not added, probably a nan
-                // Count number nans that are at beginning of path
-                ++cntNANs;
-            }
-        } else {
-            int m = path->elementCount();
-            path->lineTo(x,y);
-            int n = path->elementCount();
-            if ( m == n ) {
-                /* When points are very close to one another,
-                 * it looks like Qt will skip adding a lineTo(x,y).
-                 * This bit of code tries to force Qt to add the
-                 * lineTo(x,y) no matter how close the two points
-                 * are to one another.
-                 * See Note 2 at top of method for more details
-                 */
-                path->lineTo(x+1.0,y+1.0);
-                int o = path->elementCount();
-                if ( o > 0 ) {
-                    if ( o > m ) {
-                        path->setElementPositionAt(o-1,x,y);
-                    } else {
-                        // If that fails, more than likely x or y is nan
-                        // Draw a line from the last point to itself
-                        // See Note 2 at top of method for more details
-                        QPainterPath::Element el = path->elementAt(o-1);
-                        int i = path->elementCount();
-                        path->lineTo(el.x+1,el.y+1);
-                        int j = path->elementCount();
-                        if ( i < j ) {
-                            path->setElementPositionAt(j-1,el.x,el.y);
+                int m = path->elementCount();
+                path->lineTo(x,y);
+                int n = path->elementCount();
+                if ( m == n ) {
+                    /* When points are very close to one another,
+                     * it looks like Qt will skip adding a lineTo(x,y).
+                     * This bit of code tries to force Qt to add the
+                     * lineTo(x,y) no matter how close the two points
+                     * are to one another.
+                     * See Note 2 at top of method for more details
+                     */
+                    path->lineTo(x+1.0,y+1.0);
+                    int o = path->elementCount();
+                    if ( o > 0 ) {
+                        if ( o > m ) {
+                            path->setElementPositionAt(o-1,x,y);
                         } else {
-                            fprintf(stderr,
-                                    "koviz [error] : __createPainterPath:2:"
-                                    " could not add point (%g,%g)\n",el.x,el.y);
+                            // If that fails, more than likely x or y is nan
+                            // Draw a line from the last point to itself
+                            // See Note 2 at top of method for more details
+                            QPainterPath::Element el = path->elementAt(o-1);
+                            int i = path->elementCount();
+                            path->lineTo(el.x+1,el.y+1);
+                            int j = path->elementCount();
+                            if ( i < j ) {
+                                path->setElementPositionAt(j-1,el.x,el.y);
+                            } else {
+                                fprintf(stderr,
+                                        "koviz [error] : __createPainterPath:2:"
+                                        " could not add point (%g,%g)\n",
+                                        el.x,el.y);
+                            }
                         }
                     }
                 }
             }
         }
-
-        it->next();
     }
-    delete it;
     curveModel->unmap();
 
-    return path;
+    state->nrows = rc;
+    state->cntNANs = cntNANs;
+
+    // Grow bbox by new elements only (path->boundingRect() walks whole path)
+    int ne = path->elementCount();
+    if ( ne > nElements ) {
+        double left = DBL_MAX;
+        double right = -DBL_MAX;
+        double top = DBL_MAX;
+        double bottom = -DBL_MAX;
+        if ( nElements > 0 ) {
+            left = state->bbox.left();
+            right = state->bbox.right();
+            top = state->bbox.top();
+            bottom = state->bbox.bottom();
+        }
+        for ( int i = nElements; i < ne; ++i ) {
+            QPainterPath::Element el = path->elementAt(i);
+            if ( el.x < left ) left = el.x;
+            if ( el.x > right ) right = el.x;
+            if ( el.y < top ) top = el.y;
+            if ( el.y > bottom ) bottom = el.y;
+        }
+        state->bbox = QRectF(QPointF(left,top),QPointF(right,bottom));
+    }
 }
 
 void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
@@ -1275,6 +1626,8 @@ void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
                                       const QString &plotYScaleIn,
                                       CurveModel *curveModelIn)
 {
+    KOVIZ_TRACE("path build");
+
     QModelIndex plotIdx = curveIdx.parent().parent();
 
     // Get curve model
@@ -1323,10 +1676,14 @@ void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
         QModelIndex curveXUnitIdx = getDataIndex(curveIdx,"CurveXUnit","Curve");
         bookXUnit = data(curveXUnitIdx).toString();
     }
+    CurveItem* curveItem = _curveItem(curveIdx);
     if ( !bookXUnit.isEmpty() && bookXUnit != "--" ) {
         QString loggedXUnit = curveModel->x()->unit();
-        xs = Unit::scale(loggedXUnit, bookXUnit);
-        xb = Unit::bias(loggedXUnit, bookXUnit);
+        UnitConversion xc = curveItem ?
+               curveItem->xUnitConverter.conversion(loggedXUnit, bookXUnit) :
+               Unit::conversion(loggedXUnit, bookXUnit);
+        xs = xc.scale;
+        xb = xc.bias;
     }
     double j = xScaleIn;
     if ( !isUseXScaleIn ) {
@@ -1353,8 +1710,11 @@ void PlotBookModel::_createPainterPath(const QModelIndex &curveIdx,
     }
     if ( !bookYUnit.isEmpty() && bookYUnit != "--" ) {
         QString loggedYUnit = curveModel->y()->unit();
-        ys = Unit::scale(loggedYUnit, bookYUnit);
-        yb = Unit::bias(loggedYUnit, bookYUnit);
+        UnitConversion yc = curveItem ?
+               curveItem->yUnitConverter.conversion(loggedYUnit, bookYUnit) :
+               Unit::conversion(loggedYUnit, bookYUnit);
+        ys = yc.scale;
+        yb = yc.bias;
     }
     double k = yScaleIn;
     if ( !isUseYScaleIn ) {
@@ -1497,15 +1857,19 @@ QPainterPath* PlotBookModel::_createCurvesErrorPath(
     double xb1 = getDataDouble(idx1,"CurveXBias","Curve");
     double xs0 = getDataDouble(idx0,"CurveXScale","Curve");
     double xs1 = getDataDouble(idx1,"CurveXScale","Curve");
-    if ( !dpUnits0.isEmpty() ) {
-        ys0 *= Unit::scale(c0->y()->unit(),dpUnits0);
-        yb0 += Unit::bias(c0->y()->unit(),dpUnits0);
-        ys1 *= Unit::scale(c1->y()->unit(),dpUnits0);
-        yb1 += Unit::bias(c1->y()->unit(),dpUnits0);
-    } else {
-        ys1 *= Unit::scale(c1->y()->unit(),c0->y()->unit());
-        yb1 += Unit::bias(c1->y()->unit(),c0->y()->unit());
-    }
+    CurveItem* item0 = _curveItem(idx0);
+    CurveItem* item1 = _curveItem(idx1);
+    QString toUnit = dpUnits0.isEmpty() ? c0->y()->unit() : dpUnits0;
+    UnitConversion uc0 = item0 ?
+                item0->yUnitConverter.conversion(c0->y()->unit(),toUnit) :
+                Unit::conversion(c0->y()->unit(),toUnit);
+    UnitConversion uc1 = item1 ?
+                item1->yUnitConverter.conversion(c1->y()->unit(),toUnit) :
+                Unit::conversion(c1->y()->unit(),toUnit);
+    ys0 *= uc0.scale;
+    yb0 += uc0.bias;
+    ys1 *= uc1.scale;
+    yb1 += uc1.bias;
 
     // By default the tolerance is 0.000001
     double tolerance = getDataDouble(QModelIndex(),"TimeMatchTolerance");
@@ -2050,6 +2414,37 @@ bool PlotBookModel::isMatch(const QString &str, const QString &exp) const
     return ok;
 }
 
+void PlotBookModel::setPageLoader(PageLoader *pageLoader)
+{
+    _pageLoader = pageLoader;
+}
+
+bool PlotBookModel::isPageLoaded(const QModelIndex &pageIdx) const
+{
+    if ( !_pageLoader ) {
+        return true;
+    }
+    return _pageLoader->isPageLoaded(pageIdx);
+}
+
+void PlotBookModel::loadPage(const QModelIndex &pageIdx)
+{
+    if ( _pageLoader && isIndex(pageIdx,"Page") &&
+         !_pageLoader->isPageLoaded(pageIdx) ) {
+        _pageLoader->loadPage(pageIdx);
+    }
+}
+
+void PlotBookModel::loadPages()
+{
+    if ( !_pageLoader ) {
+        return;
+    }
+    foreach ( QModelIndex pageIdx, pageIdxs() ) {
+        loadPage(pageIdx);
+    }
+}
+
 QList<double> PlotBookModel::majorXTics(const QModelIndex& plotIdx) const
 {
     QList<double> X;
@@ -21,12 +21,25 @@
 #include "unit.h"
 #include "utils.h"
 #include "curvemodel.h"
+#include "curveproptable.h"
+#include "plotchangerouter.h"
 
 #include <QList>
 #include <QColor>
 #include <cmath>
 #include <string.h>
 
+// Materializes curves of pages that were created without them.
+// Pages of large DPs are created as skeletons and their curves are loaded
+// when the page is first shown, printed or exported.
+class PageLoader
+{
+  public:
+    virtual ~PageLoader() {}
+    virtual bool isPageLoaded(const QModelIndex& pageIdx) const = 0;
+    virtual void loadPage(const QModelIndex& pageIdx) = 0;
+};
+
 class PlotBookModel : public QStandardItemModel
 {
     Q_OBJECT
@@ -40,6 +53,20 @@ public:
     virtual bool setData(const QModelIndex &idx,
                          const QVariant &value, int role=Qt::EditRole);
 
+    // Curve properties are not items.  They are kept in a CurvePropTable
+    // and given to views as indexes whose internal pointer is the curve item.
+    virtual QModelIndex index(int row, int column,
+                              const QModelIndex& pidx=QModelIndex()) const;
+    virtual QModelIndex sibling(int row, int column,
+                                const QModelIndex& idx) const;
+    virtual int rowCount(const QModelIndex& pidx=QModelIndex()) const;
+    virtual int columnCount(const QModelIndex& pidx=QModelIndex()) const;
+    virtual bool hasChildren(const QModelIndex& pidx=QModelIndex()) const;
+    virtual QVariant data(const QModelIndex& idx,
+                          int role=Qt::DisplayRole) const;
+    virtual Qt::ItemFlags flags(const QModelIndex& idx) const;
+    virtual QMap<int,QVariant> itemData(const QModelIndex& idx) const;
+
 public:
     double xScale(const QModelIndex& curveIdx,CurveModel* curveModelIn=0) const;
     double yScale(const QModelIndex& curveIdx) const;
@@ -47,6 +74,7 @@ public:
     double yBias(const QModelIndex& curveIdx) const;
     QRectF calcCurvesBBox(const QModelIndex& curvesIdx) const;
 
+    // Returns 0 when adding a property to a curve item
     QStandardItem* addChild(QStandardItem* parentItem,
                             const QString& childTitle,
                             const QVariant &childValue=QVariant());
@@ -98,6 +126,8 @@ public:
     CurveModel* getCurveModel(const QModelIndex& curveIdx) const;
 
     QPainterPath* getPainterPath(const QModelIndex& curveIdx) const;
+    QRectF getPainterPathBBox(const QModelIndex& curveIdx) const;
+    bool extendCurves();
     QPainterPath* getCurvesErrorPath(const QModelIndex& curvesIdx);
     QString getCurvesXUnit(const QModelIndex& curvesIdx);
     QString getCurvesYUnit(const QModelIndex& curvesIdx);
@@ -160,6 +190,16 @@ public:
     // Misc
     bool isMatch(const QString& str, const QString& exp) const;
 
+    // Lazily loaded pages (see PageLoader)
+    void setPageLoader(PageLoader* pageLoader);
+    PageLoader* pageLoader() const { return _pageLoader; }
+    bool isPageLoaded(const QModelIndex& pageIdx) const;
+    void loadPage(const QModelIndex& pageIdx);
+    void loadPages();   // e.g. before printing
+
+    // Routes changes under plots to the plot views (see PlotChangeRouter)
+    PlotChangeRouter* plotChangeRouter() const { return _plotChangeRouter; }
+
 signals:
     
 public slots:
@@ -167,7 +207,14 @@ public slots:
 private:
     QStringList _timeNames;
     Runs* _runs;
+    PageLoader* _pageLoader;
+    QSharedPointer<CurvePropTable> _curveProps;
+    PlotChangeRouter* _plotChangeRouter;
     void _initModel();
+    CurveItem* _curveItem(const QModelIndex& idx) const;
+    CurveItem* _propCurveItem(const QModelIndex& idx) const;
+    void _addCurveProp(CurveItem* curveItem,
+                       const QString& tagName, const QVariant& value);
     QModelIndex _pageIdx(const QModelIndex& idx) const ;
     QModelIndex _plotIdx(const QModelIndex& idx) const ;
     QModelIndex _ancestorIdx(const QModelIndex &startIdx,
@@ -175,6 +222,24 @@ private:
                         const QString &expectedStartIdxText=QString()) const;
 
     QHash<CurveModel*,QPainterPath*> _curve2path;
+
+    // What a cached path was built from, so that it can be appended to
+    struct PainterPathState
+    {
+        int nrows;        // curve model rows consumed by path
+        int cntNANs;      // nans at start of a still empty path
+        double startTime;
+        double stopTime;
+        double xs;
+        double xb;
+        double ys;
+        double yb;
+        bool isXLogScale;
+        bool isYLogScale;
+        QRectF bbox;      // path bounding box
+    };
+    QHash<CurveModel*,PainterPathState> _curve2pathState;
+
     void _createPainterPath(const QModelIndex& curveIdx,
                             bool isUseStartTimeIn, double startTimeIn,
                             bool isUseStopTimeIn, double stopTimeIn,
@@ -193,6 +258,8 @@ private:
                                       double ys, double yb,
                                       const QString& plotXScale,
                                       const QString& plotYScale);
+    void __appendPainterPath(QPainterPath* path, CurveModel* curveModel,
+                             PainterPathState* state);
     QPainterPath* _createCurvesErrorPath(const QModelIndex& curvesIdx) const;
 
     QString _commonRootName(const QStringList& names, const QString& sep) const;
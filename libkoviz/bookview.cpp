@@ -1,4 +1,5 @@
 #include "bookview.h"
+#include "trace.h"
 
 BookView::BookView(QWidget *parent) :
     BookIdxView(parent)
@@ -139,6 +140,9 @@ QModelIndex BookView::_tabIdToModelIdx(int tabId)
 
 void BookView::savePdf(const QString &fname)
 {
+    // Curves of pages not yet shown
+    _bookModel()->loadPages();
+
     //
     // Setup printer
     //
@@ -236,6 +240,8 @@ void BookView::saveJpg(const QString &fname)
 
 void BookView::_printPage(QPainter *painter, const QModelIndex& pageIdx)
 {
+    KOVIZ_TRACE("pdf page render");
+
     QPaintDevice* paintDevice = painter->device();
     if ( !paintDevice ) return;
 
@@ -1,4 +1,7 @@
 #include "bookview_curves.h"
+#include "trace.h"
+
+#include <QtConcurrentMap>
 
 CurvesView::CurvesView(QWidget *parent) :
     BookIdxView(parent),
@@ -8,16 +11,28 @@ CurvesView::CurvesView(QWidget *parent) :
     _bw_frame(0),
     _bw_label(0),
     _bw_slider(0),
+    _bwPendingFreq(0),
     _sg_frame(0),
     _sg_window(0),
     _sg_slider(0),
-    _integ_frame(0)
+    _integ_frame(0),
+    _envelopeHoverRow(-1)
 {
     setFocusPolicy(Qt::StrongFocus);
     setFrameShape(QFrame::NoFrame);
 
     // Set mouse tracking to receive mouse move events when button not pressed
     setMouseTracking(true);
+
+    // Filtered curves cached up to 256MB (cost is in KB)
+    _bwCache.setMaxCost(256*1024);
+    _bwTimer.setSingleShot(true);
+    _bwTimer.setInterval(30);
+    connect(&_bwTimer,SIGNAL(timeout()),this,SLOT(_keyPressBApply()));
+
+    _panTimer.setSingleShot(true);
+    _panTimer.setInterval(150);
+    connect(&_panTimer,SIGNAL(timeout()),this,SLOT(_panSettled()));
 }
 
 CurvesView::~CurvesView()
@@ -32,6 +47,9 @@ CurvesView::~CurvesView()
         delete cache->curveModel();
         delete cache;
     }
+    foreach ( FFTSpectrum* spectrum, _fftCache.spectra ) {
+        delete spectrum;
+    }
 }
 
 void CurvesView::setCurrentCurveRunID(int runID)
@@ -116,7 +134,8 @@ void CurvesView::paintEvent(QPaintEvent *event)
 
         _paintGrid(painter,rootIndex());
 
-        if ( plotPresentation == "compare" ) {
+        if ( plotPresentation == "compare" ||
+             plotPresentation == "envelope" ) {
             _paintCoplot(T,painter,pen);
         } else if ( plotPresentation == "error" ) {
             _paintErrorplot(T,painter,pen,rootIndex());
@@ -182,12 +201,17 @@ void CurvesView::_paintCoplot(const QTransform &T,QPainter &painter,QPen &pen)
         _paintCurve(currentIndex(),T,painter,true);
     }
 
+    _paintEnvelopeHover(T,painter);
+
     painter.restore();
 }
 
+// If stripM is valid, only the part of a time curve within the
+// stripM x range is drawn (see _panPixmap)
 void CurvesView::_paintCurve(const QModelIndex& curveIdx,
                              const QTransform& T,
-                             QPainter& painter, bool isHighlight)
+                             QPainter& painter, bool isHighlight,
+                             const QRectF& stripM)
 {
     painter.save();
     QPen origPen = painter.pen();
@@ -283,6 +307,30 @@ void CurvesView::_paintCurve(const QModelIndex& curveIdx,
             painter.setTransform(Tscaled);
         }
 
+        // Visible index range of curve in strip
+        QPainterPath stripPath;
+        if ( stripM.isValid() && xs != 0.0 && path->elementCount() > 1 &&
+             _bookModel()->isXTime(plotIdx) ) {
+            double x0 = (stripM.left()-xb)/xs;
+            double x1 = (stripM.right()-xb)/xs;
+            if ( x0 > x1 ) {
+                qSwap(x0,x1);
+            }
+            int n = path->elementCount();
+            int i0 = _idxAtTimeBinarySearch(path,0,n-1,x0);
+            int i1 = _idxAtTimeBinarySearch(path,0,n-1,x1)+1;
+            i1 = qMin(i1,n-1);
+            for ( int i = i0; i <= i1; ++i ) {
+                QPainterPath::Element el = path->elementAt(i);
+                if ( i == i0 || el.isMoveTo() ) {
+                    stripPath.moveTo(el.x,el.y);
+                } else {
+                    stripPath.lineTo(el.x,el.y);
+                }
+            }
+            path = &stripPath;
+        }
+
         // Line style
         QString lineStyle = _bookModel()->getDataString(curveIdx,
                                                       "CurveLineStyle","Curve");
@@ -984,57 +1032,16 @@ void CurvesView::dataChanged(const QModelIndex &topLeft,
         QRectF M = model()->data(topLeft).toRectF();
 
         if ( M.size().width() > 0 && M.size().height() != 0 && _lastM != M ) {
-            if ( _pixmap ) {
-                delete _pixmap;
+            if ( !_panPixmap(_lastM,M) ) {
+                if ( _pixmap ) {
+                    delete _pixmap;
+                }
+                _pixmap = _createLivePixmap();
             }
-            _pixmap = _createLivePixmap();
         }
 
         _lastM = M;  // Saved so that pixmap is not recreated if M unchanged
 
-    } else if ( tag == "PlotMathRect" && topLeft.parent() != rootIndex() ) {
-        // Another plot has changed its PlotMathRect.
-        // Synchronize this plot's PlotMathRect with the changed one
-        // to keep zoom/pan synchronized across plots.
-
-        // Only synchronize when x variables are time (normal case).
-        if ( _bookModel()->isXTime(topLeft.parent()) &&
-             _bookModel()->isXTime(rootIndex()) ) {
-            QRectF M = model()->data(topLeft).toRectF();
-            QModelIndex plotRectIdx = _bookModel()->getDataIndex(rootIndex(),
-                                                         "PlotMathRect","Plot");
-            QRectF R = model()->data(plotRectIdx).toRectF();
-
-            QString R_PlotXScale = _bookModel()->getDataString(rootIndex(),
-                                                               "PlotXScale",
-                                                               "Plot");
-            QString M_PlotXScale = _bookModel()->getDataString(topLeft.parent(),
-                                                               "PlotXScale",
-                                                               "Plot");
-            if ( M_PlotXScale == "log" && R_PlotXScale == "linear" ) {
-                M.setLeft(pow(10,M.left()));
-                M.setRight(pow(10,M.right()));
-            } else if ( M_PlotXScale == "linear" && R_PlotXScale == "log") {
-                if ( M.left() != 0.0 ) {
-                    M.setLeft(log10(M.left()));
-                }
-                if ( M.right() != 0.0 ) {
-                    M.setRight(log10(M.right()));
-                }
-            }
-            if ( M.left() != R.left() || M.right() != R.right() ) {
-                R.setLeft(M.left());
-                R.setRight(M.right());
-                double plotXMinRange = _bookModel()->getDataDouble(rootIndex(),
-                                                        "PlotXMinRange","Plot");
-                double plotXMaxRange = _bookModel()->getDataDouble(rootIndex(),
-                                                        "PlotXMaxRange","Plot");
-                if ( R.left() >= plotXMinRange && R.right() <= plotXMaxRange ) {
-                    // Set R if within PlotXMin/MaxRange
-                    _bookModel()->setPlotMathRect(R,rootIndex());
-                }
-            }
-        }
     } else if ( topLeft.parent().parent().parent() == rootIndex() ) {
         if ( tag == "CurveXBias" ) {
             if ( _pixmap ) {
@@ -1058,7 +1065,12 @@ void CurvesView::dataChanged(const QModelIndex &topLeft,
             _pixmap = _createLivePixmap();
         }
     } else if ( topLeft.parent() == rootIndex() ) {
-        if ( tag == "PlotXScale" || tag == "PlotYScale" ) {
+        if ( tag == "PlotPresentation" ) {
+            if ( _pixmap ) {
+                delete _pixmap;
+            }
+            _pixmap = _createLivePixmap();
+        } else if ( tag == "PlotXScale" || tag == "PlotYScale" ) {
             if ( _pixmap ) {
                 delete _pixmap;
             }
@@ -1076,6 +1088,11 @@ void CurvesView::dataChanged(const QModelIndex &topLeft,
 
 QPixmap* CurvesView::_createLivePixmap()
 {
+    KOVIZ_TRACE("pixmap render");
+
+    _panTimer.stop();
+    _panResidual = QPointF(0,0);
+
     if ( viewport()->rect().size().width() == 0 ||
          viewport()->rect().size().height() == 0 ) {
         return 0;
@@ -1097,6 +1114,10 @@ QPixmap* CurvesView::_createLivePixmap()
     _paintGrid(painter, rootIndex());
 
     QTransform T = _coordToPixelTransform();
+    if ( _isEnvelope() ) {
+        _paintEnvelope(T,painter);
+        return livePixmap;
+    }
     QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
     int rc = model()->rowCount(curvesIdx);
     for ( int i = 0; i < rc; ++i ) {
@@ -1107,6 +1128,311 @@ QPixmap* CurvesView::_createLivePixmap()
     return livePixmap;
 }
 
+// When M is prevM translated (a pan), scroll the pixmap by the pan and
+// render only the strips that scrolled into view.  Curves are restricted
+// to their index range in a strip.  Returns false if a full render is
+// needed instead (zoom, resize, envelope or a pan larger than the view).
+//
+// Scrolling is by whole pixels, so the rounding error is carried in
+// _panResidual to keep it from accumulating over a drag.  A full
+// render is done when the pan settles.
+bool CurvesView::_panPixmap(const QRectF &prevM, const QRectF &M)
+{
+    QRect W = viewport()->rect();
+    if ( !_pixmap || _pixmap->size() != W.size() ) {
+        return false;
+    }
+    if ( prevM.width() <= 0.0 || prevM.height() == 0.0 ) {
+        return false;
+    }
+    if ( !qFuzzyCompare(prevM.width(),M.width()) ||
+         !qFuzzyCompare(prevM.height(),M.height()) ) {
+        return false;
+    }
+    if ( _isEnvelope() ) {
+        return false;   // envelope bins are relative to M
+    }
+
+    double a = W.width()/M.width();
+    double b = W.height()/M.height();
+    QPointF d(a*(prevM.left()-M.left()), b*(prevM.top()-M.top()));
+    QPoint shift = (d-_panResidual).toPoint();
+    if ( qAbs(shift.x()) >= W.width() || qAbs(shift.y()) >= W.height() ) {
+        return false;
+    }
+    _panResidual += QPointF(shift)-d;
+
+    KOVIZ_TRACE("pan render");
+
+    QRegion exposed;
+    _pixmap->scroll(shift.x(),shift.y(),_pixmap->rect(),&exposed);
+
+    QPainter painter(_pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QModelIndex pageIdx = rootIndex().parent().parent();
+    QColor bg = _bookModel()->pageBackgroundColor(pageIdx);
+    QTransform T = _coordToPixelTransform();
+    QTransform Tinv = T.inverted();
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    int rc = model()->rowCount(curvesIdx);
+
+    // Pad strips so that lines and symbols crossing their edges are drawn
+    int pad = 2;
+    for ( int i = 0; i < rc; ++i ) {
+        QModelIndex curveIdx = model()->index(i,0,curvesIdx);
+        pad = qMax(pad,_curveExtent(curveIdx,painter)+1);
+    }
+
+    foreach ( QRect strip, exposed.rects() ) {
+        painter.setClipRect(strip);
+        painter.fillRect(strip,bg);
+        _paintGrid(painter, rootIndex());
+        QRectF stripM = Tinv.mapRect(
+                             QRectF(strip.adjusted(-pad,-pad,pad,pad)));
+        for ( int i = 0; i < rc; ++i ) {
+            QModelIndex curveIdx = model()->index(i,0,curvesIdx);
+            _paintCurve(curveIdx,T,painter,false,stripM);
+        }
+    }
+
+    _panTimer.start();
+
+    return true;
+}
+
+// Pixels a curve's line or symbols reach from its points
+// (see _paintCurve and __paintSymbol)
+int CurvesView::_curveExtent(const QModelIndex &curveIdx,
+                             const QPainter &painter)
+{
+    int extent = 1;
+
+    QString lineStyle = _bookModel()->getDataString(curveIdx,
+                                                  "CurveLineStyle","Curve");
+    lineStyle = lineStyle.toLower();
+    if ( lineStyle == "thick_line" ) {
+        extent = 2;
+    } else if ( lineStyle == "x_thick_line" || lineStyle == "scatter" ) {
+        extent = 3;
+    }
+
+    QString symbolStyle = _bookModel()->getDataString(curveIdx,
+                                               "CurveSymbolStyle","Curve");
+    symbolStyle = symbolStyle.toLower();
+    if ( symbolStyle.startsWith("number_") ) {
+        // Circle around a 7pt digit
+        QFont font = painter.font();
+        font.setPointSize(7);
+        QFontMetrics fm(font);
+        QRectF bbox(fm.tightBoundingRect(symbolStyle.right(1)));
+        double l = 3.0*qMax(bbox.width(),bbox.height())/2.0;
+        extent = qMax(extent,(int)ceil(l/2.0)+1);
+    } else if ( !symbolStyle.isEmpty() && symbolStyle != "none" ) {
+        extent = qMax(extent,5);  // e.g. thick_triangle
+    }
+
+    return extent;
+}
+
+void CurvesView::_panSettled()
+{
+    if ( _pixmap ) {
+        delete _pixmap;
+    }
+    _pixmap = _createLivePixmap();
+    viewport()->update();
+}
+
+// Envelope is drawn for time plots with more than two curves
+bool CurvesView::_isEnvelope()
+{
+    QString pres = _bookModel()->getDataString(rootIndex(),
+                                               "PlotPresentation","Plot");
+    if ( pres != "envelope" || !_bookModel()->isXTime(rootIndex()) ) {
+        return false;
+    }
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    return ( model()->rowCount(curvesIdx) > 2 );
+}
+
+// Curve painter paths in curve row order
+QList<EnvelopeCurve> CurvesView::_envelopeCurves()
+{
+    QList<EnvelopeCurve> curves;
+
+    QString plotXScale = _bookModel()->getDataString(rootIndex(),
+                                                     "PlotXScale","Plot");
+    QString plotYScale = _bookModel()->getDataString(rootIndex(),
+                                                     "PlotYScale","Plot");
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    int rc = model()->rowCount(curvesIdx);
+    for ( int i = 0; i < rc; ++i ) {
+        QModelIndex curveIdx = model()->index(i,0,curvesIdx);
+        QPainterPath* path = _bookModel()->getPainterPath(curveIdx);
+        if ( !path ) {
+            continue;
+        }
+        // If logscale, scale/bias done in _createPainterPath
+        EnvelopeCurve curve(path,1.0,0.0,1.0,0.0);
+        if ( plotXScale == "linear" ) {
+            curve.xs = _bookModel()->xScale(curveIdx);
+            curve.xb = _bookModel()->xBias(curveIdx);
+        }
+        if ( plotYScale == "linear" ) {
+            curve.ys = _bookModel()->yScale(curveIdx);
+            curve.yb = _bookModel()->yBias(curveIdx);
+        }
+        curves.append(curve);
+    }
+
+    return curves;
+}
+
+// Filled band between lo and hi, broken where no curve has a value
+static void _paintEnvelopeBand(QPainter& painter, const QTransform& T,
+                               const Envelope& env,
+                               const QVector<double>& lo,
+                               const QVector<double>& hi,
+                               const QColor& color)
+{
+    painter.setBrush(color);
+    int n = env.nbins();
+    int beg = 0;
+    while ( beg < n ) {
+        if ( env.count.at(beg) == 0 ) {
+            ++beg;
+            continue;
+        }
+        int end = beg;
+        while ( end < n && env.count.at(end) > 0 ) {
+            ++end;
+        }
+        QPolygonF band;
+        for ( int b = beg; b < end; ++b ) {
+            band << T.map(QPointF(env.time.at(b),hi.at(b)));
+        }
+        for ( int b = end-1; b >= beg; --b ) {
+            band << T.map(QPointF(env.time.at(b),lo.at(b)));
+        }
+        painter.drawPolygon(band);
+        beg = end;
+    }
+}
+
+static void _paintEnvelopeLine(QPainter& painter, const QTransform& T,
+                               const Envelope& env,
+                               const QVector<double>& y)
+{
+    QPolygonF line;
+    for ( int b = 0; b < env.nbins(); ++b ) {
+        if ( env.count.at(b) == 0 ) {
+            if ( line.size() > 0 ) {
+                painter.drawPolyline(line);
+                line.clear();
+            }
+            continue;
+        }
+        line << T.map(QPointF(env.time.at(b),y.at(b)));
+    }
+    if ( line.size() > 0 ) {
+        painter.drawPolyline(line);
+    }
+}
+
+// Bands for min/max, 5-95 percentile and mean +/- sigma with mean and
+// median lines.  Bins are about two pixels wide, so the cost of drawing
+// does not grow with the number of runs.
+void CurvesView::_paintEnvelope(const QTransform &T, QPainter &painter)
+{
+    KOVIZ_TRACE("envelope render");
+
+    QList<EnvelopeCurve> curves = _envelopeCurves();
+    if ( curves.isEmpty() ) {
+        return;
+    }
+
+    QRectF M = _mathRect();
+    int nbins = qMax(1,viewport()->rect().width()/2);
+    Envelope env(curves,M.left(),M.right(),nbins);
+    if ( env.nbins() == 0 ) {
+        return;
+    }
+
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    QModelIndex curveIdx = model()->index(0,0,curvesIdx);
+    QColor color(_bookModel()->getDataString(curveIdx,"CurveColor","Curve"));
+
+    painter.save();
+    QTransform I;
+    painter.setTransform(I);
+    painter.setPen(Qt::NoPen);
+
+    QVector<double> lo(nbins);
+    QVector<double> hi(nbins);
+    for ( int b = 0; b < nbins; ++b ) {
+        lo[b] = env.mean.at(b)-env.sigma.at(b);
+        hi[b] = env.mean.at(b)+env.sigma.at(b);
+    }
+
+    QColor fill(color);
+    fill.setAlpha(40);
+    _paintEnvelopeBand(painter,T,env,env.min,env.max,fill);
+    fill.setAlpha(70);
+    _paintEnvelopeBand(painter,T,env,env.percentile.first(),
+                       env.percentile.last(),fill);
+    fill.setAlpha(110);
+    _paintEnvelopeBand(painter,T,env,lo,hi,fill);
+
+    painter.setBrush(Qt::NoBrush);
+    QPen pen(color);
+    pen.setWidth(0);
+    painter.setPen(pen);
+    _paintEnvelopeLine(painter,T,env,env.mean);
+    pen.setStyle(Qt::DashLine);
+    painter.setPen(pen);
+    _paintEnvelopeLine(painter,T,env,env.percentile.at(1));
+
+    painter.restore();
+}
+
+// Run closest to the mouse is drawn over the envelope with its run id
+void CurvesView::_paintEnvelopeHover(const QTransform &T, QPainter &painter)
+{
+    if ( _envelopeHoverRow < 0 || !_isEnvelope() ) {
+        return;
+    }
+    QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
+    if ( _envelopeHoverRow >= model()->rowCount(curvesIdx) ) {
+        return;
+    }
+    QModelIndex curveIdx = model()->index(_envelopeHoverRow,0,curvesIdx);
+
+    _paintCurve(curveIdx,T,painter,true);
+
+    painter.save();
+    QTransform I;
+    painter.setTransform(I);
+    QPointF pt = T.map(_envelopeHoverPt);
+    painter.drawEllipse(pt,3,3);
+    int runID = _bookModel()->getDataInt(curveIdx,"CurveRunID","Curve");
+    QString lbl = QString("run %1: %2").arg(runID)
+                                       .arg(_format(_envelopeHoverPt.y()));
+    painter.drawText(pt+QPointF(8,-8),lbl);
+    painter.restore();
+}
+
+void CurvesView::_envelopeHover(const QPoint &pt)
+{
+    QTransform T = _coordToPixelTransform().inverted();
+    QPointF mPt = T.map(QPointF(pt));
+
+    double y;
+    int row = Envelope::closestCurve(_envelopeCurves(),mPt.x(),mPt.y(),&y);
+    _envelopeHoverRow = row;
+    _envelopeHoverPt = QPointF(mPt.x(),y);
+}
+
 QString CurvesView::_format(double d)
 {
     QString s;
@@ -1474,6 +1800,15 @@ void CurvesView::mouseMoveEvent(QMouseEvent *event)
 
     _mouseCurrPos = event->pos();
 
+    if ( event->buttons() == Qt::NoButton && _isEnvelope() ) {
+        // Runs are hidden in the envelope, so pick out the one under mouse
+        if ( !(event->modifiers() & Qt::ShiftModifier) ) {
+            _envelopeHover(event->pos());
+            viewport()->update();
+        }
+        return;
+    }
+
     if ( event->buttons() == Qt::NoButton && currentIndex().isValid() ) {
 
         QString tag = model()->data(currentIndex()).toString();
@@ -2304,11 +2639,24 @@ void CurvesView::resizeEvent(QResizeEvent *event)
 }
 
 // For two curves hitting the spacebar will toggle between viewing
-// the two curves in error, compare and error+compare views
+// the two curves in error, compare and error+compare views.
+// For more curves (e.g. a MONTE) it toggles compare and envelope views.
 void CurvesView::_keyPressSpace()
 {
     QModelIndex curvesIdx = _bookModel()->getIndex(rootIndex(),"Curves","Plot");
     int rc = model()->rowCount(curvesIdx);
+    if ( rc > 2 ) {
+        if ( !_bookModel()->isXTime(rootIndex()) ) return;
+        QString pres = _bookModel()->getDataString(rootIndex(),
+                                                   "PlotPresentation","Plot");
+        pres = ( pres == "envelope" ) ? "compare" : "envelope";
+        QModelIndex presIdx = _bookModel()->getDataIndex(rootIndex(),
+                                                   "PlotPresentation","Plot");
+        model()->setData(presIdx,pres);
+        _envelopeHoverRow = -1;
+        viewport()->update();
+        return;
+    }
     if ( rc != 2 ) return;
 
     QString plotPresentation = _bookModel()->getDataString(rootIndex(),
@@ -2448,6 +2796,26 @@ void CurvesView::_keyPressEscape()
     viewport()->update();
 }
 
+static void _computeFFTSpectrum(FFTSpectrum*& spectrum)
+{
+    spectrum->compute();
+}
+
+// Row count is in the key so spectra of live tailed curves are redone
+QString CurvesView::_fftSpectrumKey(CurveModel *curveModel,
+                                    double xb, double xs,
+                                    double begX, double endX) const
+{
+    QString key = QString("%1,%2,%3,%4,%5,%6,%7")
+                  .arg((quintptr)curveModel)
+                  .arg(curveModel->fileName())
+                  .arg(curveModel->y()->name())
+                  .arg(curveModel->rowCount())
+                  .arg(xb,0,'g',17).arg(xs,0,'g',17)
+                  .arg(QString("%1:%2").arg(begX,0,'g',17).arg(endX,0,'g',17));
+    return key;
+}
+
 // Toggle between Time and Frequency domain
 void CurvesView::_keyPressF()
 {
@@ -2507,6 +2875,48 @@ void CurvesView::_keyPressF()
         _fftCache.start = _bookModel()->data(startTimeIdx).toDouble();
         _fftCache.stop = _bookModel()->data(stopTimeIdx).toDouble();
         _fftCache.curveCaches.clear();
+
+        // Spectra are kept across toggles, so only new curves (or curves
+        // whose scale, bias or x range changed) are transformed.  Those
+        // are transformed concurrently.
+        QList<FFTSpectrum*> spectra;
+        QList<FFTSpectrum*> todo;
+        QHash<QString,FFTSpectrum*> keep;
+        foreach ( QModelIndex curveIdx, curveIdxs ) {
+            CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
+            double xb = _bookModel()->getDataDouble(curveIdx,
+                                                    "CurveXBias","Curve");
+            double xs = _bookModel()->getDataDouble(curveIdx,
+                                                    "CurveXScale","Curve");
+            QString key = _fftSpectrumKey(curveModel,xb,xs,
+                                          M.left(),M.right());
+            FFTSpectrum* spectrum = keep.value(key,0);
+            if ( !spectrum ) {
+                spectrum = _fftCache.spectra.take(key);
+            }
+            if ( !spectrum ) {
+                spectrum = new FFTSpectrum(curveModel,xb,xs,
+                                           M.left(),M.right());
+                todo.append(spectrum);
+            }
+            keep.insert(key,spectrum);
+            spectra.append(spectrum);
+        }
+        foreach ( FFTSpectrum* spectrum, _fftCache.spectra ) {
+            delete spectrum;
+        }
+        _fftCache.spectra = keep;
+
+        // Curves may share a data model, so map all before computing
+        // and unmap only after every spectrum is done
+        foreach ( FFTSpectrum* spectrum, todo ) {
+            spectrum->curveModel->map();
+        }
+        QtConcurrent::blockingMap(todo,_computeFFTSpectrum);
+        foreach ( FFTSpectrum* spectrum, todo ) {
+            spectrum->curveModel->unmap();
+        }
+
         bool block = _bookModel()->blockSignals(true);
         foreach ( QModelIndex curveIdx, curveIdxs ) {
             CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
@@ -2517,9 +2927,7 @@ void CurvesView::_keyPressF()
             FFTCurveCache* cache = new FFTCurveCache(xb,xs,curveModel);
             _fftCache.curveCaches.append(cache);
 
-            CurveModel* fft = new CurveModelFFT(curveModel,
-                                                xb,xs,
-                                                M.left(),M.right());
+            CurveModel* fft = new CurveModelFFT(*spectra.at(i));
             QVariant v = PtrToQVariant<CurveModel>::convert(fft);
             QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
                                                            "CurveData","Curve");
@@ -2652,6 +3060,8 @@ void CurvesView::_keyPressB()
             this,SLOT(_keyPressBLineEditReturnPressed()));
 
     // Get Nyquist frequency for bw filter
+    _bwChannels.clear();
+    _bwCache.clear();
     double dtMin = DBL_MAX;
     foreach ( QModelIndex curveIdx, curveIdxs ) {
         CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
@@ -2663,6 +3073,7 @@ void CurvesView::_keyPressB()
             double lastTime = 0.0;
             double lastDt = 0.0;
             ModelIterator* it = curveModel->begin();
+            double beginTime = it->isDone() ? 0.0 : it->t();
             while ( !it->isDone() ) {
                 if ( isFirst ) {
                     isFirst = false;
@@ -2744,6 +3155,8 @@ void CurvesView::_keyPressB()
                 it->next();
                 ++i;
             }
+            _bwChannels.insert(curveModel->_real,
+                               BWChannel(curveModel->_real,N,beginTime,dt));
         }
     }
     int maxFilterFreq = 0; // Nyquist frequency - 1
@@ -2770,50 +3183,117 @@ void CurvesView::_keyPressB()
 
 void CurvesView::_keyPressBSliderChanged(int value)
 {
-    QModelIndex plotIdx = rootIndex();
-    QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
-    QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
-                                                           "Curve","Curves");
-
-    bool block = _bookModel()->blockSignals(true);
-    foreach ( QModelIndex curveIdx, curveIdxs ) {
-        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
-        if ( curveModel ) {
-            CurveModel* bw = new CurveModelBW(curveModel,value);
-            QVariant v = PtrToQVariant<CurveModel>::convert(bw);
-            QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
-                                                           "CurveData","Curve");
-            _bookModel()->setData(curveDataIdx,v);
-            curveModel->_real = 0; // Zero out cache since bw now owns it
-            delete curveModel;
-        }
-    }
-    _bookModel()->blockSignals(block);
-
-    // Reset bounding box so that plot refreshes (optimizing redraw)
-    QRectF Z; // Empty
-    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
-    _bookModel()->setPlotMathRect(Z,plotIdx);
-    _bookModel()->setPlotMathRect(M,plotIdx);
+    _bwPendingFreq = value;
+    _bwTimer.start();
 
     // Update lineedit label
     QString s = QString("%1").arg(value);
     _bw_label->setText(s);
 }
 
+void CurvesView::_keyPressBApply()
+{
+    _keyPressBChange(_bwPendingFreq);
+}
+
 void CurvesView::_keyPressBLineEditReturnPressed()
 {
     QString s = _bw_label->text();
     bool ok;
     int value = s.toInt(&ok);
     if ( ok ) {
-        _keyPressBSliderChanged(value);
+        _bwTimer.stop();
+        _keyPressBChange(value);
 
         // Update slider
         _bw_slider->setValue(value);
     }
 }
 
+// Curves without a cached result for freq are filtered in batches of
+// curves with the same dt and length
+void CurvesView::_keyPressBChange(int freq)
+{
+    QModelIndex plotIdx = rootIndex();
+    QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
+    QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
+                                                           "Curve","Curves");
+
+    // Hits are copied out up front since inserting new results below
+    // may evict them
+    QHash<int,QVector<double> > filtered;
+    QSet<int> isFresh;
+    QHash<QString,QList<int> > batches;
+    for ( int i = 0; i < curveIdxs.size(); ++i ) {
+        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdxs.at(i));
+        if ( !curveModel || !_bwChannels.contains(curveModel->_real) ) {
+            continue;
+        }
+        QPair<quintptr,int> key((quintptr)curveModel->_real,freq);
+        QVector<double>* hit = _bwCache.object(key);
+        if ( hit ) {
+            filtered.insert(i,*hit);
+        } else {
+            BWChannel channel = _bwChannels.value(curveModel->_real);
+            QString batchKey = QString("%1,%2").arg(channel.dt,0,'g',17)
+                                               .arg(channel.n);
+            batches[batchKey].append(i);
+            isFresh.insert(i);
+        }
+    }
+
+    foreach ( QList<int> batch, batches ) {
+        BWChannel first = _bwChannels.value(
+                       _bookModel()->getCurveModel(curveIdxs.at(batch.at(0)))
+                       ->_real);
+        QVector<const double*> ins;
+        QVector<double*> outs;
+        foreach ( int i, batch ) {
+            CurveModel* curveModel =_bookModel()->getCurveModel(curveIdxs.at(i));
+            filtered[i] = QVector<double>(first.n);
+            ins.append(curveModel->_real);
+            outs.append(filtered[i].data());
+        }
+        BWLowPassBatch bw(4,1/first.dt,freq);
+        bw.filter(ins,outs,first.n);
+    }
+
+    bool block = _bookModel()->blockSignals(true);
+    for ( int i = 0; i < curveIdxs.size(); ++i ) {
+        QModelIndex curveIdx = curveIdxs.at(i);
+        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
+        if ( !curveModel ) {
+            continue;
+        }
+        CurveModel* bw = 0;
+        if ( _bwChannels.contains(curveModel->_real) ) {
+            BWChannel channel = _bwChannels.value(curveModel->_real);
+            QPair<quintptr,int> key((quintptr)curveModel->_real,freq);
+            QVector<double> ys = filtered.value(i);
+            bw = new CurveModelBW(curveModel,freq,channel,ys);
+            if ( isFresh.contains(i) ) {
+                _bwCache.insert(key,new QVector<double>(ys),
+                                ys.size()*sizeof(double)/1024+1);
+            }
+        } else {
+            bw = new CurveModelBW(curveModel,freq);
+        }
+        QVariant v = PtrToQVariant<CurveModel>::convert(bw);
+        QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
+                                                           "CurveData","Curve");
+        _bookModel()->setData(curveDataIdx,v);
+        curveModel->_real = 0; // Zero out cache since bw now owns it
+        delete curveModel;
+    }
+    _bookModel()->blockSignals(block);
+
+    // Reset bounding box so that plot refreshes (optimizing redraw)
+    QRectF Z; // Empty
+    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
+    _bookModel()->setPlotMathRect(Z,plotIdx);
+    _bookModel()->setPlotMathRect(M,plotIdx);
+}
+
 void CurvesView::_keyPressG()
 {
     QModelIndex plotIdx = rootIndex();
@@ -3359,6 +3839,11 @@ void CurvesView::_keyPressI()
     }
 }
 
+static void _runSGSmoothJob(SGSmoothJob& job)
+{
+    job.run();
+}
+
 void CurvesView::_keyPressGChange(int window, int degree)
 {
     QModelIndex plotIdx = rootIndex();
@@ -3366,47 +3851,28 @@ void CurvesView::_keyPressGChange(int window, int degree)
     QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
                                                            "Curve","Curves");
 
-    bool block = _bookModel()->blockSignals(true);
+    // Smooth all curves concurrently, then swap models in the GUI thread
+    QModelIndexList jobIdxs;
+    QList<SGSmoothJob> jobs;
     foreach ( QModelIndex curveIdx, curveIdxs ) {
         CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
         if ( curveModel ) {
-            CurveModel* sg = new CurveModelSG(curveModel,window,degree);
-            QVariant v = PtrToQVariant<CurveModel>::convert(sg);
-            QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
-                                                           "CurveData","Curve");
-            _bookModel()->setData(curveDataIdx,v);
-            curveModel->_real = 0; // Zero out cache since sg now owns it
-            delete curveModel;
+            jobIdxs.append(curveIdx);
+            jobs.append(SGSmoothJob(curveModel,window,degree));
         }
     }
-    _bookModel()->blockSignals(block);
-
-    // Reset bounding box so that plot refreshes (optimizing redraw)
-    QRectF Z; // Empty
-    QRectF M = _bookModel()->getPlotMathRect(plotIdx);
-    _bookModel()->setPlotMathRect(Z,plotIdx);
-    _bookModel()->setPlotMathRect(M,plotIdx);
-}
-
-void CurvesView::_keyPressGSliderChanged(int value)
-{
-    QModelIndex plotIdx = rootIndex();
-    QModelIndex curvesIdx = _bookModel()->getIndex(plotIdx,"Curves","Plot");
-    QModelIndexList curveIdxs = _bookModel()->getIndexList(curvesIdx,
-                                                           "Curve","Curves");
+    QtConcurrent::blockingMap(jobs,_runSGSmoothJob);
 
     bool block = _bookModel()->blockSignals(true);
-    foreach ( QModelIndex curveIdx, curveIdxs ) {
-        CurveModel* curveModel = _bookModel()->getCurveModel(curveIdx);
-        if ( curveModel ) {
-            CurveModel* sg = new CurveModelSG(curveModel,value,3);
-            QVariant v = PtrToQVariant<CurveModel>::convert(sg);
-            QModelIndex curveDataIdx = _bookModel()->getDataIndex(curveIdx,
+    for ( int i = 0; i < jobs.size(); ++i ) {
+        CurveModel* curveModel = jobs.at(i).curveModel;
+        CurveModel* sg = new CurveModelSG(jobs.at(i));
+        QVariant v = PtrToQVariant<CurveModel>::convert(sg);
+        QModelIndex curveDataIdx = _bookModel()->getDataIndex(jobIdxs.at(i),
                                                            "CurveData","Curve");
-            _bookModel()->setData(curveDataIdx,v);
-            curveModel->_real = 0; // Zero out cache since sg now owns it
-            delete curveModel;
-        }
+        _bookModel()->setData(curveDataIdx,v);
+        curveModel->_real = 0; // Zero out cache since sg now owns it
+        delete curveModel;
     }
     _bookModel()->blockSignals(block);
 
@@ -3415,6 +3881,11 @@ void CurvesView::_keyPressGSliderChanged(int value)
     QRectF M = _bookModel()->getPlotMathRect(plotIdx);
     _bookModel()->setPlotMathRect(Z,plotIdx);
     _bookModel()->setPlotMathRect(M,plotIdx);
+}
+
+void CurvesView::_keyPressGSliderChanged(int value)
+{
+    _keyPressGChange(value,3);
 
     // Update lineedit label
     QString s = QString("%1").arg(value);
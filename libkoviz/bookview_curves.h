@@ -7,6 +7,11 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QCache>
+#include <QPair>
+#include <QTimer>
 #include <QColor>
 #include <QMouseEvent>
 #include <QRubberBand>
@@ -19,6 +24,7 @@
 #include <QImage>
 #include <QFontMetrics>
 #include <QPoint>
+#include <QRegion>
 #include <QMessageBox>
 #include <QVBoxLayout>
 #include <QSlider>
@@ -40,6 +46,7 @@
 #include "curvemodel_sg.h"
 #include "curvemodel_deriv.h"
 #include "curvemodel_integ.h"
+#include "envelope.h"
 
 class TimeAndIndex
 {
@@ -81,6 +88,7 @@ class FFTCache
     double start;
     double stop;
     QList<FFTCurveCache*> curveCaches;
+    QHash<QString,FFTSpectrum*> spectra;  // see _fftSpectrumKey()
 };
 
 class DerivCurveCache
@@ -194,9 +202,18 @@ private:
                          const QModelIndex &plotIdx);
     void _paintCurve(const QModelIndex& curveIdx,
                      const QTransform &T, QPainter& painter,
-                     bool isHighlight);
+                     bool isHighlight, const QRectF& stripM = QRectF());
     void _paintMarkers(QPainter& painter);
 
+    // Envelope presentation (MONTE runs as statistical bands)
+    bool _isEnvelope();
+    QList<EnvelopeCurve> _envelopeCurves();
+    void _paintEnvelope(const QTransform& T, QPainter& painter);
+    void _paintEnvelopeHover(const QTransform& T, QPainter& painter);
+    void _envelopeHover(const QPoint& pt);
+    int _envelopeHoverRow;   // curve row under mouse, -1 if none
+    QPointF _envelopeHoverPt;
+
     QModelIndex _chooseCurveNearMousePoint(const QPoint& pt);
     bool _isErrorCurveNearMousePoint(const QPoint& pt);
 
@@ -206,6 +223,12 @@ private:
     QPoint _mouseCurrPos;
     QPixmap* _createLivePixmap();
 
+    // Pan shifts the pixmap and renders the exposed strips only
+    QTimer _panTimer;       // full render when pan settles
+    QPointF _panResidual;   // pixmap offset error (pixels) from rounding
+    bool _panPixmap(const QRectF& prevM, const QRectF& M);
+    int _curveExtent(const QModelIndex& curveIdx, const QPainter& painter);
+
     double _mousePressXBias;
     double _mousePressYBias;
 
@@ -225,6 +248,8 @@ private:
     void _keyPressComma();
     void _keyPressEscape();
     void _keyPressF();
+    QString _fftSpectrumKey(CurveModel* curveModel, double xb, double xs,
+                            double begX, double endX) const;
     void _keyPressB();
     void _keyPressG();
     void _keyPressD();
@@ -234,6 +259,11 @@ private:
     QFrame* _bw_frame;
     QLineEdit* _bw_label;
     QSlider* _bw_slider;
+    QHash<const double*,BWChannel> _bwChannels;  // keyed by curve's _real
+    QCache<QPair<quintptr,int>,QVector<double> > _bwCache; // (_real,freq)
+    QTimer _bwTimer;       // debounces slider
+    int _bwPendingFreq;
+    void _keyPressBChange(int freq);
 
     QFrame* _sg_frame;
     QLineEdit* _sg_window;
@@ -251,10 +281,12 @@ private:
 private slots:
     void _keyPressBSliderChanged(int value);
     void _keyPressBLineEditReturnPressed();
+    void _keyPressBApply();
     void _keyPressGSliderChanged(int value);
     void _keyPressGLineEditReturnPressed();
     void _keyPressGDegreeReturnPressed();
     void _keyPressIInitValueReturnPressed();
+    void _panSettled();
 
 protected slots:
     virtual void dataChanged(const QModelIndex &topLeft,
@@ -49,6 +49,21 @@ void PageView::paintEvent(QPaintEvent *event)
     setPalette(pal);
 }
 
+// Curves of a lazily loaded page are loaded when first shown.  Loading is
+// deferred since the page may still be under construction.
+void PageView::showEvent(QShowEvent *event)
+{
+    BookIdxView::showEvent(event);
+    QTimer::singleShot(0,this,SLOT(_loadPage()));
+}
+
+void PageView::_loadPage()
+{
+    if ( isVisible() && _bookModel() ) {
+        _bookModel()->loadPage(rootIndex());
+    }
+}
+
 bool PageView::eventFilter(QObject *obj, QEvent *event)
 {
     if ( event->type() == QEvent::MouseButtonRelease ) {
@@ -7,6 +7,8 @@
 #include <QEvent>
 #include <QMouseEvent>
 #include <QPalette>
+#include <QShowEvent>
+#include <QTimer>
 
 #include "bookidxview.h"
 #include "bookview_pagetitle.h"
@@ -23,6 +25,7 @@ public:
 
 protected:
     virtual void paintEvent(QPaintEvent * event);
+    virtual void showEvent(QShowEvent * event);
     virtual bool eventFilter(QObject *obj, QEvent *event);
 
 private:
@@ -49,6 +52,7 @@ protected slots:
 protected slots:
     void _plotViewCurrentChanged(const QModelIndex& currIdx,
                                  const QModelIndex& prevIdx);
+    void _loadPage();
 
 signals:
     
@@ -191,6 +191,15 @@ PlotView::PlotView(QWidget *parent) :
     setLayout(_grid);
 }
 
+PlotView::~PlotView()
+{
+    if ( _router ) {
+        _router->unsubscribe(this);
+    }
+}
+
+// Changes come by way of the book's PlotChangeRouter instead of
+// every view getting every dataChanged() of the book
 void PlotView::setModel(QAbstractItemModel *model)
 {
     foreach (QAbstractItemView* view, _childViews ) {
@@ -199,14 +208,25 @@ void PlotView::setModel(QAbstractItemModel *model)
         if ( bview ) {
             bview->setCurvesView(_curvesView);
         }
-        connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
-                view, SLOT(dataChanged(QModelIndex,QModelIndex)));
+        if ( model ) {
+            disconnect(model,
+                       SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                       view,
+                       SLOT(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+        }
+        connect(this, SIGNAL(_plotDataChanged(QModelIndex,QModelIndex)),
+                view, SLOT(dataChanged(QModelIndex,QModelIndex)),
+                Qt::UniqueConnection);
     }
     this->setCurvesView(_curvesView);
     QAbstractItemView::setModel(model);
     if ( model ) {
         disconnect(model,SIGNAL(rowsInserted(QModelIndex,int,int)),
                    this,SLOT(rowsInserted(QModelIndex,int,int)));
+        disconnect(model,
+                   SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+                   this,
+                   SLOT(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
     }
     connect(_curvesView->selectionModel(),
             SIGNAL(currentChanged(QModelIndex,QModelIndex)),
@@ -223,6 +243,40 @@ void PlotView::setModel(QAbstractItemModel *model)
     _buttonRubberBandZoom = button2mouse.value(buttonZoom);
 }
 
+void PlotView::setRootIndex(const QModelIndex &index)
+{
+    BookIdxView::setRootIndex(index);
+
+    if ( _router ) {
+        _router->unsubscribe(this);
+    }
+    PlotBookModel* bookModel = dynamic_cast<PlotBookModel*>(model());
+    if ( bookModel && bookModel->isIndex(index,"Plot") ) {
+        _router = bookModel->plotChangeRouter();
+        _router->subscribe(index,this);
+    }
+}
+
+bool PlotView::isPlotShown() const
+{
+    return isVisible();
+}
+
+void PlotView::plotDataChanged(const QModelIndex &topLeft,
+                               const QModelIndex &bottomRight)
+{
+    dataChanged(topLeft,bottomRight);
+    emit _plotDataChanged(topLeft,bottomRight);
+}
+
+void PlotView::showEvent(QShowEvent *event)
+{
+    BookIdxView::showEvent(event);
+    if ( _router ) {
+        _router->shown(this);
+    }
+}
+
 QSize PlotView::minimumSizeHint() const
 {
     QSize s(50,50);
@@ -7,8 +7,10 @@
 #include <QList>
 #include <QEvent>
 #include <QMouseEvent>
+#include <QShowEvent>
 #include <QRubberBand>
 #include <QApplication>
+#include <QPointer>
 
 #include "bookidxview.h"
 #include "bookview_plottitle.h"
@@ -19,17 +21,30 @@
 #include "bookview_xaxislabel.h"
 #include "bookview_yaxislabel.h"
 #include "plotlayout.h"
+#include "plotchangerouter.h"
 
-class PlotView : public BookIdxView
+class PlotView : public BookIdxView, public PlotChangeListener
 {
     Q_OBJECT
 
 public:
     explicit PlotView(QWidget *parent = 0);
+    ~PlotView();
     virtual void setModel(QAbstractItemModel *model);
+    virtual void setRootIndex(const QModelIndex &index);
+
+    // PlotChangeListener
+    virtual bool isPlotShown() const;
+    virtual void plotDataChanged(const QModelIndex& topLeft,
+                                 const QModelIndex& bottomRight);
+
+signals:
+    void _plotDataChanged(const QModelIndex& topLeft,
+                          const QModelIndex& bottomRight);
 
 protected:
     virtual bool eventFilter(QObject *obj, QEvent *event);
+    virtual void showEvent(QShowEvent* event);
 
 protected:
     virtual QSize minimumSizeHint() const;
@@ -57,6 +72,8 @@ private:
 
     Qt::MouseButton _buttonRubberBandZoom;
 
+    QPointer<PlotChangeRouter> _router;
+
 protected slots:
     virtual void dataChanged(const QModelIndex &topLeft,
                              const QModelIndex &bottomRight,
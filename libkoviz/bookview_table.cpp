@@ -43,6 +43,10 @@ void BookTableView::paintEvent(QPaintEvent *event)
                                                         "TableVar","TableVars");
     QList<double> scaleFactors;
     QList<double> biases;
+    while ( _unitConverters.size() < tableVarIdxs.size() ) {
+        _unitConverters.append(UnitConverter());
+    }
+    int col = 0;
     foreach (QModelIndex tableVarIdx, tableVarIdxs) {
         QModelIndex curveIdx = _bookModel()->getDataIndex(tableVarIdx,
                                                      "TableVarData","TableVar");
@@ -55,18 +59,22 @@ void BookTableView::paintEvent(QPaintEvent *event)
 
         QString unit = _bookModel()->getDataString(tableVarIdx,
                                                    "TableVarUnit","TableVar");
+        UnitConversion uc;
         if ( unit.isEmpty() ) {
             unit = curveModel->y()->unit();
         } else {
-            sf *= Unit::scale(curveModel->y()->unit(),unit);
+            uc = _unitConverters[col].conversion(curveModel->y()->unit(),
+                                                 unit);
+            sf *= uc.scale;
         }
         units << unit;
         scaleFactors << sf;
 
         double bias = _bookModel()->getDataDouble(tableVarIdx,
                                                   "TableVarBias","TableVar");
-        bias += Unit::bias(curveModel->y()->unit(),unit);  // for temperature
+        bias += uc.bias;  // for temperature
         biases << bias;
+        ++col;
     }
     QStringList labels = _columnLabels();
 
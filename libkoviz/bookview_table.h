@@ -68,6 +68,7 @@ protected slots:
 private:
     PlotBookModel* _bookModel() const;
     QList<double> _timeStamps;
+    QList<UnitConverter> _unitConverters;  // per table var
     int _mTop;
     int _mBot;
     int _mLft;
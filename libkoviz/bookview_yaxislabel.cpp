@@ -120,8 +120,9 @@ void YAxisLabelView::wheelEvent(QWheelEvent *e)
 
         // Recalculate and update bounding box (since unit change)
         if ( plotXScale == "linear" && plotYScale == "linear" ) {
-            double scale = Unit::scale(fromUnit,toUnit);
-            double bias = Unit::bias(fromUnit,toUnit);
+            UnitConversion uc = Unit::conversion(fromUnit,toUnit);
+            double scale = uc.scale;
+            double bias = uc.bias;
             QModelIndex plotMathRectIdx = _bookModel()->getDataIndex(rootIndex(),
                                                        "PlotMathRect","Plot");
             QRectF R = model()->data(plotMathRectIdx).toRectF();
@@ -0,0 +1,94 @@
+#include "bwfilter.h"
+
+#include <QtConcurrentMap>
+#include <math.h>
+
+#define BW_LANES 4
+
+class BWLaneGroupFilter
+{
+  public:
+    BWLaneGroupFilter(const BWLowPassBatch* batch,
+                      const QVector<const double*>* ins,
+                      const QVector<double*>* outs,
+                      int n) :
+        _batch(batch), _ins(ins), _outs(outs), _n(n) {}
+
+    void operator()(int& first)
+    {
+        int nlanes = qMin(BW_LANES,_ins->size()-first);
+        _batch->_filterLanes(_ins->constData()+first,
+                             _outs->constData()+first,nlanes,_n);
+    }
+
+  private:
+    const BWLowPassBatch* _batch;
+    const QVector<const double*>* _ins;
+    const QVector<double*>* _outs;
+    int _n;
+};
+
+BWLowPassBatch::BWLowPassBatch(int order, double s, double f) :
+    _nsections(order/2)
+{
+    _A.resize(_nsections);
+    _d1.resize(_nsections);
+    _d2.resize(_nsections);
+
+    double a = tan(M_PI*f/s);
+    double a2 = a*a;
+    for ( int i = 0; i < _nsections; ++i ) {
+        double r = sin(M_PI*(2.0*i+1.0)/(4.0*_nsections));
+        double d = a2 + 2.0*a*r + 1.0;
+        _A[i] = a2/d;
+        _d1[i] = 2.0*(1-a2)/d;
+        _d2[i] = -(a2 - 2.0*a*r + 1.0)/d;
+    }
+}
+
+void BWLowPassBatch::filter(const QVector<const double*> &ins,
+                            const QVector<double*> &outs, int n) const
+{
+    if ( ins.isEmpty() || n <= 0 ) {
+        return;
+    }
+
+    QVector<int> groups;
+    for ( int i = 0; i < ins.size(); i += BW_LANES ) {
+        groups.append(i);
+    }
+    QtConcurrent::blockingMap(groups,BWLaneGroupFilter(this,&ins,&outs,n));
+}
+
+// Unused lanes filter zeros and are not written
+void BWLowPassBatch::_filterLanes(const double* const* ins,
+                                  double* const* outs,
+                                  int nlanes, int n) const
+{
+    QVector<double> state(_nsections*2*BW_LANES,0.0);
+    double* w1 = state.data();
+    double* w2 = state.data() + _nsections*BW_LANES;
+    const double* A = _A.constData();
+    const double* d1 = _d1.constData();
+    const double* d2 = _d2.constData();
+
+    for ( int i = 0; i < n; ++i ) {
+        double x[BW_LANES];
+        for ( int l = 0; l < BW_LANES; ++l ) {
+            x[l] = ( l < nlanes ) ? ins[l][i] : 0.0;
+        }
+        for ( int k = 0; k < _nsections; ++k ) {
+            double* w1k = w1 + k*BW_LANES;
+            double* w2k = w2 + k*BW_LANES;
+            for ( int l = 0; l < BW_LANES; ++l ) {
+                double w0 = d1[k]*w1k[l] + d2[k]*w2k[l] + x[l];
+                x[l] = A[k]*(w0 + 2.0*w1k[l] + w2k[l]);
+                w2k[l] = w1k[l];
+                w1k[l] = w0;
+            }
+        }
+        for ( int l = 0; l < nlanes; ++l ) {
+            outs[l][i] = x[l];
+        }
+    }
+}
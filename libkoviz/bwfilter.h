@@ -0,0 +1,53 @@
+#ifndef BWFILTER_H
+#define BWFILTER_H
+
+#include <QtGlobal>
+#include <QVector>
+
+//
+// Raw y of a uniformly sampled curve to be Butterworth filtered
+//
+class BWChannel
+{
+  public:
+    BWChannel() : ys(0), n(0), beginTime(0.0), dt(0.0) {}
+    BWChannel(const double* ys, int n, double beginTime, double dt) :
+        ys(ys), n(n), beginTime(beginTime), dt(dt) {}
+
+    const double* ys;
+    int n;
+    double beginTime;
+    double dt;
+};
+
+//
+// Double precision Butterworth low pass for many channels at once
+//
+// Same cascade of biquads as bw_low_pass() in filter.c.  Channels that
+// share a length are filtered four at a time with the filter state laid
+// out lane by lane so the per sample update vectorizes, and lane groups
+// run concurrently.
+//
+class BWLowPassBatch
+{
+  public:
+    BWLowPassBatch(int order, double samplingFreq, double cutoffFreq);
+
+    // outs[i] must hold n doubles; all ins/outs have length n
+    void filter(const QVector<const double*>& ins,
+                const QVector<double*>& outs, int n) const;
+
+  private:
+    BWLowPassBatch() {}
+    int _nsections;
+    QVector<double> _A;
+    QVector<double> _d1;
+    QVector<double> _d2;
+
+    void _filterLanes(const double* const* ins, double* const* outs,
+                      int nlanes, int n) const;
+
+    friend class BWLaneGroupFilter;
+};
+
+#endif // BWFILTER_H
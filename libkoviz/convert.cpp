@@ -0,0 +1,256 @@
+#include "convert.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QDataStream>
+#include <stdio.h>
+#include <string.h>
+
+#include "datamodel_trick.h"
+#include "datamodel_kvz.h"
+#include "trick_types.h"
+#include "csv.h"
+#include "unit.h"
+
+bool convert2csv(const QStringList& timeNames,
+                 const QString& ftrk, const QString& fcsv)
+{
+    TrickModel m(timeNames, ftrk);
+
+    QFileInfo fcsvi(fcsv);
+    if ( fcsvi.exists() ) {
+        fprintf(stderr, "koviz [error]: Will not overwrite %s\n",
+                fcsv.toLatin1().constData());
+        return false;
+    }
+
+    // Open csv file stream
+    QFile csv(fcsv);
+    if (!csv.open(QIODevice::WriteOnly)) {
+        fprintf(stderr,"koviz: [error] could not open %s\n",
+                fcsv.toLatin1().constData());
+        return false;
+    }
+    QTextStream out(&csv);
+
+    // Write csv param list (top line in csv file)
+    int cc = m.columnCount();
+    for ( int i = 0; i < cc; ++i) {
+        QString pName = m.param(i)->name();
+        QString pUnit = m.param(i)->unit();
+        out << pName << " {" << pUnit << "}";
+        if ( i < cc-1 ) {
+            out << ",";
+        }
+    }
+    out << "\n";
+
+    //
+    // Write param values
+    //
+    int rc = m.rowCount();
+    for ( int r = 0 ; r < rc; ++r ) {
+        for ( int c = 0 ; c < cc; ++c ) {
+            QModelIndex idx = m.index(r,c);
+            out << m.data(idx).toString();
+            if ( c < cc-1 ) {
+                out << ",";
+            } else {
+                out << "\n";
+            }
+        }
+    }
+
+    // Clean up
+    csv.close();
+
+    return true;
+}
+
+bool convert2trk(const QString& csvFileName, const QString& trkFileName)
+{
+    QFile file(csvFileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        fprintf(stderr, "koviz [error]: Cannot read file %s!",
+                csvFileName.toLatin1().constData());
+    }
+    CSV csv(&file);
+
+    // Parse first line to get param list
+    QList<TrickParameter> params;
+    QStringList list = csv.parseLine() ;
+    if ( list.isEmpty() ) {
+        fprintf(stderr, "koviz [error]: Empty csv file \"%s\"",
+                csvFileName.toLatin1().constData());
+        return false;
+    }
+    foreach ( QString s, list ) {
+        TrickParameter p;
+        QStringList plist = s.split(" ", QString::SkipEmptyParts);
+        p.setName(plist.at(0));
+        if ( plist.size() > 1 ) {
+            QString unitString = plist.at(1);
+            if ( unitString.startsWith('{') ) {
+                unitString = unitString.remove(0,1);
+            }
+            if ( unitString.endsWith('}') ) {
+                unitString.chop(1);
+            }
+            Unit u;
+            if ( u.isUnit(unitString.toLatin1().constData()) ) {
+                p.setUnit(unitString);
+            }
+        }
+        p.setType(TRICK_07_DOUBLE);
+        p.setSize(sizeof(double));
+        params.append(p);
+    }
+
+    QFileInfo ftrki(trkFileName);
+    if ( ftrki.exists() ) {
+        fprintf(stderr, "koviz [error]: Will not overwrite %s\n",
+                trkFileName.toLatin1().constData());
+        return false;
+    }
+
+    QFile trk(trkFileName);
+
+    if (!trk.open(QIODevice::WriteOnly)) {
+        fprintf(stderr,"koviz [error]: could not open %s\n",
+                trkFileName.toLatin1().constData());
+        return false;
+    }
+    QDataStream out(&trk);
+
+    // Write trk header
+    TrickModel::writeTrkHeader(out,params);
+
+    //
+    // Write param values
+    //
+    int line = 1;
+    while ( 1 ) {
+        ++line;
+        QStringList list = csv.parseLine() ;
+        if ( list.isEmpty() ) break;  // end of file, hopefully!!!
+        foreach ( QString s, list ) {
+            bool ok;
+            double val = s.toDouble(&ok);
+            if ( !ok ) {
+                QStringList vals = s.split(":");
+                if (vals.length() == 3 ) {
+                    // Try converting to a utc timestamp
+                    val = 3600.0*vals.at(0).toDouble(&ok);
+                    if ( ok ) {
+                        val += 60.0*vals.at(1).toDouble(&ok);
+                        if ( ok ) {
+                            val += vals.at(2).toDouble(&ok);
+                        }
+                    }
+                }
+            }
+            if ( !ok ) {
+                // If a single char, convert to unicode numeric value
+                if ( s.size() == 1 ) {
+                    val = s.at(0).unicode();
+                    ok = true;
+                }
+            }
+            if ( !ok ) {
+                QFileInfo fi(csvFileName);
+                fprintf(stderr,
+                 "koviz [error]: Bad value \"%s\" on line %d in file %s\n",
+                        s.toLatin1().constData(),
+                        line,
+                        fi.absoluteFilePath().toLatin1().constData());
+                file.close();
+                trk.remove();
+                return false;
+            }
+            out << val;
+        }
+    }
+
+    file.close();
+
+    return true;
+}
+
+bool convert2kvz(const QStringList& timeNames,
+                 const QString& ftrk, const QString& fkvz)
+{
+    QFileInfo fkvzi(fkvz);
+    if ( fkvzi.exists() ) {
+        fprintf(stderr, "koviz [error]: Will not overwrite %s\n",
+                fkvz.toLatin1().constData());
+        return false;
+    }
+
+    TrickModel m(timeNames, ftrk);
+    KvzModel::write(m,fkvz);
+
+    return true;
+}
+
+bool convertKvz2trk(const QStringList& timeNames,
+                    const QString& fkvz, const QString& ftrk)
+{
+    KvzModel m(timeNames, fkvz);
+
+    QFileInfo ftrki(ftrk);
+    if ( ftrki.exists() ) {
+        fprintf(stderr, "koviz [error]: Will not overwrite %s\n",
+                ftrk.toLatin1().constData());
+        return false;
+    }
+
+    QFile trk(ftrk);
+    if (!trk.open(QIODevice::WriteOnly)) {
+        fprintf(stderr,"koviz [error]: could not open %s\n",
+                ftrk.toLatin1().constData());
+        return false;
+    }
+    QDataStream out(&trk);
+
+    // Write trk header with params as logged
+    QList<TrickParameter> params;
+    QVector<int> sizes;
+    int rowSize = 0;
+    int cc = m.columnCount();
+    for ( int c = 0; c < cc; ++c ) {
+        const TrickParameter* p =
+                             static_cast<const TrickParameter*>(m.param(c));
+        params.append(*p);
+        sizes.append(p->size());
+        rowSize += p->size();
+    }
+    TrickModel::writeTrkHeader(out,params,m.trickVersion(),m.isBigEndian());
+
+    // Interleave block columns back into records
+    for ( int b = 0; b < m.blockCount(); ++b ) {
+        int n = m.blockRowCount(b);
+        QByteArray records(n*rowSize,'\0');
+        int offset = 0;
+        for ( int c = 0; c < cc; ++c ) {
+            QByteArray raw = m.rawBlock(c,b);
+            int sz = sizes.at(c);
+            for ( int r = 0; r < n; ++r ) {
+                memcpy(records.data()+r*rowSize+offset,
+                       raw.constData()+r*sz, sz);
+            }
+            offset += sz;
+        }
+        out.writeRawData(records.constData(),records.size());
+    }
+
+    if ( out.status() != QDataStream::Ok ) {
+        fprintf(stderr,"koviz [error]: could not write %s\n",
+                ftrk.toLatin1().constData());
+        trk.remove();
+        return false;
+    }
+    trk.close();
+
+    return true;
+}
@@ -0,0 +1,18 @@
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include <QString>
+#include <QStringList>
+
+// trk <-> csv file conversion (koviz -trk2csv and -csv2trk)
+bool convert2csv(const QStringList& timeNames,
+                 const QString& ftrk, const QString& fcsv);
+bool convert2trk(const QString& csvFileName, const QString &trkFileName);
+
+// trk <-> kvz archive conversion (koviz -trk2kvz and -kvz2trk)
+bool convert2kvz(const QStringList& timeNames,
+                 const QString& ftrk, const QString& fkvz);
+bool convertKvz2trk(const QStringList& timeNames,
+                    const QString& fkvz, const QString& ftrk);
+
+#endif // CONVERT_H
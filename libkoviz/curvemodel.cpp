@@ -1,12 +1,17 @@
 #include "curvemodel.h"
 
+#include <QAtomicInt>
+
+static QAtomicInt _nodeCount(0);
+
 CurveModel::CurveModel() :
     _real(0),
     _imag(0),
     _datamodel(0),
     _t(0),
     _x(0),
-    _y(0)
+    _y(0),
+    _nodeId((quint64)_nodeCount.fetchAndAddOrdered(1))
 {}
 
 CurveModel::CurveModel(DataModel *datamodel,
@@ -21,7 +26,8 @@ CurveModel::CurveModel(DataModel *datamodel,
     _ycol(ycol),
     _t(new CurveModelParameter),
     _x(new CurveModelParameter),
-    _y(new CurveModelParameter)
+    _y(new CurveModelParameter),
+    _nodeId((quint64)_nodeCount.fetchAndAddOrdered(1))
 {
     _t->setName(_datamodel->param(_tcol)->name());
     _t->setUnit(_datamodel->param(_tcol)->unit());
@@ -47,6 +53,27 @@ CurveModel::~CurveModel()
 
 }
 
+// Derived curves (no data model) are read through their iterators
+void CurveModel::read(int beg, int n, double *t, double *x, double *y) const
+{
+    if ( _datamodel ) {
+        _datamodel->readColumn(_tcol,beg,n,t);
+        _datamodel->readColumn(_xcol,beg,n,x);
+        _datamodel->readColumn(_ycol,beg,n,y);
+        return;
+    }
+
+    ModelIterator* it = begin();
+    it = it->at(beg);
+    for ( int i = 0; i < n; ++i ) {
+        t[i] = it->t();
+        x[i] = it->x();
+        y[i] = it->y();
+        it->next();
+    }
+    delete it;
+}
+
 int CurveModel::rowCount(const QModelIndex &pidx) const
 {
     if ( !pidx.isValid() && _datamodel ) {
@@ -74,3 +101,17 @@ QVariant CurveModel::data (const QModelIndex & index, int role ) const
     QVariant v;
     return v;
 }
+
+// Curves on the same logged columns share a key, so transforms of a
+// reloaded curve hit the cache.  Curves without a data model (filtered,
+// fft...) get a key unique to the object.
+QString CurveModel::nodeKey() const
+{
+    if ( _datamodel ) {
+        return QString("%1[%2,%3,%4]#%5").arg(_datamodel->fileName())
+                                         .arg(_tcol).arg(_xcol).arg(_ycol)
+                                         .arg(rowCount());
+    } else {
+        return QString("curve%1#%2").arg(_nodeId).arg(rowCount());
+    }
+}
@@ -32,11 +32,17 @@ class CurveModel : public QAbstractTableModel
     virtual ModelIterator* begin() const { return _datamodel->begin(_tcol,_xcol,_ycol);}
     virtual int indexAtTime(double time) { return _datamodel->indexAtTime(time); }
 
+    // Rows beg..beg+n-1 of (t,x,y) a column at a time (must be mapped)
+    virtual void read(int beg, int n, double* t, double* x, double* y) const;
+
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual QVariant data (const QModelIndex & index,
                            int role = Qt::DisplayRole ) const ;
 
+    // Identifies the curve's data for memoizing transforms of it
+    virtual QString nodeKey() const;
+
     double* _real; // cache for fft
     double* _imag; // cache for fft
 
@@ -49,6 +55,7 @@ class CurveModel : public QAbstractTableModel
     CurveModelParameter* _t;
     CurveModelParameter* _x;
     CurveModelParameter* _y;
+    quint64 _nodeId;
 
 };
 
@@ -8,6 +8,38 @@ CurveModelBW::CurveModelBW(CurveModel *curveModel, double frequency) :
     _x(new CurveModelParameter),
     _y(new CurveModelParameter),
     _iteratorTimeIndex(0)
+{
+    _setup(curveModel);
+    _init(curveModel);
+}
+
+CurveModelBW::CurveModelBW(CurveModel *curveModel, double frequency,
+                           const BWChannel &channel,
+                           const QVector<double> &ys) :
+    _freq(frequency),
+    _ncols(3),
+    _nrows(0),
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter),
+    _iteratorTimeIndex(0)
+{
+    _setup(curveModel);
+
+    // Takes over the raw data cache like _init()
+    _real = curveModel->_real;
+
+    _nrows = qMin(channel.n,ys.size());
+    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
+    for ( int i = 0; i < _nrows; ++i ) {
+        double t = channel.beginTime+channel.dt*i;
+        _data[i*_ncols+0] = t;
+        _data[i*_ncols+1] = t;
+        _data[i*_ncols+2] = ys.at(i);
+    }
+}
+
+void CurveModelBW::_setup(CurveModel *curveModel)
 {
     if ( curveModel->x()->unit() != "s" ) {
         fprintf(stderr,"koviz [bad scoobs]: CurveModelBW given curve with "
@@ -25,8 +57,6 @@ CurveModelBW::CurveModelBW(CurveModel *curveModel, double frequency) :
     _y->setUnit(curveModel->y()->unit());
 
     _iteratorTimeIndex = new BWModelIterator(this);
-
-    _init(curveModel);
 }
 
 // See ~CurveModel() too
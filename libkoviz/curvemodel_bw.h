@@ -9,6 +9,7 @@
 #include "curvemodelparameter.h"
 #include "curvemodel.h"
 #include "filter.h"
+#include "bwfilter.h"
 
 class BWModelIterator;
 
@@ -22,6 +23,10 @@ class CurveModelBW : public CurveModel
 
     explicit CurveModelBW(CurveModel* curveModel, double frequency);
 
+    // ys is the already filtered channel (see BWLowPassBatch)
+    explicit CurveModelBW(CurveModel* curveModel, double frequency,
+                          const BWChannel& channel, const QVector<double>& ys);
+
     ~CurveModelBW();
 
     CurveModelParameter* t() { return _t; }
@@ -55,6 +60,7 @@ class CurveModelBW : public CurveModel
     CurveModelParameter* _y;
     BWModelIterator* _iteratorTimeIndex;
 
+    void _setup(CurveModel* curveModel);
     void _init(CurveModel* curveModel);
     int _idxAtTimeBinarySearch (BWModelIterator* it,
                                 int low, int high, double time);
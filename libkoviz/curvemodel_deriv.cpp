@@ -1,12 +1,7 @@
 #include "curvemodel_deriv.h"
 
 CurveModelDerivative::CurveModelDerivative(CurveModel *curveModel) :
-    _ncols(3),
-    _nrows(0),
-    _t(new CurveModelParameter),
-    _x(new CurveModelParameter),
-    _y(new CurveModelParameter),
-    _iteratorTimeIndex(0)
+    CurveModelTransform(curveModel)
 {
     if ( curveModel->x()->unit() != "s" ) {
         fprintf(stderr,"koviz [bad scoobs]: CurveModelDerivative given curve "
@@ -15,153 +10,46 @@ CurveModelDerivative::CurveModelDerivative(CurveModel *curveModel) :
         exit(-1);
     }
 
-    _iteratorTimeIndex = new DerivativeModelIterator(this);
-
-    _fileName = curveModel->fileName();
-    _t->setName(curveModel->t()->name());
-    _t->setUnit(curveModel->t()->unit());
-    _x->setName(curveModel->x()->name());
-    _x->setUnit(curveModel->x()->unit());
     QString yName = "d'(" + curveModel->y()->name() + ")";
     _y->setName(yName);
 
     QString dUnit = Unit::derivative(curveModel->y()->unit());
     _y->setUnit(dUnit);
-
-    _init(curveModel);
-}
-
-CurveModelDerivative::~CurveModelDerivative()
-{
-    // See: ~CurveModel()
-}
-
-ModelIterator* CurveModelDerivative::begin() const
-{
-    return new DerivativeModelIterator(this);
-}
-
-int CurveModelDerivative::indexAtTime(double time)
-{
-    return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
 }
 
-int CurveModelDerivative::_idxAtTimeBinarySearch (DerivativeModelIterator* it,
-                                       int low, int high, double time)
+void CurveModelDerivative::_evaluate(const CurveColumns &in,
+                                     CurveColumns *out) const
 {
-        if (high <= 0 ) {
-                return 0;
-        }
-        if (low >= high) {
-                // Time not found, choose closest near high
-                double t1 = it->at(high-1)->t();
-                double t2 = it->at(high)->t();
-                double t3 = t2;
-                it = it->at(high+1);
-                if ( !it->isDone() ) {
-                    t3 = it->at(high+1)->t();
-                }
-
-                int i;
-                if ( qAbs(time-t1) < qAbs(time-t2) ) {
-                    if ( qAbs(time-t1) < qAbs(time-t3) ) {
-                        i = high-1;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                } else {
-                    if ( qAbs(time-t2) < qAbs(time-t3) ) {
-                        i = high;
-                    } else {
-                        if ( !it->isDone() ) {
-                            i = high+1;
-                        } else {
-                            i = high;
-                        }
-                    }
-                }
-                return i;
-        } else {
-                int mid = (low + high)/2;
-                if (time == it->at(mid)->t()) {
-                        return mid;
-                } else if ( time < it->at(mid)->t() ) {
-                        return _idxAtTimeBinarySearch(it,
-                                                      low, mid-1, time);
-                } else {
-                        return _idxAtTimeBinarySearch(it, mid+1, high, time);
-                }
-        }
-}
-
-int CurveModelDerivative::rowCount(const QModelIndex &pidx) const
-{
-    if ( !pidx.isValid() ) {
-        return _nrows;
-    } else {
-        return 0;
-    }
-}
-
-int CurveModelDerivative::columnCount(const QModelIndex &pidx) const
-{
-    if ( !pidx.isValid() ) {
-        return 3;
-    } else {
-        return 0;
-    }
-}
-
-// TODO CurveModel::data() --- for now, return empty QVariant
-QVariant CurveModelDerivative::data (const QModelIndex & index, int role ) const
-
-{
-    Q_UNUSED(index);
-    Q_UNUSED(role);
-    QVariant v;
-    return v;
-}
-
-void CurveModelDerivative::_init(CurveModel* curveModel)
-{
-    curveModel->map();
-    ModelIterator* it = curveModel->begin();
-
-    _nrows = curveModel->rowCount();
-    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
-
-    if ( _nrows == 0 ) {
+    const int n = in.t.size();
+    const double* x = in.x.constData();
+    const double* y = in.y.constData();
+    out->t = in.t;
+    out->x = in.x;
+    out->y.resize(n);
+    double* ys = out->y.data();
+
+    if ( n == 0 ) {
         // Nothing to do, empty
-    } else if ( _nrows == 1 ) {
-        _data[0*_ncols+0] = it->at(0)->t();
-        _data[0*_ncols+1] = it->at(0)->x();
-        _data[0*_ncols+2] = 0.0;
-    } else if ( _nrows == 2 ) {
-        double x0 = it->at(0)->x();
-        double x1 = it->at(1)->x();
-        double y0 = it->at(0)->y();
-        double y1 = it->at(1)->y();
+    } else if ( n == 1 ) {
+        ys[0] = 0.0;
+    } else if ( n == 2 ) {
+        double x0 = x[0];
+        double x1 = x[1];
+        double y0 = y[0];
+        double y1 = y[1];
         double m = (y1-y0)/(x1-x0);
         if ( x1 == x0 ) {
             m = 0;
         }
-        _data[0*_ncols+0] = it->at(0)->t();
-        _data[0*_ncols+1] = it->at(0)->x();
-        _data[0*_ncols+2] = m;
-        _data[1*_ncols+0] = it->at(1)->t();
-        _data[1*_ncols+1] = it->at(1)->x();
-        _data[1*_ncols+2] = m;
-    } else if ( _nrows == 3 ) {
-        double x0 = it->at(0)->x();
-        double y0 = it->at(0)->y();
-        double x1 = it->at(1)->x();
-        double y1 = it->at(1)->y();
-        double x2 = it->at(2)->x();
-        double y2 = it->at(2)->y();
+        ys[0] = m;
+        ys[1] = m;
+    } else if ( n == 3 ) {
+        double x0 = x[0];
+        double y0 = y[0];
+        double x1 = x[1];
+        double y1 = y[1];
+        double x2 = x[2];
+        double y2 = y[2];
         double m1 = (y1-y0)/(x1-x0);
         double m2 = (y2-y1)/(x2-x1);
         if ( x1 == x0 ) {
@@ -170,61 +58,44 @@ void CurveModelDerivative::_init(CurveModel* curveModel)
         if ( x2 == x1 ) {
             m2 = 0;
         }
-        _data[0*_ncols+0] = it->at(0)->t();
-        _data[0*_ncols+1] = it->at(0)->x();
-        _data[0*_ncols+2] = m1;
-        _data[1*_ncols+0] = it->at(1)->t();
-        _data[1*_ncols+1] = it->at(1)->x();
-        _data[1*_ncols+2] = (m1+m2)/2;
-        _data[2*_ncols+0] = it->at(2)->t();
-        _data[2*_ncols+1] = it->at(2)->x();
-        _data[2*_ncols+2] = m2;
+        ys[0] = m1;
+        ys[1] = (m1+m2)/2;
+        ys[2] = m2;
     } else {
-        for (int i = 0; i < _nrows; ++i ) {
-            _data[i*_ncols+0] = it->at(i)->t();
-            _data[i*_ncols+1] = it->at(i)->x();
+        for (int i = 0; i < n; ++i ) {
             if ( i == 0 ) {
                 // Initial point
-                double x0 = it->at(0)->x();
-                double y0 = it->at(0)->y();
-                double x1 = it->at(1)->x();
-                double y1 = it->at(1)->y();
-                double x2 = it->at(2)->x();
-                double y2 = it->at(2)->y();
-                double x3 = it->at(3)->x();
-                double y3 = it->at(3)->y();
+                double x0 = x[0];
+                double y0 = y[0];
+                double x1 = x[1];
+                double y1 = y[1];
+                double x2 = x[2];
+                double y2 = y[2];
+                double x3 = x[3];
+                double y3 = y[3];
 
                 int j;
-                for (j = 1; j < _nrows; ++j) {
-                    it = it->at(j);
-                    if ( !it->isDone() ) {
-                        x1 = it->at(j)->x();
-                        y1 = it->at(j)->y();
-                        if ( !std::isnan(x1) && !std::isnan(y1) && x0 != x1 ) {
-                            break;
-                        }
+                for (j = 1; j < n; ++j) {
+                    x1 = x[j];
+                    y1 = y[j];
+                    if ( !std::isnan(x1) && !std::isnan(y1) && x0 != x1 ) {
+                        break;
                     }
                 }
 
-                for (j = j+1; j < _nrows; ++j) {
-                    it = it->at(j);
-                    if ( !it->isDone() ) {
-                        x2 = it->at(j)->x();
-                        y2 = it->at(j)->y();
-                        if ( !std::isnan(x2) && !std::isnan(y2) && x1 != x2 ) {
-                            break;
-                        }
+                for (j = j+1; j < n; ++j) {
+                    x2 = x[j];
+                    y2 = y[j];
+                    if ( !std::isnan(x2) && !std::isnan(y2) && x1 != x2 ) {
+                        break;
                     }
                 }
 
-                for (j = j+1; j < _nrows; ++j) {
-                    it = it->at(j);
-                    if ( !it->isDone() ) {
-                        x3 = it->at(j)->x();
-                        y3 = it->at(j)->y();
-                        if ( !std::isnan(x3) && !std::isnan(y3) && x2 != x3 ) {
-                            break;
-                        }
+                for (j = j+1; j < n; ++j) {
+                    x3 = x[j];
+                    y3 = y[j];
+                    if ( !std::isnan(x3) && !std::isnan(y3) && x2 != x3 ) {
+                        break;
                     }
                 }
 
@@ -242,47 +113,47 @@ void CurveModelDerivative::_init(CurveModel* curveModel)
 
                     double m = (v2-v1)/(x2-x1);
 
-                    _data[i*_ncols+2] = m*(x0-x1)+v1;
+                    ys[i] = m*(x0-x1)+v1;
                 } else {
                     double m = (y1-y0)/(x1-x0);
                     if ( x0 == x1 ) {
                         m = 0.0;
                     }
-                    _data[i*_ncols+2] = m;
+                    ys[i] = m;
                 }
 
 
-            } else if ( i == _nrows-1 ) {
+            } else if ( i == n-1 ) {
                 // Last point
-                double x0 = it->at(i-3)->x();
-                double y0 = it->at(i-3)->y();
-                double x1 = it->at(i-2)->x();
-                double y1 = it->at(i-2)->y();
-                double x2 = it->at(i-1)->x();
-                double y2 = it->at(i-1)->y();
-                double x3 = it->at(i)->x();
-                double y3 = it->at(i)->y();
+                double x0 = x[i-3];
+                double y0 = y[i-3];
+                double x1 = x[i-2];
+                double y1 = y[i-2];
+                double x2 = x[i-1];
+                double y2 = y[i-1];
+                double x3 = x[i];
+                double y3 = y[i];
 
                 int j;
                 for (j = i-1; j >= 0; --j) {
-                    x2 = it->at(j)->x();
-                    y2 = it->at(j)->y();
+                    x2 = x[j];
+                    y2 = y[j];
                     if ( !std::isnan(x2) && !std::isnan(y2) && x2 != x3 ) {
                         break;
                     }
                 }
 
                 for (j = j-1; j >= 0; --j) {
-                    x1 = it->at(j)->x();
-                    y1 = it->at(j)->y();
+                    x1 = x[j];
+                    y1 = y[j];
                     if ( !std::isnan(x1) && !std::isnan(y1) && x1 != x2 ) {
                         break;
                     }
                 }
 
                 for (j = j-1; j >= 0; --j) {
-                    x0 = it->at(j)->x();
-                    y0 = it->at(j)->y();
+                    x0 = x[j];
+                    y0 = y[j];
                     if ( !std::isnan(x0) && !std::isnan(y0) && x0 != x1 ) {
                         break;
                     }
@@ -302,38 +173,35 @@ void CurveModelDerivative::_init(CurveModel* curveModel)
 
                     double m = (v2-v1)/(x2-x1);
 
-                    _data[i*_ncols+2] = m*(x3-x2)+v2;
+                    ys[i] = m*(x3-x2)+v2;
                 } else {
                     double m = (y3-y2)/(x3-x2);
                     if ( x3 == x2 ) {
                         m = 0.0;
                     }
-                    _data[i*_ncols+2] = m;
+                    ys[i] = m;
                 }
 
             } else {
                 // All other points (avg slope before and after)
-                double x0 = it->at(i-1)->x();
-                double x1 = it->at(i)->x();
-                double x2 = it->at(i+1)->x();
-                double y0 = it->at(i-1)->y();
-                double y1 = it->at(i)->y();
-                double y2 = it->at(i+1)->y();
+                double x0 = x[i-1];
+                double x1 = x[i];
+                double x2 = x[i+1];
+                double y0 = y[i-1];
+                double y1 = y[i];
+                double y2 = y[i+1];
                 for (int j = i-1; j >= 0; --j) {
-                    x0 = it->at(j)->x();
-                    y0 = it->at(j)->y();
+                    x0 = x[j];
+                    y0 = y[j];
                     if ( !std::isnan(x0) && !std::isnan(y0) && x0 != x1 ) {
                         break;
                     }
                 }
-                for (int j = i+1; j < _nrows; ++j) {
-                    it = it->at(j);
-                    if ( !it->isDone() ) {
-                        x2 = it->at(j)->x();
-                        y2 = it->at(j)->y();
-                        if ( !std::isnan(x2) && !std::isnan(y2) && x1 != x2 ) {
-                            break;
-                        }
+                for (int j = i+1; j < n; ++j) {
+                    x2 = x[j];
+                    y2 = y[j];
+                    if ( !std::isnan(x2) && !std::isnan(y2) && x1 != x2 ) {
+                        break;
                     }
                 }
                 double m0 = (y1-y0)/(x1-x0);
@@ -350,11 +218,8 @@ void CurveModelDerivative::_init(CurveModel* curveModel)
                 } else if ( !std::isnan(m0) && std::isnan(m1) ) {
                     m = m0;
                 }
-                _data[i*_ncols+2] = m;
+                ys[i] = m;
             }
         }
     }
-
-    delete it;
-    curveModel->unmap();
 }
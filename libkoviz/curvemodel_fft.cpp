@@ -1,4 +1,5 @@
 #include "curvemodel_fft.h"
+#include <string.h>
 
 CurveModelFFT::CurveModelFFT(CurveModel *curveModel,
                              double xb, double xs,
@@ -13,6 +14,33 @@ CurveModelFFT::CurveModelFFT(CurveModel *curveModel,
     _x(new CurveModelParameter),
     _y(new CurveModelParameter),
     _iteratorTimeIndex(0)
+{
+    _setup(curveModel);
+
+    FFTSpectrum spectrum(curveModel,xb,xs,begX,endX);
+    curveModel->map();
+    spectrum.compute();
+    curveModel->unmap();
+    _setSpectrum(spectrum);
+}
+
+CurveModelFFT::CurveModelFFT(const FFTSpectrum &spectrum) :
+    _begX(spectrum.begX),
+    _endX(spectrum.endX),
+    _xb(spectrum.xb),
+    _xs(spectrum.xs),
+    _ncols(3),
+    _nrows(0),
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter),
+    _iteratorTimeIndex(0)
+{
+    _setup(spectrum.curveModel);
+    _setSpectrum(spectrum);
+}
+
+void CurveModelFFT::_setup(CurveModel *curveModel)
 {
     if ( curveModel->x()->unit() != "s" ) {
         fprintf(stderr,"koviz [bad scoobs]: CurveModelFFT given curve with "
@@ -30,8 +58,6 @@ CurveModelFFT::CurveModelFFT(CurveModel *curveModel,
     _x->setUnit("Hz");
     _y->setName(curveModel->y()->name());
     _y->setUnit(curveModel->y()->unit());
-
-    _init(curveModel);
 }
 
 CurveModelFFT::~CurveModelFFT()
@@ -129,16 +155,29 @@ QVariant CurveModelFFT::data (const QModelIndex & index, int role ) const
     return v;
 }
 
-void CurveModelFFT::_init(CurveModel* curveModel)
+FFTSpectrum::FFTSpectrum(CurveModel *curveModel,
+                         double xb, double xs, double begX, double endX) :
+    curveModel(curveModel),
+    xb(xb),
+    xs(xs),
+    begX(begX),
+    endX(endX),
+    dt(0.0)
 {
-    curveModel->map();
+}
+
+void FFTSpectrum::compute()
+{
+    real.clear();
+    imag.clear();
+    dt = 0.0;
 
     int i = 0;
     int i0 = -1;
     int N = 0;
     ModelIterator* it = curveModel->begin();
     while ( !it->isDone() ) {
-        if ( it->x()*_xs+_xb < _begX ) {
+        if ( it->x()*xs+xb < begX ) {
             it->next();
             ++i;
             continue;
@@ -146,7 +185,7 @@ void CurveModelFFT::_init(CurveModel* curveModel)
         if ( i0 == -1 ) {
             i0 = i;
         }
-        if ( it->x()*_xs+_xb > _endX ) {
+        if ( it->x()*xs+xb > endX ) {
             break;
         }
         ++N;
@@ -154,27 +193,25 @@ void CurveModelFFT::_init(CurveModel* curveModel)
     }
 
     if ( i0 == -1 || N < 2 ) {
+        delete it;
         return;
     }
 
-    double dt = 0;
-    it = it->at(i0);
-    double t = it->x()*_xs+_xb;
+    double t = it->at(i0)->x()*xs+xb;
     it->next();
     while ( !it->isDone() ) {
-        dt = it->x()*_xs+_xb - t;
+        dt = it->x()*xs+xb - t;
         if ( dt > 0 ) {
             break;
         }
         it->next();
     }
-    if ( dt == 0 ) {
+    if ( dt <= 0 ) {
+        dt = 0.0;
+        delete it;
         return;
     }
 
-    _real = (double*)malloc(N*sizeof(double));
-    _imag = (double*)malloc(N*sizeof(double));
-
     it = it->at(i0);
     double goodVal = 0.0;
     while ( !it->isDone() ) {
@@ -186,34 +223,46 @@ void CurveModelFFT::_init(CurveModel* curveModel)
         break;
     }
 
-    double ys = 1.0;
-    double yb = 0.0;
+    // NaNs take the last good value
+    QVector<double> y(N);
     i = 0;
     it = it->at(i0);
     while ( !it->isDone() && i < N ) {
-        _real[i] = it->y()*ys+yb;
-        if ( std::isnan(_real[i]) ) {
-            _real[i] = goodVal;
+        y[i] = it->y();
+        if ( std::isnan(y[i]) ) {
+            y[i] = goodVal;
         }
-        _imag[i] = 0.0;
-        goodVal = _real[i];
+        goodVal = y[i];
         it->next();
         ++i;
     }
     delete it;
 
-    Fft_transform(_real,_imag,N);
+    real.resize(N);
+    imag.resize(N);
+    FFTPlan::transformReal(y.constData(),(size_t)N,real.data(),imag.data());
+}
 
-    _nrows = N;
-    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
+// Keeps the full spectrum in _real/_imag for CurveModelIFFT
+void CurveModelFFT::_setSpectrum(const FFTSpectrum &spectrum)
+{
+    int N = spectrum.real.size();
+    if ( N < 2 || spectrum.dt <= 0 ) {
+        return;
+    }
+
+    _real = (double*)malloc(N*sizeof(double));
+    _imag = (double*)malloc(N*sizeof(double));
+    memcpy(_real,spectrum.real.constData(),N*sizeof(double));
+    memcpy(_imag,spectrum.imag.constData(),N*sizeof(double));
 
-    for ( i = 0 ; i < _nrows; ++i ) {
-        double f = (1/dt)*i/N;
+    _nrows = N;
+    _data.resize(_nrows*_ncols);
+    for ( int i = 0 ; i < _nrows; ++i ) {
+        double f = (1/spectrum.dt)*i/N;
         double m = qSqrt(_real[i]*_real[i]+_imag[i]*_imag[i]);
         _data[i*_ncols+0] = f;
         _data[i*_ncols+1] = f;
         _data[i*_ncols+2] = m;
     }
-
-    curveModel->unmap();
 }
@@ -4,15 +4,41 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QtMath>
+#include <QVector>
 #include "parameter.h"
 #include "datamodel.h"
 #include "curvemodelparameter.h"
 #include "curvemodel.h"
-#include "fft.h"
+#include "fftplan.h"
 
 class CurveModelFFT;
 class FFTModelIterator;
 
+//
+// Spectrum of a curve's y over [begX,endX] (x scaled/biased by xs/xb)
+//
+// compute() only reads the curve, so spectra for many curves can be
+// computed concurrently once their models are mapped.  CurveModelFFT
+// can then be built from a spectrum cheaply in the GUI thread.
+//
+class FFTSpectrum
+{
+  public:
+    FFTSpectrum(CurveModel* curveModel, double xb, double xs,
+                double begX, double endX);
+
+    void compute();  // curveModel must be mapped
+
+    CurveModel* curveModel;
+    double xb;
+    double xs;
+    double begX;
+    double endX;
+    double dt;
+    QVector<double> real;
+    QVector<double> imag;
+};
+
 class CurveModelFFT : public CurveModel
 {
   Q_OBJECT
@@ -24,6 +50,8 @@ class CurveModelFFT : public CurveModel
     explicit CurveModelFFT(CurveModel* curveModel, double xb, double xs,
                            double begX, double endX);
 
+    explicit CurveModelFFT(const FFTSpectrum& spectrum);
+
     ~CurveModelFFT();
 
     CurveModelParameter* t() { return _t; }
@@ -49,7 +77,7 @@ class CurveModelFFT : public CurveModel
     double _endX;
     double _xb;
     double _xs;
-    double* _data;
+    QVector<double> _data;
     int _ncols;
     int _nrows;
     int _tcol;
@@ -61,7 +89,8 @@ class CurveModelFFT : public CurveModel
 
     FFTModelIterator* _iteratorTimeIndex;
 
-    void _init(CurveModel *curveModel);
+    void _setup(CurveModel *curveModel);
+    void _setSpectrum(const FFTSpectrum& spectrum);
     int _idxAtTimeBinarySearch (FFTModelIterator *it,
                                 int low, int high, double time);
 };
@@ -156,7 +156,7 @@ void CurveModelIFFT::_init(CurveModel* curveModel)
         _imag[i] = curveModel->_imag[i];
     }
 
-    Fft_inverseTransform(_real,_imag,N);
+    FFTPlan::plan(N)->inverseTransform(_real,_imag);
 
     _data = (double*)malloc(_nrows*_ncols*sizeof(double));
 
@@ -8,7 +8,7 @@
 #include "datamodel.h"
 #include "curvemodelparameter.h"
 #include "curvemodel.h"
-#include "fft.h"
+#include "fftplan.h"
 
 class IFFTModelIterator;
 
@@ -9,6 +9,26 @@ CurveModelSG::CurveModelSG(CurveModel *curveModel,int window,int degree) :
     _x(new CurveModelParameter),
     _y(new CurveModelParameter),
     _iteratorTimeIndex(0)
+{
+    _setup(curveModel);
+    _init(curveModel);
+}
+
+CurveModelSG::CurveModelSG(const SGSmoothJob &job) :
+    _window(job.window),
+    _degree(job.degree),
+    _ncols(3),
+    _nrows(0),
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter),
+    _iteratorTimeIndex(0)
+{
+    _setup(job.curveModel);
+    _init(job.curveModel,&job.ys);
+}
+
+void CurveModelSG::_setup(CurveModel *curveModel)
 {
     if ( curveModel->x()->unit() != "s" ) {
         fprintf(stderr,"koviz [bad scoobs]: CurveModelSG given curve with "
@@ -26,8 +46,6 @@ CurveModelSG::CurveModelSG(CurveModel *curveModel,int window,int degree) :
     _y->setUnit(curveModel->y()->unit());
 
     _iteratorTimeIndex = new SGModelIterator(this);
-
-    _init(curveModel);
 }
 
 // See ~CurveModel() too
@@ -130,7 +148,7 @@ QVariant CurveModelSG::data (const QModelIndex & index, int role ) const
     return v;
 }
 
-void CurveModelSG::_init(CurveModel* curveModel)
+void CurveModelSG::_init(CurveModel* curveModel, const QVector<double>* ys)
 {
     curveModel->map();
 
@@ -175,19 +193,43 @@ void CurveModelSG::_init(CurveModel* curveModel)
     _real = curveModel->_real;
 
     _nrows = N;
-    double *buf = (double*)malloc(_nrows*sizeof(double));
-    for (int i = 0; i < N; ++i) {
-        buf[i] = _real[i];
+    QVector<double> buf;
+    if ( ys && ys->size() == N ) {
+        buf = *ys;
+    } else {
+        buf = QVector<double>(N);
+        for (int i = 0; i < N; ++i) {
+            buf[i] = _real[i];
+        }
+        calc_sgsmooth(_nrows, buf.data(), _window, _degree);
     }
-    buf = calc_sgsmooth(_nrows, buf, _window, _degree);
     _data = (double*)malloc(_nrows*_ncols*sizeof(double));
     for ( int i = 0; i < N; ++i ) {
         _data[i*_ncols+0] = beginTime+dt*i;
         _data[i*_ncols+1] = beginTime+dt*i;
-        _data[i*_ncols+2] = buf[i];
+        _data[i*_ncols+2] = buf.at(i);
     }
-    free(buf);
 
     delete it;
     curveModel->unmap();
 }
+
+SGSmoothJob::SGSmoothJob(CurveModel *curveModel, int window, int degree) :
+    curveModel(curveModel),
+    window(window),
+    degree(degree)
+{
+}
+
+void SGSmoothJob::run()
+{
+    int N = curveModel->rowCount();
+    if ( curveModel->_real == 0 || N <= 0 ) {
+        return;
+    }
+    ys = QVector<double>(N);
+    for ( int i = 0; i < N; ++i ) {
+        ys[i] = curveModel->_real[i];
+    }
+    calc_sgsmooth(N, ys.data(), window, degree);
+}
@@ -4,6 +4,7 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QtMath>
+#include <QVector>
 #include "parameter.h"
 #include "datamodel.h"
 #include "curvemodelparameter.h"
@@ -13,6 +14,24 @@
 
 class SGModelIterator;
 
+//
+// Smoothed y for a curve whose _real caches its raw y (see _keyPressG)
+//
+// run() only reads the cache, so jobs for many curves can run
+// concurrently.  CurveModelSG takes the result in the GUI thread.
+//
+class SGSmoothJob
+{
+  public:
+    SGSmoothJob(CurveModel* curveModel, int window, int degree);
+    void run();
+
+    CurveModel* curveModel;
+    int window;
+    int degree;
+    QVector<double> ys;
+};
+
 class CurveModelSG : public CurveModel
 {
   Q_OBJECT
@@ -22,6 +41,7 @@ class CurveModelSG : public CurveModel
   public:
 
     explicit CurveModelSG(CurveModel* curveModel,int window,int degree);
+    explicit CurveModelSG(const SGSmoothJob& job);
 
     ~CurveModelSG();
 
@@ -57,7 +77,8 @@ class CurveModelSG : public CurveModel
     CurveModelParameter* _y;
     SGModelIterator* _iteratorTimeIndex;
 
-    void _init(CurveModel* curveModel);
+    void _setup(CurveModel* curveModel);
+    void _init(CurveModel* curveModel, const QVector<double>* ys=0);
     int _idxAtTimeBinarySearch (SGModelIterator* it,
                                 int low, int high, double time);
 };
@@ -0,0 +1,213 @@
+#include "curvemodel_transform.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+int CurveColumns::cost() const
+{
+    qint64 n = t.size();
+    if ( x.constData() != t.constData() ) {
+        n += x.size();
+    }
+    n += y.size();
+    return (int)(n*sizeof(double)/1024) + 1;
+}
+
+QMutex TransformCache::_mutex;
+QCache<QString,CurveColumns> TransformCache::_cache(256*1024);
+
+bool TransformCache::find(const QString &key, CurveColumns *columns)
+{
+    QMutexLocker locker(&_mutex);
+    CurveColumns* cached = _cache.object(key);
+    if ( !cached ) {
+        return false;
+    }
+    *columns = *cached;
+    return true;
+}
+
+void TransformCache::insert(const QString &key, const CurveColumns &columns)
+{
+    QMutexLocker locker(&_mutex);
+    _cache.insert(key,new CurveColumns(columns),columns.cost());
+}
+
+void TransformCache::setBudget(int megabytes)
+{
+    QMutexLocker locker(&_mutex);
+    _cache.setMaxCost(megabytes*1024);
+}
+
+int TransformCache::budget()
+{
+    QMutexLocker locker(&_mutex);
+    return _cache.maxCost()/1024;
+}
+
+void TransformCache::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _cache.clear();
+}
+
+CurveModelTransform::CurveModelTransform(CurveModel *parent) :
+    _t(new CurveModelParameter),
+    _x(new CurveModelParameter),
+    _y(new CurveModelParameter),
+    _parent(parent),
+    _nrows(-1)
+{
+    _fileName = parent->fileName();
+    _t->setName(parent->t()->name());
+    _t->setUnit(parent->t()->unit());
+    _x->setName(parent->x()->name());
+    _x->setUnit(parent->x()->unit());
+    _y->setName(parent->y()->name());
+    _y->setUnit(parent->y()->unit());
+}
+
+// See ~CurveModel() too
+CurveModelTransform::~CurveModelTransform()
+{
+    delete _t;
+    delete _x;
+    delete _y;
+}
+
+QString CurveModelTransform::nodeKey() const
+{
+    return QString("%1[%2]").arg(_op()).arg(_parent->nodeKey());
+}
+
+// A logged curve is read into columns once and memoized like any node
+CurveColumns CurveModelTransform::columns(CurveModel *curveModel)
+{
+    CurveModelTransform* transform =
+                             qobject_cast<CurveModelTransform*>(curveModel);
+    if ( transform ) {
+        return transform->_columns();
+    }
+
+    CurveColumns cols;
+    QString key = curveModel->nodeKey();
+    if ( TransformCache::find(key,&cols) ) {
+        return cols;
+    }
+
+    curveModel->map();
+    int n = curveModel->rowCount();
+    cols.t.resize(n);
+    cols.x.resize(n);
+    cols.y.resize(n);
+    bool isXTime = true;
+    ModelIterator* it = curveModel->begin();
+    int i = 0;
+    while ( !it->isDone() && i < n ) {
+        cols.t[i] = it->t();
+        cols.x[i] = it->x();
+        cols.y[i] = it->y();
+        if ( cols.x[i] != cols.t[i] ) {
+            isXTime = false;
+        }
+        it->next();
+        ++i;
+    }
+    delete it;
+    curveModel->unmap();
+
+    if ( i < n ) {
+        cols.t.resize(i);
+        cols.x.resize(i);
+        cols.y.resize(i);
+    }
+    if ( isXTime ) {
+        cols.x = cols.t;  // share
+    }
+
+    TransformCache::insert(key,cols);
+    return cols;
+}
+
+CurveColumns CurveModelTransform::_columns() const
+{
+    CurveColumns out;
+    QString key = nodeKey();
+    if ( !TransformCache::find(key,&out) ) {
+        CurveColumns in = CurveModelTransform::columns(_parent);
+        _evaluate(in,&out);
+        TransformCache::insert(key,out);
+    }
+    _nrows = out.t.size();
+    return out;
+}
+
+ModelIterator* CurveModelTransform::begin() const
+{
+    return new TransformModelIterator(_columns());
+}
+
+int CurveModelTransform::indexAtTime(double time)
+{
+    CurveColumns cols = _columns();
+    int n = cols.t.size();
+    if ( n <= 1 ) {
+        return 0;
+    }
+
+    // Closest sample, first of duplicate timestamps
+    const double* t = cols.t.constData();
+    const double* it = std::lower_bound(t,t+n,time);
+    int i = (int)(it-t);
+    if ( i >= n ) {
+        return n-1;
+    }
+    if ( i > 0 && qAbs(time-t[i-1]) <= qAbs(t[i]-time) ) {
+        --i;
+        while ( i > 0 && t[i-1] == t[i] ) {
+            --i;
+        }
+    }
+    return i;
+}
+
+int CurveModelTransform::rowCount(const QModelIndex &pidx) const
+{
+    if ( pidx.isValid() ) {
+        return 0;
+    }
+    if ( _nrows < 0 ) {
+        _columns();
+    }
+    return _nrows;
+}
+
+int CurveModelTransform::columnCount(const QModelIndex &pidx) const
+{
+    if ( !pidx.isValid() ) {
+        return 3;
+    } else {
+        return 0;
+    }
+}
+
+// Columns are t, x and y
+QVariant CurveModelTransform::data (const QModelIndex & idx, int role ) const
+{
+    QVariant val;
+
+    if ( idx.isValid() && role == Qt::DisplayRole ) {
+        CurveColumns cols = _columns();
+        int row = idx.row();
+        if ( row >= 0 && row < cols.t.size() ) {
+            switch ( idx.column() ) {
+            case 0: val = cols.t.at(row); break;
+            case 1: val = cols.x.at(row); break;
+            case 2: val = cols.y.at(row); break;
+            default: break;
+            }
+        }
+    }
+
+    return val;
+}
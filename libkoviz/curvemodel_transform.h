@@ -0,0 +1,179 @@
+#ifndef CURVE_MODEL_TRANSFORM_H
+#define CURVE_MODEL_TRANSFORM_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <QVector>
+#include <QCache>
+#include <QMutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include "datamodel.h"
+#include "curvemodelparameter.h"
+#include "curvemodel.h"
+
+//
+// Columns of a curve
+//
+// QVectors are implicitly shared, so a transform that only changes y
+// hands its parent's t (and x) to its output without copying, and x is
+// the same buffer as t when the curve is plotted against time.
+//
+class CurveColumns
+{
+  public:
+    QVector<double> t;
+    QVector<double> x;
+    QVector<double> y;
+
+    int cost() const;  // KB
+};
+
+//
+// Memoized transform outputs keyed by node key under a memory budget
+//
+// Least recently used outputs are evicted first.  Evicted outputs stay
+// alive while an iterator holds them and are recomputed from the parent
+// on next use.
+//
+class TransformCache
+{
+  public:
+    static bool find(const QString& key, CurveColumns* columns);
+    static void insert(const QString& key, const CurveColumns& columns);
+    static void setBudget(int megabytes);
+    static int budget();   // megabytes
+    static void clear();
+
+  private:
+    static QMutex _mutex;
+    static QCache<QString,CurveColumns> _cache;
+};
+
+class TransformModelIterator;
+
+//
+// Base for curves derived from a parent curve
+//
+// A transform is a node in a graph whose leaves are logged curves.  It
+// is evaluated lazily, on first use, from its parent's columns (which
+// may themselves be a transform's memoized output) and the result is
+// memoized in the TransformCache under
+//
+//     op(params)[parent node key]
+//
+// The parent must outlive the transform.
+//
+class CurveModelTransform : public CurveModel
+{
+  Q_OBJECT
+
+  friend class TransformModelIterator;
+
+  public:
+
+    explicit CurveModelTransform(CurveModel* parent);
+    ~CurveModelTransform();
+
+    CurveModelParameter* t() { return _t; }
+    CurveModelParameter* x() { return _x; }
+    CurveModelParameter* y() { return _y; }
+
+    QString fileName() const { return _fileName; }
+
+    void map() {}
+    void unmap() {}
+    ModelIterator* begin() const ;
+    int indexAtTime(double time);
+
+    virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual QVariant data (const QModelIndex & index,
+                           int role = Qt::DisplayRole ) const ;
+
+    virtual QString nodeKey() const;
+    CurveModel* parentCurve() const { return _parent; }
+
+    static CurveColumns columns(CurveModel* curveModel);
+
+  protected:
+
+    QString _fileName;
+    CurveModelParameter* _t;
+    CurveModelParameter* _x;
+    CurveModelParameter* _y;
+
+    virtual QString _op() const = 0;
+    virtual void _evaluate(const CurveColumns& in, CurveColumns* out) const=0;
+
+  private:
+
+    CurveModel* _parent;
+    mutable int _nrows;     // -1 until first evaluated
+
+    CurveColumns _columns() const;
+};
+
+class TransformModelIterator : public ModelIterator
+{
+  public:
+
+    inline TransformModelIterator(const CurveColumns& columns) :
+        i(0),
+        _n(columns.t.size()),
+        _columns(columns),
+        _t(_columns.t.constData()),
+        _x(_columns.x.constData()),
+        _y(_columns.y.constData())
+    {
+    }
+
+    virtual ~TransformModelIterator() {}
+
+    virtual void start()
+    {
+        i = 0;
+    }
+
+    virtual void next()
+    {
+        ++i;
+    }
+
+    virtual bool isDone() const
+    {
+        return ( i >= _n ) ;
+    }
+
+    virtual TransformModelIterator* at(int n)
+    {
+        i = n;
+        return this;
+    }
+
+    inline double t() const
+    {
+        return _t[i];
+    }
+
+    inline double x() const
+    {
+        return _x[i];
+    }
+
+    inline double y() const
+    {
+        return _y[i];
+    }
+
+  private:
+
+    int i;
+    int _n;
+    CurveColumns _columns;  // keeps data alive if evicted
+    const double* _t;
+    const double* _x;
+    const double* _y;
+};
+
+#endif // CURVE_MODEL_TRANSFORM_H
@@ -0,0 +1,126 @@
+#include "curveproptable.h"
+
+static int _bitCount(quint32 bits)
+{
+    int n = 0;
+    while ( bits ) {
+        bits &= bits-1;
+        ++n;
+    }
+    return n;
+}
+
+CurvePropTable::CurvePropTable() :
+    _values(tags().size())
+{
+}
+
+const QStringList &CurvePropTable::tags()
+{
+    static QStringList tags;
+    if ( tags.isEmpty() ) {
+        tags << "CurveRunID"
+             << "CurveTimeName" << "CurveTimeUnit"
+             << "CurveXName" << "CurveXUnit"
+             << "CurveYName" << "CurveYUnit"
+             << "CurveXMinRange" << "CurveXMaxRange"
+             << "CurveYMinRange" << "CurveYMaxRange"
+             << "CurveXScale" << "CurveXBias"
+             << "CurveYScale" << "CurveYBias"
+             << "CurveSymbolSize" << "CurveYLabel"
+             << "CurveColor" << "CurveLineStyle" << "CurveSymbolStyle"
+             << "CurveData";
+    }
+    return tags;
+}
+
+int CurvePropTable::tagIndex(const QString &tag)
+{
+    static QHash<QString,int> tag2idx;
+    if ( tag2idx.isEmpty() ) {
+        for ( int i = 0; i < tags().size(); ++i ) {
+            tag2idx.insert(tags().at(i),i);
+        }
+    }
+    return tag2idx.value(tag,-1);
+}
+
+int CurvePropTable::alloc()
+{
+    if ( !_freeIds.isEmpty() ) {
+        int id = _freeIds.last();
+        _freeIds.pop_back();
+        return id;
+    }
+    int id = _tagMasks.size();
+    _tagMasks.append(0);
+    for ( int i = 0; i < _values.size(); ++i ) {
+        _values[i].append(QVariant());
+    }
+    return id;
+}
+
+void CurvePropTable::release(int id)
+{
+    for ( int i = 0; i < _values.size(); ++i ) {
+        _values[i][id] = QVariant();
+    }
+    _tagMasks[id] = 0;
+    _freeIds.append(id);
+}
+
+int CurvePropTable::rowCount(int id) const
+{
+    return _bitCount(_tagMasks.at(id));
+}
+
+bool CurvePropTable::hasTag(int id, int tag) const
+{
+    return _tagMasks.at(id) & (1u << tag);
+}
+
+int CurvePropTable::row(int id, int tag) const
+{
+    return _bitCount(_tagMasks.at(id) & ((1u << tag)-1));
+}
+
+int CurvePropTable::tag(int id, int row) const
+{
+    quint32 mask = _tagMasks.at(id);
+    for ( int tag = 0; tag < _values.size(); ++tag ) {
+        if ( mask & (1u << tag) ) {
+            if ( row == 0 ) {
+                return tag;
+            }
+            --row;
+        }
+    }
+    return -1;
+}
+
+void CurvePropTable::addTag(int id, int tag)
+{
+    _tagMasks[id] |= (1u << tag);
+}
+
+QVariant CurvePropTable::value(int id, int tag) const
+{
+    return _values.at(tag).at(id);
+}
+
+void CurvePropTable::setValue(int id, int tag, const QVariant &value)
+{
+    _values[tag][id] = value;
+}
+
+CurveItem::CurveItem(const QSharedPointer<CurvePropTable> &table) :
+    QStandardItem("Curve"),
+    _table(table),
+    _id(table->alloc())
+{
+}
+
+CurveItem::~CurveItem()
+{
+    _table->release(_id);
+}
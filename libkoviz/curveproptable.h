@@ -0,0 +1,71 @@
+#ifndef CURVEPROPTABLE_H
+#define CURVEPROPTABLE_H
+
+#include <QStandardItem>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <QHash>
+
+#include "unit.h"
+
+//
+// Properties (CurveColor, CurveXBias...) of all curves in a book
+//
+// A column of values per property tag, indexed by curve id, instead of a
+// tag item and value item per property per curve.  A curve has the subset
+// of tags that were added to it, and its rows are its tags in the order of
+// tags().
+//
+class CurvePropTable
+{
+  public:
+    CurvePropTable();
+
+    static const QStringList& tags();
+    static int tagIndex(const QString& tag);   // -1 if not a curve tag
+
+    int alloc();
+    void release(int id);
+
+    int rowCount(int id) const;
+    bool hasTag(int id, int tag) const;
+    int row(int id, int tag) const;    // row tag has/would have in curve
+    int tag(int id, int row) const;
+    void addTag(int id, int tag);
+
+    QVariant value(int id, int tag) const;
+    void setValue(int id, int tag, const QVariant& value);
+
+  private:
+    QVector<quint32> _tagMasks;          // bit per tag curve has
+    QVector<QVector<QVariant> > _values; // column per tag, row per id
+    QVector<int> _freeIds;
+};
+
+//
+// "Curve" item of a book, its properties are kept in a CurvePropTable
+//
+class CurveItem : public QStandardItem
+{
+  public:
+    enum { Type = QStandardItem::UserType + 1 };
+
+    CurveItem(const QSharedPointer<CurvePropTable>& table);
+    ~CurveItem();
+
+    int type() const { return Type; }
+    int id() const { return _id; }
+    CurvePropTable* table() const { return _table.data(); }
+
+    // Logged to book unit conversions of the curve's painter path
+    UnitConverter xUnitConverter;
+    UnitConverter yUnitConverter;
+
+  private:
+    QSharedPointer<CurvePropTable> _table;
+    int _id;
+};
+
+#endif // CURVEPROPTABLE_H
@@ -3,6 +3,7 @@
 #include "datamodel_trick.h"
 #include "datamodel_csv.h"
 #include "datamodel_mot.h"
+#include "datamodel_kvz.h"
 
 DataModel *DataModel::createDataModel(const QStringList &timeNames,
                                       const QString &fileName)
@@ -15,6 +16,8 @@ DataModel *DataModel::createDataModel(const QStringList &timeNames,
         dataModel = new CsvModel(timeNames,fileName);
     } else if ( fi.suffix() == "mot" ) {
         dataModel = new MotModel(timeNames,fileName);
+    } else if ( fi.suffix() == "kvz" ) {
+        dataModel = new KvzModel(timeNames,fileName);
     } else {
         fprintf(stderr,"koviz [error]: DataModel::createDataModel() cannot "
                        "handle file=\"%s\"\n",fileName.toLatin1().constData());
@@ -23,3 +26,15 @@ DataModel *DataModel::createDataModel(const QStringList &timeNames,
 
     return dataModel;
 }
+
+// Models with a faster way of reading a column override this
+void DataModel::readColumn(int col, int beg, int n, double *out) const
+{
+    ModelIterator* it = begin(col,col,col);
+    it = it->at(beg);
+    for ( int i = 0; i < n; ++i ) {
+        out[i] = it->y();
+        it->next();
+    }
+    delete it;
+}
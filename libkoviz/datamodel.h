@@ -41,6 +41,13 @@ class DataModel : public QAbstractTableModel
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const = 0;
     virtual int indexAtTime(double time) = 0 ;
 
+    // Values of col for rows beg..beg+n-1 (model must be mapped)
+    virtual void readColumn(int col, int beg, int n, double* out) const;
+
+    // Pick up records appended to file since load (e.g. sim still running)
+    // Returns number of new rows
+    virtual int refresh() { return 0; }
+
     virtual int rowCount(const QModelIndex& pidx=QModelIndex()) const = 0;
     virtual int columnCount(const QModelIndex& pidx=QModelIndex()) const = 0;
     virtual QVariant data(const QModelIndex& idx,
@@ -0,0 +1,168 @@
+#include "datamodel_catalog.h"
+
+QString CatalogModel::_err_string;
+QTextStream CatalogModel::_err_stream(&CatalogModel::_err_string);
+static QMutex _errMutex;  // models are loaded from worker threads
+
+CatalogModel::CatalogModel(const QStringList &timeNames,
+                           const QString &fileName,
+                           const QList<Parameter> &params,
+                           int nrows,
+                           qint64 size,
+                           QObject *parent) :
+    DataModel(timeNames, fileName, parent),
+    _timeNames(timeNames),
+    _params(params),
+    _nrows(nrows),
+    _size(size),
+    _model(0)
+{
+    for ( int col = 0; col < _params.size(); ++col ) {
+        _param2column.insert(_params.at(col).name(),col);
+    }
+}
+
+CatalogModel::~CatalogModel()
+{
+    delete _model;
+}
+
+// Curves of different runs may be mapped from worker threads
+// Returns 0 if the file can't be loaded (see _loadError)
+DataModel *CatalogModel::_load() const
+{
+    QMutexLocker locker(&_mutex);
+
+    if ( _model || !_loadError.isEmpty() ) {
+        return _model;
+    }
+
+    DataModel* m = 0;
+    try {
+        m = DataModel::createDataModel(_timeNames,fileName());
+    } catch (std::exception &e) {
+        _loadError = e.what();
+        return 0;
+    }
+
+    bool isSame = ( m->columnCount() == _params.size() );
+    for ( int col = 0; isSame && col < _params.size(); ++col ) {
+        isSame = ( m->param(col)->name() == _params.at(col).name() );
+    }
+    if ( !isSame ) {
+        delete m;
+        QMutexLocker errLocker(&_errMutex);
+        _err_stream << "koviz [error]: params of " << fileName()
+                    << " changed since koviz started\n";
+        _loadError = _err_string;
+        return 0;
+    }
+
+    if ( m->thread() != thread() ) {
+        m->moveToThread(thread());
+    }
+    const_cast<CatalogModel*>(this)->_model = m;
+
+    return _model;
+}
+
+// For DataModel calls that, like TrickModel's, throw if there is no data
+DataModel *CatalogModel::_loaded() const
+{
+    DataModel* m = _load();
+    if ( !m ) {
+        QMutexLocker locker(&_mutex);
+        throw std::runtime_error(_loadError.toLatin1().constData());
+    }
+    return m;
+}
+
+void CatalogModel::map()
+{
+    _loaded()->map();
+}
+
+void CatalogModel::unmap()
+{
+    QMutexLocker locker(&_mutex);
+    if ( _model ) {
+        _model->unmap();
+    }
+}
+
+const Parameter *CatalogModel::param(int col) const
+{
+    return &_params.at(col);
+}
+
+int CatalogModel::paramColumn(const QString &param) const
+{
+    return _param2column.value(param,-1);
+}
+
+ModelIterator *CatalogModel::begin(int tcol, int xcol, int ycol) const
+{
+    return _loaded()->begin(tcol,xcol,ycol);
+}
+
+void CatalogModel::readColumn(int col, int beg, int n, double *out) const
+{
+    _loaded()->readColumn(col,beg,n,out);
+}
+
+int CatalogModel::indexAtTime(double time)
+{
+    return _loaded()->indexAtTime(time);
+}
+
+// Unchanged files are not loaded
+int CatalogModel::refresh()
+{
+    DataModel* m = 0;
+    {
+        QMutexLocker locker(&_mutex);
+        m = _model;
+    }
+    if ( !m ) {
+        if ( QFileInfo(fileName()).size() == _size ) {
+            return 0;
+        }
+        m = _load();
+        if ( !m ) {
+            return 0;
+        }
+        int nNewRows = m->rowCount() - _nrows;
+        return ( nNewRows > 0 ) ? nNewRows : 0;
+    }
+    return m->refresh();
+}
+
+int CatalogModel::rowCount(const QModelIndex &pidx) const
+{
+    if ( pidx.isValid() ) {
+        return 0;
+    }
+    QMutexLocker locker(&_mutex);
+    if ( _model ) {
+        return _model->rowCount();
+    }
+    return _nrows;
+}
+
+int CatalogModel::columnCount(const QModelIndex &pidx) const
+{
+    if ( pidx.isValid() ) {
+        return 0;
+    }
+    return _params.size();
+}
+
+QVariant CatalogModel::data(const QModelIndex &idx, int role) const
+{
+    QVariant val;
+    DataModel* m = _load();
+    if ( m ) {
+        val = m->data(m->index(idx.row(),idx.column()),role);
+    }
+    return val;
+}
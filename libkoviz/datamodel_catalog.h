@@ -0,0 +1,73 @@
+#ifndef CATALOG_MODEL_H
+#define CATALOG_MODEL_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVariant>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <stdexcept>
+
+#include "datamodel.h"
+#include "parameter.h"
+
+//
+// Data model opened from the runs catalog (see RunsCatalog)
+//
+// Params and row count come from the catalog, so no header is parsed
+// when koviz starts.  The file's model is created the first time data is
+// needed (e.g. a curve is mapped) and all data calls go to it.  If the
+// file can't be loaded, map() and begin() throw like TrickModel does and
+// data() is empty.
+//
+class CatalogModel : public DataModel
+{
+  Q_OBJECT
+
+  public:
+
+    explicit CatalogModel(const QStringList &timeNames,
+                          const QString &fileName,
+                          const QList<Parameter>& params,
+                          int nrows,
+                          qint64 size,
+                          QObject *parent = 0);
+    ~CatalogModel();
+
+    virtual void map();
+    virtual void unmap();
+    virtual const Parameter* param(int col) const ;
+    virtual int paramColumn(const QString& param) const ;
+    virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
+    virtual void readColumn(int col, int beg, int n, double* out) const;
+    virtual int indexAtTime(double time);
+    virtual int refresh();
+
+    virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual QVariant data (const QModelIndex & index,
+                           int role = Qt::DisplayRole ) const;
+
+  private:
+
+    QStringList _timeNames;
+    QList<Parameter> _params;
+    QHash<QString,int> _param2column;
+    int _nrows;
+    qint64 _size;
+    DataModel* _model;
+    mutable QString _loadError;
+    mutable QMutex _mutex;         // guards _model and _loadError
+
+    static QString _err_string;
+    static QTextStream _err_stream;
+
+    DataModel* _load() const;
+    DataModel* _loaded() const;
+};
+
+#endif // CATALOG_MODEL_H
@@ -1,4 +1,5 @@
 #include "datamodel_csv.h"
+#include "trace.h"
 
 QString CsvModel::_err_string;
 QTextStream CsvModel::_err_stream(&CsvModel::_err_string);
@@ -16,6 +17,8 @@ CsvModel::CsvModel(const QStringList& timeNames,
 
 void CsvModel::_init()
 {
+    KOVIZ_TRACE("csv load");
+
     QFile file(_csvfile);
 
     if (!file.open(QIODevice::ReadOnly)) {
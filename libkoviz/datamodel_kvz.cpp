@@ -0,0 +1,550 @@
+#include "datamodel_kvz.h"
+#include "trace.h"
+
+#include <QtConcurrentMap>
+#include <float.h>
+#include <string.h>
+#include <algorithm>
+
+QString KvzModel::_err_string;
+QTextStream KvzModel::_err_stream(&KvzModel::_err_string);
+
+// A column of a block to compress (write) or decompress (read)
+struct KvzBlockJob
+{
+    QByteArray payload;   // compressed
+    QByteArray raw;       // values as logged
+    int size;             // bytesize of value
+    int nrows;            // -1 if payload is corrupt
+    TrickReadFunc read;
+    double* out;
+};
+
+// XOR each value with the value before it and shuffle bytes into planes
+// (all first bytes, then all second bytes...), so that slowly changing
+// values become runs of zeros for the compressor.  XOR of the bytes is
+// XOR of the value bits, so this works for any type and byte order.
+static QByteArray _encode(const QByteArray& raw, int size)
+{
+    int n = raw.size()/size;
+    QByteArray coded(raw.size(),'\0');
+    const char* in = raw.constData();
+    char* out = coded.data();
+    for ( int k = 0; k < size; ++k ) {
+        char* plane = out + k*n;
+        plane[0] = in[k];
+        for ( int i = 1; i < n; ++i ) {
+            plane[i] = in[i*size+k] ^ in[(i-1)*size+k];
+        }
+    }
+    return coded;
+}
+
+static QByteArray _decode(const QByteArray& coded, int size)
+{
+    int n = coded.size()/size;
+    QByteArray raw(coded.size(),'\0');
+    const char* in = coded.constData();
+    char* out = raw.data();
+    for ( int k = 0; k < size; ++k ) {
+        const char* plane = in + k*n;
+        out[k] = plane[0];
+        for ( int i = 1; i < n; ++i ) {
+            out[i*size+k] = plane[i] ^ out[(i-1)*size+k];
+        }
+    }
+    return raw;
+}
+
+static void _encodeJob(KvzBlockJob& job)
+{
+    // Level 1 since load time, not file size, is what matters
+    job.payload = qCompress(_encode(job.raw,job.size),1);
+    job.raw.clear();
+}
+
+static void _decodeJob(KvzBlockJob& job)
+{
+    QByteArray coded = qUncompress(job.payload);
+    job.payload.clear();
+    if ( job.size <= 0 || coded.size() != job.nrows*job.size ) {
+        job.nrows = -1;
+        return;
+    }
+    job.raw = _decode(coded,job.size);
+    coded.clear();
+    if ( job.out ) {
+        const char* raw = job.raw.constData();
+        for ( int i = 0; i < job.nrows; ++i ) {
+            job.out[i] = job.read((ptrdiff_t)(raw+i*job.size));
+        }
+        job.raw.clear();
+    }
+}
+
+static void _writeString(QDataStream& out, const QString& str)
+{
+    QByteArray bytes = str.toLatin1();
+    out << (qint32)bytes.size();
+    out.writeRawData(bytes.constData(),bytes.size());
+}
+
+static QString _readString(QDataStream& in)
+{
+    qint32 sz = 0;
+    in >> sz;
+    if ( sz < 0 || sz > 65536 ) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return QString();
+    }
+    QByteArray bytes(sz,'\0');
+    in.readRawData(bytes.data(),sz);
+    return QString::fromLatin1(bytes.constData(),sz);
+}
+
+KvzModel::KvzModel(const QStringList& timeNames,
+                   const QString& kvzfile,
+                   QObject *parent) :
+    DataModel(timeNames, kvzfile, parent),
+    _timeNames(timeNames),_kvzfile(kvzfile),
+    _trick_version(TrickModel::TrickVersion07),
+    _isBigEndian(false),
+    _nrows(0), _ncols(0), _rowsPerBlock(0), _indexTimeCol(0), _timeCol(0)
+{
+    _init();
+}
+
+KvzModel::~KvzModel()
+{
+    foreach ( TrickParameter* param, _col2param.values() ) {
+        delete param;
+    }
+}
+
+void KvzModel::_init()
+{
+    KOVIZ_TRACE("kvz header parse");
+
+    QFile file(_kvzfile);
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        _err_stream << "koviz [error]: could not open "
+                    << _kvzfile << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+
+    char data[8];
+    if ( in.readRawData(data,6) != 6 || strncmp(data,"KVZ-01",6) != 0 ) {
+        _err_stream << "koviz [error]: not a koviz archive: "
+                    << _kvzfile << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+    in.readRawData(data,2);
+    if ( data[0] == '1' && data[1] == '0' ) {
+        _trick_version = TrickModel::TrickVersion10;
+    } else {
+        _trick_version = TrickModel::TrickVersion07;
+    }
+    in.readRawData(data,1);
+    _isBigEndian = ( data[0] == 'B' );
+    bool isSwap = ( _isBigEndian != (Q_BYTE_ORDER == Q_BIG_ENDIAN) );
+
+    in >> _ncols >> _nrows >> _rowsPerBlock >> _indexTimeCol;
+    if ( in.status() != QDataStream::Ok || _ncols <= 0 || _nrows < 0 ||
+         _rowsPerBlock <= 0 || _indexTimeCol < 0 || _indexTimeCol >= _ncols ) {
+        _err_stream << "koviz [error]: kvz file \""
+                    << _kvzfile << "\" is corrupt!\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+
+    for ( int col = 0; col < _ncols; ++col ) {
+        TrickParameter* param = new TrickParameter;
+        param->setName(_readString(in));
+        param->setUnit(_readString(in));
+        qint32 type = 0;
+        qint32 size = 0;
+        in >> type >> size;
+        param->setType(type);
+        param->setSize(size);
+        _col2param.insert(col,param);
+        if ( in.status() != QDataStream::Ok || size <= 0 ) {
+            _err_stream << "koviz [error]: kvz file \""
+                        << _kvzfile << "\" is corrupt!\n";
+            throw std::runtime_error(_err_string.toLatin1().constData());
+        }
+        _param2column.insert(param->name(),col);
+        _readFuncs.append(TrickModel::readFunc(_trick_version,
+                                               type,size,isSwap));
+    }
+
+    qint64 indexPos = 0;
+    in >> indexPos;
+    if ( in.status() != QDataStream::Ok || !file.seek(indexPos) ) {
+        _err_stream << "koviz [error]: kvz file \""
+                    << _kvzfile << "\" is corrupt!\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+
+    // Block index
+    int nblocks = (int)((_nrows+_rowsPerBlock-1)/_rowsPerBlock);
+    _blocks.resize(nblocks);
+    for ( int b = 0; b < nblocks; ++b ) {
+        Block& block = _blocks[b];
+        in >> block.tmin >> block.tmax;
+        block.pos.resize(_ncols);
+        block.len.resize(_ncols);
+        for ( int col = 0; col < _ncols; ++col ) {
+            in >> block.pos[col] >> block.len[col];
+        }
+    }
+    if ( in.status() != QDataStream::Ok ) {
+        _err_stream << "koviz [error]: kvz file \""
+                    << _kvzfile << "\" is corrupt!\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+
+    // Make sure time param exists in model and set time column
+    bool isFoundTime = false;
+    foreach (QString timeName, _timeNames) {
+        if ( _param2column.contains(timeName)) {
+            _timeCol = _param2column.value(timeName) ;
+            isFoundTime = true;
+            break;
+        }
+    }
+    if ( ! isFoundTime ) {
+        _err_stream << "koviz [error]: couldn't find time param \""
+                    << _timeNames.join("=") << "\" in kvzfile=" << _kvzfile
+                    << ".  Try setting -timeName on commandline option.";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+}
+
+const Parameter* KvzModel::param(int col) const
+{
+    return _col2param.value(col);
+}
+
+// Blocks are decoded when first needed (see _values()) and kept
+void KvzModel::map()
+{
+}
+
+void KvzModel::unmap()
+{
+}
+
+int KvzModel::paramColumn(const QString &paramName) const
+{
+    return _param2column.value(paramName,-1);
+}
+
+ModelIterator *KvzModel::begin(int tcol, int xcol, int ycol) const
+{
+    int nblocks = _blocks.size();
+    return new KvzModelIterator(0,this,
+                                _values(tcol,0,nblocks),
+                                _values(xcol,0,nblocks),
+                                _values(ycol,0,nblocks));
+}
+
+// Only the blocks holding rows beg..beg+n-1 are decoded
+void KvzModel::readColumn(int col, int beg, int n, double *out) const
+{
+    if ( n <= 0 ) {
+        return;
+    }
+    int begBlock = beg/_rowsPerBlock;
+    int endBlock = (int)(((qint64)beg+n-1)/_rowsPerBlock)+1;
+    memcpy(out,_values(col,begBlock,endBlock)+beg,n*sizeof(double));
+}
+
+// The block index narrows the search to one block, which is all that is
+// decoded
+int KvzModel::indexAtTime(double time)
+{
+    if ( _nrows == 0 ) {
+        return 0;
+    }
+
+    if ( _timeCol != _indexTimeCol ) {
+        const double* t = _values(_timeCol,0,_blocks.size());
+        qint64 i = std::lower_bound(t,t+_nrows,time) - t;
+        if ( i >= _nrows ) {
+            return (int)(_nrows-1);
+        }
+        if ( i > 0 && qAbs(time-t[i-1]) <= qAbs(t[i]-time) ) {
+            --i;
+        }
+        return (int)i;
+    }
+
+    // Binary search block index for first block ending at/after time
+    int lo = 0;
+    int hi = _blocks.size()-1;
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( _blocks.at(mid).tmax < time ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    if ( _blocks.at(lo).tmax < time ) {
+        return (int)(_nrows-1);
+    }
+
+    qint64 beg = (qint64)lo*_rowsPerBlock;
+    int n = blockRowCount(lo);
+    const double* t = _values(_timeCol,lo,lo+1) + beg;
+    int j = std::lower_bound(t,t+n,time) - t;
+    if ( j >= n ) {
+        j = n-1;  // Time not monotonic within block
+    } else if ( j > 0 ) {
+        if ( qAbs(time-t[j-1]) <= qAbs(t[j]-time) ) {
+            --j;
+        }
+    } else if ( lo > 0 ) {
+        // Last time of previous block is its tmax
+        if ( qAbs(time-_blocks.at(lo-1).tmax) <= qAbs(t[0]-time) ) {
+            --j;
+        }
+    }
+    return (int)(beg+j);
+}
+
+int KvzModel::rowCount(const QModelIndex &pidx) const
+{
+    if ( ! pidx.isValid() ) {
+        return _nrows;
+    } else {
+        return 0;
+    }
+}
+
+int KvzModel::columnCount(const QModelIndex &pidx) const
+{
+    if ( ! pidx.isValid() ) {
+        return _ncols;
+    } else {
+        return 0;
+    }
+}
+
+QVariant KvzModel::data(const QModelIndex &idx, int role) const
+{
+    QVariant val;
+
+    if ( idx.isValid() && role == Qt::DisplayRole ) {
+        int block = idx.row()/_rowsPerBlock;
+        val = _values(idx.column(),block,block+1)[idx.row()];
+    }
+
+    return val;
+}
+
+int KvzModel::blockRowCount(int block) const
+{
+    qint64 beg = (qint64)block*_rowsPerBlock;
+    return (int)qMin((qint64)_rowsPerBlock,_nrows-beg);
+}
+
+QByteArray KvzModel::rawBlock(int col, int block) const
+{
+    KvzBlockJob job;
+    job.payload = _readPayloads(col,QList<int>() << block).first();
+    job.size = _col2param.value(col)->size();
+    job.nrows = blockRowCount(block);
+    job.read = _readFuncs.at(col);
+    job.out = 0;
+    _decodeJob(job);
+    if ( job.nrows < 0 ) {
+        _err_stream << "koviz [error]: kvz file \""
+                    << _kvzfile << "\" is corrupt!\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+    return job.raw;
+}
+
+QList<QByteArray> KvzModel::_readPayloads(int col,
+                                          const QList<int>& blocks) const
+{
+    QFile file(_kvzfile);
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        _err_stream << "koviz [error]: could not open "
+                    << _kvzfile << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+
+    QList<QByteArray> payloads;
+    foreach ( int b, blocks ) {
+        const Block& block = _blocks.at(b);
+        file.seek(block.pos.at(col));
+        QByteArray payload = file.read(block.len.at(col));
+        if ( payload.size() != block.len.at(col) ) {
+            _err_stream << "koviz [error]: kvz file \""
+                        << _kvzfile << "\" is truncated!\n";
+            throw std::runtime_error(_err_string.toLatin1().constData());
+        }
+        payloads.append(payload);
+    }
+
+    return payloads;
+}
+
+// Blocks of col in [begBlock,endBlock) that are not yet decoded are read
+// and decompressed in parallel.  Returns all of col's values, of which
+// only decoded blocks are valid.
+const double* KvzModel::_values(int col, int begBlock, int endBlock) const
+{
+    QMutexLocker locker(&_mutex);
+
+    Column& column = _columns[col];
+    if ( column.values.isEmpty() ) {
+        column.values.resize((int)_nrows);
+        column.isDecoded.fill(false,_blocks.size());
+    }
+
+    QList<int> blocks;
+    for ( int b = begBlock; b < endBlock; ++b ) {
+        if ( !column.isDecoded.at(b) ) {
+            blocks.append(b);
+        }
+    }
+    double* values = column.values.data();
+    if ( blocks.isEmpty() ) {
+        return values;
+    }
+
+    KOVIZ_TRACE("kvz block decode");
+
+    QList<QByteArray> payloads = _readPayloads(col,blocks);
+    QList<KvzBlockJob> jobs;
+    for ( int i = 0; i < blocks.size(); ++i ) {
+        int b = blocks.at(i);
+        KvzBlockJob job;
+        job.payload = payloads.at(i);
+        job.size = _col2param.value(col)->size();
+        job.nrows = blockRowCount(b);
+        job.read = _readFuncs.at(col);
+        job.out = values + (qint64)b*_rowsPerBlock;
+        jobs.append(job);
+    }
+    payloads.clear();
+    QtConcurrent::blockingMap(jobs,_decodeJob);
+
+    foreach ( KvzBlockJob job, jobs ) {
+        if ( job.nrows < 0 ) {
+            _err_stream << "koviz [error]: kvz file \""
+                        << _kvzfile << "\" is corrupt!\n";
+            throw std::runtime_error(_err_string.toLatin1().constData());
+        }
+    }
+    foreach ( int b, blocks ) {
+        column.isDecoded[b] = true;
+    }
+
+    return values;
+}
+
+// Each column of a block is coded and compressed in parallel
+void KvzModel::write(const TrickModel &trk, const QString &kvzfile,
+                     int rowsPerBlock)
+{
+    KOVIZ_TRACE("kvz write");
+
+    QFile file(kvzfile);
+    if ( !file.open(QIODevice::WriteOnly) ) {
+        _err_stream << "koviz [error]: could not open "
+                    << kvzfile << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    qint32 ncols = trk.columnCount();
+    qint64 nrows = trk.rowCount();
+    qint32 timeCol = trk.timeColumn();
+    bool isSwap = ( trk.isBigEndian() != (Q_BYTE_ORDER == Q_BIG_ENDIAN) );
+
+    out.writeRawData("KVZ-01",6);
+    out.writeRawData(trk.trickVersion() == TrickModel::TrickVersion10 ?
+                     "10" : "07",2);
+    out.writeRawData(trk.isBigEndian() ? "B" : "L",1);
+    out << ncols << nrows << (qint32)rowsPerBlock << timeCol;
+
+    QVector<int> sizes;
+    for ( int col = 0; col < ncols; ++col ) {
+        const TrickParameter* p =
+                        static_cast<const TrickParameter*>(trk.param(col));
+        _writeString(out,p->name());
+        _writeString(out,p->unit());
+        out << (qint32)p->type() << (qint32)p->size();
+        sizes.append(p->size());
+    }
+    qint64 indexPosPos = file.pos();
+    out << (qint64)0;  // block index position, set when index is written
+
+    const TrickParameter* timeParam =
+                        static_cast<const TrickParameter*>(trk.param(timeCol));
+    TrickReadFunc readTime = TrickModel::readFunc(trk.trickVersion(),
+                                                  timeParam->type(),
+                                                  timeParam->size(), isSwap);
+    qint64 timeOffset = trk.paramOffset(timeCol);
+
+    QVector<Block> blocks;
+    for ( qint64 beg = 0; beg < nrows; beg += rowsPerBlock ) {
+        int n = (int)qMin((qint64)rowsPerBlock,nrows-beg);
+
+        QList<KvzBlockJob> jobs;
+        for ( int col = 0; col < ncols; ++col ) {
+            KvzBlockJob job;
+            job.size = sizes.at(col);
+            job.nrows = n;
+            job.read = 0;
+            job.out = 0;
+            job.raw.resize(n*job.size);
+            char* raw = job.raw.data();
+            qint64 offset = trk.paramOffset(col);
+            for ( int r = 0; r < n; ++r ) {
+                memcpy(raw+r*job.size,trk.record(beg+r)+offset,job.size);
+            }
+            jobs.append(job);
+        }
+        QtConcurrent::blockingMap(jobs,_encodeJob);
+
+        Block block;
+        block.tmin = DBL_MAX;
+        block.tmax = -DBL_MAX;
+        for ( int r = 0; r < n; ++r ) {
+            double t = readTime((ptrdiff_t)(trk.record(beg+r)+timeOffset));
+            block.tmin = qMin(block.tmin,t);
+            block.tmax = qMax(block.tmax,t);
+        }
+        for ( int col = 0; col < ncols; ++col ) {
+            const QByteArray& payload = jobs.at(col).payload;
+            block.pos.append(file.pos());
+            block.len.append(payload.size());
+            out.writeRawData(payload.constData(),payload.size());
+        }
+        blocks.append(block);
+    }
+
+    qint64 indexPos = file.pos();
+    foreach ( Block block, blocks ) {
+        out << block.tmin << block.tmax;
+        for ( int col = 0; col < ncols; ++col ) {
+            out << block.pos.at(col) << block.len.at(col);
+        }
+    }
+    file.seek(indexPosPos);
+    out << indexPos;
+
+    if ( out.status() != QDataStream::Ok ) {
+        _err_stream << "koviz [error]: could not write "
+                    << kvzfile << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+    file.close();
+}
@@ -0,0 +1,195 @@
+#ifndef KVZ_MODEL_H
+#define KVZ_MODEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QTextStream>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <stdexcept>
+
+#include "datamodel.h"
+#include "datamodel_trick.h"
+
+class KvzModel;
+class KvzModelIterator;
+
+//
+// Koviz archive (*.kvz) of a trk file
+//
+// Rows are cut into blocks and each column of a block is stored on its
+// own, XOR coded against the previous value, byte shuffled and
+// compressed.  A block index at the end of the file has each block's
+// time range and the file position of each of its columns, so a curve
+// only reads and decompresses the columns it plots.  Blocks of a column
+// are decompressed in parallel.
+//
+// Values are kept as logged (type and byte order), so kvz -> trk gives
+// back the trk file.
+//
+//   "KVZ-01"                   magic
+//   "07"|"10" 'L'|'B'          Trick version and byte order of values
+//   qint32 ncols
+//   qint64 nrows
+//   qint32 rows per block
+//   qint32 time column of block index
+//   per param: name, unit (qint32 size + latin1), qint32 type, qint32 size
+//   qint64 file position of block index
+//   column blocks
+//   per block: double tmin, double tmax, per column: qint64 pos, qint32 len
+//
+// Header and index are little endian.
+//
+class KvzModel : public DataModel
+{
+  Q_OBJECT
+
+  friend class KvzModelIterator;
+
+  public:
+
+    explicit KvzModel(const QStringList &timeNames,
+                      const QString &kvzfile,
+                      QObject *parent = 0);
+    ~KvzModel();
+
+    virtual const Parameter* param(int col) const ;
+    virtual void map();
+    virtual void unmap();
+    virtual int paramColumn(const QString& paramName) const ;
+    virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
+    virtual void readColumn(int col, int beg, int n, double* out) const;
+    virtual int indexAtTime(double time);
+
+    virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual QVariant data (const QModelIndex & index,
+                           int role = Qt::DisplayRole ) const;
+
+    // Logged values of a column in a block (e.g. for kvz -> trk)
+    TrickModel::TrickVersion trickVersion() const { return _trick_version; }
+    bool isBigEndian() const { return _isBigEndian; }
+    int blockCount() const { return _blocks.size(); }
+    int blockRowCount(int block) const;
+    QByteArray rawBlock(int col, int block) const;
+
+    static void write(const TrickModel& trk, const QString& kvzfile,
+                      int rowsPerBlock = 8192);
+
+  private:
+
+    struct Block
+    {
+        double tmin;
+        double tmax;
+        QVector<qint64> pos;   // per column
+        QVector<qint32> len;
+    };
+
+    QStringList _timeNames;
+    QString _kvzfile;
+
+    TrickModel::TrickVersion _trick_version;
+    bool _isBigEndian;
+    qint64 _nrows;
+    qint32 _ncols;
+    qint32 _rowsPerBlock;
+    qint32 _indexTimeCol;
+    int _timeCol;
+
+    QHash<int,TrickParameter*> _col2param;
+    QHash<QString,int> _param2column;
+    QVector<TrickReadFunc> _readFuncs;
+    QVector<Block> _blocks;
+
+    // A column's blocks are decoded on demand and kept until the model
+    // is destroyed, since iterators point into them
+    struct Column
+    {
+        QVector<double> values;
+        QVector<bool> isDecoded;   // per block
+    };
+
+    mutable QHash<int,Column> _columns;
+    mutable QMutex _mutex;
+
+    static QString _err_string;
+    static QTextStream _err_stream;
+
+    void _init();
+    const double* _values(int col, int begBlock, int endBlock) const;
+    QList<QByteArray> _readPayloads(int col, const QList<int>& blocks) const;
+};
+
+class KvzModelIterator : public ModelIterator
+{
+  public:
+
+    inline KvzModelIterator(): i(0) {}
+
+    inline KvzModelIterator(int row, // iterator pos
+                            const KvzModel* model,
+                            const double* t, const double* x,
+                            const double* y):
+        i(row),
+        _model(model),
+        _t(t), _x(x), _y(y)
+    {
+    }
+
+    virtual ~KvzModelIterator() {}
+
+    virtual void start()
+    {
+        i = 0;
+    }
+
+    virtual void next()
+    {
+        ++i;
+    }
+
+    virtual bool isDone() const
+    {
+        return ( i >= _model->_nrows ) ;
+    }
+
+    virtual KvzModelIterator* at(int n)
+    {
+        i = n;
+        return this;
+    }
+
+    inline double t() const
+    {
+        return _t[i];
+    }
+
+    inline double x() const
+    {
+        return _x[i];
+    }
+
+    inline double y() const
+    {
+        return _y[i];
+    }
+
+  private:
+
+    qint64 i;
+    const KvzModel* _model;
+    const double* _t;
+    const double* _x;
+    const double* _y;
+};
+
+#endif // KVZ_MODEL_H
@@ -1,4 +1,5 @@
 #include "datamodel_mot.h"
+#include "trace.h"
 
 QString MotModel::_err_string;
 QTextStream MotModel::_err_stream(&MotModel::_err_string);
@@ -16,6 +17,8 @@ MotModel::MotModel(const QStringList& timeNames,
 
 void MotModel::_init()
 {
+    KOVIZ_TRACE("mot load");
+
     QFile file(_motfile);
 
     if (!file.open(QIODevice::ReadOnly)) {
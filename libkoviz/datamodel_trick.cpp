@@ -1,16 +1,217 @@
 #include "datamodel_trick.h"
 #include <QStringList>
+#include <QFileInfo>
+#include "trace.h"
 #include <stdio.h>
 #include <stdexcept>
 #include <unistd.h>
+#include <string.h>
+#include <QtEndian>
 
 QString TrickModel::_err_string;
 QTextStream TrickModel::_err_stream(&TrickModel::_err_string);
+bool TrickModel::isLiveTail = false;
+
+//
+// Read kernels, one per (C type, byte swap) instantiated from TrickKernel<>
+//
+// Values are memcpy'd since records are packed and not aligned.  Swapping
+// is done on the unsigned integer of the same size, which compiles to a
+// single byte swap instruction.  readColumn() reads a run of rows with the
+// value read inlined, instead of a call through a TrickReadFunc per value.
+//
+template <int N> struct TrickSwap;
+template <> struct TrickSwap<1> {
+    typedef quint8 Type;
+    static Type swap(Type v) { return v; }
+};
+template <> struct TrickSwap<2> {
+    typedef quint16 Type;
+    static Type swap(Type v) { return qbswap(v); }
+};
+template <> struct TrickSwap<4> {
+    typedef quint32 Type;
+    static Type swap(Type v) { return qbswap(v); }
+};
+template <> struct TrickSwap<8> {
+    typedef quint64 Type;
+    static Type swap(Type v) { return qbswap(v); }
+};
+
+struct TrickKernels
+{
+    TrickReadFunc read;
+    TrickReadColumnFunc readColumn;
+};
+
+template <typename T, bool isSwap>
+struct TrickKernel
+{
+    static inline double read(ptrdiff_t addr)
+    {
+        T v;
+        if ( isSwap ) {
+            typename TrickSwap<sizeof(T)>::Type u;
+            memcpy(&u,(const void*)addr,sizeof(T));
+            u = TrickSwap<sizeof(T)>::swap(u);
+            memcpy(&v,&u,sizeof(T));
+        } else {
+            memcpy(&v,(const void*)addr,sizeof(T));
+        }
+        return (double) v;
+    }
+
+    static void readColumn(ptrdiff_t addr, qint64 stride, qint64 n,
+                           double* out)
+    {
+        for ( qint64 i = 0; i < n; ++i ) {
+            out[i] = read(addr+i*stride);
+        }
+    }
+
+    static TrickKernels kernels()
+    {
+        TrickKernels k;
+        k.read = &read;
+        k.readColumn = &readColumn;
+        return k;
+    }
+};
+
+static double _readUnsupported(ptrdiff_t addr)
+{
+    Q_UNUSED(addr);
+    fprintf(stderr,
+            "koviz [error]: can't handle trick type of logged param.\n"
+            "              Look in trick_types.h for type.\n");
+    exit(-1);
+    return 0.0;
+}
+
+static void _readColumnUnsupported(ptrdiff_t addr, qint64 stride, qint64 n,
+                                   double* out)
+{
+    Q_UNUSED(stride);
+    Q_UNUSED(n);
+    Q_UNUSED(out);
+    _readUnsupported(addr);
+}
+
+static TrickKernels _kernelsUnsupported()
+{
+    TrickKernels k;
+    k.read = &_readUnsupported;
+    k.readColumn = &_readColumnUnsupported;
+    return k;
+}
+
+// Longs and bools are sized by the param size in the header, since they
+// differ between the machine that logged the file and this one
+template <bool isSwap>
+static TrickKernels _kernelsSized(int size, bool isSigned)
+{
+    switch (size) {
+    case 1: return isSigned ? TrickKernel<qint8,isSwap>::kernels()
+                            : TrickKernel<quint8,isSwap>::kernels();
+    case 2: return isSigned ? TrickKernel<qint16,isSwap>::kernels()
+                            : TrickKernel<quint16,isSwap>::kernels();
+    case 4: return isSigned ? TrickKernel<qint32,isSwap>::kernels()
+                            : TrickKernel<quint32,isSwap>::kernels();
+    case 8: return isSigned ? TrickKernel<qint64,isSwap>::kernels()
+                            : TrickKernel<quint64,isSwap>::kernels();
+    default: return _kernelsUnsupported();
+    }
+}
+
+template <bool isSwap>
+static TrickKernels _kernels07(int paramtype, int size)
+{
+    switch (paramtype) {
+    case TRICK_07_DOUBLE:
+        return TrickKernel<double,isSwap>::kernels();
+    case TRICK_07_UNSIGNED_LONG_LONG:
+        return TrickKernel<quint64,isSwap>::kernels();
+    case TRICK_07_LONG_LONG:
+        return TrickKernel<qint64,isSwap>::kernels();
+    case TRICK_07_FLOAT:
+        return TrickKernel<float,isSwap>::kernels();
+    case TRICK_07_INTEGER:
+    case TRICK_07_ENUMERATED:
+    case TRICK_07_UNSIGNED_BITFIELD:
+    case TRICK_07_BITFIELD:
+        return TrickKernel<qint32,isSwap>::kernels();
+    case TRICK_07_UNSIGNED_CHARACTER:
+        return TrickKernel<quint8,isSwap>::kernels();
+    case TRICK_07_SHORT:
+        return TrickKernel<qint16,isSwap>::kernels();
+    case TRICK_07_UNSIGNED_SHORT:
+        return TrickKernel<quint16,isSwap>::kernels();
+    case TRICK_07_UNSIGNED_INTEGER:
+        return TrickKernel<quint32,isSwap>::kernels();
+    case TRICK_07_LONG:
+        return _kernelsSized<isSwap>(size,true);
+    case TRICK_07_BOOLEAN:
+        return _kernelsSized<isSwap>(size,false);
+    default:
+        return _kernelsUnsupported();
+    }
+}
+
+template <bool isSwap>
+static TrickKernels _kernels10(int paramtype, int size)
+{
+    switch (paramtype) {
+    case TRICK_10_DOUBLE:
+        return TrickKernel<double,isSwap>::kernels();
+    case TRICK_10_UNSIGNED_LONG_LONG:
+        return TrickKernel<quint64,isSwap>::kernels();
+    case TRICK_10_LONG_LONG:
+        return TrickKernel<qint64,isSwap>::kernels();
+    case TRICK_10_FLOAT:
+        return TrickKernel<float,isSwap>::kernels();
+    case TRICK_10_INTEGER:
+    case TRICK_10_ENUMERATED:
+    case TRICK_10_UNSIGNED_BITFIELD:
+    case TRICK_10_BITFIELD:
+        return TrickKernel<qint32,isSwap>::kernels();
+    case TRICK_10_UNSIGNED_CHARACTER:
+        return TrickKernel<quint8,isSwap>::kernels();
+    case TRICK_10_CHARACTER:
+        return TrickKernel<qint8,isSwap>::kernels();
+    case TRICK_10_SHORT:
+        return TrickKernel<qint16,isSwap>::kernels();
+    case TRICK_10_UNSIGNED_SHORT:
+        return TrickKernel<quint16,isSwap>::kernels();
+    case TRICK_10_UNSIGNED_INTEGER:
+        return TrickKernel<quint32,isSwap>::kernels();
+    case TRICK_10_LONG:
+        return _kernelsSized<isSwap>(size,true);
+    case TRICK_10_UNSIGNED_LONG:
+        return _kernelsSized<isSwap>(size,false);
+    case TRICK_10_BOOLEAN:
+        return _kernelsSized<isSwap>(size,false);
+    default:
+        return _kernelsUnsupported();
+    }
+}
+
+static TrickKernels _kernels(TrickModel::TrickVersion version,
+                             int paramtype, int size, bool isSwap)
+{
+    if ( version == TrickModel::TrickVersion07 ) {
+        return isSwap ? _kernels07<true>(paramtype,size)
+                      : _kernels07<false>(paramtype,size);
+    } else {
+        return isSwap ? _kernels10<true>(paramtype,size)
+                      : _kernels10<false>(paramtype,size);
+    }
+}
 
 TrickModel::TrickModel(const QStringList& timeNames,
                        const QString& trkfile, QObject *parent) :
     DataModel(timeNames, trkfile, parent),
     _timeNames(timeNames),_trkfile(trkfile),
+    _isSwap(false),
     _nrows(0), _row_size(0), _ncols(0), _timeCol(0),_pos_beg_data(0),
     _mem(0), _data(0), _fd(-1), _file(_trkfile),_iteratorTimeIndex(0)
 {
@@ -20,9 +221,16 @@ TrickModel::TrickModel(const QStringList& timeNames,
 
 bool TrickModel::_load_trick_header()
 {
+    KOVIZ_TRACE("trk header parse");
+
     bool ret = true;
 
-    if (!_file.open(QIODevice::ReadOnly)) {
+    bool isOpen;
+    {
+        KOVIZ_TRACE("file open");
+        isOpen = _file.open(QIODevice::ReadOnly);
+    }
+    if ( !isOpen ) {
         _err_stream << "koviz [error]: could not open "
                     << _trkfile << "\n";
         throw std::runtime_error(_err_string.toLatin1().constData());
@@ -49,8 +257,10 @@ bool TrickModel::_load_trick_header()
     in.readRawData(data,1) ; // L or B (endian)
     if ( data[0] == 'L' ) {
         in.setByteOrder(QDataStream::LittleEndian);
+        _isSwap = ( Q_BYTE_ORDER == Q_BIG_ENDIAN );
     } else {
         in.setByteOrder(QDataStream::BigEndian);
+        _isSwap = ( Q_BYTE_ORDER == Q_LITTLE_ENDIAN );
     }
 
     //
@@ -67,6 +277,10 @@ bool TrickModel::_load_trick_header()
         _row_size += _load_binary_param(in,cc);
         TrickParameter* p = _col2param.value(cc);
         _paramtypes.push_back(p->type());
+        _readFuncs.append(readFunc(_trick_version,p->type(),p->size(),
+                                   _isSwap));
+        _readColumnFuncs.append(readColumnFunc(_trick_version,p->type(),
+                                               p->size(),_isSwap));
     }
     if ( _row_size == 0 ) {
         _err_stream << "koviz [error]: trk file \""
@@ -76,7 +290,7 @@ bool TrickModel::_load_trick_header()
 
     // Sanity check. Bytes remaining should be a multiple of the record size
     qint64 nbytes = _file.bytesAvailable();
-    if ( nbytes % _row_size != 0 ) {
+    if ( nbytes % _row_size != 0 && !isLiveTail ) {
         _err_stream << "koviz [error]: trk file \""
                     << _file.fileName() << "\" is corrupt!\n";
         throw std::runtime_error(_err_string.toLatin1().constData());
@@ -148,11 +362,31 @@ qint32 TrickModel::_load_binary_param(QDataStream& in, int col)
     return sz;
 }
 
+TrickReadFunc TrickModel::readFunc(TrickVersion version,
+                                   int paramtype, int size, bool isSwap)
+{
+    return _kernels(version,paramtype,size,isSwap).read;
+}
+
+TrickReadColumnFunc TrickModel::readColumnFunc(TrickVersion version,
+                                               int paramtype, int size,
+                                               bool isSwap)
+{
+    return _kernels(version,paramtype,size,isSwap).readColumn;
+}
+
 void TrickModel::map()
 {
     if ( _data ) return; // already mapped
 
-    if (!_file.open(QIODevice::ReadOnly)) {
+    KOVIZ_TRACE("trk mmap");
+
+    bool isOpen;
+    {
+        KOVIZ_TRACE("file open");
+        isOpen = _file.open(QIODevice::ReadOnly);
+    }
+    if ( !isOpen ) {
         _err_stream << "koviz [error]: could not open "
                     << _file.fileName() << "\n";
         throw std::runtime_error(_err_string.toLatin1().constData());
@@ -188,11 +422,39 @@ void TrickModel::unmap()
     }
 }
 
+int TrickModel::refresh()
+{
+    QFileInfo fi(_trkfile);
+    qint64 nrows = (fi.size()-_pos_beg_data)/_row_size;
+    if ( nrows <= _nrows ) {
+        return 0;
+    }
+
+    // Remap so that the mapping covers the appended records
+    bool isMapped = ( _data != 0 );
+    if ( isMapped ) {
+        unmap();
+    }
+    int nNewRows = (int)(nrows-_nrows);
+    _nrows = nrows;
+    if ( isMapped ) {
+        map();
+    }
+
+    return nNewRows;
+}
+
 ModelIterator *TrickModel::begin(int tcol, int xcol, int ycol) const
 {
     return new TrickModelIterator(0,this,tcol,xcol,ycol);
 }
 
+void TrickModel::readColumn(int col, int beg, int n, double *out) const
+{
+    _readColumnFuncs.at(col)(_data+beg*_row_size+_col2offset.value(col),
+                             _row_size,n,out);
+}
+
 TrickModel::~TrickModel()
 {
     unmap();
@@ -211,19 +473,21 @@ int TrickModel::indexAtTime(double time)
     return _idxAtTimeBinarySearch(_iteratorTimeIndex,0,rowCount()-1,time);
 }
 
+// Defaults to a little endian Trick 07 header
 void TrickModel::writeTrkHeader(QDataStream &out,
-                                const QList<TrickParameter>& params)
+                                const QList<TrickParameter>& params,
+                                TrickVersion version, bool isBigEndian)
 {
-    // Make it little endian
-    out.setByteOrder(QDataStream::LittleEndian);
+    out.setByteOrder(isBigEndian ? QDataStream::BigEndian
+                                 : QDataStream::LittleEndian);
 
     //
     // Trick-version-endian (10 bytes)
     //
     out.writeRawData("Trick-",6) ;
-    out.writeRawData("07",2) ;
+    out.writeRawData(version == TrickVersion10 ? "10" : "07",2) ;
     out.writeRawData("-",1) ;
-    out.writeRawData("L",1) ; // little endian
+    out.writeRawData(isBigEndian ? "B" : "L",1) ;
 
     //
     // Num params recorded (4 bytes - int)
@@ -327,10 +591,6 @@ int TrickModel::columnCount(const QModelIndex &pidx) const
     }
 }
 
-
-// TODO: byteswap like
-//      dp = (double *)(address) ;
-//      value = _swap ? trick_byteswap_double(*dp) : *dp ;
 QVariant TrickModel::data(const QModelIndex &idx, int role) const
 {
     QVariant val;
@@ -342,8 +602,7 @@ QVariant TrickModel::data(const QModelIndex &idx, int role) const
         if ( role == Qt::DisplayRole ) {
             qint64 _pos_data = row*_row_size + _col2offset.value(col);
             ptrdiff_t addr = _data+_pos_data;
-            int paramtype =  _paramtypes.at(col);
-            val = _toDouble(addr,paramtype);
+            val = _readFuncs.at(col)(addr);
         }
     }
 
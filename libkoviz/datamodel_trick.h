@@ -16,6 +16,7 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 #include <vector>
 
 #include "datamodel.h"
@@ -27,6 +28,14 @@ using namespace std;
 class TrickModel;
 class TrickModelIterator;
 
+// Reads a logged value at addr as a double.  There is a function per
+// logged C type and byte order, picked once per column (see _readFuncs)
+typedef double (*TrickReadFunc)(ptrdiff_t addr);
+
+// Reads n logged values stride bytes apart from addr into out
+typedef void (*TrickReadColumnFunc)(ptrdiff_t addr, qint64 stride, qint64 n,
+                                    double* out);
+
 class TrickParameter : public Parameter
 {
 public:
@@ -86,9 +95,40 @@ class TrickModel : public DataModel
         return _param2column.value(param,-1);
     }
     virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
+    virtual void readColumn(int col, int beg, int n, double* out) const;
     int indexAtTime(double time);
-
-    static void writeTrkHeader(QDataStream &out, const QList<TrickParameter> &params);
+    virtual int refresh();
+
+    // If set, a partially written record at end of file is ignored
+    // instead of the file being treated as corrupt (see LiveTail)
+    static bool isLiveTail;
+
+    static void writeTrkHeader(QDataStream &out,
+                               const QList<TrickParameter> &params,
+                               TrickVersion version = TrickVersion07,
+                               bool isBigEndian = false);
+
+    // Kernel that reads a logged value of paramtype/size (e.g. in a
+    // byte-swapped file if isSwap) as a double
+    static TrickReadFunc readFunc(TrickVersion version,
+                                  int paramtype, int size, bool isSwap);
+    static TrickReadColumnFunc readColumnFunc(TrickVersion version,
+                                              int paramtype, int size,
+                                              bool isSwap);
+
+    // Raw records in file byte order (e.g. for archiving, see KvzModel)
+    TrickVersion trickVersion() const { return _trick_version; }
+    bool isBigEndian() const
+    {
+        return _isSwap ? (Q_BYTE_ORDER == Q_LITTLE_ENDIAN)
+                       : (Q_BYTE_ORDER == Q_BIG_ENDIAN);
+    }
+    int timeColumn() const { return _timeCol; }
+    qint64 paramOffset(int col) const { return _col2offset.value(col); }
+    const char* record(qint64 row) const
+    {
+        return (const char*)(_data + row*_row_size);
+    }
 
     virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
     virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
@@ -103,7 +143,10 @@ class TrickModel : public DataModel
     QHash<int,TrickParameter*> _col2param;   // ordered by column
 
     TrickVersion _trick_version;
+    bool _isSwap;       // file byte order is not host byte order
     vector<int> _paramtypes;
+    QVector<TrickReadFunc> _readFuncs;   // per column
+    QVector<TrickReadColumnFunc> _readColumnFuncs;
     QHash<QString,int> _param2column;
 
     qint64 _nrows;
@@ -132,143 +175,6 @@ class TrickModel : public DataModel
     static void _write_binary_param(QDataStream& out, const TrickParameter &p);
     static void _write_binary_qstring(QDataStream& out, const QString& str);
 
-  private:
-
-    inline double _toDouble(ptrdiff_t addr, int paramtype) const
-    {
-        if ( _trick_version == TrickVersion07 ) {
-            switch (paramtype) {
-            case TRICK_07_DOUBLE:
-            {
-                return *((double*)(addr));
-            }
-            case TRICK_07_UNSIGNED_LONG_LONG:
-            {
-                return (double) *((unsigned long long*)(addr));
-            }
-            case TRICK_07_LONG_LONG:
-            {
-                return (double) *((long long*)(addr));
-            }
-            case TRICK_07_FLOAT:
-            {
-                return (double) *((float*)(addr));
-            }
-            case TRICK_07_INTEGER:
-            case TRICK_07_ENUMERATED:
-            case TRICK_07_UNSIGNED_BITFIELD:
-            {
-                return (double) *((int*)(addr));
-            }
-            case TRICK_07_UNSIGNED_CHARACTER:
-            {
-                return (double) *((unsigned char*)(addr));
-            }
-            case TRICK_07_SHORT:
-            {
-                return (double) *((short int*)(addr));
-            }
-            case TRICK_07_UNSIGNED_SHORT:
-            {
-                return (double) *((unsigned short int*)(addr));
-            }
-            case TRICK_07_UNSIGNED_INTEGER:
-            {
-                return (double) *((unsigned int*)(addr));
-            }
-            case TRICK_07_LONG:
-            {
-                return (double) *((long int*)(addr));
-            }
-            case TRICK_07_BOOLEAN:
-            {
-                return (double) *((bool *)(addr));
-            }
-            case TRICK_07_BITFIELD:
-            {
-                return (double) *((int *)(addr));
-            }
-            default:
-            {
-                fprintf(stderr,
-                        "koviz [error]: can't handle trick 07 type \"%d\"\n"
-                        "              Look in trick_types.h for type.\n",
-                        paramtype);
-                exit(-1);
-            }
-            }
-        } else {
-            switch (paramtype) {
-            case TRICK_10_DOUBLE:
-            {
-                return *((double*)(addr));
-            }
-            case TRICK_10_UNSIGNED_LONG_LONG:
-            {
-                return (double) *((unsigned long long*)(addr));
-            }
-            case TRICK_10_LONG_LONG:
-            {
-                return (double) *((long long*)(addr));
-            }
-            case TRICK_10_FLOAT:
-            {
-                return (double) *((float*)(addr));
-            }
-            case TRICK_10_INTEGER:
-            case TRICK_10_ENUMERATED:
-            case TRICK_10_UNSIGNED_BITFIELD:
-            {
-                return (double) *((int*)(addr));
-            }
-            case TRICK_10_UNSIGNED_CHARACTER:
-            {
-                return (double) *((unsigned char*)(addr));
-            }
-            case TRICK_10_SHORT:
-            {
-                return (double) *((short int*)(addr));
-            }
-            case TRICK_10_UNSIGNED_SHORT:
-            {
-                return (double) *((unsigned short int*)(addr));
-            }
-            case TRICK_10_UNSIGNED_INTEGER:
-            {
-                return (double) *((unsigned int*)(addr));
-            }
-            case TRICK_10_LONG:
-            {
-                return (double) *((long int*)(addr));
-            }
-            case TRICK_10_BOOLEAN:
-            {
-                return (double) *((bool *)(addr));
-            }
-            case TRICK_10_BITFIELD:
-            {
-                return (double) *((int *)(addr));
-            }
-            case TRICK_10_CHARACTER:
-            {
-                return (double) *((char *)(addr));
-            }
-            case TRICK_10_UNSIGNED_LONG:
-            {
-                return (double) *((unsigned long*)(addr));
-            }
-            default:
-            {
-                fprintf(stderr,
-                        "koviz [error]: can't handle trick 10 type \"%d\"\n"
-                        "              Look in trick_types.h for type\n.",
-                        paramtype);
-                exit(-1);
-            }
-            }
-        }
-    }
-
 signals:
     
 public slots:
@@ -295,9 +201,9 @@ class TrickModelIterator : public ModelIterator
         _tco(_model->_col2offset.value(tcol)),
         _xco(_model->_col2offset.value(xcol)),
         _yco(_model->_col2offset.value(ycol)),
-        _ttype(_model->_paramtypes.at(tcol)),
-        _xtype(_model->_paramtypes.at(xcol)),
-        _ytype(_model->_paramtypes.at(ycol))
+        _tread(_model->_readFuncs.at(tcol)),
+        _xread(_model->_readFuncs.at(xcol)),
+        _yread(_model->_readFuncs.at(ycol))
     {
     }
 
@@ -327,17 +233,17 @@ class TrickModelIterator : public ModelIterator
 
     inline double t() const
     {
-        return _model->_toDouble(_data+i*_row_size+_tco,_ttype);
+        return _tread(_data+i*_row_size+_tco);
     }
 
     inline double x() const
     {
-        return _model->_toDouble(_data+i*_row_size+_xco,_xtype);
+        return _xread(_data+i*_row_size+_xco);
     }
 
     inline double y() const
     {
-        return _model->_toDouble(_data+i*_row_size+_yco,_ytype);
+        return _yread(_data+i*_row_size+_yco);
     }
 
   private:
@@ -353,9 +259,9 @@ class TrickModelIterator : public ModelIterator
     qint64 _tco ;
     qint64 _xco ;
     qint64 _yco ;
-    int _ttype ;
-    int _xtype ;
-    int _ytype ;
+    TrickReadFunc _tread ;
+    TrickReadFunc _xread ;
+    TrickReadFunc _yread ;
 };
 
 
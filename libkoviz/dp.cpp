@@ -1,7 +1,13 @@
 #include "dp.h"
 #include "options.h"
 
+#include <QMutex>
+#include <QMutexLocker>
+
 DPProduct* product;// hack to pass to yacc parser
+static QMutex _productMutex; // guards product and the yacc parser (DPIndex)
+static QMutex _errMutex;     // guards the _err_streams (DPIndex)
+extern QString dpParseError; // set by yyerror()
 
 QString DPProduct::_err_string;
 QTextStream DPProduct::_err_stream(&DPProduct::_err_string);
@@ -18,6 +24,7 @@ DPProduct::DPProduct(const QString &fileName) :
     } else {
         QFile file(fileName);
         if (!file.open(QIODevice::ReadOnly)) {
+            QMutexLocker locker(&_errMutex);
             _err_stream << "koviz [error]: could not open "
                         << file.fileName();
             throw std::runtime_error(_err_string.toLatin1().constData());
@@ -39,7 +46,12 @@ DPProduct::DPProduct(const QString &fileName) :
 DPProduct::~DPProduct()
 {
     if ( _doc ) delete _doc;
-    product = 0 ;
+    {
+        QMutexLocker locker(&_productMutex);
+        if ( product == this ) {
+            product = 0 ;
+        }
+    }
     foreach ( DPPage* page, _pages ) {
         if ( page ) {
             delete page;
@@ -77,18 +89,23 @@ void DPProduct::_handleDP05File(QString &contents)
         }
     }
     if ( i == INT_MAX ) {
-        fprintf(stderr,"koviz [error]: no PLOTS: or TABLES: "
-                       "or PROGRAM: keywords in %s\n",
-                _fileName.toLatin1().constData());
-        exit(-1);
+        QMutexLocker locker(&_errMutex);
+        _err_stream << "koviz [error]: no PLOTS: or TABLES: "
+                    << "or PROGRAM: keywords in " << _fileName << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
     }
     contents = contents.remove(0,i-1);
 
+    QMutexLocker locker(&_productMutex);
     product = this; // TODO: product is global, need to fix the hack
 
     YY_BUFFER_STATE state = yy_scan_string(contents.toLatin1().constData());
-    yyparse();
+    dpParseError.clear();
+    int ret = yyparse();
     yy_delete_buffer(state);
+    if ( ret != 0 ) {
+        throw std::runtime_error(dpParseError.toLatin1().constData());
+    }
 }
 
 void DPProduct::_handleDPXMLFile(const QString &xmlfile)
@@ -96,12 +113,14 @@ void DPProduct::_handleDPXMLFile(const QString &xmlfile)
     _doc = new QDomDocument(xmlfile);
     QFile file(xmlfile);
     if (!file.open(QIODevice::ReadOnly)) {
+        QMutexLocker locker(&_errMutex);
         _err_stream << "koviz [error]: could not open "
                     << xmlfile << "\n";
         throw std::runtime_error(_err_string.toLatin1().constData());
     }
     if (!_doc->setContent(&file)) {
         file.close();
+        QMutexLocker locker(&_errMutex);
         _err_stream << "koviz [error]: could not parse "
                     << xmlfile << "\n";
         throw std::runtime_error(_err_string.toLatin1().constData());
@@ -740,6 +759,7 @@ DPCurve::DPCurve(const QDomElement &e) : _x(0), _y(0)
                     setLineStyle(var->lineStyle().toLatin1().constData());
                 }
                 if ( count > 1 ) {
+                    QMutexLocker locker(&_errMutex);
                     _err_stream << "koviz [error]: DPPlot can't handle "
                                 << "multiple y vars found in "
                                 << e.ownerDocument().toString() << "\n";
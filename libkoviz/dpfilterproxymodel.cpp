@@ -4,12 +4,24 @@
 QHash<QString,bool> DPFilterProxyModel::_acceptedDPFileCache;
 
 DPFilterProxyModel::DPFilterProxyModel(const QStringList& params,
+                                       DPIndex *dpIndex,
                                        QObject *parent) :
-    QSortFilterProxyModel(parent)
+    QSortFilterProxyModel(parent),
+    _dpIndex(dpIndex)
 {
     foreach (QString param, params) {
         _modelParams.insert(param,0);
     }
+
+    if ( _dpIndex ) {
+        connect(_dpIndex,SIGNAL(updated()),this,SLOT(_dpIndexUpdated()));
+    }
+}
+
+// Pending DPs are not in the accept cache, so refiltering picks them up
+void DPFilterProxyModel::_dpIndexUpdated()
+{
+    invalidateFilter();
 }
 
 bool DPFilterProxyModel::filterAcceptsRow(int row,
@@ -84,8 +96,25 @@ bool DPFilterProxyModel::_isAccept(const QModelIndex &idx,
 
         // Filter for DPs that have params in paramList constructor argument
         if ( isAccept ) {
-            foreach ( QString param,DPProduct::paramList(dpFilePath) ) {
-                if ( !_modelParams.contains(param) ) {
+            QStringList dpParams;
+            if ( _dpIndex ) {
+                DPIndex::Status status = _dpIndex->status(dpFilePath,
+                                                          &dpParams);
+                if ( status == DPIndex::Pending ) {
+                    return false;  // Not cached, accepted once indexed
+                } else if ( status == DPIndex::Bad ) {
+                    isAccept = false;
+                }
+            } else {
+                dpParams = DPProduct::paramList(dpFilePath);
+            }
+            foreach ( QString param, dpParams ) {
+                if ( Expression::isExpression(param) ) {
+                    if ( !_isAcceptExpression(param) ) {
+                        isAccept = false;
+                        break;
+                    }
+                } else if ( !_modelParams.contains(param) ) {
                     isAccept = false;
                     break;
                 }
@@ -97,3 +126,21 @@ bool DPFilterProxyModel::_isAccept(const QModelIndex &idx,
 
     return isAccept;
 }
+
+// Inline expression var e.g. <var>@hypot(ball.x,ball.y){m}</var>
+bool DPFilterProxyModel::_isAcceptExpression(const QString &param) const
+{
+    try {
+        QString unit;
+        Expression expr(Expression::splitUnit(param,&unit));
+        foreach ( QString var, expr.variables() ) {
+            if ( !_modelParams.contains(var) ) {
+                return false;
+            }
+        }
+    } catch (std::exception &e) {
+        fprintf(stderr,"%s\n",e.what());
+        return false;
+    }
+    return true;
+}
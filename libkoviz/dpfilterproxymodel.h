@@ -8,12 +8,17 @@
 #include <QHash>
 
 #include "dp.h"
+#include "dpindex.h"
+#include "expression.h"
 
 class DPFilterProxyModel : public QSortFilterProxyModel
 {
     Q_OBJECT
 public:
+    // If dpIndex is given, DP params come from the index and DPs not yet
+    // indexed are hidden until the index is updated
     explicit DPFilterProxyModel( const QStringList& params,
+                                 DPIndex* dpIndex = 0,
                                  QObject *parent = 0);
 
 protected:
@@ -23,13 +28,18 @@ signals:
     
 public slots:
 
+private slots:
+    void _dpIndexUpdated();
+
 private:
     QHash<QString,int> _modelParams;
+    DPIndex* _dpIndex;
     static QHash<QString,bool> _acceptedDPFileCache; // static to get around const
 
     bool _isAccept(const QModelIndex& idx,
                    QFileSystemModel* m,
                    const QRegExp& rx) const;
+    bool _isAcceptExpression(const QString& param) const;
 
 
     
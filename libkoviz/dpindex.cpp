@@ -0,0 +1,174 @@
+#include "dpindex.h"
+
+#include <QtConcurrentMap>
+
+DPIndex::DPIndex(const QString &fileName, QObject *parent) :
+    QObject(parent),
+    _fileName(fileName),
+    _isDirty(false)
+{
+    _load();
+
+    connect(&_watcher,SIGNAL(resultReadyAt(int)),
+            this,SLOT(_resultReadyAt(int)));
+    connect(&_watcher,SIGNAL(finished()),
+            this,SLOT(_finished()));
+
+    // Batch updates so the tree is not refiltered per file
+    _updateTimer.setSingleShot(true);
+    _updateTimer.setInterval(250);
+    connect(&_updateTimer,SIGNAL(timeout()),this,SIGNAL(updated()));
+}
+
+DPIndex::~DPIndex()
+{
+    _queue.clear();
+    _watcher.cancel();
+    _watcher.waitForFinished();
+    save();
+}
+
+QString DPIndex::defaultFileName(const QString &dpDir)
+{
+    if ( dpDir.isEmpty() ) {
+        return QString();
+    }
+    return QDir(dpDir).absolutePath() + "/.koviz_dpindex";
+}
+
+DPIndex::Status DPIndex::status(const QString &dpFile, QStringList *params)
+{
+    QFileInfo fi(dpFile);
+    QString path = fi.absoluteFilePath();
+
+    if ( _entries.contains(path) ) {
+        const DPIndexEntry& entry = _entries[path];
+        if ( entry.size == fi.size() &&
+             entry.mtime == fi.lastModified().toMSecsSinceEpoch() ) {
+            if ( entry.isError ) {
+                return Bad;
+            }
+            if ( params ) {
+                *params = entry.params;
+            }
+            return Indexed;
+        }
+    }
+
+    if ( !_queued.contains(path) ) {
+        _queued.insert(path);
+        _queue.append(path);
+        if ( !_watcher.isRunning() && _queue.size() == 1 ) {
+            // Start after the caller's filter pass has queued its files
+            QTimer::singleShot(0,this,SLOT(_start()));
+        }
+    }
+
+    return Pending;
+}
+
+void DPIndex::_start()
+{
+    if ( _watcher.isRunning() || _queue.isEmpty() ) {
+        return;
+    }
+    _batch = _queue;
+    _queue.clear();
+    _watcher.setFuture(QtConcurrent::mapped(_batch,&DPIndex::_parse));
+}
+
+void DPIndex::_resultReadyAt(int i)
+{
+    DPIndexEntry entry = _watcher.resultAt(i);
+    _entries.insert(entry.path,entry);
+    _queued.remove(entry.path);
+    if ( !entry.isError ) {
+        _isDirty = true;
+    }
+    if ( !_updateTimer.isActive() ) {
+        _updateTimer.start();
+    }
+}
+
+void DPIndex::_finished()
+{
+    _batch.clear();
+    save();
+    if ( !_queue.isEmpty() ) {
+        _start();
+    } else {
+        _updateTimer.stop();
+        emit updated();
+    }
+}
+
+// Runs in a worker thread
+DPIndexEntry DPIndex::_parse(const QString &dpFile)
+{
+    DPIndexEntry entry;
+    QFileInfo fi(dpFile);
+    entry.path = dpFile;
+    entry.size = fi.size();
+    entry.mtime = fi.lastModified().toMSecsSinceEpoch();
+    try {
+        entry.params = DPProduct::paramList(dpFile);
+    } catch (std::exception &e) {
+        fprintf(stderr,"%s\n",e.what());
+        entry.isError = true;
+    }
+    return entry;
+}
+
+void DPIndex::_load()
+{
+    QFile file(_fileName);
+    if ( _fileName.isEmpty() ||
+         !file.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+        return;
+    }
+    QTextStream in(&file);
+    if ( in.readLine() != "koviz-dpindex 1" ) {
+        return;  // Unknown version, will be overwritten
+    }
+    while ( !in.atEnd() ) {
+        QStringList fields = in.readLine().split('\t');
+        if ( fields.size() < 3 ) {
+            continue;
+        }
+        DPIndexEntry entry;
+        entry.path = fields.takeFirst();
+        entry.size = fields.takeFirst().toLongLong();
+        entry.mtime = fields.takeFirst().toLongLong();
+        entry.params = fields;
+        _entries.insert(entry.path,entry);
+    }
+}
+
+bool DPIndex::save()
+{
+    if ( !_isDirty || _fileName.isEmpty() ) {
+        return true;
+    }
+    QFile file(_fileName);
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                    QIODevice::Text) ) {
+        fprintf(stderr,"koviz [warning]: could not write DP index %s\n",
+                _fileName.toLatin1().constData());
+        _isDirty = false;  // Do not warn again
+        return false;
+    }
+    QTextStream out(&file);
+    out << "koviz-dpindex 1\n";
+    foreach ( DPIndexEntry entry, _entries ) {
+        if ( entry.isError ) {
+            continue;  // Retried next session
+        }
+        out << entry.path << "\t" << entry.size << "\t" << entry.mtime;
+        foreach ( QString param, entry.params ) {
+            out << "\t" << param;
+        }
+        out << "\n";
+    }
+    _isDirty = false;
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef DPINDEX_H
+#define DPINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QTextStream>
+#include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <stdexcept>
+
+#include "dp.h"
+
+// Params of a DP file as of the file's size and modification time
+class DPIndexEntry
+{
+  public:
+    DPIndexEntry() : size(-1), mtime(-1), isError(false) {}
+
+    QString path;
+    qint64 size;
+    qint64 mtime;
+    QStringList params;
+    bool isError;     // DP could not be parsed
+};
+
+//
+// Index of DP file params for the DP tree filter
+//
+// Parsing a DP file is slow and a SIM may have many of them, so DP files
+// are parsed in parallel in the background.  A file is queued the first
+// time its status is asked for and updated() is emitted as files get
+// indexed, so the DP tree fills in progressively.  The index is persisted
+// to a cache file, entries are reused as long as the DP file has the same
+// size and modification time.
+//
+class DPIndex : public QObject
+{
+    Q_OBJECT
+  public:
+    enum Status { Pending, Indexed, Bad };
+
+    explicit DPIndex(const QString& fileName, QObject *parent = 0);
+    ~DPIndex();
+
+    // Cache file kept in the DP dir e.g. SIM_dir/.koviz_dpindex
+    static QString defaultFileName(const QString& dpDir);
+
+    // If Indexed, params are set.  If Pending, dpFile is queued.
+    Status status(const QString& dpFile, QStringList* params);
+
+    bool save();
+
+  signals:
+    void updated();
+
+  private:
+    QString _fileName;
+    QHash<QString,DPIndexEntry> _entries;   // key is absolute path
+    bool _isDirty;
+    QStringList _queue;
+    QSet<QString> _queued;
+    QStringList _batch;
+    QFutureWatcher<DPIndexEntry> _watcher;
+    QTimer _updateTimer;
+
+    void _load();
+    static DPIndexEntry _parse(const QString& dpFile);
+
+  private slots:
+    void _start();
+    void _resultReadyAt(int i);
+    void _finished();
+};
+
+#endif // DPINDEX_H
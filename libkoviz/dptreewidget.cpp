@@ -1,5 +1,7 @@
 #include "dptreewidget.h"
 
+#include <QDateTime>
+
 #ifdef __linux
 #include "timeit_linux.h"
 #endif
@@ -38,7 +40,7 @@ void DPTreeView::selectionChanged(const QItemSelection &selected,
 DPTreeWidget::DPTreeWidget(const QString& timeName,
                            const QString &dpDirName,
                            const QStringList &dpFiles,
-                           QStandardItemModel *dpVarsModel,
+                           VarsModel *dpVarsModel,
                            const QStringList& runDirs,
                            PlotBookModel *bookModel,
                            QItemSelectionModel *bookSelectModel,
@@ -59,8 +61,13 @@ DPTreeWidget::DPTreeWidget(const QString& timeName,
     _isShowTables(isShowTables),
     _unitOverrides(unitOverrides),
     _gridLayout(0),
-    _searchBox(0)
+    _searchBox(0),
+    _isLoadingPage(false)
 {
+    _bookModel->setPageLoader(this);
+    connect(_bookModel,SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+            this,SLOT(_bookRowsAboutToBeRemoved(QModelIndex,int,int)));
+
     _setupModel();
 
     _gridLayout = new QGridLayout(parent);
@@ -87,6 +94,10 @@ DPTreeWidget::DPTreeWidget(const QString& timeName,
 
 DPTreeWidget::~DPTreeWidget()
 {
+    if ( _bookModel->pageLoader() == this ) {
+        _bookModel->setPageLoader(0);
+    }
+
     if ( _dpModel ) {
         delete _dpModel;
         _dpModel = 0;
@@ -205,7 +216,8 @@ void DPTreeWidget::_setupModel()
         QString param = _dpVarsModel->data(idx).toString();
         dpParams.append(param);
     }
-    _dpFilterModel = new DPFilterProxyModel(dpParams);
+    _dpIndex = new DPIndex(DPIndex::defaultFileName(_dir->path()),this);
+    _dpFilterModel = new DPFilterProxyModel(dpParams,_dpIndex);
 
     _dpFilterModel->setDynamicSortFilter(true);
     _dpFilterModel->setSourceModel(_dpModel);
@@ -296,22 +308,22 @@ void DPTreeWidget::_createDPPages(const QString& dpfile)
     QCursor currCursor = this->cursor();
     this->setCursor(QCursor(Qt::WaitCursor));
 
-    DPProduct dp(dpfile);
+    // Pages keep the DP until their curves are loaded
+    QSharedPointer<DPProduct> dp(new DPProduct(dpfile));
     int rc = _runDirs.count();
 
-    // Program
-    DPProgram* dpprogram = dp.program();
-
     // Pages
     QModelIndex pagesIdx = _bookModel->getIndex(QModelIndex(), "Pages");
     QStandardItem *pagesItem = _bookModel->itemFromIndex(pagesIdx);
 
-    // Page0 plots
+    // Page0 plots (time ranges are synced to page0 when curves are loaded)
+    QString page0Name;
     QModelIndex page0Idx = _bookModel->index(0,0,pagesIdx);
-    QModelIndexList siblingPlotIdxs = _bookModel->plotIdxs(page0Idx);
-
+    if ( page0Idx.isValid() ) {
+        page0Name = _bookModel->getDataString(page0Idx,"PageName","Page");
+    }
 
-    foreach (DPPage* page, dp.pages() ) {
+    foreach (DPPage* page, dp->pages() ) {
 
         // Page
         QStandardItem *pageItem = _addChild(pagesItem,"Page");
@@ -363,7 +375,7 @@ void DPTreeWidget::_createDPPages(const QString& dpfile)
             if ( rc == 2 && plot->curves().size() == 1 ) {
                 QString presentation = _bookModel->getDataString(QModelIndex(),
                                                                "Presentation");
-                if ( !presentation.isEmpty() ) {
+                if ( !presentation.isEmpty() && presentation != "envelope" ) {
                     // Commandline argument -pres given
                     _addChild(plotItem, "PlotPresentation", presentation);
                 } else {
@@ -386,6 +398,10 @@ void DPTreeWidget::_createDPPages(const QString& dpfile)
                         _addChild(plotItem, "PlotPresentation","compare");
                     }
                 }
+            } else if ( rc > 2 && plot->curves().size() == 1 &&
+                        _bookModel->getDataString(QModelIndex(),
+                                           "Presentation") == "envelope" ) {
+                _addChild(plotItem, "PlotPresentation", "envelope");
             } else {
                 _addChild(plotItem, "PlotPresentation", "compare");
             }
@@ -421,148 +437,284 @@ void DPTreeWidget::_createDPPages(const QString& dpfile)
             _addChild(plotItem, "PlotMinorYTics", listMinorYTics);
             _addChild(plotItem, "PlotRect", plot->rect());
 
-            // Curves
-            QStandardItem *curvesItem = _addChild(plotItem,"Curves");
-            QList<QColor> colors;
-            int nCurves = plot->curves().size();
-            colors = _bookModel->createCurveColors(rc*nCurves);
+            // Curves are added when page is loaded
+            _addChild(plotItem,"Curves");
+        }
+
+        DPLazyPage lazyPage;
+        lazyPage.dp = dp;
+        lazyPage.page = page;
+        lazyPage.page0Name = page0Name;
+        _lazyPages.insert(pageName,lazyPage);
+    }
 
-            QStringList styles = _bookModel->lineStyles();
+    this->setCursor(currCursor);
+}
 
-            // Turn off model signals when adding children for speedup
-            bool block = _bookModel->blockSignals(true);
+bool DPTreeWidget::isPageLoaded(const QModelIndex &pageIdx) const
+{
+    QString pageName = _bookModel->getDataString(pageIdx,"PageName","Page");
+    return !_lazyPages.contains(pageName);
+}
 
-            int i = 0;
-            foreach (DPCurve* dpcurve, plot->curves() ) {
+void DPTreeWidget::loadPage(const QModelIndex &pageIdx)
+{
+    _loadPage(pageIdx,true);
+}
 
-                // Setup progress bar dialog for time intensive loads
-                QProgressDialog progress("Loading curves...", "Abort",
-                                         0, rc, this);
-                progress.setWindowModality(Qt::WindowModal);
-                progress.setMinimumDuration(500);
+QModelIndex DPTreeWidget::_pageIdx(const QString &pageName) const
+{
+    foreach ( QModelIndex pageIdx, _bookModel->pageIdxs() ) {
+        if ( _bookModel->getDataString(pageIdx,"PageName","Page")==pageName ) {
+            return pageIdx;
+        }
+    }
+    return QModelIndex();
+}
 
-#ifdef __linux
-                TimeItLinux timer;
-                timer.start();
-#endif
+void DPTreeWidget::_loadPage(const QModelIndex &pageIdx,
+                             bool isPrefetchNeighbors)
+{
+    QString pageName = _bookModel->getDataString(pageIdx,"PageName","Page");
+    if ( !_lazyPages.contains(pageName) ) {
+        return;
+    }
+    if ( _isLoadingPage ) {
+        // E.g. prefetch timer fired while progress dialog is up, retry later
+        _prefetchPages.removeAll(pageName);
+        _prefetchPages.prepend(pageName);
+        QTimer::singleShot(100,this,SLOT(_prefetch()));
+        return;
+    }
 
-                QString default_style = "plain";
+    QCursor currCursor = this->cursor();
+    this->setCursor(QCursor(Qt::WaitCursor));
 
-                QString ux0;
-                QString uy0;
-                QString r0;
-                for ( int r = 0; r < rc; ++r) {
+    // Page0 is loaded first since its time range is used for this page
+    DPLazyPage lazyPage = _lazyPages.value(pageName);
+    QModelIndexList siblingPlotIdxs;
+    if ( !lazyPage.page0Name.isEmpty() ) {
+        QModelIndex page0Idx = _pageIdx(lazyPage.page0Name);
+        if ( page0Idx.isValid() ) {
+            _loadPage(page0Idx,false);
+            siblingPlotIdxs = _bookModel->plotIdxs(page0Idx);
+        }
+    }
 
-                    QString color = colors.at(i++).name();
+    _isLoadingPage = true;
+    _lazyPages.remove(pageName);
+    QModelIndexList plotIdxs = _bookModel->plotIdxs(pageIdx);
+    int i = 0;
+    foreach ( DPPlot* plot, lazyPage.page->plots() ) {
+        if ( i >= plotIdxs.size() ) {
+            break;
+        }
+        _createDPCurves(plotIdxs.at(i++),plot,lazyPage.dp->program(),
+                        siblingPlotIdxs);
+    }
+    _isLoadingPage = false;
 
-                    CurveModel* curveModel = _addCurve(curvesItem,dpcurve,
-                                                       dpprogram,r,
-                                                       color,default_style);
+    this->setCursor(currCursor);
 
-                    if ( r == 0 ) {
-                        ux0 = curveModel->x()->unit();
-                        uy0 = curveModel->y()->unit();
-                        r0 = QFileInfo(curveModel->fileName()).dir().dirName();
-                    } else {
-                        QString ux1 = curveModel->x()->unit();
-                        QString uy1 = curveModel->y()->unit();
-                        QString r1 = QFileInfo(curveModel->fileName()).
-                                     dir().dirName();
-                        if ( !Unit::canConvert(ux0,ux1) ) {
-                            fprintf(stderr,
-                                 "koviz [error]: Unit mismatch for param=%s "
-                                 "between the following RUNs:\n"
-                                 "        %s {%s}\n"
-                                 "        %s {%s}\n",
-                                 curveModel->x()->name().toLatin1().constData(),
-                                 r0.toLatin1().constData(),
-                                 ux0.toLatin1().constData(),
-                                 r1.toLatin1().constData(),
-                                 ux1.toLatin1().constData());
-                            exit(-1);
-                        }
-                        if ( !Unit::canConvert(uy0,uy1) ) {
-                            fprintf(stderr,
-                                 "koviz [error]: Unit mismatch for param=%s "
-                                 "between the following RUNs:\n"
-                                 "        %s {%s}\n"
-                                 "        %s {%s}\n",
-                                 curveModel->y()->name().toLatin1().constData(),
-                                 r0.toLatin1().constData(),
-                                 uy0.toLatin1().constData(),
-                                 r1.toLatin1().constData(),
-                                 uy1.toLatin1().constData());
-                            exit(-1);
-                        }
-                    }
+    if ( isPrefetchNeighbors ) {
+        // Queue neighboring pages so that paging through a DP is quick
+        QModelIndexList pageIdxs = _bookModel->pageIdxs();
+        int row = pageIdxs.indexOf(pageIdx);
+        QList<int> rows;
+        rows << row+1 << row-1;
+        foreach ( int r, rows ) {
+            if ( r < 0 || r >= pageIdxs.size() ) {
+                continue;
+            }
+            QString name = _bookModel->getDataString(pageIdxs.at(r),
+                                                     "PageName","Page");
+            if ( _lazyPages.contains(name) && !_prefetchPages.contains(name) ) {
+                _prefetchPages.append(name);
+            }
+        }
+        if ( !_prefetchPages.isEmpty() ) {
+            QTimer::singleShot(0,this,SLOT(_prefetch()));
+        }
+    }
+}
+
+// Loads one queued page per pass through the event loop, so that the GUI
+// stays responsive between pages
+void DPTreeWidget::_prefetch()
+{
+    while ( !_prefetchPages.isEmpty() ) {
+        QString pageName = _prefetchPages.takeFirst();
+        QModelIndex pageIdx = _pageIdx(pageName);
+        if ( pageIdx.isValid() && _lazyPages.contains(pageName) ) {
+            _loadPage(pageIdx,false);
+            break;
+        }
+    }
+    if ( !_prefetchPages.isEmpty() ) {
+        QTimer::singleShot(0,this,SLOT(_prefetch()));
+    }
+}
+
+// Closed pages are forgotten so they are not loaded or prefetched
+void DPTreeWidget::_bookRowsAboutToBeRemoved(const QModelIndex &pidx,
+                                             int start, int end)
+{
+    if ( _lazyPages.isEmpty() || !_bookModel->isIndex(pidx,"Pages") ) {
+        return;
+    }
+    for ( int row = start; row <= end; ++row ) {
+        QModelIndex pageIdx = _bookModel->index(row,0,pidx);
+        QString pageName = _bookModel->getDataString(pageIdx,
+                                                     "PageName","Page");
+        _lazyPages.remove(pageName);
+        _prefetchPages.removeAll(pageName);
+    }
+}
+
+void DPTreeWidget::_createDPCurves(const QModelIndex &plotIdx, DPPlot *plot,
+                                   DPProgram *dpprogram,
+                                   const QModelIndexList &siblingPlotIdxs)
+{
+    int rc = _runDirs.count();
+
+    // Curves
+    QModelIndex curvesIdx = _bookModel->getIndex(plotIdx,"Curves","Plot");
+    QStandardItem *curvesItem = _bookModel->itemFromIndex(curvesIdx);
+    QList<QColor> colors;
+    int nCurves = plot->curves().size();
+    colors = _bookModel->createCurveColors(rc*nCurves);
+
+    QStringList styles = _bookModel->lineStyles();
 
+    // Turn off model signals when adding children for speedup
+    bool block = _bookModel->blockSignals(true);
+
+    int i = 0;
+    foreach (DPCurve* dpcurve, plot->curves() ) {
+
+        // Setup progress bar dialog for time intensive loads
+        QProgressDialog progress("Loading curves...", "Abort",
+                                 0, rc, this);
+        progress.setWindowModality(Qt::WindowModal);
+        progress.setMinimumDuration(500);
 
 #ifdef __linux
-                    int secs = qRound(timer.stop()/1000000.0);
-                    div_t d = div(secs,60);
-                    QString msg = QString("Loaded %1 of %2 curves "
-                                          "(%3 min %4 sec)")
-                                       .arg(r+1).arg(rc).arg(d.quot).arg(d.rem);
-                    progress.setLabelText(msg);
+        TimeItLinux timer;
+        timer.start();
 #endif
-                    progress.setValue(r);
-                    if (progress.wasCanceled()) {
-                        break;
-                    }
-                }
 
-                // Update progress dialog
-                progress.setValue(rc);
-            }
+        QString default_style = "plain";
 
-            // Turn signals back on before adding curveModel
-            _bookModel->blockSignals(block);
-
-            // Initialize plot math rect
-            QModelIndex curvesIdx = curvesItem->index();
-            QRectF bbox = _bookModel->calcCurvesBBox(curvesIdx);
-            QModelIndex plotMathRectIdx = _bookModel->getDataIndex(plotIdx,
-                                                                 "PlotMathRect",
-                                                                 "Plot");
-            if ( _bookModel->isXTime(plotIdx) ) {
-                foreach ( QModelIndex siblingPlotIdx, siblingPlotIdxs ) {
-                    bool isXTime = _bookModel->isXTime(siblingPlotIdx);
-                    if ( isXTime ) {
-                        QRectF sibPlotRect = _bookModel->getPlotMathRect(
-                                                                siblingPlotIdx);
-                        bbox.setLeft(sibPlotRect.left());
-                        bbox.setRight(sibPlotRect.right());
-                        break;
-                    }
+        QString ux0;
+        QString uy0;
+        QString r0;
+        for ( int r = 0; r < rc; ++r) {
+
+            QString color = colors.at(i++).name();
+
+            CurveModel* curveModel = _addCurve(curvesItem,dpcurve,
+                                               dpprogram,r,
+                                               color,default_style);
+
+            if ( r == 0 ) {
+                ux0 = curveModel->x()->unit();
+                uy0 = curveModel->y()->unit();
+                r0 = QFileInfo(curveModel->fileName()).dir().dirName();
+            } else {
+                QString ux1 = curveModel->x()->unit();
+                QString uy1 = curveModel->y()->unit();
+                QString r1 = QFileInfo(curveModel->fileName()).
+                             dir().dirName();
+                if ( !Unit::canConvert(ux0,ux1) ) {
+                    fprintf(stderr,
+                         "koviz [error]: Unit mismatch for param=%s "
+                         "between the following RUNs:\n"
+                         "        %s {%s}\n"
+                         "        %s {%s}\n",
+                         curveModel->x()->name().toLatin1().constData(),
+                         r0.toLatin1().constData(),
+                         ux0.toLatin1().constData(),
+                         r1.toLatin1().constData(),
+                         ux1.toLatin1().constData());
+                    exit(-1);
+                }
+                if ( !Unit::canConvert(uy0,uy1) ) {
+                    fprintf(stderr,
+                         "koviz [error]: Unit mismatch for param=%s "
+                         "between the following RUNs:\n"
+                         "        %s {%s}\n"
+                         "        %s {%s}\n",
+                         curveModel->y()->name().toLatin1().constData(),
+                         r0.toLatin1().constData(),
+                         uy0.toLatin1().constData(),
+                         r1.toLatin1().constData(),
+                         uy1.toLatin1().constData());
+                    exit(-1);
                 }
             }
-            if ( bbox.width() > 0.0 ) {
-                _bookModel->setData(plotMathRectIdx,bbox);
-            }
 
-            // Reset monte carlo input view current idx to signal curr changed
-            int currRunId = -1;
-            if ( _monteInputsView ) {
-                currRunId = _monteInputsView->currentRun();
+
+#ifdef __linux
+            int secs = qRound(timer.stop()/1000000.0);
+            div_t d = div(secs,60);
+            QString msg = QString("Loaded %1 of %2 curves "
+                                  "(%3 min %4 sec)")
+                               .arg(r+1).arg(rc).arg(d.quot).arg(d.rem);
+            progress.setLabelText(msg);
+#endif
+            progress.setValue(r);
+            if (progress.wasCanceled()) {
+                break;
             }
-            if ( currRunId >= 0 ) {
-                foreach (QModelIndex curveIdx,_bookModel->curveIdxs(curvesIdx)){
-                    int curveRunId = _bookModel->getDataInt(curveIdx,
-                                                          "CurveRunID","Curve");
-                    if ( curveRunId == currRunId ) {
-                        // Reset monte input view's current index which will set
-                        // plot view's current index (by way of signal/slots)
-                        QModelIndex currIdx = _monteInputsView->currentIndex();
-                        _monteInputsView->setCurrentIndex(QModelIndex());
-                        _monteInputsView->setCurrentIndex(currIdx);
-                        break;
-                    }
-                }
+        }
+
+        // Update progress dialog
+        progress.setValue(rc);
+    }
+
+    // Turn signals back on before adding curveModel
+    _bookModel->blockSignals(block);
+
+    // Initialize plot math rect
+    QRectF bbox = _bookModel->calcCurvesBBox(curvesIdx);
+    QModelIndex plotMathRectIdx = _bookModel->getDataIndex(plotIdx,
+                                                         "PlotMathRect",
+                                                         "Plot");
+    if ( _bookModel->isXTime(plotIdx) ) {
+        foreach ( QModelIndex siblingPlotIdx, siblingPlotIdxs ) {
+            bool isXTime = _bookModel->isXTime(siblingPlotIdx);
+            if ( isXTime ) {
+                QRectF sibPlotRect = _bookModel->getPlotMathRect(
+                                                        siblingPlotIdx);
+                bbox.setLeft(sibPlotRect.left());
+                bbox.setRight(sibPlotRect.right());
+                break;
             }
         }
     }
+    if ( bbox.width() > 0.0 ) {
+        _bookModel->setData(plotMathRectIdx,bbox);
+    }
 
-    this->setCursor(currCursor);
+    // Reset monte carlo input view current idx to signal curr changed
+    int currRunId = -1;
+    if ( _monteInputsView ) {
+        currRunId = _monteInputsView->currentRun();
+    }
+    if ( currRunId >= 0 ) {
+        foreach (QModelIndex curveIdx,_bookModel->curveIdxs(curvesIdx)){
+            int curveRunId = _bookModel->getDataInt(curveIdx,
+                                                  "CurveRunID","Curve");
+            if ( curveRunId == currRunId ) {
+                // Reset monte input view's current index which will set
+                // plot view's current index (by way of signal/slots)
+                QModelIndex currIdx = _monteInputsView->currentIndex();
+                _monteInputsView->setCurrentIndex(QModelIndex());
+                _monteInputsView->setCurrentIndex(currIdx);
+                break;
+            }
+        }
+    }
 }
 
 void DPTreeWidget::_createDPTables(const QString &dpfile)
@@ -737,31 +889,43 @@ CurveModel* DPTreeWidget::_addCurve(QStandardItem *curvesItem,
 
             if ( !outputCurveName.isEmpty() ) {
 
-                QList<CurveModel*> inputCurves;
-                foreach ( Parameter inputParam, dpprogram->inputParams() ) {
-                    CurveModel* inputCurve = _bookModel->createCurve(runId,
-                                                             _timeName,
-                                                             _timeName,
-                                                             inputParam.name());
-                    if ( inputCurve ) {
-                        inputCurves << inputCurve;
-                    } else {
-                        fprintf(stderr, "koviz [error]: DP Program input "
-                                "variable not found:\n"
-                                "    DPProgramInputName=%s\n",
-                                inputParam.name().toLatin1().constData());
-                        exit(-1);
+                // Program outputs are computed once per RUN and shared
+                // by every curve (and page) that plots them
+                QString programKey = _programKey(dpprogram,runId);
+                ProgramModel* programModel =
+                                         _programModels.value(programKey,0);
+                if ( !programModel ) {
+                    QList<CurveModel*> inputCurves;
+                    foreach ( Parameter inputParam,
+                              dpprogram->inputParams() ) {
+                        CurveModel* inputCurve = _bookModel->createCurve(
+                                                           runId,
+                                                           _timeName,
+                                                           _timeName,
+                                                           inputParam.name());
+                        if ( inputCurve ) {
+                            inputCurves << inputCurve;
+                        } else {
+                            fprintf(stderr, "koviz [error]: DP Program input "
+                                    "variable not found:\n"
+                                    "    DPProgramInputName=%s\n",
+                                    inputParam.name().toLatin1().constData());
+                            exit(-1);
+                        }
                     }
-                }
 
-                QStringList timeNames;
-                timeNames << _timeName;
-                ProgramModel* programModel = new ProgramModel(inputCurves,
-                                                       dpprogram->inputParams(),
-                                                       dpprogram->outputs(),
-                                                       timeNames,
-                                                       dpprogram->fileName());
-                _programModels << programModel;
+                    QStringList timeNames;
+                    timeNames << _timeName;
+                    programModel = new ProgramModel(inputCurves,
+                                                    dpprogram->inputParams(),
+                                                    dpprogram->outputs(),
+                                                    timeNames,
+                                                    dpprogram->fileName());
+                    _programModels.insert(programKey,programModel);
+                    foreach ( CurveModel* inputCurve, inputCurves ) {
+                        delete inputCurve;
+                    }
+                }
                 int ycol = programModel->paramColumn(outputCurveName);
                 curveModel = new CurveModel(programModel,0,0,ycol);
             }
@@ -1034,6 +1198,21 @@ CurveModel* DPTreeWidget::_addCurve(QStandardItem *curvesItem,
     return curveModel;
 }
 
+// The program's modification time is in the key so a rebuilt program
+// is rerun when the DP is reopened
+QString DPTreeWidget::_programKey(DPProgram *dpprogram, int runId) const
+{
+    QFileInfo fi(dpprogram->fileName());
+    QString key = QString("%1|%2|%3|%4|%5|%6")
+                         .arg(_runDirs.at(runId))
+                         .arg(fi.absoluteFilePath())
+                         .arg(fi.lastModified().toMSecsSinceEpoch())
+                         .arg(_timeName)
+                         .arg(dpprogram->inputs().join(","))
+                         .arg(dpprogram->outputs().join(","));
+    return key;
+}
+
 bool DPTreeWidget::_isDP(const QString &fp)
 {
     bool ret = false ;
@@ -9,12 +9,16 @@
 #include <QDir>
 #include <QHash>
 #include <QProgressDialog>
+#include <QSharedPointer>
+#include <QTimer>
 #include "dp.h"
 #include "dpfilterproxymodel.h"
+#include "dpindex.h"
 #include "bookmodel.h"
 #include "utils.h"
 #include "monteinputsview.h"
 #include "programmodel.h"
+#include "varsmodel.h"
 
 // This class introduced to fix Qt bug:
 // https://codereview.qt-project.org/#/c/65171/3
@@ -32,15 +36,19 @@ protected:
 };
 
 // Data Products TreeView with Search Box
+//
+// DP pages are created without curves.  A page's curves are loaded when the
+// page is first shown (or printed) and neighboring pages are then loaded a
+// page at a time when the event loop is idle.
 
-class DPTreeWidget : public QWidget
+class DPTreeWidget : public QWidget, public PageLoader
 {
     Q_OBJECT
 public:
     explicit DPTreeWidget(const QString& timeName,
                           const QString& dpDirName,
                           const QStringList& dpFiles,
-                          QStandardItemModel* dpVarsModel,
+                          VarsModel* dpVarsModel,
                           const QStringList& runDirs,
                           PlotBookModel* bookModel,
                           QItemSelectionModel*  bookSelectModel,
@@ -49,6 +57,10 @@ public:
                           const QStringList& unitOverrides,
                           QWidget *parent = 0);
     ~DPTreeWidget();
+
+    // PageLoader
+    virtual bool isPageLoaded(const QModelIndex& pageIdx) const;
+    virtual void loadPage(const QModelIndex& pageIdx);
     
 signals:
     
@@ -59,7 +71,7 @@ private:
     QString _timeName;
     QString _dpDirName;
     QStringList _dpFiles;
-    QStandardItemModel* _dpVarsModel;
+    VarsModel* _dpVarsModel;
     QDir* _dir;
     QStringList _runDirs;
     PlotBookModel* _bookModel;
@@ -71,13 +83,32 @@ private:
     QLineEdit* _searchBox;
     DPTreeView* _dpTreeView ;
     DPFilterProxyModel* _dpFilterModel;
+    DPIndex* _dpIndex;
     QFileSystemModel* _dpModel ;
     QModelIndex _dpModelRootIdx;
-    QList<ProgramModel*> _programModels;
+    QHash<QString,ProgramModel*> _programModels;  // per RUN and program
+
+    // Page whose curves are not loaded yet
+    class DPLazyPage
+    {
+      public:
+        DPLazyPage() : page(0) {}
+        QSharedPointer<DPProduct> dp;
+        DPPage* page;
+        QString page0Name;   // page time ranges are synced to
+    };
+    QHash<QString,DPLazyPage> _lazyPages;  // key is PageName
+    QStringList _prefetchPages;
+    bool _isLoadingPage;
 
     void _setupModel();
     void _createDP(const QString& dpfile);
     void _createDPPages(const QString& dpfile);
+    void _createDPCurves(const QModelIndex& plotIdx, DPPlot* plot,
+                         DPProgram* dpprogram,
+                         const QModelIndexList& siblingPlotIdxs);
+    void _loadPage(const QModelIndex& pageIdx, bool isPrefetchNeighbors);
+    QModelIndex _pageIdx(const QString& pageName) const;
     void _createDPTables(const QString& dpfile);
     QStandardItem* _addChild(QStandardItem* parentItem,
                    const QString& childTitle,
@@ -87,6 +118,7 @@ private:
                           int runId,
                           const QString &defaultColor,
                           const QString &defaultLineStyle);
+    QString _programKey(DPProgram* dpprogram, int runId) const;
     bool _isDP(const QString& fp);
     QString _descrPlotTitle(DPPlot* plot);
 
@@ -97,6 +129,9 @@ public slots:
     void clearSelection();
 
 private slots:
+    void _prefetch();
+    void _bookRowsAboutToBeRemoved(const QModelIndex& pidx,
+                                   int start, int end);
     void _searchBoxTextChanged(const QString &rx);
      void _dpTreeViewCurrentChanged(const QModelIndex &currIdx,
                                     const QModelIndex &prevIdx);
@@ -0,0 +1,291 @@
+#include "envelope.h"
+
+#include <QThread>
+#include <QtConcurrentMap>
+#include <float.h>
+#include <math.h>
+
+#define ENVELOPE_NBUCKETS 128
+
+// First element with time >= time, elementCount() if none
+static int _lowerBound(const EnvelopeCurve& c, double time)
+{
+    int lo = 0;
+    int hi = c.path->elementCount();
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( c.path->elementAt(mid).x*c.xs+c.xb < time ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool Envelope::valueAt(const EnvelopeCurve &c, double time, double *y)
+{
+    int n = c.path->elementCount();
+    int i = _lowerBound(c,time);
+    if ( i >= n ) {
+        return false;
+    }
+
+    QPainterPath::Element e1 = c.path->elementAt(i);
+    double t1 = e1.x*c.xs+c.xb;
+    double y1 = e1.y*c.ys+c.yb;
+    if ( t1 == time ) {
+        *y = y1;
+        return true;
+    }
+    if ( i == 0 ) {
+        return false;
+    }
+
+    QPainterPath::Element e0 = c.path->elementAt(i-1);
+    double t0 = e0.x*c.xs+c.xb;
+    double y0 = e0.y*c.ys+c.yb;
+    *y = y0 + (time-t0)*(y1-y0)/(t1-t0);
+    return true;
+}
+
+// Value of curve in each bin (NAN if none) and min/max of its points
+static void _curveBins(const EnvelopeCurve& c, double t0, double dt, int nbins,
+                       double* vals, int* cnts,
+                       double* pointMin, double* pointMax)
+{
+    for ( int b = 0; b < nbins; ++b ) {
+        vals[b] = 0.0;
+        cnts[b] = 0;
+    }
+
+    const double tEnd = t0 + nbins*dt;
+    const int n = c.path->elementCount();
+    for ( int i = _lowerBound(c,t0); i < n; ++i ) {
+        QPainterPath::Element e = c.path->elementAt(i);
+        double t = e.x*c.xs+c.xb;
+        if ( t >= tEnd ) {
+            break;
+        }
+        double y = e.y*c.ys+c.yb;
+        if ( y != y ) {
+            continue;  // nan
+        }
+        int b = qBound(0,(int)((t-t0)/dt),nbins-1);
+        vals[b] += y;
+        cnts[b]++;
+        if ( y < pointMin[b] ) pointMin[b] = y;
+        if ( y > pointMax[b] ) pointMax[b] = y;
+    }
+
+    for ( int b = 0; b < nbins; ++b ) {
+        if ( cnts[b] > 0 ) {
+            vals[b] /= cnts[b];
+        } else {
+            double y;
+            if ( Envelope::valueAt(c,t0+(b+0.5)*dt,&y) ) {
+                vals[b] = y;
+            } else {
+                vals[b] = NAN;
+            }
+        }
+    }
+}
+
+// Partial reduction over curves [beg,end)
+class EnvelopeTask
+{
+  public:
+    EnvelopeTask() : beg(0), end(0) {}
+    EnvelopeTask(int beg, int end, int nbins) :
+        beg(beg), end(end),
+        pointMin(nbins,DBL_MAX), pointMax(nbins,-DBL_MAX),
+        min(nbins,DBL_MAX), max(nbins,-DBL_MAX),
+        sum(nbins,0.0), sumsq(nbins,0.0), count(nbins,0) {}
+
+    int beg;
+    int end;
+    QVector<double> pointMin;
+    QVector<double> pointMax;
+    QVector<double> min;       // of curve bin values
+    QVector<double> max;
+    QVector<double> sum;
+    QVector<double> sumsq;
+    QVector<int> count;
+    QVector<int> hist;         // second pass, nbins*ENVELOPE_NBUCKETS
+};
+
+// First pass (vmin == 0) sums and min/maxes, second pass histograms
+// curve bin values between vmin and vmax
+class EnvelopeReducer
+{
+  public:
+    EnvelopeReducer(const QList<EnvelopeCurve>* curves,
+                    double t0, double dt, int nbins,
+                    const QVector<double>* vmin,
+                    const QVector<double>* vmax) :
+        _curves(curves), _t0(t0), _dt(dt), _nbins(nbins),
+        _vmin(vmin), _vmax(vmax) {}
+
+    void operator()(EnvelopeTask& task)
+    {
+        QVector<double> vals(_nbins);
+        QVector<int> cnts(_nbins);
+        for ( int i = task.beg; i < task.end; ++i ) {
+            _curveBins(_curves->at(i),_t0,_dt,_nbins,vals.data(),cnts.data(),
+                       task.pointMin.data(),task.pointMax.data());
+            for ( int b = 0; b < _nbins; ++b ) {
+                double v = vals.at(b);
+                if ( v != v ) {
+                    continue;
+                }
+                if ( !_vmin ) {
+                    task.sum[b] += v;
+                    task.sumsq[b] += v*v;
+                    task.count[b]++;
+                    if ( v < task.min[b] ) task.min[b] = v;
+                    if ( v > task.max[b] ) task.max[b] = v;
+                } else {
+                    double lo = _vmin->at(b);
+                    double w = _vmax->at(b)-lo;
+                    int k = 0;
+                    if ( w > 0.0 ) {
+                        k = qBound(0,(int)((v-lo)/w*ENVELOPE_NBUCKETS),
+                                   ENVELOPE_NBUCKETS-1);
+                    }
+                    task.hist[b*ENVELOPE_NBUCKETS+k]++;
+                }
+            }
+        }
+    }
+
+  private:
+    const QList<EnvelopeCurve>* _curves;
+    double _t0;
+    double _dt;
+    int _nbins;
+    const QVector<double>* _vmin;
+    const QVector<double>* _vmax;
+};
+
+QList<double> Envelope::percentiles()
+{
+    QList<double> list;
+    list << 5.0 << 50.0 << 95.0;
+    return list;
+}
+
+Envelope::Envelope(const QList<EnvelopeCurve> &curves,
+                   double begTime, double endTime, int nbins)
+{
+    if ( curves.isEmpty() || nbins < 1 || !(endTime > begTime) ) {
+        return;
+    }
+    const double dt = (endTime-begTime)/nbins;
+
+    int ntasks = qBound(1,QThread::idealThreadCount(),curves.size());
+    QList<EnvelopeTask> tasks;
+    for ( int i = 0; i < ntasks; ++i ) {
+        int beg = (int)((qint64)curves.size()*i/ntasks);
+        int end = (int)((qint64)curves.size()*(i+1)/ntasks);
+        tasks.append(EnvelopeTask(beg,end,nbins));
+    }
+
+    QtConcurrent::blockingMap(tasks,EnvelopeReducer(&curves,begTime,dt,
+                                                    nbins,0,0));
+
+    time.resize(nbins);
+    count.fill(0,nbins);
+    min.fill(DBL_MAX,nbins);
+    max.fill(-DBL_MAX,nbins);
+    mean.fill(NAN,nbins);
+    sigma.fill(NAN,nbins);
+    QVector<double> vmin(nbins,DBL_MAX);
+    QVector<double> vmax(nbins,-DBL_MAX);
+    QVector<double> sum(nbins,0.0);
+    QVector<double> sumsq(nbins,0.0);
+    foreach ( EnvelopeTask task, tasks ) {
+        for ( int b = 0; b < nbins; ++b ) {
+            count[b] += task.count.at(b);
+            min[b] = qMin(min.at(b),task.pointMin.at(b));
+            max[b] = qMax(max.at(b),task.pointMax.at(b));
+            vmin[b] = qMin(vmin.at(b),task.min.at(b));
+            vmax[b] = qMax(vmax.at(b),task.max.at(b));
+            sum[b] += task.sum.at(b);
+            sumsq[b] += task.sumsq.at(b);
+        }
+    }
+    for ( int b = 0; b < nbins; ++b ) {
+        time[b] = begTime + (b+0.5)*dt;
+        int n = count.at(b);
+        if ( n > 0 ) {
+            // Interpolated values may lie outside of point min/max
+            min[b] = qMin(min.at(b),vmin.at(b));
+            max[b] = qMax(max.at(b),vmax.at(b));
+            double m = sum.at(b)/n;
+            mean[b] = m;
+            sigma[b] = sqrt(qMax(0.0,sumsq.at(b)/n - m*m));
+        } else {
+            min[b] = NAN;
+            max[b] = NAN;
+        }
+    }
+
+    // Second pass for percentiles
+    for ( int i = 0; i < tasks.size(); ++i ) {
+        tasks[i].hist.fill(0,nbins*ENVELOPE_NBUCKETS);
+    }
+    QtConcurrent::blockingMap(tasks,EnvelopeReducer(&curves,begTime,dt,
+                                                    nbins,&vmin,&vmax));
+    QVector<int> hist(nbins*ENVELOPE_NBUCKETS,0);
+    foreach ( EnvelopeTask task, tasks ) {
+        for ( int k = 0; k < hist.size(); ++k ) {
+            hist[k] += task.hist.at(k);
+        }
+    }
+
+    foreach ( double p, percentiles() ) {
+        QVector<double> pct(nbins,NAN);
+        for ( int b = 0; b < nbins; ++b ) {
+            int n = count.at(b);
+            if ( n == 0 ) {
+                continue;
+            }
+            const int* h = hist.constData() + b*ENVELOPE_NBUCKETS;
+            double rank = p/100.0*n;
+            double w = vmax.at(b)-vmin.at(b);
+            int cum = 0;
+            int k = 0;
+            for ( ; k < ENVELOPE_NBUCKETS-1; ++k ) {
+                if ( cum + h[k] >= rank ) {
+                    break;
+                }
+                cum += h[k];
+            }
+            double frac = ( h[k] > 0 ) ? (rank-cum)/h[k] : 0.0;
+            frac = qBound(0.0,frac,1.0);
+            pct[b] = vmin.at(b) + (k+frac)/ENVELOPE_NBUCKETS*w;
+        }
+        percentile.append(pct);
+    }
+}
+
+int Envelope::closestCurve(const QList<EnvelopeCurve> &curves,
+                           double time, double y, double *curveY)
+{
+    int closest = -1;
+    double minDist = DBL_MAX;
+    for ( int i = 0; i < curves.size(); ++i ) {
+        double cy;
+        if ( !valueAt(curves.at(i),time,&cy) || cy != cy ) {
+            continue;
+        }
+        double dist = qAbs(cy-y);
+        if ( dist < minDist ) {
+            minDist = dist;
+            closest = i;
+            *curveY = cy;
+        }
+    }
+    return closest;
+}
@@ -0,0 +1,65 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <QList>
+#include <QVector>
+#include <QPainterPath>
+
+//
+// Curve path and its plot scale/bias, math = path*s+b
+//
+class EnvelopeCurve
+{
+  public:
+    EnvelopeCurve() : path(0), xs(1.0), xb(0.0), ys(1.0), yb(0.0) {}
+    EnvelopeCurve(const QPainterPath* path,
+                  double xs, double xb, double ys, double yb) :
+        path(path), xs(xs), xb(xb), ys(ys), yb(yb) {}
+
+    const QPainterPath* path;
+    double xs;
+    double xb;
+    double ys;
+    double yb;
+};
+
+//
+// Statistics across curves (e.g. all RUNs of a MONTE) in time bins
+//
+// Each curve contributes one value per bin, the mean of its points in
+// the bin or, when its points are sparser than the bins, its value
+// interpolated at the bin center.  min/max are over all points so
+// spikes within a bin are not lost.  Percentiles come from a fixed size
+// histogram per bin, so memory depends on the number of bins and not on
+// the number of curves.  Curves are reduced in parallel, one group of
+// curves per thread.
+//
+// Curves must be time plots with ascending x.
+//
+class Envelope
+{
+  public:
+    Envelope(const QList<EnvelopeCurve>& curves,
+             double begTime, double endTime, int nbins);
+
+    static QList<double> percentiles();   // e.g. 5,50,95
+
+    // Index of curve whose value at time is closest to y, -1 if none
+    static int closestCurve(const QList<EnvelopeCurve>& curves,
+                            double time, double y, double* curveY);
+
+    // Value of curve at time, false if time is outside of curve
+    static bool valueAt(const EnvelopeCurve& curve, double time, double* y);
+
+    int nbins() const { return time.size(); }
+
+    QVector<double> time;      // bin centers
+    QVector<int> count;        // curves with a value in bin
+    QVector<double> min;
+    QVector<double> max;
+    QVector<double> mean;
+    QVector<double> sigma;
+    QList<QVector<double> > percentile;  // in order of percentiles()
+};
+
+#endif // ENVELOPE_H
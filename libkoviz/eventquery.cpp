@@ -0,0 +1,332 @@
+#include "eventquery.h"
+
+#include <QtConcurrentMap>
+
+EventQuery::EventQuery(const QString &predicate) :
+    _predicate(predicate),
+    _isAbs(false),
+    _op(LT),
+    _value(0.0)
+{
+    static const char* opNames[] = { "<=", ">=", "==", "!=", "<", ">" };
+    static const Op ops[] = { LE, GE, EQ, NE, LT, GT };
+
+    // Operator is first one outside of parens (var may have an index)
+    int i = 0;
+    int depth = 0;
+    int opLen = 0;
+    for ( ; i < predicate.size(); ++i ) {
+        QChar c = predicate.at(i);
+        if ( c == '(' || c == '[' ) {
+            ++depth;
+        } else if ( c == ')' || c == ']' ) {
+            --depth;
+        } else if ( depth == 0 ) {
+            // Two char ops first so "<=" is not taken as "<"
+            for ( int k = 0; k < 6; ++k ) {
+                if ( predicate.mid(i).startsWith(opNames[k]) ) {
+                    _op = ops[k];
+                    opLen = QString(opNames[k]).size();
+                    break;
+                }
+            }
+            if ( opLen > 0 ) {
+                break;
+            }
+        }
+    }
+    if ( opLen == 0 ) {
+        _error("no comparison operator (< <= > >= == !=)");
+    }
+
+    _var = predicate.left(i).trimmed();
+    if ( _var.size() > 2 && _var.startsWith('|') && _var.endsWith('|') ) {
+        _isAbs = true;
+        _var = _var.mid(1,_var.size()-2).trimmed();
+    } else if ( _var.startsWith("abs(") && _var.endsWith(')') ) {
+        _isAbs = true;
+        _var = _var.mid(4,_var.size()-5).trimmed();
+    }
+    if ( _var.isEmpty() ) {
+        _error("no variable");
+    }
+
+    bool ok;
+    _value = predicate.mid(i+opLen).trimmed().toDouble(&ok);
+    if ( !ok ) {
+        _error("right hand side should be a number");
+    }
+}
+
+void EventQuery::_error(const QString &msg) const
+{
+    QString errString;
+    QTextStream errStream(&errString);
+    errStream << "koviz [error]: bad query \"" << _predicate << "\", "
+              << msg << "\n";
+    errStream.flush();
+    throw std::runtime_error(errString.toLatin1().constData());
+}
+
+bool EventQuery::isMatch(double v) const
+{
+    if ( _isAbs ) {
+        v = qAbs(v);
+    }
+    switch (_op) {
+    case LT: return v < _value;
+    case LE: return v <= _value;
+    case GT: return v > _value;
+    case GE: return v >= _value;
+    case EQ: return v == _value;
+    case NE: return v != _value && v == v;
+    }
+    return false;
+}
+
+bool EventQuery::isCandidate(double lo, double hi) const
+{
+    if ( lo != lo ) {
+        return false;  // block has no numbers
+    }
+    if ( _isAbs ) {
+        if ( lo >= 0.0 ) {
+            // [lo,hi] as is
+        } else if ( hi <= 0.0 ) {
+            double l = -hi;
+            hi = -lo;
+            lo = l;
+        } else {
+            hi = qMax(-lo,hi);
+            lo = 0.0;
+        }
+    }
+    switch (_op) {
+    case LT: return lo < _value;
+    case LE: return lo <= _value;
+    case GT: return hi > _value;
+    case GE: return hi >= _value;
+    case EQ: return lo <= _value && _value <= hi;
+    case NE: return !(lo == _value && hi == _value);
+    }
+    return true;
+}
+
+// Query of one run's curve
+class QueryRun
+{
+  public:
+    int run;
+    CurveModel* curve;
+    QString key;
+    bool isSummarized;     // blocks came from summary cache
+    QueryBlocks blocks;
+    QList<QueryEvent> events;
+};
+
+class QueryRunner
+{
+  public:
+    QueryRunner(const EventQuery* query) : _query(query) {}
+
+    void operator()(QueryRun& q)
+    {
+        const int bs = EventQuery::blockSize();
+        double ys = q.curve->y()->scale();
+        double yb = q.curve->y()->bias();
+        int nrows = q.curve->rowCount();
+        int nblocks = (nrows+bs-1)/bs;
+        if ( !q.isSummarized ) {
+            q.blocks.nrows = nrows;
+            q.blocks.min.fill(NAN,nblocks);
+            q.blocks.max.fill(NAN,nblocks);
+        }
+
+        bool isOpen = false;
+        double start = 0.0;
+        double end = 0.0;
+
+        q.curve->map();
+        ModelIterator* it = q.curve->begin();
+        for ( int b = 0; b < nblocks; ++b ) {
+            if ( q.isSummarized &&
+                 !_query->isCandidate(q.blocks.min.at(b),
+                                      q.blocks.max.at(b)) ) {
+                if ( isOpen ) {
+                    q.events.append(QueryEvent(q.run,start,end));
+                    isOpen = false;
+                }
+                continue;
+            }
+            int row = b*bs;
+            int rowEnd = qMin(row+bs,nrows);
+            double lo = NAN;
+            double hi = NAN;
+            it->at(row);
+            for ( ; row < rowEnd && !it->isDone(); ++row ) {
+                double v = it->y()*ys+yb;
+                if ( v == v ) {
+                    if ( lo != lo || v < lo ) lo = v;
+                    if ( hi != hi || v > hi ) hi = v;
+                }
+                if ( _query->isMatch(v) ) {
+                    if ( !isOpen ) {
+                        isOpen = true;
+                        start = it->t();
+                    }
+                    end = it->t();
+                } else if ( isOpen ) {
+                    q.events.append(QueryEvent(q.run,start,end));
+                    isOpen = false;
+                }
+                it->next();
+            }
+            if ( !q.isSummarized ) {
+                q.blocks.min[b] = lo;
+                q.blocks.max[b] = hi;
+            }
+        }
+        if ( isOpen ) {
+            q.events.append(QueryEvent(q.run,start,end));
+        }
+        delete it;
+        q.curve->unmap();
+    }
+
+  private:
+    const EventQuery* _query;
+};
+
+QList<QueryEvent> EventQuery::run(Runs *runs, const QString &timeName,
+                                  Summaries *summaries) const
+{
+    // Curve models are created here since Runs is not thread safe
+    QList<QueryRun> queries;
+    QStringList runDirs = runs->runDirs();
+    for ( int i = 0; i < runDirs.size(); ++i ) {
+        CurveModel* curve = runs->curveModel(i,timeName,timeName,_var);
+        if ( !curve ) {
+            continue;
+        }
+        QueryRun q;
+        q.run = i;
+        q.curve = curve;
+        q.isSummarized = false;
+        QFileInfo fi(curve->fileName());
+        if ( summaries && fi.isFile() ) {
+            q.key = QString("%1\t%2\t%3\t%4\t%5\t%6")
+                    .arg(fi.absoluteFilePath()).arg(curve->y()->name())
+                    .arg(curve->y()->scale(),0,'g',17)
+                    .arg(curve->y()->bias(),0,'g',17)
+                    .arg(fi.size())
+                    .arg(fi.lastModified().toMSecsSinceEpoch());
+            if ( summaries->contains(q.key) ) {
+                q.blocks = summaries->value(q.key);
+                q.isSummarized = ( q.blocks.nrows == curve->rowCount() );
+            }
+        }
+        queries.append(q);
+    }
+
+    QtConcurrent::blockingMap(queries,QueryRunner(this));
+
+    QList<QueryEvent> events;
+    foreach ( QueryRun q, queries ) {
+        if ( summaries && !q.key.isEmpty() && !q.isSummarized ) {
+            summaries->insert(q.key,q.blocks);
+        }
+        events.append(q.events);
+        delete q.curve;
+    }
+
+    return events;
+}
+
+QString EventQuery::summariesFileName(const QStringList &runDirs)
+{
+    if ( runDirs.isEmpty() ) {
+        return QString();
+    }
+    QString dir = QFileInfo(runDirs.at(0)).absolutePath();
+    if ( !QFileInfo(dir).isWritable() ) {
+        return QString();
+    }
+    return dir + "/.koviz_summaries";
+}
+
+// Key ends with data file's size and mtime (see run())
+static bool _isSummaryCurrent(const QString& key)
+{
+    QStringList fields = key.split('\t');
+    if ( fields.size() < 3 ) {
+        return false;
+    }
+    QFileInfo fi(fields.first());
+    return ( fi.isFile() &&
+             fields.at(fields.size()-2) == QString::number(fi.size()) &&
+             fields.last() ==
+                 QString::number(fi.lastModified().toMSecsSinceEpoch()) );
+}
+
+void EventQuery::loadSummaries(const QString &fileName, Summaries *summaries)
+{
+    QFile file(fileName);
+    if ( fileName.isEmpty() || !file.open(QIODevice::ReadOnly) ) {
+        return;
+    }
+    QDataStream in(&file);
+    QString version;
+    in >> version;
+    if ( version != "koviz-summaries 1" ) {
+        return;  // Unknown version, will be overwritten
+    }
+    qint32 n = 0;
+    in >> n;
+    Summaries loaded;
+    for ( int i = 0; i < n && in.status() == QDataStream::Ok; ++i ) {
+        QString key;
+        QueryBlocks blocks;
+        qint32 nrows = 0;
+        in >> key >> nrows >> blocks.min >> blocks.max;
+        blocks.nrows = nrows;
+        if ( _isSummaryCurrent(key) ) {
+            loaded.insert(key,blocks);
+        }
+    }
+    if ( in.status() != QDataStream::Ok ) {
+        return;  // Truncated, rebuilt by queries
+    }
+    foreach ( QString key, loaded.keys() ) {
+        if ( !summaries->contains(key) ) {
+            summaries->insert(key,loaded.value(key));
+        }
+    }
+}
+
+bool EventQuery::saveSummaries(const QString &fileName,
+                               const Summaries &summaries)
+{
+    if ( fileName.isEmpty() ) {
+        return true;
+    }
+    QStringList keys;
+    foreach ( QString key, summaries.keys() ) {
+        if ( _isSummaryCurrent(key) ) {
+            keys.append(key);
+        }
+    }
+
+    QFile file(fileName);
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        fprintf(stderr,"koviz [warning]: could not write summaries %s\n",
+                fileName.toLatin1().constData());
+        return false;
+    }
+    QDataStream out(&file);
+    out << QString("koviz-summaries 1") << (qint32)keys.size();
+    foreach ( QString key, keys ) {
+        QueryBlocks blocks = summaries.value(key);
+        out << key << (qint32)blocks.nrows << blocks.min << blocks.max;
+    }
+    return ( out.status() == QDataStream::Ok );
+}
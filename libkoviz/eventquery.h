@@ -0,0 +1,101 @@
+#ifndef EVENTQUERY_H
+#define EVENTQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QDataStream>
+#include <QFile>
+#include <QDir>
+#include <stdexcept>
+#include <math.h>
+
+#include "runs.h"
+#include "curvemodel.h"
+
+// Interval of a run where the query predicate holds
+class QueryEvent
+{
+  public:
+    QueryEvent() : run(-1), start(0.0), end(0.0) {}
+    QueryEvent(int run, double start, double end) :
+        run(run), start(start), end(end) {}
+
+    int run;        // index in runs->runDirs() i.e. CurveRunID
+    double start;   // time of first and last sample satisfying predicate
+    double end;
+};
+
+// Min/max of blocks of rows of a curve's y
+class QueryBlocks
+{
+  public:
+    QueryBlocks() : nrows(0) {}
+
+    int nrows;
+    QVector<double> min;   // NAN if block has no numbers
+    QVector<double> max;
+};
+
+//
+// Finds where a predicate holds across all runs e.g.
+//
+//     alt < 0
+//     |q| > 1500         (or abs(q) > 1500)
+//
+// Operators are < <= > >= == !=
+//
+// Each curve is summarized by the min/max of blocks of rows.  Blocks
+// whose min/max show the predicate cannot hold are skipped and only the
+// candidate blocks are scanned.  Summaries are built while scanning on
+// the first query of a variable and are kept in a summary cache for later
+// queries, which may be saved to a file for later sessions (e.g. -query).
+// Runs are queried in parallel.
+//
+class EventQuery
+{
+  public:
+    enum Op { LT, LE, GT, GE, EQ, NE };
+
+    // Throws std::runtime_error if predicate is bad
+    EventQuery(const QString& predicate);
+
+    QString var() const { return _var; }
+
+    // Summaries keyed by data file, column, scale and bias
+    typedef QHash<QString,QueryBlocks> Summaries;
+
+    QList<QueryEvent> run(Runs* runs, const QString& timeName,
+                          Summaries* summaries = 0) const;
+
+    // Summary cache file kept alongside the runs
+    // e.g. MONTE_dir/.koviz_summaries, empty if that dir is not writable
+    static QString summariesFileName(const QStringList& runDirs);
+
+    // Summaries of changed or removed data files are not loaded or saved
+    static void loadSummaries(const QString& fileName, Summaries* summaries);
+    static bool saveSummaries(const QString& fileName,
+                              const Summaries& summaries);
+
+    // True if some value in [lo,hi] could satisfy predicate
+    bool isCandidate(double lo, double hi) const;
+    bool isMatch(double v) const;
+
+    static int blockSize() { return 4096; }
+
+  private:
+    QString _predicate;
+    QString _var;
+    bool _isAbs;
+    Op _op;
+    double _value;
+
+    void _error(const QString& msg) const;
+};
+
+#endif // EVENTQUERY_H
@@ -0,0 +1,108 @@
+#include "eventquerywindow.h"
+
+EventQueryWindow::EventQueryWindow(Runs *runs,
+                                   const QString &timeName,
+                                   QWidget *parent) :
+    QWidget(parent,Qt::Window),
+    _runs(runs),
+    _timeName(timeName),
+    _eventsModel(0)
+{
+    setWindowTitle(tr("koviz events"));
+
+    _queryEdit = new QLineEdit(this);
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+    _queryEdit->setPlaceholderText("e.g. alt < 0 or |q| > 1500");
+#endif
+    _queryButton = new QPushButton(tr("Query"),this);
+    _statusLabel = new QLabel(this);
+
+    _tableView = new QTableView(this);
+    _tableView->setSortingEnabled(true);
+    _tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _tableView->setSelectionMode(QAbstractItemView::SingleSelection);
+    _tableView->verticalHeader()->hide();
+
+    QGridLayout* layout = new QGridLayout(this);
+    layout->addWidget(_queryEdit,0,0);
+    layout->addWidget(_queryButton,0,1);
+    layout->addWidget(_tableView,1,0,1,2);
+    layout->addWidget(_statusLabel,2,0,1,2);
+    layout->setColumnStretch(0,1);
+
+    connect(_queryButton,SIGNAL(clicked()),this,SLOT(_query()));
+    connect(_queryEdit,SIGNAL(returnPressed()),this,SLOT(_query()));
+    connect(_tableView,SIGNAL(activated(QModelIndex)),
+            this,SLOT(_activated(QModelIndex)));
+
+    resize(480,480);
+
+    EventQuery::loadSummaries(
+                EventQuery::summariesFileName(_runs->runDirs()),&_summaries);
+}
+
+EventQueryWindow::~EventQueryWindow()
+{
+    EventQuery::saveSummaries(
+                EventQuery::summariesFileName(_runs->runDirs()),_summaries);
+}
+
+void EventQueryWindow::_query()
+{
+    QString predicate = _queryEdit->text().trimmed();
+    if ( predicate.isEmpty() ) {
+        return;
+    }
+
+    QList<QueryEvent> events;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    try {
+        EventQuery query(predicate);
+        events = query.run(_runs,_timeName,&_summaries);
+    } catch (std::runtime_error &e) {
+        QApplication::restoreOverrideCursor();
+        QMessageBox::warning(this,tr("koviz"),e.what());
+        return;
+    }
+    QApplication::restoreOverrideCursor();
+
+    QStringList labels;
+    labels << "Run" << "RunId" << "Start" << "End" << "Duration";
+    QStandardItemModel* m = new QStandardItemModel(events.size(),
+                                                   labels.size(),this);
+    m->setHorizontalHeaderLabels(labels);
+    QStringList runDirs = _runs->runDirs();
+    int r = 0;
+    foreach ( QueryEvent event, events ) {
+        QString runDir = runDirs.at(event.run);
+        QStandardItem* runItem = new QStandardItem(
+                                               QFileInfo(runDir).fileName());
+        runItem->setData(event.run,Qt::UserRole);  // position in run list
+        m->setItem(r,0,runItem);
+        m->setItem(r,1,new NumSortItem(
+                             QString::number(Runs::runId(runDir,event.run))));
+        m->setItem(r,2,new NumSortItem(QString::number(event.start,'g',10)));
+        m->setItem(r,3,new NumSortItem(QString::number(event.end,'g',10)));
+        m->setItem(r,4,new NumSortItem(QString::number(event.end-event.start,
+                                                       'g',10)));
+        ++r;
+    }
+    _tableView->setModel(m);
+    _tableView->resizeColumnsToContents();
+    if ( _eventsModel ) {
+        delete _eventsModel;
+    }
+    _eventsModel = m;
+
+    _statusLabel->setText(QString("%1 events").arg(events.size()));
+}
+
+void EventQueryWindow::_activated(const QModelIndex &idx)
+{
+    const QAbstractItemModel* m = idx.model();
+    int run = m->data(m->index(idx.row(),0),Qt::UserRole).toInt();
+    double start = m->data(m->index(idx.row(),2)).toDouble();
+    double end = m->data(m->index(idx.row(),3)).toDouble();
+    emit eventActivated(run,start,end);
+}
@@ -0,0 +1,54 @@
+#ifndef EVENTQUERYWINDOW_H
+#define EVENTQUERYWINDOW_H
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableView>
+#include <QGridLayout>
+#include <QLabel>
+#include <QHeaderView>
+#include <QApplication>
+#include <QMessageBox>
+#include <QStandardItemModel>
+#include <QFileInfo>
+#include <stdexcept>
+
+#include "runs.h"
+#include "eventquery.h"
+#include "numsortitem.h"
+
+//
+// Panel listing where a predicate holds across runs,
+// activating an event jumps to its run and time
+//
+class EventQueryWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit EventQueryWindow(Runs* runs,
+                              const QString& timeName,
+                              QWidget *parent = 0);
+    ~EventQueryWindow();
+
+signals:
+    // run is the position of the event's run in the run list (CurveRunID)
+    void eventActivated(int run, double start, double end);
+
+private:
+    Runs* _runs;
+    QString _timeName;
+    QLineEdit* _queryEdit;
+    QPushButton* _queryButton;
+    QLabel* _statusLabel;
+    QTableView* _tableView;
+    QStandardItemModel* _eventsModel;
+    EventQuery::Summaries _summaries;
+
+private slots:
+    void _query();
+    void _activated(const QModelIndex& idx);
+};
+
+#endif // EVENTQUERYWINDOW_H
@@ -0,0 +1,477 @@
+#include "expression.h"
+
+#include <math.h>
+
+#define EXPR_BLOCK 256
+
+enum ExprFunc {
+    FuncSqrt, FuncAbs, FuncExp, FuncLog, FuncLog10,
+    FuncSin, FuncCos, FuncTan, FuncAsin, FuncAcos, FuncAtan,
+    FuncSinh, FuncCosh, FuncTanh, FuncFloor, FuncCeil,
+    FuncAtan2, FuncPow, FuncMin, FuncMax, FuncHypot, FuncFmod
+};
+
+Expression::Expression(const QString &text) :
+    _text(strip(text).trimmed()),
+    _maxDepth(0),
+    _pos(0)
+{
+    if ( _text.isEmpty() ) {
+        _error("empty expression");
+    }
+
+    _parseExpr();
+    _skipSpace();
+    if ( _pos < _text.size() ) {
+        _error(QString("unexpected \"%1\"").arg(_text.at(_pos)));
+    }
+
+    // Stack depth
+    int depth = 0;
+    foreach ( Instr instr, _code ) {
+        switch (instr.op) {
+        case OpConst:
+        case OpVar: ++depth; break;
+        case OpNeg:
+        case OpSquare:
+        case OpFunc1: break;
+        default: --depth; break;  // binary
+        }
+        _maxDepth = qMax(_maxDepth,depth);
+    }
+}
+
+bool Expression::isExpression(const QString &name)
+{
+    return name.startsWith('@');
+}
+
+QString Expression::strip(const QString &name)
+{
+    if ( isExpression(name) ) {
+        return name.mid(1);
+    }
+    return name;
+}
+
+QString Expression::splitUnit(const QString &name, QString *unit)
+{
+    QString text = name.trimmed();
+    unit->clear();
+    if ( text.endsWith('}') ) {
+        int i = text.lastIndexOf('{');
+        if ( i > 0 && text.left(i).trimmed().endsWith(')') ) {
+            *unit = text.mid(i+1,text.size()-i-2).trimmed();
+            text = text.left(i).trimmed();
+        }
+    }
+    return text;
+}
+
+// Local message since DP filtering may try many bad expressions
+void Expression::_error(const QString &msg) const
+{
+    QString errString;
+    QTextStream errStream(&errString);
+    errStream << "koviz [error]: " << msg << " in expression:\n\n"
+              << "    " << _text << "\n"
+              << "    " << QString(qMin(_pos,_text.size()),' ') << "^\n";
+    errStream.flush();
+    throw std::runtime_error(errString.toLatin1().constData());
+}
+
+void Expression::_skipSpace()
+{
+    while ( _pos < _text.size() && _text.at(_pos).isSpace() ) {
+        ++_pos;
+    }
+}
+
+bool Expression::_accept(QChar c)
+{
+    _skipSpace();
+    if ( _pos < _text.size() && _text.at(_pos) == c ) {
+        ++_pos;
+        return true;
+    }
+    return false;
+}
+
+void Expression::_expect(QChar c)
+{
+    if ( !_accept(c) ) {
+        _error(QString("expected \"%1\"").arg(c));
+    }
+}
+
+// expr := term (('+'|'-') term)*
+void Expression::_parseExpr()
+{
+    _parseTerm();
+    while ( 1 ) {
+        if ( _accept('+') ) {
+            _parseTerm();
+            _emit(OpAdd);
+        } else if ( _accept('-') ) {
+            _parseTerm();
+            _emit(OpSub);
+        } else {
+            break;
+        }
+    }
+}
+
+// term := unary (('*'|'/') unary)*
+void Expression::_parseTerm()
+{
+    _parseUnary();
+    while ( 1 ) {
+        if ( _accept('*') ) {
+            _parseUnary();
+            _emit(OpMul);
+        } else if ( _accept('/') ) {
+            _parseUnary();
+            _emit(OpDiv);
+        } else {
+            break;
+        }
+    }
+}
+
+// unary := ('-'|'+') unary | power
+void Expression::_parseUnary()
+{
+    if ( _accept('-') ) {
+        _parseUnary();
+        _emit(OpNeg);
+    } else if ( _accept('+') ) {
+        _parseUnary();
+    } else {
+        _parsePower();
+    }
+}
+
+// power := primary ('^' unary)?  so -x^2 is -(x^2) and 2^3^2 is 2^9
+void Expression::_parsePower()
+{
+    _parsePrimary();
+    if ( _accept('^') ) {
+        _parseUnary();
+        _emit(OpPow);
+    }
+}
+
+// primary := number | '(' expr ')' | func '(' args ')' | var ('{' unit '}')?
+void Expression::_parsePrimary()
+{
+    _skipSpace();
+    if ( _pos >= _text.size() ) {
+        _error("unexpected end");
+    }
+
+    QChar c = _text.at(_pos);
+    bool isNumber = c.isDigit() ||
+                    (c == '.' && _pos+1 < _text.size() &&
+                                 _text.at(_pos+1).isDigit());
+    if ( isNumber ) {
+        int beg = _pos;
+        while ( _pos < _text.size() &&
+                (_text.at(_pos).isDigit() || _text.at(_pos) == '.') ) {
+            ++_pos;
+        }
+        if ( _pos < _text.size() &&
+             (_text.at(_pos) == 'e' || _text.at(_pos) == 'E') ) {
+            int exp = _pos+1;
+            if ( exp < _text.size() &&
+                 (_text.at(exp) == '+' || _text.at(exp) == '-') ) {
+                ++exp;
+            }
+            if ( exp < _text.size() && _text.at(exp).isDigit() ) {
+                _pos = exp;
+                while ( _pos < _text.size() && _text.at(_pos).isDigit() ) {
+                    ++_pos;
+                }
+            }
+        }
+        bool ok;
+        double value = _text.mid(beg,_pos-beg).toDouble(&ok);
+        if ( !ok ) {
+            _pos = beg;
+            _error("bad number");
+        }
+        _emit(OpConst,0,value);
+        return;
+    }
+
+    if ( _accept('(') ) {
+        _parseExpr();
+        _expect(')');
+        return;
+    }
+
+    int beg = _pos;
+    QString name = _identifier();
+    if ( name.isEmpty() ) {
+        _error(QString("unexpected \"%1\"").arg(c));
+    }
+
+    _skipSpace();
+    if ( _pos < _text.size() && _text.at(_pos) == '(' ) {
+        int nargs = 0;
+        int id = _funcId(name,&nargs);
+        if ( id < 0 ) {
+            _pos = beg;
+            _error(QString("unknown function \"%1\"").arg(name));
+        }
+        _expect('(');
+        _parseExpr();
+        if ( nargs == 2 ) {
+            _expect(',');
+            _parseExpr();
+        }
+        _expect(')');
+        _emit(nargs == 2 ? OpFunc2 : OpFunc1, id);
+        return;
+    }
+
+    if ( name == "pi" ) {
+        _emit(OpConst,0,M_PI);
+        return;
+    }
+
+    QString unit;
+    if ( _accept('{') ) {
+        int k = _text.indexOf('}',_pos);
+        if ( k < 0 ) {
+            _error("missing \"}\"");
+        }
+        unit = _text.mid(_pos,k-_pos).trimmed();
+        _pos = k+1;
+    }
+
+    int idx = -1;
+    for ( int i = 0; i < _vars.size(); ++i ) {
+        if ( _vars.at(i) == name && _varUnits.at(i) == unit ) {
+            idx = i;
+            break;
+        }
+    }
+    if ( idx < 0 ) {
+        idx = _vars.size();
+        _vars.append(name);
+        _varUnits.append(unit);
+    }
+    _emit(OpVar,idx);
+}
+
+// Trick style names e.g. ball.state.out.position[0]
+QString Expression::_identifier()
+{
+    int beg = _pos;
+    if ( _pos < _text.size() &&
+         (_text.at(_pos).isLetter() || _text.at(_pos) == '_') ) {
+        ++_pos;
+        while ( _pos < _text.size() ) {
+            QChar c = _text.at(_pos);
+            if ( c.isLetterOrNumber() || c == '_' || c == '.' || c == ':' ) {
+                ++_pos;
+            } else if ( c == '[' ) {
+                int k = _text.indexOf(']',_pos);
+                if ( k < 0 ) {
+                    _error("missing \"]\"");
+                }
+                _pos = k+1;
+            } else {
+                break;
+            }
+        }
+    }
+    return _text.mid(beg,_pos-beg);
+}
+
+void Expression::_emit(Op op, int arg, double value)
+{
+    int n = _code.size();
+
+    // Fold constants
+    if ( (op == OpNeg || op == OpFunc1) &&
+         n >= 1 && _code.at(n-1).op == OpConst ) {
+        double x = _code.at(n-1).value;
+        _code[n-1].value = (op == OpNeg) ? -x : _func1(arg,x);
+        return;
+    }
+    if ( op != OpConst && op != OpVar && op != OpNeg && op != OpFunc1 &&
+         n >= 2 && _code.at(n-1).op == OpConst &&
+                   _code.at(n-2).op == OpConst ) {
+        double x = _code.at(n-2).value;
+        double y = _code.at(n-1).value;
+        double r = 0.0;
+        switch (op) {
+        case OpAdd: r = x+y; break;
+        case OpSub: r = x-y; break;
+        case OpMul: r = x*y; break;
+        case OpDiv: r = x/y; break;
+        case OpPow: r = pow(x,y); break;
+        default: r = _func2(arg,x,y); break;
+        }
+        _code.resize(n-1);
+        _code[n-2].value = r;
+        return;
+    }
+
+    // x^2 is common enough (magnitudes) to be worth its own instruction
+    if ( op == OpPow && n >= 1 && _code.at(n-1).op == OpConst &&
+         _code.at(n-1).value == 2.0 ) {
+        _code[n-1] = Instr(OpSquare,0,0.0);
+        return;
+    }
+
+    _code.append(Instr(op,arg,value));
+}
+
+int Expression::_funcId(const QString &name, int *nargs)
+{
+    static const char* names1[] = {
+        "sqrt", "abs", "exp", "log", "log10",
+        "sin", "cos", "tan", "asin", "acos", "atan",
+        "sinh", "cosh", "tanh", "floor", "ceil", 0
+    };
+    static const char* names2[] = {
+        "atan2", "pow", "min", "max", "hypot", "fmod", 0
+    };
+
+    for ( int i = 0; names1[i]; ++i ) {
+        if ( name == names1[i] ) {
+            *nargs = 1;
+            return FuncSqrt+i;
+        }
+    }
+    for ( int i = 0; names2[i]; ++i ) {
+        if ( name == names2[i] ) {
+            *nargs = 2;
+            return FuncAtan2+i;
+        }
+    }
+    return -1;
+}
+
+double Expression::_func1(int id, double x)
+{
+    switch (id) {
+    case FuncSqrt: return sqrt(x);
+    case FuncAbs: return fabs(x);
+    case FuncExp: return exp(x);
+    case FuncLog: return log(x);
+    case FuncLog10: return log10(x);
+    case FuncSin: return sin(x);
+    case FuncCos: return cos(x);
+    case FuncTan: return tan(x);
+    case FuncAsin: return asin(x);
+    case FuncAcos: return acos(x);
+    case FuncAtan: return atan(x);
+    case FuncSinh: return sinh(x);
+    case FuncCosh: return cosh(x);
+    case FuncTanh: return tanh(x);
+    case FuncFloor: return floor(x);
+    case FuncCeil: return ceil(x);
+    default: return 0.0;
+    }
+}
+
+double Expression::_func2(int id, double x, double y)
+{
+    switch (id) {
+    case FuncAtan2: return atan2(x,y);
+    case FuncPow: return pow(x,y);
+    case FuncMin: return x < y ? x : y;
+    case FuncMax: return x > y ? x : y;
+    case FuncHypot: return hypot(x,y);
+    case FuncFmod: return fmod(x,y);
+    default: return 0.0;
+    }
+}
+
+void Expression::evaluate(const double * const *vars, int n, double *out) const
+{
+    QVector<double> stack(qMax(_maxDepth,1)*EXPR_BLOCK);
+    const Instr* code = _code.constData();
+    const int ncode = _code.size();
+
+    for ( int row = 0; row < n; row += EXPR_BLOCK ) {
+        const int m = qMin(EXPR_BLOCK,n-row);
+        int d = 0;
+        for ( int k = 0; k < ncode; ++k ) {
+            const Instr& instr = code[k];
+            double* b = stack.data() + qMax(d-1,0)*EXPR_BLOCK; // top
+            double* a = stack.data() + qMax(d-2,0)*EXPR_BLOCK; // binary lhs
+            switch (instr.op) {
+            case OpConst: {
+                double* s = stack.data() + d*EXPR_BLOCK;
+                const double v = instr.value;
+                for ( int i = 0; i < m; ++i ) s[i] = v;
+                ++d;
+                break;
+            }
+            case OpVar: {
+                double* s = stack.data() + d*EXPR_BLOCK;
+                const double* v = vars[instr.arg] + row;
+                for ( int i = 0; i < m; ++i ) s[i] = v[i];
+                ++d;
+                break;
+            }
+            case OpAdd:
+                for ( int i = 0; i < m; ++i ) a[i] += b[i];
+                --d;
+                break;
+            case OpSub:
+                for ( int i = 0; i < m; ++i ) a[i] -= b[i];
+                --d;
+                break;
+            case OpMul:
+                for ( int i = 0; i < m; ++i ) a[i] *= b[i];
+                --d;
+                break;
+            case OpDiv:
+                for ( int i = 0; i < m; ++i ) a[i] /= b[i];
+                --d;
+                break;
+            case OpPow:
+                for ( int i = 0; i < m; ++i ) a[i] = pow(a[i],b[i]);
+                --d;
+                break;
+            case OpNeg:
+                for ( int i = 0; i < m; ++i ) b[i] = -b[i];
+                break;
+            case OpSquare:
+                for ( int i = 0; i < m; ++i ) b[i] *= b[i];
+                break;
+            case OpFunc1:
+                switch (instr.arg) {
+                case FuncSqrt:
+                    for ( int i = 0; i < m; ++i ) b[i] = sqrt(b[i]);
+                    break;
+                case FuncAbs:
+                    for ( int i = 0; i < m; ++i ) b[i] = fabs(b[i]);
+                    break;
+                default:
+                    for ( int i = 0; i < m; ++i ) {
+                        b[i] = _func1(instr.arg,b[i]);
+                    }
+                    break;
+                }
+                break;
+            case OpFunc2:
+                for ( int i = 0; i < m; ++i ) {
+                    a[i] = _func2(instr.arg,a[i],b[i]);
+                }
+                --d;
+                break;
+            }
+        }
+
+        const double* s = stack.constData();
+        for ( int i = 0; i < m; ++i ) {
+            out[row+i] = s[i];
+        }
+    }
+}
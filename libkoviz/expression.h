@@ -0,0 +1,105 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QTextStream>
+#include <stdexcept>
+
+//
+// Arithmetic expression over logged variables e.g.
+//
+//     sqrt(ball.state.out.velocity[0]^2 + ball.state.out.velocity[1]^2)
+//     atan2(ball.state.out.position[1]{ft},ball.state.out.position[0]{ft})
+//
+// Variables are logged param names.  A {unit} after a variable converts
+// it to that unit before use.  Operators are + - * / ^ and unary minus.
+// Functions are sqrt abs exp log log10 sin cos tan asin acos atan sinh
+// cosh tanh floor ceil (one arg) and atan2 pow min max hypot fmod (two).
+// pi is a constant.
+//
+// The text is compiled once to postfix code with constants folded.
+// evaluate() runs the code over column arrays a block of rows at a time,
+// each instruction being a flat loop over the block, so it may be called
+// on disjoint row ranges from several threads.
+//
+// Expressions used as var names in DPs and -map values are prefixed
+// with '@', see isExpression(), e.g.
+//
+//     koviz -map "speed=@sqrt(ball.v[0]^2+ball.v[1]^2){m/s}" RUN_a
+//
+// makes speed a var in the vars browser and in DPs.
+//
+class Expression
+{
+  public:
+    explicit Expression(const QString& text);  // throws on syntax error
+
+    static bool isExpression(const QString& name);
+    static QString strip(const QString& name);  // drop the '@' prefix
+
+    // "@sqrt(x^2+y^2){m}" is "@sqrt(x^2+y^2)" with result unit m.  Only a
+    // unit after a closing paren is a result unit, x{ft} converts x.
+    static QString splitUnit(const QString& name, QString* unit);
+
+    QString text() const { return _text; }
+    QStringList variables() const { return _vars; }
+    QStringList variableUnits() const { return _varUnits; } // "" if none
+
+    // vars[i] holds n values of variables().at(i); out holds n values
+    void evaluate(const double* const* vars, int n, double* out) const;
+
+  private:
+
+    enum Op {
+        OpConst,
+        OpVar,
+        OpAdd,
+        OpSub,
+        OpMul,
+        OpDiv,
+        OpPow,
+        OpNeg,
+        OpSquare,
+        OpFunc1,
+        OpFunc2
+    };
+
+    class Instr
+    {
+      public:
+        Instr() : op(OpConst), arg(0), value(0.0) {}
+        Instr(Op op, int arg, double value) : op(op), arg(arg), value(value){}
+        Op op;
+        int arg;       // variable index or function id
+        double value;  // constant
+    };
+
+    QString _text;
+    QStringList _vars;
+    QStringList _varUnits;
+    QVector<Instr> _code;
+    int _maxDepth;
+
+    // Parser state
+    int _pos;
+
+    void _parseExpr();
+    void _parseTerm();
+    void _parseUnary();
+    void _parsePower();
+    void _parsePrimary();
+    void _skipSpace();
+    bool _accept(QChar c);
+    void _expect(QChar c);
+    QString _identifier();
+    void _emit(Op op, int arg=0, double value=0.0);
+    void _error(const QString& msg) const;
+
+    static int _funcId(const QString& name, int* nargs);
+    static double _func1(int id, double x);
+    static double _func2(int id, double x, double y);
+};
+
+#endif // EXPRESSION_H
@@ -0,0 +1,222 @@
+#include "expressionmodel.h"
+#include "programmodel.h"
+#include "unit.h"
+
+#include <QtConcurrentMap>
+#include <algorithm>
+
+QString ExpressionModel::_err_string;
+QTextStream ExpressionModel::_err_stream(&ExpressionModel::_err_string);
+
+static const int _chunkSize = 65536;
+
+class ExpressionChunkEvaluator
+{
+  public:
+    ExpressionChunkEvaluator(const Expression* expr,
+                             const QVector<const double*>* inputs,
+                             double* out, int nrows) :
+        _expr(expr), _inputs(inputs), _out(out), _nrows(nrows) {}
+
+    void operator()(int& row)
+    {
+        QVector<const double*> in(_inputs->size());
+        for ( int i = 0; i < in.size(); ++i ) {
+            in[i] = _inputs->at(i) + row;
+        }
+        int n = qMin(_chunkSize,_nrows-row);
+        _expr->evaluate(in.constData(),n,_out+row);
+    }
+
+  private:
+    const Expression* _expr;
+    const QVector<const double*>* _inputs;
+    double* _out;
+    int _nrows;
+};
+
+ExpressionModel::ExpressionModel(const QList<CurveModel *> &inputCurves,
+                                 const Expression &expr,
+                                 const QString &name,
+                                 const QString &unit,
+                                 const QStringList &timeNames,
+                                 const QString &fileName,
+                                 QObject *parent) :
+    DataModel(timeNames, fileName, parent),
+    _nrows(0)
+{
+    _valueParam.setName(name);
+    _valueParam.setUnit(unit.isEmpty() ? QString("--") : unit);
+    _init(inputCurves,expr);
+}
+
+ExpressionModel::~ExpressionModel()
+{
+}
+
+void ExpressionModel::_init(const QList<CurveModel *> &inputCurves,
+                            const Expression &expr)
+{
+    const QStringList vars = expr.variables();
+    const QStringList units = expr.variableUnits();
+    if ( inputCurves.size() != vars.size() ) {
+        _err_stream << "koviz [bad scoobs]: ExpressionModel::_init() "
+                       "expected " << vars.size() << " input curves, got "
+                    << inputCurves.size() << "\n";
+        throw std::runtime_error(_err_string.toLatin1().constData());
+    }
+
+    if ( !inputCurves.isEmpty() ) {
+        _timeParam.setName(inputCurves.at(0)->t()->name());
+        _timeParam.setUnit(inputCurves.at(0)->t()->unit());
+    }
+
+    // Read inputs, converted to the units given in the expression
+    QList<QVector<double> > ts;
+    QList<QVector<double> > ys;
+    for ( int i = 0; i < inputCurves.size(); ++i ) {
+        CurveModel* curveModel = inputCurves.at(i);
+        QString fromUnit = curveModel->y()->unit();
+        QString toUnit = units.at(i);
+        double sf = 1.0;
+        double bias = 0.0;
+        if ( !toUnit.isEmpty() && toUnit != fromUnit ) {
+            if ( !Unit::canConvert(fromUnit,toUnit) ) {
+                _err_stream << "koviz [error]: cannot convert "
+                            << vars.at(i) << " from {" << fromUnit
+                            << "} to {" << toUnit << "} in expression:\n\n"
+                            << "    " << expr.text() << "\n";
+                throw std::runtime_error(_err_string.toLatin1().constData());
+            }
+            UnitConversion uc = Unit::conversion(fromUnit,toUnit);
+            sf = uc.scale;
+            bias = uc.bias;
+        }
+
+        curveModel->map();
+        QVector<double> t;
+        QVector<double> y;
+        t.reserve(curveModel->rowCount());
+        y.reserve(curveModel->rowCount());
+        ModelIterator* it = curveModel->begin();
+        while ( !it->isDone() ) {
+            t.append(it->t());
+            y.append(it->y()*sf+bias);
+            it->next();
+        }
+        delete it;
+        curveModel->unmap();
+
+        ts.append(t);
+        ys.append(y);
+    }
+
+    QVector<double> timeStamps = ProgramModel::timeline(ts);
+    _nrows = timeStamps.size();
+    _data.resize(2*_nrows);
+    double* times = _data.data();
+    double* out = _data.data() + _nrows;
+    for ( int row = 0; row < _nrows; ++row ) {
+        times[row] = timeStamps.at(row);
+    }
+
+    // Inputs already on the timeline are used in place
+    QList<QVector<double> > resampled;
+    QVector<const double*> inputs;
+    for ( int i = 0; i < ts.size(); ++i ) {
+        if ( ts.at(i) == timeStamps ) {
+            inputs.append(ys.at(i).constData());
+        } else {
+            QVector<double> y(_nrows);
+            ProgramModel::interpolate(ts.at(i),ys.at(i),
+                                      times,_nrows,y.data());
+            resampled.append(y);
+            inputs.append(y.constData());  // shared with resampled
+        }
+    }
+
+    if ( inputs.isEmpty() ) {
+        // Constant expression, no timeline to put it on
+        return;
+    }
+
+    QList<int> chunks;
+    for ( int row = 0; row < _nrows; row += _chunkSize ) {
+        chunks.append(row);
+    }
+    QtConcurrent::blockingMap(chunks,ExpressionChunkEvaluator(&expr,&inputs,
+                                                              out,_nrows));
+}
+
+const Parameter* ExpressionModel::param(int col) const
+{
+    if ( col == 0 ) {
+        return &_timeParam;
+    } else if ( col == 1 ) {
+        return &_valueParam;
+    }
+    return 0;
+}
+
+int ExpressionModel::paramColumn(const QString &paramName) const
+{
+    if ( paramName == _timeParam.name() ) {
+        return 0;
+    } else if ( paramName == _valueParam.name() ) {
+        return 1;
+    }
+    return -1;
+}
+
+ModelIterator *ExpressionModel::begin(int tcol, int xcol, int ycol) const
+{
+    return new ExpressionModelIterator(0,this,tcol,xcol,ycol);
+}
+
+// Index of the time stamp closest to time
+int ExpressionModel::indexAtTime(double time)
+{
+    if ( _nrows == 0 ) {
+        return 0;
+    }
+    const double* times = _data.constData();
+    const double* it = std::lower_bound(times,times+_nrows,time);
+    int i = it - times;
+    if ( i >= _nrows ) {
+        return _nrows-1;
+    }
+    if ( i > 0 && qAbs(time-times[i-1]) <= qAbs(times[i]-time) ) {
+        return i-1;
+    }
+    return i;
+}
+
+int ExpressionModel::rowCount(const QModelIndex &pidx) const
+{
+    if ( ! pidx.isValid() ) {
+        return _nrows;
+    } else {
+        return 0;
+    }
+}
+
+int ExpressionModel::columnCount(const QModelIndex &pidx) const
+{
+    if ( ! pidx.isValid() ) {
+        return 2;
+    } else {
+        return 0;
+    }
+}
+
+QVariant ExpressionModel::data(const QModelIndex &idx, int role) const
+{
+    Q_UNUSED(role);
+    QVariant val;
+
+    if ( idx.isValid() && idx.row() < _nrows && idx.column() < 2 ) {
+        val = _data.at(idx.column()*_nrows+idx.row());
+    }
+
+    return val;
+}
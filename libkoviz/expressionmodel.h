@@ -0,0 +1,131 @@
+#ifndef EXPRESSION_MODEL_H
+#define EXPRESSION_MODEL_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include <QTextStream>
+#include <stdexcept>
+
+#include "datamodel.h"
+#include "parameter.h"
+#include "curvemodel.h"
+#include "expression.h"
+
+class ExpressionModel;
+class ExpressionModelIterator;
+
+//
+// Derived variable computed from an Expression over logged curves
+//
+// Two columns, time and the expression value.  Inputs logged at
+// different rates are merged onto one timeline the same way as DP
+// programs (see ProgramModel).  Rows are evaluated in parallel chunks.
+//
+class ExpressionModel : public DataModel
+{
+  Q_OBJECT
+
+  friend class ExpressionModelIterator;
+
+  public:
+
+    // inputCurves line up with expr.variables()
+    explicit ExpressionModel(const QList<CurveModel*>& inputCurves,
+                             const Expression& expr,
+                             const QString& name,
+                             const QString& unit,
+                             const QStringList &timeNames,
+                             const QString &fileName,
+                             QObject *parent = 0);
+    ~ExpressionModel();
+
+    virtual const Parameter* param(int col) const ;
+    virtual void map() {}
+    virtual void unmap() {}
+    virtual int paramColumn(const QString& paramName) const ;
+    virtual ModelIterator* begin(int tcol, int xcol, int ycol) const ;
+    virtual int indexAtTime(double time);
+
+    virtual int rowCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual int columnCount(const QModelIndex & pidx = QModelIndex() ) const;
+    virtual QVariant data (const QModelIndex & index,
+                           int role = Qt::DisplayRole ) const;
+
+  private:
+
+    int _nrows;
+    Parameter _timeParam;
+    Parameter _valueParam;
+    QVector<double> _data;   // column major, _data[col*_nrows+row]
+
+    void _init(const QList<CurveModel *> &inputCurves,
+               const Expression& expr);
+
+    static QString _err_string;
+    static QTextStream _err_stream;
+};
+
+class ExpressionModelIterator : public ModelIterator
+{
+  public:
+
+    inline ExpressionModelIterator(int row, const ExpressionModel* model,
+                                   int tcol, int xcol, int ycol):
+        i(row),
+        _model(model),
+        _t(model->_data.constData()+tcol*model->_nrows),
+        _x(model->_data.constData()+xcol*model->_nrows),
+        _y(model->_data.constData()+ycol*model->_nrows)
+    {
+    }
+
+    virtual ~ExpressionModelIterator() {}
+
+    virtual void start()
+    {
+        i = 0;
+    }
+
+    virtual void next()
+    {
+        ++i;
+    }
+
+    virtual bool isDone() const
+    {
+        return ( i >= _model->_nrows ) ;
+    }
+
+    virtual ExpressionModelIterator* at(int n)
+    {
+        i = n;
+        return this;
+    }
+
+    inline double t() const
+    {
+        return _t[i];
+    }
+
+    inline double x() const
+    {
+        return _x[i];
+    }
+
+    inline double y() const
+    {
+        return _y[i];
+    }
+
+  private:
+
+    int i;
+    const ExpressionModel* _model;
+    const double* _t;
+    const double* _x;
+    const double* _y;
+};
+
+#endif // EXPRESSION_MODEL_H
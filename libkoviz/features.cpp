@@ -0,0 +1,420 @@
+#include "features.h"
+
+#include <QtConcurrentMap>
+
+Feature::Feature() :
+    _kind(Max),
+    _arg(0.0)
+{
+}
+
+Feature::Feature(Kind kind, const QString &var, double arg) :
+    _kind(kind),
+    _var(var),
+    _arg(arg)
+{
+}
+
+void Feature::_error(const QString &spec, const QString &msg)
+{
+    QString errString;
+    QTextStream errStream(&errString);
+    errStream << "koviz [error]: bad run feature \"" << spec << "\", "
+              << msg << "\n";
+    errStream.flush();
+    throw std::runtime_error(errString.toLatin1().constData());
+}
+
+// In order of Kind
+QStringList Feature::kindNames()
+{
+    QStringList names;
+    names << "max" << "min" << "final" << "mean" << "rms"
+          << "tmax" << "tmin" << "tcross" << "at";
+    return names;
+}
+
+Feature Feature::parse(const QString &spec)
+{
+    QString s = spec.trimmed();
+    int open = s.indexOf('(');
+    int kindIdx = kindNames().indexOf(s.left(open).trimmed());
+    if ( open < 1 || !s.endsWith(')') || kindIdx < 0 ) {
+        _error(spec,QString("use one of %1(var) where tcross and at take "
+                            "a second argument e.g. tcross(var,100.0)")
+                            .arg(kindNames().join("(var) ")));
+    }
+    Kind kind = (Kind)kindIdx;
+    QString var = s.mid(open+1,s.size()-open-2).trimmed();
+    double arg = 0.0;
+
+    if ( kind == Crossing || kind == AtTime ) {
+        // Last comma outside of parens, var may be an expression
+        int comma = -1;
+        int depth = 0;
+        for ( int i = 0; i < var.size(); ++i ) {
+            if ( var.at(i) == '(' ) {
+                ++depth;
+            } else if ( var.at(i) == ')' ) {
+                --depth;
+            } else if ( var.at(i) == ',' && depth == 0 ) {
+                comma = i;
+            }
+        }
+        bool ok = false;
+        if ( comma > 0 ) {
+            arg = var.mid(comma+1).trimmed().toDouble(&ok);
+            var = var.left(comma).trimmed();
+        }
+        if ( !ok ) {
+            _error(spec,"second argument should be a number");
+        }
+    }
+
+    if ( var.isEmpty() ) {
+        _error(spec,"no variable");
+    }
+
+    return Feature(kind,var,arg);
+}
+
+QStringList Feature::splitSpecs(const QString &specs)
+{
+    QStringList list;
+    QString spec;
+    int depth = 0;
+    for ( int i = 0; i < specs.size(); ++i ) {
+        QChar c = specs.at(i);
+        if ( c == '(' ) {
+            ++depth;
+        } else if ( c == ')' ) {
+            --depth;
+        }
+        if ( c == ',' && depth == 0 ) {
+            if ( !spec.trimmed().isEmpty() ) {
+                list << spec.trimmed();
+            }
+            spec.clear();
+        } else {
+            spec.append(c);
+        }
+    }
+    if ( !spec.trimmed().isEmpty() ) {
+        list << spec.trimmed();
+    }
+    return list;
+}
+
+QString Feature::spec() const
+{
+    QString name = kindNames().at(_kind);
+    if ( _kind == Crossing || _kind == AtTime ) {
+        return QString("%1(%2,%3)").arg(name).arg(_var)
+                                   .arg(QString::number(_arg,'g',15));
+    }
+    return QString("%1(%2)").arg(name).arg(_var);
+}
+
+double Feature::compute(CurveModel *curveModel) const
+{
+    double ys = curveModel->y()->scale();
+    double yb = curveModel->y()->bias();
+
+    double val = NAN;
+    double ext = NAN;   // max or min so far
+    int n = 0;
+    double sum = 0.0;
+    double tPrev = 0.0;
+    double yPrev = 0.0;
+
+    curveModel->map();
+    ModelIterator* it = curveModel->begin();
+    while ( !it->isDone() ) {
+        double t = it->t();
+        double y = it->y()*ys+yb;
+        if ( _kind == AtTime ) {
+            if ( t == _arg ) {
+                val = y;
+                break;
+            } else if ( t > _arg ) {
+                if ( n > 0 ) {
+                    val = yPrev + (_arg-tPrev)*(y-yPrev)/(t-tPrev);
+                }
+                break;
+            }
+        } else if ( _kind == Crossing ) {
+            double d = y-_arg;
+            if ( d == 0.0 ) {
+                val = t;
+                break;
+            } else if ( n > 0 && (yPrev-_arg)*d < 0.0 ) {
+                val = tPrev + (_arg-yPrev)*(t-tPrev)/(y-yPrev);
+                break;
+            }
+        } else if ( _kind == Final ) {
+            val = y;
+        } else if ( _kind == Max || _kind == TimeOfMax ) {
+            if ( n == 0 || y > ext ) {
+                ext = y;
+                val = ( _kind == Max ) ? y : t;
+            }
+        } else if ( _kind == Min || _kind == TimeOfMin ) {
+            if ( n == 0 || y < ext ) {
+                ext = y;
+                val = ( _kind == Min ) ? y : t;
+            }
+        } else if ( _kind == Mean ) {
+            sum += y;
+        } else if ( _kind == RMS ) {
+            sum += y*y;
+        }
+        tPrev = t;
+        yPrev = y;
+        ++n;
+        it->next();
+    }
+    delete it;
+    curveModel->unmap();
+
+    if ( n > 0 ) {
+        if ( _kind == Mean ) {
+            val = sum/n;
+        } else if ( _kind == RMS ) {
+            val = sqrt(sum/n);
+        }
+    }
+
+    return val;
+}
+
+// Features of one run that were not in the cache
+class FeatureRun
+{
+  public:
+    QList<CurveModel*> curves;
+    QList<int> features;         // index of feature of each curve
+    QVector<double> values;
+};
+
+class FeatureRunner
+{
+  public:
+    FeatureRunner(const QList<Feature>* features) : _features(features) {}
+
+    void operator()(FeatureRun& run)
+    {
+        run.values.resize(run.curves.size());
+        for ( int k = 0; k < run.curves.size(); ++k ) {
+            const Feature& feature = _features->at(run.features.at(k));
+            run.values[k] = feature.compute(run.curves.at(k));
+        }
+    }
+
+  private:
+    const QList<Feature>* _features;
+};
+
+FeatureCache::FeatureCache(const QString &fileName) :
+    _fileName(fileName),
+    _isDirty(false)
+{
+    _load();
+}
+
+FeatureCache::~FeatureCache()
+{
+    save();
+}
+
+QString FeatureCache::defaultFileName(const QStringList &runDirs)
+{
+    if ( runDirs.isEmpty() ) {
+        return QString();
+    }
+    return QFileInfo(runDirs.at(0)).absolutePath() + "/.koviz_features";
+}
+
+void FeatureCache::_load()
+{
+    QFile file(_fileName);
+    if ( _fileName.isEmpty() ||
+         !file.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+        return;
+    }
+    QTextStream in(&file);
+    if ( in.readLine() != "koviz-features 1" ) {
+        return;  // Unknown version, will be overwritten
+    }
+    while ( !in.atEnd() ) {
+        QStringList fields = in.readLine().split('\t');
+        if ( fields.size() != 5 ) {
+            continue;
+        }
+        Entry entry;
+        entry.size = fields.at(2).toLongLong();
+        entry.mtime = fields.at(3).toLongLong();
+        entry.value = ( fields.at(4) == "nan" ) ? NAN
+                                                : fields.at(4).toDouble();
+        _entries.insert(fields.at(0) + "\t" + fields.at(1),entry);
+    }
+}
+
+bool FeatureCache::save()
+{
+    if ( !_isDirty || _fileName.isEmpty() ) {
+        return true;
+    }
+    QFile file(_fileName);
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                    QIODevice::Text) ) {
+        fprintf(stderr,"koviz [warning]: could not write feature cache %s\n",
+                _fileName.toLatin1().constData());
+        return false;
+    }
+    QTextStream out(&file);
+    out << "koviz-features 1\n";
+    QHash<QString,Entry>::const_iterator it = _entries.constBegin();
+    while ( it != _entries.constEnd() ) {
+        const Entry& entry = it.value();
+        out << it.key() << "\t" << entry.size << "\t" << entry.mtime << "\t";
+        if ( entry.value != entry.value ) {
+            out << "nan";
+        } else {
+            out << QString::number(entry.value,'g',17);
+        }
+        out << "\n";
+        ++it;
+    }
+    _isDirty = false;
+    return true;
+}
+
+QList<QVector<double> > FeatureCache::values(Runs *runs,
+                                             const QString &timeName,
+                                             const QList<Feature> &features)
+{
+    QStringList runDirs = runs->runDirs();
+    QList<QVector<double> > vals;
+    for ( int j = 0; j < features.size(); ++j ) {
+        vals.append(QVector<double>(runDirs.size(),NAN));
+    }
+
+    // Look up cache, curve models are created here since Runs is not
+    // thread safe
+    QList<FeatureRun> todo;
+    QList<int> todoRuns;
+    QList<QStringList> todoKeys;
+    QList<QList<Entry> > todoStats;
+    for ( int i = 0; i < runDirs.size(); ++i ) {
+        QString runDir = QFileInfo(runDirs.at(i)).absoluteFilePath();
+        FeatureRun run;
+        QStringList keys;
+        QList<Entry> stats;
+        for ( int j = 0; j < features.size(); ++j ) {
+            const Feature& feature = features.at(j);
+            CurveModel* curveModel = runs->curveModel(i,timeName,timeName,
+                                                      feature.var());
+            if ( !curveModel ) {
+                continue;
+            }
+            QFileInfo fi(curveModel->fileName());
+            Entry stat;
+            stat.size = -1;
+            stat.mtime = -1;
+            stat.value = NAN;
+            if ( fi.isFile() ) {
+                stat.size = fi.size();
+                stat.mtime = fi.lastModified().toMSecsSinceEpoch();
+            }
+            QString key = runDir + "\t" + feature.spec();
+            if ( stat.size >= 0 && _entries.contains(key) ) {
+                Entry entry = _entries.value(key);
+                if ( entry.size == stat.size && entry.mtime == stat.mtime ) {
+                    vals[j][i] = entry.value;
+                    delete curveModel;
+                    continue;
+                }
+            }
+            run.curves.append(curveModel);
+            run.features.append(j);
+            keys.append(key);
+            stats.append(stat);
+        }
+        if ( !run.curves.isEmpty() ) {
+            todo.append(run);
+            todoRuns.append(i);
+            todoKeys.append(keys);
+            todoStats.append(stats);
+        }
+    }
+
+    QtConcurrent::blockingMap(todo,FeatureRunner(&features));
+
+    for ( int r = 0; r < todo.size(); ++r ) {
+        const FeatureRun& run = todo.at(r);
+        int i = todoRuns.at(r);
+        for ( int k = 0; k < run.curves.size(); ++k ) {
+            double v = run.values.at(k);
+            vals[run.features.at(k)][i] = v;
+            Entry entry = todoStats.at(r).at(k);
+            if ( entry.size >= 0 ) {
+                entry.value = v;
+                _entries.insert(todoKeys.at(r).at(k),entry);
+                _isDirty = true;
+            }
+            delete run.curves.at(k);
+        }
+    }
+
+    return vals;
+}
+
+void FeatureCache::addColumns(QStandardItemModel *inputsModel,
+                              Runs *runs, const QString &timeName,
+                              const QStringList &specs)
+{
+    QList<Feature> features;
+    foreach ( QString spec, specs ) {
+        features.append(Feature::parse(spec));
+    }
+    if ( features.isEmpty() ) {
+        return;
+    }
+
+    QStringList runDirs = runs->runDirs();
+    FeatureCache cache(defaultFileName(runDirs));
+    QList<QVector<double> > vals = cache.values(runs,timeName,features);
+    cache.save();
+
+    QHash<int,int> runId2idx;
+    for ( int i = 0; i < runDirs.size(); ++i ) {
+        runId2idx.insert(Runs::runId(runDirs.at(i),i),i);
+    }
+
+    for ( int j = 0; j < features.size(); ++j ) {
+        QString header = features.at(j).spec();
+        int col = -1;
+        for ( int c = 0; c < inputsModel->columnCount(); ++c ) {
+            if ( inputsModel->headerData(c,Qt::Horizontal).toString()
+                 == header ) {
+                col = c;
+                break;
+            }
+        }
+        if ( col < 0 ) {
+            col = inputsModel->columnCount();
+            inputsModel->insertColumn(col);
+            inputsModel->setHeaderData(col,Qt::Horizontal,header);
+        }
+        for ( int r = 0; r < inputsModel->rowCount(); ++r ) {
+            int runId = inputsModel->data(inputsModel->index(r,0)).toInt();
+            int i = runId2idx.value(runId,-1);
+            double v = ( i >= 0 ) ? vals.at(j).at(i) : NAN;
+            QString s;
+            if ( v == v ) {
+                s = QString::number(v,'g',10);
+            }
+            inputsModel->setItem(r,col,new NumSortItem(s));
+        }
+    }
+}
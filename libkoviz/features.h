@@ -0,0 +1,106 @@
+#ifndef FEATURES_H
+#define FEATURES_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QStandardItemModel>
+#include <stdexcept>
+#include <math.h>
+
+#include "runs.h"
+#include "curvemodel.h"
+#include "numsortitem.h"
+
+//
+// Per run scalar of a variable e.g. "max(ball.state.out.position[1])"
+//
+//     max(v) min(v) final(v) mean(v) rms(v)
+//     tmax(v) tmin(v)     time of (first) max/min
+//     tcross(v,thresh)    time v first crosses thresh
+//     at(v,time)          v at time (interpolated)
+//
+class Feature
+{
+  public:
+    enum Kind { Max, Min, Final, Mean, RMS, TimeOfMax, TimeOfMin,
+                Crossing, AtTime };
+
+    Feature();
+    Feature(Kind kind, const QString& var, double arg = 0.0);
+
+    // Throws std::runtime_error if spec is bad
+    static Feature parse(const QString& spec);
+    static QStringList kindNames();
+
+    // Split on commas outside of parens e.g. "max(x),tcross(y,1)"
+    static QStringList splitSpecs(const QString& specs);
+
+    QString spec() const;
+    Kind kind() const { return _kind; }
+    QString var() const { return _var; }
+    double arg() const { return _arg; }
+
+    // NAN if curve has no value for feature (e.g. threshold not crossed)
+    double compute(CurveModel* curveModel) const;
+
+  private:
+    Kind _kind;
+    QString _var;
+    double _arg;
+
+    static void _error(const QString& spec, const QString& msg);
+};
+
+//
+// Features of runs, persisted to a cache file
+//
+// Entries are keyed by run and feature spec and are reused as long as the
+// run's data file has the same size and modification time, so after the
+// first pass over a MONTE the features come from the cache.  Runs missing
+// from the cache are computed in parallel, one task per run.
+//
+class FeatureCache
+{
+  public:
+    FeatureCache(const QString& fileName);
+    ~FeatureCache();
+
+    // Cache file kept alongside the runs e.g. MONTE_dir/.koviz_features
+    static QString defaultFileName(const QStringList& runDirs);
+
+    // Values of each feature, indexed like runs->runDirs()
+    QList<QVector<double> > values(Runs* runs, const QString& timeName,
+                                   const QList<Feature>& features);
+
+    // Adds (or replaces) a sortable column per feature in the monte
+    // inputs model.  Column 0 of the model is the RunId by convention.
+    static void addColumns(QStandardItemModel* inputsModel,
+                           Runs* runs, const QString& timeName,
+                           const QStringList& specs);
+
+    bool save();
+
+  private:
+    class Entry
+    {
+      public:
+        qint64 size;
+        qint64 mtime;
+        double value;
+    };
+
+    QString _fileName;
+    QHash<QString,Entry> _entries;   // key is "rundir\tspec"
+    bool _isDirty;
+
+    void _load();
+};
+
+#endif // FEATURES_H
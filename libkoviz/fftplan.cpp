@@ -0,0 +1,249 @@
+#include "fftplan.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <math.h>
+
+static const int _maxCachedPlans = 64;
+static QMutex _cacheMutex;
+static QHash<quint64,QSharedPointer<FFTPlan> > _cache;
+
+QSharedPointer<FFTPlan> FFTPlan::plan(size_t n)
+{
+    {
+        QMutexLocker locker(&_cacheMutex);
+        QHash<quint64,QSharedPointer<FFTPlan> >::const_iterator it =
+                                                      _cache.find((quint64)n);
+        if ( it != _cache.end() ) {
+            return it.value();
+        }
+    }
+
+    // Build outside the lock since Bluestein plans need an inner plan
+    QSharedPointer<FFTPlan> p(new FFTPlan(n));
+
+    QMutexLocker locker(&_cacheMutex);
+    if ( _cache.contains((quint64)n) ) {
+        return _cache.value((quint64)n);  // another thread beat us to it
+    }
+    if ( _cache.size() >= _maxCachedPlans ) {
+        // Plans in use stay alive through their shared pointers
+        _cache.clear();
+    }
+    _cache.insert((quint64)n,p);
+    return p;
+}
+
+void FFTPlan::clearCache()
+{
+    QMutexLocker locker(&_cacheMutex);
+    _cache.clear();
+}
+
+FFTPlan::FFTPlan(size_t n) :
+    _n(n),
+    _isRadix2(n > 0 && (n & (n-1)) == 0),
+    _m(0)
+{
+    size_t half = n/2;
+    _cos.resize((int)half+1);
+    _sin.resize((int)half+1);
+    for ( size_t k = 0; k <= half; ++k ) {
+        _cos[(int)k] = cos(2*M_PI*k/n);
+        _sin[(int)k] = sin(2*M_PI*k/n);
+    }
+
+    if ( n < 2 ) {
+        return;
+    }
+
+    if ( _isRadix2 ) {
+        int levels = 0;
+        for ( size_t temp = n; temp > 1U; temp >>= 1 ) {
+            levels++;
+        }
+        _bitrev.resize((int)n);
+        for ( size_t i = 0; i < n; ++i ) {
+            size_t x = i;
+            size_t r = 0;
+            for ( int j = 0; j < levels; ++j, x >>= 1 ) {
+                r = (r << 1) | (x & 1U);
+            }
+            _bitrev[(int)i] = (int)r;
+        }
+        return;
+    }
+
+    // Bluestein, convolution length m >= 2n+1
+    _m = 1;
+    while ( _m/2 <= n ) {
+        _m *= 2;
+    }
+    _inner = FFTPlan::plan(_m);
+
+    _chirpCos.resize((int)n);
+    _chirpSin.resize((int)n);
+    for ( size_t i = 0; i < n; ++i ) {
+        unsigned long long temp = (unsigned long long)i*i;
+        temp %= (unsigned long long)n*2;
+        double angle = M_PI*temp/n;
+        _chirpCos[(int)i] = cos(angle);
+        _chirpSin[(int)i] = sin(angle);
+    }
+
+    _bReal.fill(0.0,(int)_m);
+    _bImag.fill(0.0,(int)_m);
+    _bReal[0] = _chirpCos[0];
+    _bImag[0] = _chirpSin[0];
+    for ( size_t i = 1; i < n; ++i ) {
+        _bReal[(int)i] = _bReal[(int)(_m-i)] = _chirpCos[(int)i];
+        _bImag[(int)i] = _bImag[(int)(_m-i)] = _chirpSin[(int)i];
+    }
+    _inner->transform(_bReal.data(),_bImag.data());
+}
+
+void FFTPlan::transform(double *real, double *imag) const
+{
+    if ( _n < 2 ) {
+        return;
+    }
+    if ( _isRadix2 ) {
+        _radix2(real,imag);
+    } else {
+        _bluestein(real,imag);
+    }
+}
+
+void FFTPlan::inverseTransform(double *real, double *imag) const
+{
+    transform(imag,real);
+}
+
+void FFTPlan::_radix2(double *real, double *imag) const
+{
+    size_t n = _n;
+
+    for ( size_t i = 0; i < n; ++i ) {
+        size_t j = (size_t)_bitrev.at((int)i);
+        if ( j > i ) {
+            double temp = real[i];
+            real[i] = real[j];
+            real[j] = temp;
+            temp = imag[i];
+            imag[i] = imag[j];
+            imag[j] = temp;
+        }
+    }
+
+    const double* cosTable = _cos.constData();
+    const double* sinTable = _sin.constData();
+    for ( size_t size = 2; size <= n; size *= 2 ) {
+        size_t halfsize = size/2;
+        size_t tablestep = n/size;
+        for ( size_t i = 0; i < n; i += size ) {
+            for ( size_t j = i, k = 0; j < i+halfsize; j++, k += tablestep ) {
+                size_t l = j + halfsize;
+                double tpre =  real[l]*cosTable[k] + imag[l]*sinTable[k];
+                double tpim = -real[l]*sinTable[k] + imag[l]*cosTable[k];
+                real[l] = real[j] - tpre;
+                imag[l] = imag[j] - tpim;
+                real[j] += tpre;
+                imag[j] += tpim;
+            }
+        }
+        if ( size == n ) {
+            break;
+        }
+    }
+}
+
+void FFTPlan::_bluestein(double *real, double *imag) const
+{
+    size_t n = _n;
+    size_t m = _m;
+    const double* c = _chirpCos.constData();
+    const double* s = _chirpSin.constData();
+
+    QVector<double> areal((int)m,0.0);
+    QVector<double> aimag((int)m,0.0);
+    double* ar = areal.data();
+    double* ai = aimag.data();
+    for ( size_t i = 0; i < n; ++i ) {
+        ar[i] =  real[i]*c[i] + imag[i]*s[i];
+        ai[i] = -real[i]*s[i] + imag[i]*c[i];
+    }
+
+    // Convolve with the chirp using its cached spectrum
+    _inner->transform(ar,ai);
+    const double* br = _bReal.constData();
+    const double* bi = _bImag.constData();
+    for ( size_t i = 0; i < m; ++i ) {
+        double temp = ar[i]*br[i] - ai[i]*bi[i];
+        ai[i] = ai[i]*br[i] + ar[i]*bi[i];
+        ar[i] = temp;
+    }
+    _inner->inverseTransform(ar,ai);
+
+    for ( size_t i = 0; i < n; ++i ) {
+        double cr = ar[i]/m;
+        double ci = ai[i]/m;
+        real[i] =  cr*c[i] + ci*s[i];
+        imag[i] = -cr*s[i] + ci*c[i];
+    }
+}
+
+// Pack even/odd samples as z[k] = x[2k] + i*x[2k+1], take the n/2 point
+// transform and untangle the two real spectra.  Odd n falls back to
+// the complex transform.
+void FFTPlan::transformReal(const double *x, size_t n,
+                            double *real, double *imag)
+{
+    if ( n == 0 ) {
+        return;
+    }
+
+    if ( n % 2 != 0 || n < 4 ) {
+        for ( size_t i = 0; i < n; ++i ) {
+            real[i] = x[i];
+            imag[i] = 0.0;
+        }
+        FFTPlan::plan(n)->transform(real,imag);
+        return;
+    }
+
+    size_t h = n/2;
+    QVector<double> zr((int)h);
+    QVector<double> zi((int)h);
+    for ( size_t k = 0; k < h; ++k ) {
+        zr[(int)k] = x[2*k];
+        zi[(int)k] = x[2*k+1];
+    }
+    FFTPlan::plan(h)->transform(zr.data(),zi.data());
+
+    QSharedPointer<FFTPlan> p = FFTPlan::plan(n);
+    const double* w_cos = p->_cos.constData();
+    const double* w_sin = p->_sin.constData();
+    for ( size_t k = 0; k <= h; ++k ) {
+        size_t k1 = k % h;
+        size_t k2 = (h-k) % h;
+        double ar = zr.at((int)k1);
+        double ai = zi.at((int)k1);
+        double br = zr.at((int)k2);   // conj(Z[h-k])
+        double bi = -zi.at((int)k2);
+
+        double er = 0.5*(ar+br);      // even samples spectrum
+        double ei = 0.5*(ai+bi);
+        double or_ = 0.5*(ai-bi);     // odd samples spectrum
+        double oi = -0.5*(ar-br);
+
+        double c = w_cos[k];
+        double s = w_sin[k];
+        real[k] = er + c*or_ + s*oi;
+        imag[k] = ei + c*oi - s*or_;
+    }
+    for ( size_t k = 1; k < h; ++k ) {
+        real[n-k] =  real[k];
+        imag[n-k] = -imag[k];
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QSharedPointer>
+#include <stddef.h>
+
+//
+// Precomputed tables for an FFT of size n
+//
+// Plans are immutable once built and shared through a size keyed cache,
+// so repeated transforms of the same length (e.g. all curves in a RUN)
+// skip the trig tables, bit reversal and, for non power of 2 sizes, the
+// Bluestein chirp and its spectrum.  transform() may be called from
+// several threads at once.
+//
+// Same conventions as fft.h: forward is exp(-2*pi*i*j*k/n), unscaled.
+//
+class FFTPlan
+{
+  public:
+    static QSharedPointer<FFTPlan> plan(size_t n);   // cached
+    static void clearCache();
+
+    size_t size() const { return _n; }
+
+    void transform(double* real, double* imag) const;
+    void inverseTransform(double* real, double* imag) const;
+
+    // Full n point spectrum of real x via an n/2 point complex transform
+    // when n is even
+    static void transformReal(const double* x, size_t n,
+                              double* real, double* imag);
+
+  private:
+    FFTPlan(size_t n);
+
+    size_t _n;
+    bool _isRadix2;
+    QVector<double> _cos;       // cos(2*pi*k/n), k=0..n/2
+    QVector<double> _sin;
+    QVector<int> _bitrev;       // radix-2 only
+
+    // Bluestein
+    size_t _m;                  // power-of-2 convolution length
+    QVector<double> _chirpCos;  // cos(pi*k*k/n)
+    QVector<double> _chirpSin;
+    QVector<double> _bReal;     // spectrum of chirp, size m
+    QVector<double> _bImag;
+    QSharedPointer<FFTPlan> _inner;
+
+    void _radix2(double* real, double* imag) const;
+    void _bluestein(double* real, double* imag) const;
+};
+
+#endif // FFTPLAN_H
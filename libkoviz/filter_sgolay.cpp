@@ -3,17 +3,18 @@
 // Credit: https://raw.githubusercontent.com/thatchristoph/vmd-cvs-github
 //               /master/plugins/signalproc/src/sgsmooth.C
 //
-// Sliding window signal processing (and linear algebra toolkit).
+// Sliding window signal processing.
 //
 // supported operations:
 // <ul>
 // <li> Savitzky-Golay smoothing.
 // <li> computing a numerical derivative based of Savitzky-Golay smoothing.
-// <li> required linear algebra support for SG smoothing using STL based
-//      vector/matrix classes 
 // </ul>
 //
-// \brief Linear Algebra "Toolkit".
+// Both are a convolution with coefficients that only depend on the
+// window width, polynomial degree and derivative order.  Coefficient
+// tables are built once per (width,degree,order) from a discrete
+// orthonormal polynomial basis and shared by all curves and threads.
 //
 
 // system headers
@@ -21,16 +22,14 @@
 #include <stddef.h>             // for size_t
 #include <math.h>               // for fabs  
 #include <vector>
+#include <map>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "filter_sgolay.h"
 
-//! default convergence
-static const double TINY_FLOAT = 1.0e-300;
-
 //! comfortable array of doubles
 typedef std::vector<double> float_vect;
-//! comfortable array of ints;
-typedef std::vector<int>    int_vect;
 
 // savitzky golay smoothing.
 static float_vect sg_smooth(const float_vect &v, const int w, const int deg);
@@ -96,359 +95,206 @@ extern "C" double *calc_sgsderiv(const int ndat, double *input,
     return input;
 }
 
-/*! matrix class.
+/*! \brief Savitzky-Golay coefficient table.
+ *
+ * q holds an orthonormal polynomial basis (degree 0..deg) sampled at the
+ * 2w+1 window positions and qd its order'th derivative with respect to
+ * the sample index, both row major with deg+1 columns.  The least
+ * squares fit of window data b evaluated at position p is then
  *
- * This is a matrix class derived from a vector of float_vects.  Note that
- * the matrix elements indexed [row][column] with indices starting at 0 (c
- * style). Also note that because of its design looping through rows should
- * be faster than looping through columns.  
+ *     sum_m qd[p][m] * sum_j q[j][m]*b[j]
  *
- * \brief two dimensional floating point array
- */
-class float_mat : public std::vector<float_vect> {
-private:
-    //! disable the default constructor
-    explicit float_mat() {};
-    //! disable assignment operator until it is implemented.
-    float_mat &operator =(const float_mat &) { return *this; };
-public:
-    //! constructor with sizes
-    float_mat(const size_t rows, const size_t cols, const double def=0.0);
-    //! copy constructor for matrix
-    float_mat(const float_mat &m);
-    //! copy constructor for vector
-    float_mat(const float_vect &v);
-
-    //! use default destructor
-    // ~float_mat() {};
-
-    //! get size
-    size_t nr_rows(void) const { return size(); };
-    //! get size
-    size_t nr_cols(void) const { return front().size(); };
+ * and center holds those weights for the middle of the window. */
+struct sg_table {
+    int width;
+    int deg;
+    int order;
+    float_vect q;
+    float_vect qd;
+    float_vect center;
 };
 
-
-
-// constructor with sizes
-float_mat::float_mat(const size_t rows,const size_t cols,const double defval) 
-        : std::vector<float_vect>(rows) {
-    unsigned int i;
-    for (i = 0; i < rows; ++i) {
-        (*this)[i].resize(cols, defval);
-    }
-    if ((rows < 1) || (cols < 1)) {
-        char buffer[1024];
-        
-        sprintf(buffer, "cannot build matrix with %lu rows and %lu columns\n",
-                rows, cols);
-        sgs_error(buffer);
-    }
-}
-
-// copy constructor for matrix
-float_mat::float_mat(const float_mat &m) : std::vector<float_vect>(m.size()) {
-                
-    float_mat::iterator inew = begin();
-    float_mat::const_iterator iold = m.begin();
-    for (/* empty */; iold < m.end(); ++inew, ++iold) {
-        const size_t oldsz = iold->size();
-        inew->resize(oldsz);
-        const float_vect oldvec(*iold);
-        *inew = oldvec;
-    }
-}
-
-// copy constructor for vector
-float_mat::float_mat(const float_vect &v) 
-        : std::vector<float_vect>(1) {
-
-    const size_t oldsz = v.size();
-    front().resize(oldsz);
-    front() = v;
-}
-
-//////////////////////
-// Helper functions //
-//////////////////////
-
-//! permute() orders the rows of A to match the integers in the index array.
-void permute(float_mat &A, int_vect &idx) 
+static sg_table *sg_build_table(const int width, const int deg,
+                                const int order)
 {
-    int_vect i(idx.size());
-    unsigned int j,k;
-    
-    for (j = 0; j < A.nr_rows(); ++j) {
-        i[j] = j;
-    }
-  
-    // loop over permuted indices
-    for (j = 0; j < A.nr_rows(); ++j) { 
-        if (i[j] != idx[j]) {
-
-            // search only the remaining indices
-            for (k = j+1; k < A.nr_rows(); ++k) { 
-                if (i[k] ==idx[j]) {
-                    std::swap(A[j],A[k]); // swap the rows and
-                    i[k] = i[j];     // the elements of
-                    i[j] = idx[j];   // the ordered index.
-                    break; // next j
+    const int window = 2 * width + 1;
+    const int ncols = deg + 1;
+
+    sg_table *t = new sg_table;
+    t->width = width;
+    t->deg = deg;
+    t->order = order;
+    t->q.assign(window * ncols, 0.0);
+    t->qd.assign(window * ncols, 0.0);
+    t->center.assign(window, 0.0);
+
+    // Positions are centered and scaled to [-1,1] for conditioning
+    const double s = double(width);
+    float_vect u(window);
+    int i,j,k,m;
+    for (i = 0; i < window; ++i) {
+        u[i] = (i - width) / s;
+    }
+
+    // Gram-Schmidt on 1,u,u^2... keeping each basis polynomial's
+    // coefficients (coef[m*ncols+k] is the u^k coefficient of q_m)
+    float_vect coef(ncols * ncols, 0.0);
+    float_vect p(window);
+    float_vect pc(ncols);
+    for (m = 0; m < ncols; ++m) {
+        double norm0 = 0.0;
+        for (i = 0; i < window; ++i) {
+            p[i] = pow(u[i], double(m));
+            norm0 += p[i] * p[i];
+        }
+        norm0 = sqrt(norm0);
+        pc.assign(ncols, 0.0);
+        pc[m] = 1.0;
+
+        for (int pass = 0; pass < 2; ++pass) {  // twice for stability
+            for (k = 0; k < m; ++k) {
+                double dot = 0.0;
+                for (i = 0; i < window; ++i) {
+                    dot += p[i] * t->q[i * ncols + k];
+                }
+                for (i = 0; i < window; ++i) {
+                    p[i] -= dot * t->q[i * ncols + k];
+                }
+                for (j = 0; j < ncols; ++j) {
+                    pc[j] -= dot * coef[k * ncols + j];
                 }
             }
         }
-    }
-}
-
-/*! \brief Implicit partial pivoting.  
- *
- * The function looks for pivot element only in rows below the current
- * element, A[idx[row]][column], then swaps that row with the current one in
- * the index map. The algorithm is for implicit pivoting (i.e., the pivot is
- * chosen as if the max coefficient in each row is set to 1) based on the
- * scaling information in the vector scale. The map of swapped indices is
- * recorded in swp. The return value is +1 or -1 depending on whether the
- * number of row swaps was even or odd respectively. */
-static int partial_pivot(float_mat &A, const size_t row, const size_t col, 
-                         float_vect &scale, int_vect &idx, double tol)
-{
-    if (tol <= 0.0)
-        tol = TINY_FLOAT;
 
-    int swapNum = 1;
-
-    // default pivot is the current position, [row,col]
-    unsigned int pivot = row;
-    double piv_elem = fabs(A[idx[row]][col]) * scale[idx[row]];
-
-    // loop over possible pivots below current
-    unsigned int j;
-    for (j = row + 1; j < A.nr_rows(); ++j) { 
-
-        const double tmp = fabs(A[idx[j]][col]) * scale[idx[j]];  
-
-        // if this elem is larger, then it becomes the pivot 
-        if (tmp > piv_elem) {     
-            pivot = j;
-            piv_elem = tmp;
+        double norm = 0.0;
+        for (i = 0; i < window; ++i) {
+            norm += p[i] * p[i];
         }
-    }
-
-#if 0
-    if(piv_elem < tol) {
-        sgs_error("partial_pivot(): Zero pivot encountered.\n")
-#endif
-
-    if(pivot > row) {           // bring the pivot to the diagonal
-        j = idx[row];           // reorder swap array
-        idx[row] = idx[pivot];
-        idx[pivot] = j;
-        swapNum = -swapNum;     // keeping track of odd or even swap
-    }
-    return swapNum;
-}
-
-/*! \brief Perform backward substitution.
- *
- * Solves the system of equations A*b=a, ASSUMING that A is upper
- * triangular. If diag==1, then the diagonal elements are additionally
- * assumed to be 1.  Note that the lower triangular elements are never
- * checked, so this function is valid to use after a LU-decomposition in
- * place.  A is not modified, and the solution, b, is returned in a. */
-static void lu_backsubst(float_mat &A, float_mat &a, bool diag=false) 
-{
-    int r,c;
-    unsigned int k;
-    
-    for (r = (A.nr_rows() - 1); r >= 0; --r) {
-        for (c = (A.nr_cols() - 1); c > r; --c) {
-            for (k = 0; k < A.nr_cols(); ++k) {
-                a[r][k] -= A[r][c] * a[c][k];
-            }
+        norm = sqrt(norm);
+        if (norm <= 1.0e-10 * norm0) {
+            continue;  // degree too high for window, leave q_m zero
         }
-        if(!diag) {
-            for (k = 0; k < A.nr_cols(); ++k) {
-                a[r][k] /= A[r][r];
-            }
+        for (i = 0; i < window; ++i) {
+            t->q[i * ncols + m] = p[i] / norm;
         }
-    }
-}
-
-/*! \brief Perform forward substitution.
- *
- * Solves the system of equations A*b=a, ASSUMING that A is lower
- * triangular. If diag==1, then the diagonal elements are additionally
- * assumed to be 1.  Note that the upper triangular elements are never
- * checked, so this function is valid to use after a LU-decomposition in
- * place.  A is not modified, and the solution, b, is returned in a. */
-static void lu_forwsubst(float_mat &A, float_mat &a, bool diag=true) 
-{
-    unsigned int r,k,c;
-    for (r = 0;r < A.nr_rows(); ++r) {
-        for(c = 0; c < r; ++c) {
-            for (k = 0; k < A.nr_cols(); ++k) {
-                a[r][k] -= A[r][c] * a[c][k];
-            }
-        }
-        if(!diag) {
-            for (k = 0; k < A.nr_cols(); ++k) {
-                a[r][k] /= A[r][r];
-            }
+        for (j = 0; j < ncols; ++j) {
+            coef[m * ncols + j] = pc[j] / norm;
         }
     }
-}
-
-/*! \brief Performs LU factorization in place.  
- *
- * This is Crout's algorithm (cf., Num. Rec. in C, Section 2.3).  The map of
- * swapped indeces is recorded in idx. The return value is +1 or -1
- * depending on whether the number of row swaps was even or odd
- * respectively.  idx must be preinitialized to a valid set of indices
- * (e.g., {1,2, ... ,A.nr_rows()}). */
-static int lu_factorize(float_mat &A, int_vect &idx, double tol=TINY_FLOAT)
-{
-    if ( tol <= 0.0) 
-        tol = TINY_FLOAT;
-
-    if ((A.nr_rows() == 0) || (A.nr_rows() != A.nr_cols())) {
-        sgs_error("lu_factorize(): cannot handle empty "
-                  "or nonsquare matrices.\n");
-        
-        return 0;
-    }
 
-    float_vect scale(A.nr_rows());  // implicit pivot scaling
-    unsigned int i,j;
-    for (i = 0; i < A.nr_rows(); ++i) {
-        double maxval = 0.0;
-        for (j = 0; j < A.nr_cols(); ++j) {
-            if (fabs(A[i][j]) > maxval)
-                maxval = fabs(A[i][j]);
-        }
-        if (maxval == 0.0) {
-            sgs_error("lu_factorize(): zero pivot found.\n");
-            return 0;
+    // d^order/di^order of each basis polynomial, di = s*du
+    const double dscale = pow(s, -double(order));
+    for (i = 0; i < window; ++i) {
+        for (m = 0; m < ncols; ++m) {
+            double val = 0.0;
+            for (k = order; k < ncols; ++k) {
+                double c = coef[m * ncols + k];
+                for (j = 0; j < order; ++j) {
+                    c *= double(k - j);
+                }
+                val += c * pow(u[i], double(k - order));
+            }
+            t->qd[i * ncols + m] = val * dscale;
         }
-        scale[i] = 1.0 / maxval;
     }
 
-    int swapNum = 1;
-    unsigned int c,r;
-    for (c = 0; c < A.nr_cols() ; ++c) {            // loop over columns
-        swapNum *= partial_pivot(A, c, c, scale, idx, tol); // bring pivot to diagonal
-        for(r = 0; r < A.nr_rows(); ++r) {      //  loop over rows
-            unsigned int lim = (r < c) ? r : c;
-            for (j = 0; j < lim; ++j) {
-                A[idx[r]][c] -= A[idx[r]][j] * A[idx[j]][c];
-            }
-            if (r > c) 
-                A[idx[r]][c] /= A[idx[c]][c];
+    for (j = 0; j < window; ++j) {
+        double w = 0.0;
+        for (m = 0; m < ncols; ++m) {
+            w += t->qd[width * ncols + m] * t->q[j * ncols + m];
         }
+        t->center[j] = w;
     }
-    permute(A,idx);
-    return swapNum;
-}
 
-/*! \brief Solve a system of linear equations. 
- * Solves the inhomogeneous matrix problem with lu-decomposition. Note that
- * inversion may be accomplished by setting a to the identity_matrix. */
-static float_mat lin_solve(const float_mat &A, const float_mat &a, 
-                           double tol=TINY_FLOAT) 
-{
-    float_mat B(A);
-    float_mat b(a);
-    int_vect idx(B.nr_rows());
-    unsigned int j;
-    
-    for (j = 0; j < B.nr_rows(); ++j) {
-        idx[j] = j;  // init row swap label array
-    }
-    lu_factorize(B,idx,tol); // get the lu-decomp.
-    permute(b,idx);          // sort the inhomogeneity to match the lu-decomp
-    lu_forwsubst(B,b);       // solve the forward problem
-    lu_backsubst(B,b);       // solve the backward problem
-    return b;
+    return t;
 }
 
-///////////////////////
-// related functions //
-///////////////////////
+//! tables are small (3 * window * (deg+1) doubles) and kept for the run
+static QMutex sg_table_mutex;
+static std::map<std::pair<int, std::pair<int,int> >, sg_table *> sg_tables;
 
-//! Returns the inverse of a matrix using LU-decomposition. 
-static float_mat invert(const float_mat &A) 
+static const sg_table *sg_get_table(const int width, const int deg,
+                                    const int order)
 {
-    const int n = A.size();
-    float_mat E(n, n, 0.0);
-    float_mat B(A);
-    int i;
-
-    for (i = 0; i < n; ++i) {
-        E[i][i] = 1.0;
-    }
-
-    return lin_solve(B, E);
+    std::pair<int, std::pair<int,int> > key(width,
+                                            std::make_pair(deg, order));
+    QMutexLocker locker(&sg_table_mutex);
+    std::map<std::pair<int, std::pair<int,int> >, sg_table *>::iterator it =
+                                                         sg_tables.find(key);
+    if (it != sg_tables.end()) {
+        return it->second;
+    }
+    sg_table *t = sg_build_table(width, deg, order);
+    sg_tables[key] = t;
+    return t;
 }
 
-//! returns the transposed matrix.
-static float_mat transpose(const float_mat &a)
+//! dot product, four accumulators so the compiler can vectorize it
+static inline double sg_dot(const double *c, const double *v, const int n)
 {
-    float_mat res(a.nr_cols(), a.nr_rows());
-    unsigned int i,j;
-    
-    for (i = 0; i < a.nr_rows(); ++i) {
-        for (j = 0; j < a.nr_cols(); ++j) {
-            res[j][i] = a[i][j];
-        }
-    }
-    return res;
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        s0 += c[j]     * v[j];
+        s1 += c[j + 1] * v[j + 1];
+        s2 += c[j + 2] * v[j + 2];
+        s3 += c[j + 3] * v[j + 3];
+    }
+    for (; j < n; ++j) {
+        s0 += c[j] * v[j];
+    }
+    return (s0 + s1) + (s2 + s3);
 }
 
-//! matrix multiplication.
-float_mat operator *(const float_mat &a, const float_mat &b)
+/*! \brief convolve with a coefficient table.
+ *
+ * The first and last w outputs come from the fit to the first and last
+ * windows, the upper part fitted in reverse like the original sgsmooth.
+ * Derivatives are divided by h^order. */
+static float_vect sg_filter(const float_vect &v, const int width,
+                            const int deg, const int order, const double h)
 {
-    float_mat res(a.nr_rows(), b.nr_cols());
-    if (a.nr_cols() != b.nr_rows()) {
-        sgs_error("incompatible matrices in multiplication\n");
-        return res;
-    }
-
-    unsigned int i,j,k;
-    
-    for (i = 0; i < a.nr_rows(); ++i) {
-        for (j = 0; j < b.nr_cols(); ++j) {
-            double sum(0.0);
-            for (k = 0; k < a.nr_cols(); ++k) {
-                sum += a[i][k] * b[k][j];
-            }
-            res[i][j] = sum;
+    const sg_table *t = sg_get_table(width, deg, order);
+    const int n = v.size();
+    const int window = 2 * width + 1;
+    const int ncols = deg + 1;
+    const double hscale = 1.0 / pow(h, double(order));
+    const double sign = (order % 2 == 0) ? 1.0 : -1.0;
+    float_vect res(n, 0.0);
+    float_vect rv(window);
+    float_vect proj(ncols);
+    float_vect rproj(ncols);
+    int i,j,m;
+
+    for (j = 0; j < window; ++j) {
+        rv[j] = v[n - 1 - j];
+    }
+    for (m = 0; m < ncols; ++m) {
+        proj[m] = 0.0;
+        rproj[m] = 0.0;
+        for (j = 0; j < window; ++j) {
+            proj[m]  += t->q[j * ncols + m] * v[j];
+            rproj[m] += t->q[j * ncols + m] * rv[j];
         }
     }
-    return res;
-}
-
-
-//! calculate savitzky golay coefficients.
-static float_vect sg_coeff(const float_vect &b, const size_t deg)
-{
-    const size_t rows(b.size());
-    const size_t cols(deg + 1);
-    float_mat A(rows, cols);
-    float_vect res(rows);
-        
-    // generate input matrix for least squares fit
-    unsigned int i,j;
-    for (i = 0; i < rows; ++i) {
-        for (j = 0; j < cols; ++j) {
-            A[i][j] = pow(double(i), double(j));
+    for (i = 0; i < width; ++i) {
+        double lo = 0.0;
+        double hi = 0.0;
+        for (m = 0; m < ncols; ++m) {
+            lo += t->qd[i * ncols + m] * proj[m];
+            hi += t->qd[i * ncols + m] * rproj[m];
         }
+        res[i] = lo * hscale;
+        res[n - 1 - i] = sign * hi * hscale;
     }
 
-    float_mat c(invert(transpose(A) * A) * (transpose(A) * transpose(b)));
-
-    for (i = 0; i < b.size(); ++i) {
-        res[i] = c[0][0];
-        for (j = 1; j <= deg; ++j) {
-            res[i] += c[j][0] * pow(double(i), double(j));
-        }
+    const double *c = &t->center[0];
+    const double *x = &v[0];
+#if defined(_OPENMP)
+#pragma omp parallel for private(i) schedule(static)
+#endif
+    for (i = 0; i <= n - window; ++i) {
+        res[i + width] = sg_dot(c, x + i, window) * hscale;
     }
     return res;
 }
@@ -456,11 +302,9 @@ static float_vect sg_coeff(const float_vect &b, const size_t deg)
 /*! \brief savitzky golay smoothing.  
  *
  * This method means fitting a polynome of degree 'deg' to a sliding window
- * of width 2w+1 throughout the data.  The needed coefficients are
- * generated dynamically by doing a least squares fit on a "symmetric" unit
- * vector of size 2w+1, e.g. for w=2 b=(0,0,1,0,0). evaluating the polynome
- * yields the sg-coefficients.  at the border non symmectric vectors b are
- * used. */
+ * of width 2w+1 throughout the data.  Away from the borders this is a
+ * convolution with the "symmetric" coefficients.  at the border the fit
+ * to the first (last) window is evaluated off center. */
 float_vect sg_smooth(const float_vect &v, const int width, const int deg)
 {
     float_vect res(v.size(), 0.0);
@@ -495,81 +339,20 @@ float_vect sg_smooth(const float_vect &v, const int width, const int deg)
 #pragma omp parallel for private(i,j) schedule(static)
 #endif    
         for (i = 0; i <= (int)(v.size() - window); ++i) {
-            for (j = 0; j < window; ++j) {
-                res[i + width] += c2[j] * v[i + j];
-            } 
+            res[i + width] = sg_dot(&c2[0], &v[i], window);
         }
         return res;
     }
 
-    // handle border cases first because we need different coefficients
-#if defined(_OPENMP)
-#pragma omp parallel for private(i,j) schedule(static)
-#endif    
-    for (i = 0; i < width; ++i) {
-        float_vect b1(window, 0.0);
-        b1[i] = 1.0;
-
-        const float_vect c1(sg_coeff(b1, deg));
-        for (j = 0; j < window; ++j) {
-            res[i]          += c1[j] * v[j];
-            res[endidx - i] += c1[j] * v[endidx - j];
-        } 
-    }
-
-    // now loop over rest of data. reusing the "symmetric" coefficients.
-    float_vect b2(window, 0.0);
-    b2[width] = 1.0;
-    const float_vect c2(sg_coeff(b2, deg));
-
-#if defined(_OPENMP)
-#pragma omp parallel for private(i,j) schedule(static)
-#endif    
-    for (i = 0; i <= (int)(v.size() - window); ++i) {
-        for (j = 0; j < window; ++j) {
-            res[i + width] += c2[j] * v[i + j];
-        } 
-    }
-    return res;
-}
-
-/*! least squares fit a polynome of degree 'deg' to data in 'b'.
- *  then calculate the first derivative and return it. */
-static float_vect lsqr_fprime(const float_vect &b, const int deg)
-{
-    const int rows(b.size());
-    const int cols(deg + 1);
-    float_mat A(rows, cols);
-    float_vect res(rows);
-
-    // generate input matrix for least squares fit
-    int i,j;
-    for (i = 0; i < rows; ++i) {
-        for (j = 0; j < cols; ++j) {
-            A[i][j] = pow(double(i), double(j));
-        }
-    }
-
-    float_mat c(invert(transpose(A) * A) * (transpose(A) * transpose(b)));
-        
-    for (i = 0; i < (int)b.size(); ++i) {
-        res[i] = c[1][0];
-        for (j = 1; j < deg; ++j) {
-            res[i] += c[j + 1][0] * double(j+1)
-                * pow(double(i), double(j));
-        }
-    }
-    return res;
+    return sg_filter(v, width, deg, 0, 1.0);
 }
 
 /*! \brief savitzky golay smoothed numerical derivative.  
  *
  * This method means fitting a polynome of degree 'deg' to a sliding window
- * of width 2w+1 throughout the data.  
- *
- * In contrast to the sg_smooth function we do a brute force attempt by
- * always fitting the data to a polynome of degree 'deg' and using the
- * result. */
+ * of width 2w+1 throughout the data and taking the first derivative of
+ * the fit.  Like sg_smooth, only the coefficient table depends on the
+ * fit, so no least squares problem is solved per sample. */
 float_vect sg_derivative(const float_vect &v, const int width, 
                          const int deg, const double h)
 {
@@ -579,41 +362,7 @@ float_vect sg_derivative(const float_vect &v, const int width,
         return res;
     }
 
-    const int window = 2 * width + 1;
-
-    // handle border cases first because we do not repeat the fit
-    // lower part
-    float_vect b(window, 0.0);
-    int i,j;
-    
-    for (i = 0; i < window; ++i) {
-        b[i] = v[i] / h;
-    }
-    const float_vect c(lsqr_fprime(b, deg));
-    for (j = 0; j <= width; ++j) {
-        res[j] = c[j];
-    }
-    // upper part. direction of fit is reversed
-    for (i = 0; i < window; ++i) {
-        b[i] = v[v.size() - 1 - i] / h;
-    }
-    const float_vect d(lsqr_fprime(b, deg));
-    for (i = 0; i <= width; ++i) {
-        res[v.size() - 1 - i] = -d[i];
-    }
-
-    // now loop over rest of data. wasting a lot of least squares calcs
-    // since we only use the middle value.
-#if defined(_OPENMP)
-#pragma omp parallel for private(i,j) schedule(static)
-#endif    
-    for (i = 1; i < (int)(v.size() - window); ++i) {
-        for (j = 0; j < window; ++j) {
-            b[j] = v[i + j] / h;
-        }
-        res[i + width] = lsqr_fprime(b, deg)[width];
-    }
-    return res;
+    return sg_filter(v, width, deg, 1, h);
 }
 
 // Local Variables:
@@ -1,5 +1,8 @@
 #include "frame.h"
 
+#include <QVector>
+#include <algorithm>
+
 QString Frame::frame_sched_time = "trick_real_time.rt_sync.frame_sched_time";
 QString Frame::frame_overrun_time= "trick_real_time.rt_sync.frame_overrun_time";
 
@@ -47,24 +50,29 @@ void Frame::_calc_topjobs()
 {
     const int count = 10; // top ten for now
 
-    QHash<int,int> threadIdToTimeIdx;
+    if ( _jobs->isEmpty() ) {
+        return;
+    }
+
+    // Jobs logged in the same file share a row at this frame's timestamp
+    QHash<const RuntimeMatrix*,int> matrixToRow;
+
+    QVector<QPair<double,Job*> > rts;
+    rts.reserve(_jobs->size());
 
     double jcnt = 0.0 ;
     foreach ( Job* job, *_jobs ) {
 
-        int threadId = job->thread_id();
-        int tidx;
-        if ( threadIdToTimeIdx.contains(threadId) ) {
-            tidx = threadIdToTimeIdx.value(threadId);
+        const RuntimeMatrix* matrix = job->runtimeMatrix();
+        int row;
+        if ( matrixToRow.contains(matrix) ) {
+            row = matrixToRow.value(matrix);
         } else {
-            tidx = job->curve()->indexAtTime(_timestamp);
-            threadIdToTimeIdx.insert(threadId,tidx);
+            row = matrix->rowAtTime(_timestamp);
+            matrixToRow.insert(matrix,row);
         }
 
-        ModelIterator* it = job->curve()->begin();
-        double rt = it->at(tidx)->x()/1000000.0;
-        delete it;
-
+        double rt = job->runtime(row)/1000000.0;
         if ( rt < 0 ) {
             rt = 0.0;
         }
@@ -74,25 +82,15 @@ void Frame::_calc_topjobs()
             jcnt += 1.0;
         }
 
-        // List of top jobs with most runtime for the frame
-        int len = _topjobs.length();
-        if ( len < count ) {
-            _topjobs.append(qMakePair(rt,job));
-        } else {
-            if ( len == count ) {
-                qSort(_topjobs.begin(), _topjobs.end(), frameTopJobsGreaterThan);
-            }
-            QPair<double,Job*> ljob = _topjobs.last();
-            int ltidx = threadIdToTimeIdx.value(ljob.second->thread_id());
-            ModelIterator* it = ljob.second->curve()->begin();
-            double lrt = it->at(ltidx)->x()/1000000.0;
-            delete it;
-            if ( rt > lrt ) {
-                _topjobs.replace(len-1,qMakePair(rt,job));
-                qSort(_topjobs.begin(), _topjobs.end(), frameTopJobsGreaterThan);
-            }
-        }
+        rts.append(qMakePair(rt,job));
     }
     _jobloadindex = 100.0*jcnt/(double)_jobs->size();
-    qSort(_topjobs.begin(),_topjobs.end(),frameTopJobsGreaterThan);
+
+    // List of top jobs with most runtime for the frame
+    int n = qMin(count,rts.size());
+    std::partial_sort(rts.begin(),rts.begin()+n,rts.end(),
+                      frameTopJobsGreaterThan);
+    for ( int i = 0; i < n; ++i ) {
+        _topjobs.append(rts.at(i));
+    }
 }
@@ -1,6 +1,7 @@
 #include "job.h"
 
 #include <QRegExp>
+#include <QHash>
 #include <stdio.h>
 #include <cmath>
 #include <QtCore/qmath.h>
@@ -49,55 +50,50 @@ inline void Job::_do_stats()
         _is_stats  = true;
     }
 
-    if ( ! _curve ) {
+    if ( ! _matrix ) {
         // TODO: throw exception
         fprintf(stderr,"koviz [error]: Job::_do_stats() called without setting:");
-        fprintf(stderr," curve\n");
+        fprintf(stderr," runtime matrix\n");
         exit(-1);
     }
 
     long freq;
-    QMap<long,int> map_freq;
+    QHash<long,int> map_freq;
     long last_nonzero_timestamp = 0 ;
 
     long sum_squares = 0 ;
     long sum_rt = 0 ;
     long max_rt = 0 ;
-    ModelIterator* it = _curve->begin();
-    int cnt = 0;
-    while ( !it->isDone() ) {
+    int imax_rt = 0;
+    const double* times = _matrix->times();
+    const double* rts = _matrix->column(_col);
+    int cnt = _matrix->rowCount();
+    for ( int i = 0; i < cnt; ++i ) {
 
-        double time = it->t();
-        long rt = (long)it->y();
+        long rt = (long)rts[i];
 
         if ( rt < 0 ) {
-            rt =  0.0;
+            rt =  0;
         }
 
-        if ( cnt > 0 && rt > 0 ) {
-            freq = round_10((long)(time*1000000.0) - last_nonzero_timestamp);
-            long freq_cnt ;
-            if ( map_freq.contains(freq) ) {
-                freq_cnt = map_freq.value(freq)+1;
-            } else {
-                freq_cnt = 0;
-            }
-            map_freq.insert(freq,freq_cnt);
-            last_nonzero_timestamp = (long)(time*1000000.0);
+        if ( i > 0 && rt > 0 ) {
+            long timestamp = (long)(times[i]*1000000.0);
+            freq = round_10(timestamp - last_nonzero_timestamp);
+            ++map_freq[freq];
+            last_nonzero_timestamp = timestamp;
         }
 
         if ( rt > max_rt ) {
             max_rt = rt;
-            _max_timestamp = time;
+            imax_rt = i;
         }
 
         sum_squares += rt*rt;
         sum_rt += rt;
-
-        ++cnt;
-        it->next();
     }
-    delete it;
+    if ( max_rt > 0 ) {
+        _max_timestamp = times[imax_rt];
+    }
 
     double ss = (double)sum_squares;
     double s = (double)sum_rt;
@@ -111,16 +107,20 @@ inline void Job::_do_stats()
     // (re)Calculate job frequency
     //
     if ( _npoints > 1 ) {
-        int max_cnt = 0 ;
+        int max_cnt = 1 ;
+        long mode_freq = 0;
         double savedFreq = _freq;
         _freq = 0;
-        // Could be multiple frequencies - choose mode
-        foreach ( long freq, map_freq.keys() ) {
-            int cnt = map_freq.value(freq);
-            if ( cnt > max_cnt ) {
-                _freq = freq/1000000.0;
-                max_cnt = cnt;
+        // Could be multiple frequencies - choose mode (smallest on ties)
+        QHash<long,int>::const_iterator i = map_freq.constBegin();
+        while ( i != map_freq.constEnd() ) {
+            if ( i.value() > max_cnt ||
+                 (i.value() == max_cnt && max_cnt > 1 && i.key() < mode_freq)) {
+                mode_freq = i.key();
+                max_cnt = i.value();
+                _freq = mode_freq/1000000.0;
             }
+            ++i;
         }
 
         if ( _job_name == "trick_sys.sched.advance_sim_time" && _freq == 0 ) {
@@ -254,8 +254,9 @@ double Job::freq()
 // An example logname:
 // JOB_schedbus.SimBus##read_ALDS15_ObcsRouter_C1.1828.00(read_simbus_0.100)
 
-Job::Job(CurveModel* curve) :
-     _curve(curve),_npoints(0),_isFrameTimerJob(false),
+Job::Job(CurveModel *curve, const RuntimeMatrix *matrix, int col) :
+     _curve(curve),_matrix(matrix),_col(col),_npoints(0),
+     _isFrameTimerJob(false),
      _is_stats(false)
 {
     if ( !curve ) {
@@ -269,7 +270,7 @@ Job::Job(CurveModel* curve) :
 }
 
 Job::Job(const QString &jobId) :
-     _curve(0),_npoints(0),_isFrameTimerJob(false),
+     _curve(0),_matrix(0),_col(-1),_npoints(0),_isFrameTimerJob(false),
      _log_name(jobId),
      _is_stats(false)
 {
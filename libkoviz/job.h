@@ -7,6 +7,7 @@
 #include <stdexcept>
 
 #include "curvemodel.h"
+#include "runtimematrix.h"
 
 class Job;
 
@@ -18,7 +19,7 @@ class Job
   public:
     // job_id is logged job name
     // e.g. JOB_bus.SimBus##read_ObcsRouter_C1.1828.00(read_simbus_0.100)
-    Job(CurveModel* curve);
+    Job(CurveModel* curve, const RuntimeMatrix* matrix=0, int col=-1);
     Job(const QString& job_id);
 
     bool isFrameTimerJob() { return _isFrameTimerJob; }
@@ -39,12 +40,18 @@ class Job
     inline CurveModel* curve() const { return _curve; }
     inline int npoints() const { return _npoints; }
 
+    // Columnar runtimes (logged microsecs) shared with other jobs in same log
+    inline const RuntimeMatrix* runtimeMatrix() const { return _matrix; }
+    inline double runtime(int row) const { return _matrix->value(row,_col); }
+
 private:
     Job() {}
 
     void _parseJobId(const QString& job_id);
 
     CurveModel* _curve;
+    const RuntimeMatrix* _matrix;
+    int _col;
     int _npoints;
     bool _isFrameTimerJob;
 
@@ -67,7 +67,8 @@ void CurvesLayoutItem::paint(QPainter *painter,
     if ( nCurves == 2 ) {
         QString plotPresentation = _bookModel->getDataString(_plotIdx,
                                                      "PlotPresentation","Plot");
-        if ( plotPresentation == "compare" ) {
+        if ( plotPresentation == "compare" ||
+             plotPresentation == "envelope" ) {
             _printCoplot(T,painter,_plotIdx);
         } else if (plotPresentation == "error" || plotPresentation.isEmpty()) {
             _printErrorplot(T,painter,_plotIdx);
@@ -31,6 +31,8 @@ UI_DIR      = $$BUILDDIR/ui
 
 
 SOURCES += bookmodel.cpp \
+           curveproptable.cpp \
+           plotchangerouter.cpp \
            bookview_pagetitle.cpp \
            bookview_plot.cpp \
            bookview.cpp \
@@ -47,9 +49,11 @@ SOURCES += bookmodel.cpp \
            bookview_table.cpp \
            dp.cpp \
            varswidget.cpp \
+           varsmodel.cpp \
            dptreewidget.cpp \
            monteinputsview.cpp \
            dpfilterproxymodel.cpp \
+           dpindex.cpp \
            options.cpp \
            frame.cpp \
            job.cpp \
@@ -77,6 +81,14 @@ SOURCES += bookmodel.cpp \
            timeinput.cpp \
            curvemodel.cpp \
            programmodel.cpp \
+           expression.cpp \
+           expressionmodel.cpp \
+           envelope.cpp \
+           features.cpp \
+           eventquery.cpp \
+           eventquerywindow.cpp \
+           sensitivity.cpp \
+           sensitivitywindow.cpp \
            session.cpp \
            plotlayout.cpp \
            pagelayout.cpp \
@@ -94,8 +106,13 @@ SOURCES += bookmodel.cpp \
            mapvalue.cpp \
            curvemodelparameter.cpp \
            datamodel_mot.cpp \
+           datamodel_catalog.cpp \
+           datamodel_kvz.cpp \
+           runscatalog.cpp \
            bookview_tabwidget.cpp \
            fft.cpp \
+           fftplan.cpp \
+           bwfilter.cpp \
            curvemodel_fft.cpp \
            curvemodel_ifft.cpp \
            filter.c \
@@ -104,9 +121,17 @@ SOURCES += bookmodel.cpp \
            filter_sgolay.cpp \
            coord_arrow.cpp \
            curvemodel_deriv.cpp \
-           curvemodel_integ.cpp
+           curvemodel_integ.cpp \
+           curvemodel_transform.cpp \
+           runtimematrix.cpp \
+           livetail.cpp \
+           snapmonitor.cpp \
+           convert.cpp \
+           trace.cpp
 
 HEADERS  += bookmodel.h \
+            curveproptable.h \
+            plotchangerouter.h \
             bookidxview.h \
             bookview.h \
             bookview_corner.h \
@@ -123,9 +148,11 @@ HEADERS  += bookmodel.h \
             bookview_table.h \
             dp.h \
             varswidget.h \
+            varsmodel.h \
             dptreewidget.h \
             monteinputsview.h \
             dpfilterproxymodel.h \
+            dpindex.h \
             options.h \
             frame.h \
             job.h \
@@ -157,6 +184,14 @@ HEADERS  += bookmodel.h \
             datamodel_trick.h \
             curvemodel.h \
             programmodel.h \
+            expression.h \
+            expressionmodel.h \
+            envelope.h \
+            features.h \
+            eventquery.h \
+            eventquerywindow.h \
+            sensitivity.h \
+            sensitivitywindow.h \
             session.h \
             plotlayout.h \
             pagelayout.h \
@@ -174,8 +209,13 @@ HEADERS  += bookmodel.h \
             mapvalue.h \
             curvemodelparameter.h \
             datamodel_mot.h \
+            datamodel_catalog.h \
+            datamodel_kvz.h \
+            runscatalog.h \
             bookview_tabwidget.h \
             fft.h \
+            fftplan.h \
+            bwfilter.h \
             curvemodel_fft.h \
             curvemodel_ifft.h \
             filter.h \
@@ -184,7 +224,13 @@ HEADERS  += bookmodel.h \
             filter_sgolay.h \
             coord_arrow.h \
             curvemodel_deriv.h \
-            curvemodel_integ.h
+            curvemodel_integ.h \
+            curvemodel_transform.h \
+            runtimematrix.h \
+            livetail.h \
+            snapmonitor.h \
+            convert.h \
+            trace.h
 
 FLEXSOURCES = product_lexer.l
 BISONSOURCES = product_parser.y
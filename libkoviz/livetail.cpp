@@ -0,0 +1,47 @@
+#include "livetail.h"
+
+LiveTail::LiveTail(Runs *runs, PlotBookModel *bookModel,
+                   double refreshRate, QObject *parent) :
+    QObject(parent),
+    _runs(runs),
+    _bookModel(bookModel),
+    _isChanged(false),
+    _isPoll(false)
+{
+    foreach ( DataModel* model, _runs->models() ) {
+        QString fileName = model->fileName();
+        _watcher.addPath(fileName);
+        if ( !_watcher.files().contains(fileName) ) {
+            // Cannot watch file, fall back to polling
+            _isPoll = true;
+        }
+    }
+    connect(&_watcher,SIGNAL(fileChanged(QString)),
+            this,SLOT(_fileChanged(QString)));
+
+    if ( refreshRate <= 0.0 ) {
+        refreshRate = 1.0;
+    }
+    _timer.setInterval((int)(1000.0/refreshRate));
+    connect(&_timer,SIGNAL(timeout()),this,SLOT(_refresh()));
+    _timer.start();
+}
+
+void LiveTail::_fileChanged(const QString &fileName)
+{
+    Q_UNUSED(fileName);
+    _isChanged = true;  // Coalesce writes until next refresh
+}
+
+void LiveTail::_refresh()
+{
+    if ( !_isChanged && !_isPoll ) {
+        return;
+    }
+    _isChanged = false;
+
+    if ( _runs->refresh() > 0 ) {
+        _bookModel->extendCurves();
+        emit dataAppended();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef LIVETAIL_H
+#define LIVETAIL_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QString>
+
+#include "runs.h"
+#include "bookmodel.h"
+
+//
+// Follow RUN log files while a sim is still writing them
+//
+// Files are watched with a QFileSystemWatcher (inotify on linux).  If a
+// file cannot be watched (e.g. some network mounts), files are polled.
+// At most refreshRate times a second, data models pick up appended records
+// and the book's cached curve paths are extended (not rebuilt).
+//
+class LiveTail : public QObject
+{
+    Q_OBJECT
+
+  public:
+    LiveTail(Runs* runs, PlotBookModel* bookModel,
+             double refreshRate, QObject* parent=0);
+
+  signals:
+    void dataAppended();
+
+  private:
+    Runs* _runs;
+    PlotBookModel* _bookModel;
+    QFileSystemWatcher _watcher;
+    QTimer _timer;
+    bool _isChanged;
+    bool _isPoll;
+
+  private slots:
+    void _fileChanged(const QString& fileName);
+    void _refresh();
+};
+
+#endif // LIVETAIL_H
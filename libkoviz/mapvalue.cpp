@@ -9,6 +9,12 @@ MapValue::MapValue(const QString &strIn) :
     QString str(strIn);
     int i;
 
+    // Expression (see expression.h), scale, bias and units are part of it
+    if ( str.trimmed().startsWith('@') ) {
+        _name = str.trimmed();
+        return;
+    }
+
     // Scale
     i = str.indexOf("scale(");
     if ( i > 0 ) {
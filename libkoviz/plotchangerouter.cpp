@@ -0,0 +1,146 @@
+#include "plotchangerouter.h"
+#include "bookmodel.h"
+
+PlotChangeRouter::PlotChangeRouter(PlotBookModel *bookModel) :
+    QObject(bookModel),
+    _bookModel(bookModel),
+    _isSyncing(false)
+{
+    connect(_bookModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+            this, SLOT(_dataChanged(QModelIndex,QModelIndex)));
+}
+
+void PlotChangeRouter::subscribe(const QModelIndex &plotIdx,
+                                 PlotChangeListener *listener)
+{
+    unsubscribe(listener);
+    QStandardItem* plotItem = _bookModel->itemFromIndex(plotIdx);
+    if ( !plotItem ) {
+        return;
+    }
+    _listeners.insert(plotItem,listener);
+    _plotItems.insert(listener,plotItem);
+}
+
+void PlotChangeRouter::unsubscribe(PlotChangeListener *listener)
+{
+    if ( _plotItems.contains(listener) ) {
+        _listeners.remove(_plotItems.value(listener),listener);
+        _plotItems.remove(listener);
+    }
+    _held.remove(listener);
+}
+
+void PlotChangeRouter::shown(PlotChangeListener *listener)
+{
+    QList<Change> changes = _held.take(listener);
+    foreach ( Change change, changes ) {
+        if ( change.first.isValid() && change.second.isValid() ) {
+            listener->plotDataChanged(change.first,change.second);
+        }
+    }
+}
+
+void PlotChangeRouter::_hold(PlotChangeListener *listener,
+                             const QModelIndex &topLeft,
+                             const QModelIndex &bottomRight)
+{
+    // Views reread the model, so a change only needs to be held once
+    QList<Change>& changes = _held[listener];
+    foreach ( Change change, changes ) {
+        if ( change.first == topLeft && change.second == bottomRight ) {
+            return;
+        }
+    }
+    changes.append(Change(topLeft,bottomRight));
+}
+
+void PlotChangeRouter::_dataChanged(const QModelIndex &topLeft,
+                                    const QModelIndex &bottomRight)
+{
+    // Book, page and table changes are not under a plot
+    QModelIndex plotIdx = topLeft;
+    while ( plotIdx.isValid() ) {
+        plotIdx = plotIdx.sibling(plotIdx.row(),0);
+        if ( _bookModel->isIndex(plotIdx,"Plot") ) {
+            break;
+        }
+        plotIdx = plotIdx.parent();
+    }
+    if ( !plotIdx.isValid() ) {
+        return;
+    }
+
+    QStandardItem* plotItem = _bookModel->itemFromIndex(plotIdx);
+    foreach ( PlotChangeListener* listener, _listeners.values(plotItem) ) {
+        if ( listener->isPlotShown() ) {
+            listener->plotDataChanged(topLeft,bottomRight);
+        } else {
+            _hold(listener,topLeft,bottomRight);
+        }
+    }
+
+    if ( !_isSyncing && topLeft.column() == 1 && topLeft.parent() == plotIdx ) {
+        QModelIndex tagIdx = topLeft.sibling(topLeft.row(),0);
+        if ( _bookModel->data(tagIdx).toString() == "PlotMathRect" ) {
+            _syncXRange(plotIdx);
+        }
+    }
+}
+
+// Only synchronize when x variables are time (normal case)
+void PlotChangeRouter::_syncXRange(const QModelIndex &srcPlotIdx)
+{
+    if ( !_bookModel->isXTime(srcPlotIdx) ) {
+        return;
+    }
+
+    QModelIndex srcRectIdx = _bookModel->getDataIndex(srcPlotIdx,
+                                                      "PlotMathRect","Plot");
+    QRectF srcM = _bookModel->data(srcRectIdx).toRectF();
+    QString srcXScale = _bookModel->getDataString(srcPlotIdx,
+                                                  "PlotXScale","Plot");
+    QStandardItem* srcPlotItem = _bookModel->itemFromIndex(srcPlotIdx);
+
+    _isSyncing = true;
+    foreach ( QStandardItem* plotItem, _listeners.uniqueKeys() ) {
+        if ( plotItem == srcPlotItem ) {
+            continue;
+        }
+        QModelIndex plotIdx = _bookModel->indexFromItem(plotItem);
+        if ( !plotIdx.isValid() || !_bookModel->isXTime(plotIdx) ) {
+            continue;
+        }
+
+        QRectF M = srcM;
+        QModelIndex rectIdx = _bookModel->getDataIndex(plotIdx,
+                                                       "PlotMathRect","Plot");
+        QRectF R = _bookModel->data(rectIdx).toRectF();
+        QString xScale = _bookModel->getDataString(plotIdx,
+                                                   "PlotXScale","Plot");
+        if ( srcXScale == "log" && xScale == "linear" ) {
+            M.setLeft(pow(10,M.left()));
+            M.setRight(pow(10,M.right()));
+        } else if ( srcXScale == "linear" && xScale == "log") {
+            if ( M.left() != 0.0 ) {
+                M.setLeft(log10(M.left()));
+            }
+            if ( M.right() != 0.0 ) {
+                M.setRight(log10(M.right()));
+            }
+        }
+        if ( M.left() != R.left() || M.right() != R.right() ) {
+            R.setLeft(M.left());
+            R.setRight(M.right());
+            double xMinRange = _bookModel->getDataDouble(plotIdx,
+                                                        "PlotXMinRange","Plot");
+            double xMaxRange = _bookModel->getDataDouble(plotIdx,
+                                                        "PlotXMaxRange","Plot");
+            if ( R.left() >= xMinRange && R.right() <= xMaxRange ) {
+                // Set R if within PlotXMin/MaxRange
+                _bookModel->setPlotMathRect(R,plotIdx);
+            }
+        }
+    }
+    _isSyncing = false;
+}
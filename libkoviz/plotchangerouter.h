@@ -0,0 +1,70 @@
+#ifndef PLOTCHANGEROUTER_H
+#define PLOTCHANGEROUTER_H
+
+#include <QObject>
+#include <QModelIndex>
+#include <QPersistentModelIndex>
+#include <QStandardItem>
+#include <QMultiHash>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QRectF>
+#include <math.h>
+
+class PlotBookModel;
+
+// A view of a plot that is told of changes under its plot
+class PlotChangeListener
+{
+  public:
+    virtual ~PlotChangeListener() {}
+    virtual bool isPlotShown() const = 0;
+    virtual void plotDataChanged(const QModelIndex& topLeft,
+                                 const QModelIndex& bottomRight) = 0;
+};
+
+//
+// Routes book model changes to the views of the plot they are under
+//
+// Plot views subscribe with their plot index.  A change goes only to the
+// views of its plot, and is held for views that are hidden (e.g. on
+// another page tab) until they are shown.  Changes that are not under a
+// plot (page, table and book settings) are not routed.
+//
+// When a plot is zoomed/panned, the router synchronizes the x range of
+// the other time plots once each.  Before, each curves view
+// synchronized itself with every other plot, which fanned out again on
+// every plot it changed.
+//
+class PlotChangeRouter : public QObject
+{
+    Q_OBJECT
+  public:
+    explicit PlotChangeRouter(PlotBookModel* bookModel);
+
+    void subscribe(const QModelIndex& plotIdx, PlotChangeListener* listener);
+    void unsubscribe(PlotChangeListener* listener);
+
+    // Replays changes held while listener was hidden
+    void shown(PlotChangeListener* listener);
+
+  private slots:
+    void _dataChanged(const QModelIndex& topLeft,
+                      const QModelIndex& bottomRight);
+
+  private:
+    typedef QPair<QPersistentModelIndex,QPersistentModelIndex> Change;
+
+    PlotBookModel* _bookModel;
+    QMultiHash<QStandardItem*,PlotChangeListener*> _listeners; // plot item key
+    QHash<PlotChangeListener*,QStandardItem*> _plotItems;
+    QHash<PlotChangeListener*,QList<Change> > _held;
+    bool _isSyncing;
+
+    void _hold(PlotChangeListener* listener,
+               const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void _syncXRange(const QModelIndex& srcPlotIdx);
+};
+
+#endif // PLOTCHANGEROUTER_H
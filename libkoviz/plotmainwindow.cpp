@@ -34,7 +34,7 @@ PlotMainWindow::PlotMainWindow(
         QString map,
         QString mapFile,
         Runs* runs,
-        QStandardItemModel* varsModel,
+        VarsModel* varsModel,
         QStandardItemModel *monteInputsModel,
         QWidget *parent) :
     QMainWindow(parent),
@@ -60,7 +60,9 @@ PlotMainWindow::PlotMainWindow(
     _monteInputsModel(monteInputsModel),
     _monteInputsView(0),
     _dpTreeWidget(0),
-    vidView(0)
+    vidView(0),
+    _sensitivityWindow(0),
+    _eventQueryWindow(0)
 {
     // Window title
     QModelIndex titlesIdx = _bookModel->getIndex(QModelIndex(),
@@ -344,6 +346,13 @@ void PlotMainWindow::createMenu()
     _clearTablesAction = _optsMenu->addAction(tr("ClearTables"));
     _plotAllVarsAction = _optsMenu->addAction(tr("PlotAllVars"));
     _enableDragDropAction = _optsMenu->addAction(tr("EnableDragAndDrop"));
+    _sensitivityAction = _optsMenu->addAction(tr("Sensitivity"));
+    _sensitivityAction->setEnabled(_monteInputsModel &&
+                                   _monteInputsModel->rowCount() > 2);
+    _eventsAction = _optsMenu->addAction(tr("Events"));
+    _runFeaturesAction = _optsMenu->addAction(tr("AddRunFeatures"));
+    _runFeaturesAction->setEnabled(_monteInputsModel &&
+                                   _monteInputsModel->rowCount() > 1);
     _enableDragDropAction->setCheckable(true);
     _showLiveCoordAction->setCheckable(true);
     _showLiveCoordAction->setChecked(true);
@@ -381,6 +390,12 @@ void PlotMainWindow::createMenu()
             this, SLOT(_plotAllVars()));
     connect(_enableDragDropAction, SIGNAL(toggled(bool)),
             this, SLOT(_toggleEnableDragDrop(bool)));
+    connect(_sensitivityAction, SIGNAL(triggered()),
+            this, SLOT(_showSensitivity()));
+    connect(_runFeaturesAction, SIGNAL(triggered()),
+            this, SLOT(_addRunFeatures()));
+    connect(_eventsAction, SIGNAL(triggered()),
+            this, SLOT(_showEvents()));
     setMenuWidget(_menuBar);
 }
 
@@ -549,6 +564,9 @@ void PlotMainWindow::_saveDP()
         return;
     }
 
+    // Curves of pages not yet shown
+    _bookModel->loadPages();
+
     QString i1("  ");
     QString i2("    ");
     QString i3("      ");
@@ -1430,6 +1448,82 @@ void PlotMainWindow::_toggleEnableDragDrop(bool isChecked )
     _varsWidget->setDragEnabled(isChecked);
 }
 
+// Correlate outputs with MONTE inputs.  Outputs default to the
+// variables plotted in the book.
+void PlotMainWindow::_showSensitivity()
+{
+    if ( !_sensitivityWindow ) {
+        QStringList outputs;
+        foreach ( QModelIndex pageIdx, _bookModel->pageIdxs() ) {
+            foreach ( QModelIndex plotIdx, _bookModel->plotIdxs(pageIdx) ) {
+                QModelIndex curvesIdx = _bookModel->getIndex(plotIdx,
+                                                             "Curves","Plot");
+                QModelIndexList curveIdxs = _bookModel->curveIdxs(curvesIdx);
+                if ( curveIdxs.isEmpty() ) {
+                    continue;
+                }
+                QString yName = _bookModel->getDataString(curveIdxs.at(0),
+                                                          "CurveYName",
+                                                          "Curve");
+                if ( !outputs.contains(yName) ) {
+                    outputs << yName;
+                }
+            }
+        }
+        _sensitivityWindow = new SensitivityWindow(_runs,_monteInputsModel,
+                                                   _timeNames.at(0),
+                                                   outputs,this);
+    }
+    _sensitivityWindow->show();
+    _sensitivityWindow->raise();
+}
+
+// Per run scalars as sortable monte input columns
+void PlotMainWindow::_addRunFeatures()
+{
+    bool ok;
+    QString specs = QInputDialog::getText(this,tr("Add Run Features"),
+                          tr("Features e.g. max(var),tmax(var),final(var),"
+                             "rms(var),tcross(var,100.0):"),
+                          QLineEdit::Normal,QString(),&ok);
+    if ( !ok || specs.trimmed().isEmpty() ) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    try {
+        FeatureCache::addColumns(_monteInputsModel,_runs,_timeNames.at(0),
+                                 Feature::splitSpecs(specs));
+    } catch (std::runtime_error &e) {
+        QApplication::restoreOverrideCursor();
+        QMessageBox::warning(this,tr("koviz"),e.what());
+        return;
+    }
+    QApplication::restoreOverrideCursor();
+}
+
+void PlotMainWindow::_showEvents()
+{
+    if ( !_eventQueryWindow ) {
+        _eventQueryWindow = new EventQueryWindow(_runs,_timeNames.at(0),this);
+        connect(_eventQueryWindow,SIGNAL(eventActivated(int,double,double)),
+                this,SLOT(_eventActivated(int,double,double)));
+    }
+    _eventQueryWindow->show();
+    _eventQueryWindow->raise();
+}
+
+// Jump to event, its run's curves made current and live time at its start
+void PlotMainWindow::_eventActivated(int run, double start, double end)
+{
+    Q_UNUSED(end);
+
+    _bookView->setCurrentCurveRunID(run);
+    QModelIndex liveIdx = _bookModel->getDataIndex(QModelIndex(),
+                                                   "LiveCoordTime");
+    _bookModel->setData(liveIdx,start);
+}
+
 void PlotMainWindow::_startTimeChanged(double startTime)
 {
     QModelIndex startTimeIdx = _bookModel->getDataIndex(QModelIndex(),
@@ -26,6 +26,7 @@
 #include <QProcess>
 #include <QTcpSocket>
 #include <QStatusBar>
+#include <QInputDialog>
 
 #include "monte.h"
 #include "dp.h"
@@ -38,6 +39,8 @@
 #include "runs.h"
 #include "timecom.h"
 #include "videowindow.h"
+#include "sensitivitywindow.h"
+#include "eventquerywindow.h"
 
 class PlotMainWindow : public QMainWindow
 {
@@ -63,7 +66,7 @@ public:
                              QString map,
                              QString mapFile,
                              Runs* runs,
-                             QStandardItemModel* varsModel,
+                             VarsModel* varsModel,
                              QStandardItemModel* monteInputsModel=0,
                              QWidget *parent = 0);
 
@@ -95,7 +98,7 @@ private:
     QString _map;
     QString _mapFile;
     Runs* _runs;
-    QStandardItemModel* _varsModel;
+    VarsModel* _varsModel;
     QStandardItemModel* _monteInputsModel;
     MonteInputsView* _monteInputsView;
     QHeaderView* _monteInputsHeaderView;
@@ -121,6 +124,9 @@ private:
     QAction *_clearTablesAction;
     QAction *_plotAllVarsAction;
     QAction *_enableDragDropAction;
+    QAction *_sensitivityAction;
+    QAction *_runFeaturesAction;
+    QAction *_eventsAction;
 
     QTabWidget* _nbDPVars;
     VarsWidget* _varsWidget;
@@ -146,6 +152,8 @@ private:
     TimeCom* _blender;
 
     VideoWindow* vidView;
+    SensitivityWindow* _sensitivityWindow;
+    EventQueryWindow* _eventQueryWindow;
     QTcpSocket* _vsSocket ;
 
     void _openVideoFile(const QString& fname);
@@ -167,6 +175,10 @@ private slots:
      void _launchScript(QAction *action);
      void _plotAllVars();
      void _toggleEnableDragDrop(bool isChecked);
+     void _showSensitivity();
+     void _addRunFeatures();
+     void _showEvents();
+     void _eventActivated(int run, double start, double end);
 
      void _startTimeChanged(double startTime);
      void _liveTimeChanged(double liveTime);
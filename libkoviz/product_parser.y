@@ -19,6 +19,10 @@ QList<double> globalFloatList;
 
 QString dpFileName();
 
+// yyparse() returns non-zero after an error and the product reports it
+// (DPs are parsed in worker threads by DPIndex, so no exit here)
+QString dpParseError;
+
 void yyerror(const char *str)
 {
     Q_UNUSED(str);
@@ -27,8 +31,7 @@ void yyerror(const char *str)
     msg += "  Error found in file: " + dpFileName() + "\n";
     msg += "  Error found on line: " + QString("%1").arg(yylineno) + "\n";
     msg += "      Last Token Read: " + QString(yytext) + "\n";
-    fprintf(stderr, "%s\n",msg.toLatin1().constData());
-    exit(-1);
+    dpParseError = msg;
 }
 
 int yywrap()
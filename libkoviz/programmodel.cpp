@@ -1,5 +1,8 @@
 #include "programmodel.h"
 
+#include <QtConcurrentMap>
+#include <algorithm>
+
 QString ProgramModel::_err_string;
 QTextStream ProgramModel::_err_stream(&ProgramModel::_err_string);
 
@@ -12,11 +15,52 @@ ProgramModel::ProgramModel(const QList<CurveModel *> &inputCurves,
     DataModel(timeNames, programfile, parent),
     _timeNames(timeNames),_programfile(programfile),
     _nrows(0), _ncols(0),_iteratorTimeIndex(0),
-    _data(0), _library(0)
+    _data(0), _library(0), _program(0), _programBatch(0)
 {
     _init(inputCurves,inputParams,outputNames);
 }
 
+// Row chunk handed to kovizProgramBatch
+class ProgramChunk
+{
+  public:
+    ProgramChunk() : row(0), nrows(0), ret(0) {}
+    ProgramChunk(int row, int nrows) : row(row), nrows(nrows), ret(0) {}
+    int row;
+    int nrows;
+    int ret;
+};
+
+class ProgramChunkRunner
+{
+  public:
+    ProgramChunkRunner(const ProgramModel* model, const double* inputs,
+                       int nInputs, int nOutputs) :
+        _model(model), _inputs(inputs),
+        _nInputs(nInputs), _nOutputs(nOutputs) {}
+
+    void operator()(ProgramChunk& chunk)
+    {
+        const int nrows = _model->_nrows;
+        QVector<const double*> in(_nInputs);
+        QVector<double*> out(_nOutputs);
+        for ( int i = 0; i < _nInputs; ++i ) {
+            in[i] = &_inputs[i*nrows+chunk.row];
+        }
+        for ( int i = 0; i < _nOutputs; ++i ) {
+            out[i] = &_model->_data[(i+1)*nrows+chunk.row]; // 1 for time
+        }
+        chunk.ret = _model->_programBatch(in.data(),_nInputs,
+                                          out.data(),_nOutputs,chunk.nrows);
+    }
+
+  private:
+    const ProgramModel* _model;
+    const double* _inputs;
+    int _nInputs;
+    int _nOutputs;
+};
+
 void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
                          const QList<Parameter> &inputParams,
                          const QStringList& outputNames)
@@ -32,10 +76,12 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
                         "\"%s\"\n",_programfile.toLatin1().constData());
         exit(-1);
     }
+    _programBatch = (ExternalProgramBatch)
+                    _library->resolve("kovizProgramBatch");
     _program = (ExternalProgram) _library->resolve("kovizProgram");
-    if ( !_program ) {
+    if ( !_program && !_programBatch ) {
         fprintf(stderr, "koviz [error]: Could not find symbol "
-                        "\"kovizProgram\" in %s\n",
+                        "\"kovizProgram\" or \"kovizProgramBatch\" in %s\n",
                         _library->fileName().toLatin1().constData());
         exit(-1);
     }
@@ -88,58 +134,18 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
     _iteratorTimeIndex = new ProgramModelIterator(0,this,
                                                   _timeCol,_timeCol,_timeCol);
 
-    // Get number of data rows in program file
-    foreach ( CurveModel* curveModel, inputCurves ) {
-        curveModel->map();
-        ModelIterator* it = curveModel->begin();
-
-        int i = 0;
-        while ( !it->isDone() ) {
-
-            double t = it->t();
-
-            if ( i >= _timeStamps.size() ) {
-                _timeStamps.append(t);
-                it->next();
-                ++i;
-                continue;
-            }
-
-            double timeStamp = _timeStamps.at(i);
-            if ( t == timeStamp ) {
-                it->next();
-            } else if ( t < timeStamp ) {
-                _timeStamps.insert(i,t);
-                it->next();
-            }
-            ++i;
-        }
-
-        delete it;
-        curveModel->unmap();
-    }
-    _nrows = _timeStamps.size();
-
-    // Allocate to hold *all* parsed data
-    _data = (double*)malloc(_nrows*_ncols*sizeof(double));
-
-    // Copy timestamps to _data (column 0)
-    int row = 0;
-    foreach (double timeStamp, _timeStamps ) {
-        _data[row*_ncols] = timeStamp;
-        ++row;
-    }
-
-    // Load input curve data into an array
-    double* input_data = (double*)malloc(_nrows*nInputs*sizeof(double));
-    row = 0;
+    // Read input curves, converted to the units the program expects
+    QList<QVector<double> > ts;
+    QList<QVector<double> > ys;
     col = 0;
     foreach ( CurveModel* curveModel, inputCurves ) {
         Parameter inputParam = inputParams.at(col);
         double sf = 1.0;
         double bias = 0.0;
         if ( inputParam.unit() != "--" ) {
-            if ( !Unit::canConvert(curveModel->y()->unit(),inputParam.unit())) {
+            int fromId = Unit::id(curveModel->y()->unit());
+            int toId = Unit::id(inputParam.unit());
+            if ( fromId < 0 || !Unit::canConvert(fromId,toId) ) {
                 fprintf(stderr, "koviz [error]: DP program input cannot be "
                                 "converted from logged units:\n"
                                 "    DPProgramInputName=%s\n"
@@ -150,53 +156,176 @@ void ProgramModel::_init(const QList<CurveModel*>& inputCurves,
                         curveModel->y()->unit().toLatin1().constData());
                 exit(-1);
             }
-            sf = Unit::scale(curveModel->y()->unit(), inputParam.unit());
-            bias = Unit::bias(curveModel->y()->unit(), inputParam.unit());
+            UnitConversion uc = Unit::conversion(fromId,toId);
+            sf = uc.scale;
+            bias = uc.bias;
         }
+
         curveModel->map();
+        QVector<double> t;
+        QVector<double> y;
+        t.reserve(curveModel->rowCount());
+        y.reserve(curveModel->rowCount());
         ModelIterator* it = curveModel->begin();
-        row = 0;
         while ( !it->isDone() ) {
+            t.append(it->t());
+            y.append(it->y()*sf+bias);
+            it->next();
+        }
+        delete it;
+        curveModel->unmap();
 
-            double timeStamp = _data[row*_ncols];
-
-            double t = it->t();
-
-            if ( t == timeStamp ) {
-                input_data[row*nInputs+col] = it->y()*sf+bias;
-            } else if ( timeStamp < t ) {
-                // Interpolate
-            } else {
-                fprintf(stderr, "koviz [bad scoobs]: ProgramModel::_init() "
-                                "time stamp weirdness... abort!!!"
-                                "t=%g timeStamp=%g row=%d\n",
-                                t,timeStamp,row);
+        for ( int i = 1; i < t.size(); ++i ) {
+            if ( t.at(i) < t.at(i-1) ) {
+                fprintf(stderr, "koviz [error]: DP program input time "
+                                "goes backwards:\n"
+                                "    DPProgramInputName=%s\n"
+                                "    t=%g previous=%g row=%d\n",
+                        inputParam.name().toLatin1().constData(),
+                        t.at(i),t.at(i-1),i);
                 exit(-1);
             }
-
-            it->next();
-            ++row;
         }
 
-        delete it;
-        curveModel->unmap();
+        ts.append(t);
+        ys.append(y);
         ++col;
     }
 
+    QVector<double> timeStamps = timeline(ts);
+    _nrows = timeStamps.size();
+
+    // Allocate to hold *all* data, time column first
+    _data = (double*)malloc((size_t)_nrows*_ncols*sizeof(double));
+    for ( int row = 0; row < _nrows; ++row ) {
+        _data[row] = timeStamps.at(row);
+    }
+
+    // Input columns sampled on the timeline
+    double* input_data = (double*)malloc((size_t)_nrows*
+                                         qMax(nInputs,1)*sizeof(double));
+    for ( int i = 0; i < nInputs; ++i ) {
+        double* in = &input_data[i*_nrows];
+        if ( ts.at(i) == timeStamps ) {
+            const double* y = ys.at(i).constData();
+            for ( int row = 0; row < _nrows; ++row ) {
+                in[row] = y[row];
+            }
+        } else {
+            interpolate(ts.at(i),ys.at(i),_data,_nrows,in);
+        }
+    }
+    ts.clear();
+    ys.clear();
+
     // Generate output curves
-    double* in;
-    double* out = (double*)malloc(nOutputs);
-    col = 1;
+    if ( _programBatch ) {
+        _runProgramBatch(input_data,nInputs,nOutputs);
+    } else {
+        _runProgram(input_data,nInputs,nOutputs);
+    }
+
+    free(input_data);
+}
+
+// Inputs usually share one timeline, in which case it is used as is
+QVector<double> ProgramModel::timeline(const QList<QVector<double> > &ts)
+{
+    QVector<double> timeline;
+    if ( ts.isEmpty() ) {
+        return timeline;
+    }
+
+    timeline = ts.at(0);
+    for ( int i = 1; i < ts.size(); ++i ) {
+        if ( ts.at(i) == timeline ) {
+            continue;
+        }
+        QVector<double> merged(timeline.size()+ts.at(i).size());
+        double* end = std::set_union(timeline.constBegin(),
+                                     timeline.constEnd(),
+                                     ts.at(i).constBegin(),
+                                     ts.at(i).constEnd(),
+                                     merged.begin());
+        merged.resize(end-merged.constBegin());
+        timeline = merged;
+    }
+
+    double* end = std::unique(timeline.begin(),timeline.end());
+    timeline.resize(end-timeline.constBegin());
+
+    return timeline;
+}
+
+void ProgramModel::interpolate(const QVector<double> &ts,
+                                const QVector<double> &ys,
+                                const double *timeline, int n,
+                                double *out)
+{
+    const int m = ts.size();
+    if ( m == 0 ) {
+        for ( int row = 0; row < n; ++row ) {
+            out[row] = 0.0;
+        }
+        return;
+    }
+
+    const double* t = ts.constData();
+    const double* y = ys.constData();
+    int j = 0;
+    for ( int row = 0; row < n; ++row ) {
+        double time = timeline[row];
+        while ( j < m-1 && t[j+1] <= time ) {
+            ++j;
+        }
+        if ( time <= t[j] || j == m-1 ) {
+            out[row] = y[j];
+        } else {
+            double frac = (time-t[j])/(t[j+1]-t[j]);
+            out[row] = y[j] + frac*(y[j+1]-y[j]);
+        }
+    }
+}
+
+void ProgramModel::_runProgram(const double* inputs,
+                               int nInputs, int nOutputs)
+{
+    double* in = (double*)malloc(qMax(nInputs,1)*sizeof(double));
+    double* out = (double*)malloc(qMax(nOutputs,1)*sizeof(double));
     for ( int row = 0; row < _nrows; ++row ) {
-        in = &input_data[row*nInputs];
+        for ( int i = 0; i < nInputs; ++i ) {
+            in[i] = inputs[i*_nrows+row];
+        }
         _program(in,nInputs,out,nOutputs);
-        for (int i = 0; i < nOutputs; ++i ) {
-            _data[row*_ncols+i+1] = out[i]; // 1 for timestamp
+        for ( int i = 0; i < nOutputs; ++i ) {
+            _data[(i+1)*_nrows+row] = out[i]; // 1 for timestamp
         }
     }
     free(out);
+    free(in);
+}
 
-    free(input_data);
+void ProgramModel::_runProgramBatch(const double* inputs,
+                                    int nInputs, int nOutputs)
+{
+    const int chunkSize = 65536;
+    QList<ProgramChunk> chunks;
+    for ( int row = 0; row < _nrows; row += chunkSize ) {
+        chunks.append(ProgramChunk(row,qMin(chunkSize,_nrows-row)));
+    }
+
+    QtConcurrent::blockingMap(chunks,ProgramChunkRunner(this,inputs,
+                                                        nInputs,nOutputs));
+
+    foreach ( ProgramChunk chunk, chunks ) {
+        if ( chunk.ret != 0 ) {
+            fprintf(stderr, "koviz [error]: kovizProgramBatch in %s "
+                            "returned %d for rows %d-%d\n",
+                    _library->fileName().toLatin1().constData(),
+                    chunk.ret,chunk.row,chunk.row+chunk.nrows-1);
+            exit(-1);
+        }
+    }
 }
 
 void ProgramModel::map()
@@ -231,6 +360,10 @@ ProgramModel::~ProgramModel()
         delete _iteratorTimeIndex;
         _iteratorTimeIndex = 0;
     }
+
+    // The library stays loaded, other models may share it
+    delete _library;
+    _library = 0;
 }
 
 const Parameter* ProgramModel::param(int col) const
@@ -323,7 +456,7 @@ QVariant ProgramModel::data(const QModelIndex &idx, int role) const
     if ( idx.isValid() && _data ) {
         int row = idx.row();
         int col = idx.column();
-        val = _data[row*_ncols+col];
+        val = _data[col*_nrows+row];
     }
 
     return val;
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 #include <QVariant>
 #include <QTextStream>
 #include <QProgressDialog>
@@ -23,6 +24,25 @@ class ProgramModel;
 class ProgramModelIterator;
 
 typedef int (*ExternalProgram)(double*,int,double*,int);
+typedef int (*ExternalProgramBatch)(const double**,int,double**,int,int);
+
+//
+// Outputs of an external DP program over the union of its input timelines
+//
+// The shared library exports one or both of:
+//
+//     int kovizProgram(double* in, int nInputs, double* out, int nOutputs);
+//     int kovizProgramBatch(const double** in, int nInputs,
+//                           double** out, int nOutputs, int nRows);
+//
+// kovizProgram is called once per row, in time order.  kovizProgramBatch
+// gets column arrays (in[i][row], out[j][row]) and is preferred when
+// present; it is handed row chunks from several threads at once, so it
+// must not keep state between calls.  A non-zero return is an error.
+//
+// Inputs logged at different rates are linearly interpolated onto the
+// merged timeline; outside an input's time range its end value is held.
+//
 
 class ProgramModel : public DataModel
 {
@@ -52,6 +72,16 @@ class ProgramModel : public DataModel
     virtual QVariant data (const QModelIndex & index,
                            int role = Qt::DisplayRole ) const;
 
+    // Sorted union of ascending input timelines
+    static QVector<double> timeline(const QList<QVector<double> >& ts);
+
+    // Linear interpolation of (ts,ys) at each timeline stamp, holding
+    // end values outside of ts
+    static void interpolate(const QVector<double>& ts,
+                            const QVector<double>& ys,
+                            const double* timeline, int n,
+                            double* out);
+
   private:
 
     QStringList _timeNames;
@@ -65,12 +95,11 @@ class ProgramModel : public DataModel
     QHash<QString,int> _paramName2col;
     ProgramModelIterator* _iteratorTimeIndex;
 
-    QList<double> _timeStamps;
-
-    double* _data;
+    double* _data;    // column major, _data[col*_nrows+row]
 
     QLibrary* _library;
     ExternalProgram _program;
+    ExternalProgramBatch _programBatch;
 
     static QString _err_string;
     static QTextStream _err_stream;
@@ -80,6 +109,10 @@ class ProgramModel : public DataModel
                const QStringList &outputNames);
     int _idxAtTimeBinarySearch (ProgramModelIterator *it,
                                int low, int high, double time);
+    void _runProgram(const double* inputs, int nInputs, int nOutputs);
+    void _runProgramBatch(const double* inputs, int nInputs, int nOutputs);
+
+    friend class ProgramChunkRunner;
 };
 
 class ProgramModelIterator : public ModelIterator
@@ -122,17 +155,17 @@ class ProgramModelIterator : public ModelIterator
 
     inline double t() const
     {
-        return _model->_data[i*_model->_ncols+_tcol];
+        return _model->_data[_tcol*_model->_nrows+i];
     }
 
     inline double x() const
     {
-        return _model->_data[i*_model->_ncols+_xcol];
+        return _model->_data[_xcol*_model->_nrows+i];
     }
 
     inline double y() const
     {
-        return _model->_data[i*_model->_ncols+_ycol];
+        return _model->_data[_ycol*_model->_nrows+i];
     }
 
   private:
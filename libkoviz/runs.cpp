@@ -1,8 +1,12 @@
 #include "runs.h"
+#include "runscatalog.h"
+#include "trace.h"
 
 QString Runs::_err_string;
 QTextStream Runs::_err_stream(&Runs::_err_string);
 
+bool Runs::isCatalog = true;
+
 Runs::Runs() :
     _runDirs(QStringList()),
     _varMap(QHash<QString,QStringList>()),
@@ -34,6 +38,9 @@ Runs::~Runs()
     foreach ( DataModel* m, _models ) {
         delete m;
     }
+    foreach ( DataModel* m, _exprModels ) {
+        delete m;
+    }
     foreach ( QString p, _params ) {
         delete _paramToModels.value(p);
     }
@@ -41,8 +48,15 @@ Runs::~Runs()
 
 void Runs::_init()
 {
-    QStringList filter;
-    filter << "*.trk" << "*.csv" << "*.mot";
+    KOVIZ_TRACE("runs init");
+
+    // Run dir listings and file headers come from the catalog when unchanged
+    QString catalogFile;
+    if ( isCatalog ) {
+        catalogFile = RunsCatalog::defaultFileName(_runDirs);
+    }
+    RunsCatalog catalog(catalogFile);
+
     QStringList files;
     QHash<QString,QStringList> runToFiles;
     QHash<QString,QString> fileToRun;
@@ -54,8 +68,7 @@ void Runs::_init()
                         << run << "\n";
             throw std::invalid_argument(_err_string.toLatin1().constData());
         }
-        QDir runDir(run);
-        QStringList lfiles = runDir.entryList(filter, QDir::Files);
+        QStringList lfiles = catalog.dataFiles(run);
         if ( lfiles.contains("log_timeline.csv") ) {
             lfiles.removeAll("log_timeline.csv");
         }
@@ -81,7 +94,7 @@ void Runs::_init()
         }
 
         if ( lfiles.empty() ) {
-            _err_stream << "koviz [error]: Either no *.trk/csv/mot files "
+            _err_stream << "koviz [error]: Either no *.trk/csv/mot/kvz files "
                            "in run dir: " << run << "\n"
                         << "               or log files were filtered out.\n";
             throw std::invalid_argument(_err_string.toLatin1().constData());
@@ -124,7 +137,7 @@ void Runs::_init()
                 progress->setValue(files.size());
             }
         }
-        DataModel* m = DataModel::createDataModel(_timeNames,fname);
+        DataModel* m = catalog.dataModel(_timeNames,fname);
         m->unmap();
         _models.append(m);
         int ncols = m->columnCount();
@@ -211,6 +224,33 @@ void Runs::_init()
             _paramToModels.value(p)->append(m);
         }
     }
+
+    // Derived vars e.g. -map "speed=@sqrt(v[0]^2+v[1]^2)" are coplottable
+    // when the vars they use are
+    foreach ( QString key, _varMap.keys() ) {
+        foreach ( QString val, _varMap.value(key) ) {
+            if ( !Expression::isExpression(val) ) {
+                continue;
+            }
+            QString unit;
+            Expression expr(Expression::splitUnit(val,&unit)); // throws
+            bool isCoplottable = true;
+            foreach ( QString var, expr.variables() ) {
+                if ( !_params.contains(var) && !_timeNames.contains(var) ) {
+                    isCoplottable = false;
+                    break;
+                }
+            }
+            if ( isCoplottable ) {
+                _exprs.insert(key,val);
+                if ( !_params.contains(key) ) {
+                    _params.append(key);
+                }
+            }
+            break;
+        }
+    }
+    _params.sort();
     int row = 0;
     foreach ( QString run, _runDirs ) {
         QDir rundir(run);
@@ -233,8 +273,16 @@ CurveModel* Runs::curveModel(const QString& rundir,
                         const QString &x,
                         const QString &y) const
 {
+    KOVIZ_TRACE("curve create");
+
     CurveModel* curveModel = 0;
 
+    if ( Expression::isExpression(y) ) {
+        return _expressionCurve(rundir,t,x,y,y);
+    } else if ( _exprs.contains(y) ) {
+        return _expressionCurve(rundir,t,x,y,_exprs.value(y));
+    }
+
     DataModel* model = _paramModel(y,rundir);
     if ( !model ) {
         return 0;
@@ -278,6 +326,95 @@ CurveModel* Runs::curveModel(const QString& rundir,
     return curveModel;
 }
 
+// Expression models are built once per run and expression, from curves
+// of the vars the expression uses
+CurveModel* Runs::_expressionCurve(const QString &rundir,
+                                   const QString &t,
+                                   const QString &x,
+                                   const QString &y,
+                                   const QString &exprText) const
+{
+    QString frundir = QDir(rundir).absolutePath();
+    QString key = QString("%1|%2|%3").arg(frundir).arg(t).arg(y);
+    DataModel* model = _exprModels.value(key,0);
+    if ( !model ) {
+        // A map var whose expression uses itself through other map vars
+        // e.g. a=@b+1, b=@a*2 would recurse forever
+        if ( _exprVars.contains(y) ) {
+            fprintf(stderr, "koviz [error]: Expression of var=%s "
+                            "uses itself: %s -> %s\n",
+                    y.toLatin1().constData(),
+                    _exprVars.join(" -> ").toLatin1().constData(),
+                    y.toLatin1().constData());
+            exit(-1);
+        }
+        try {
+            QString unit;
+            Expression expr(Expression::splitUnit(exprText,&unit));
+            if ( expr.variables().isEmpty() ) {
+                // No curve to give the expression a timeline
+                fprintf(stderr, "koviz [error]: Expression=%s "
+                                "of var=%s has no variables.\n",
+                        exprText.toLatin1().constData(),
+                        y.toLatin1().constData());
+                exit(-1);
+            }
+            _exprVars.append(y);
+            QList<CurveModel*> inputCurves;
+            foreach ( QString var, expr.variables() ) {
+                CurveModel* inputCurve = 0;
+                if ( var != y ) {
+                    inputCurve = curveModel(rundir,t,t,var);
+                }
+                if ( !inputCurve ) {
+                    fprintf(stderr, "koviz [error]: Could not find:\n"
+                                    "         variable=%s\n"
+                                    "         used in expression=%s\n"
+                                    "         in run=%s\n",
+                            var.toLatin1().constData(),
+                            exprText.toLatin1().constData(),
+                            rundir.toLatin1().constData());
+                    exit(-1);
+                }
+                inputCurves << inputCurve;
+            }
+            _exprVars.removeLast();
+            model = new ExpressionModel(inputCurves,expr,y,unit,_timeNames,
+                                        frundir + "/" + y);
+            foreach ( CurveModel* inputCurve, inputCurves ) {
+                delete inputCurve;
+            }
+        } catch (std::exception &e) {
+            fprintf(stderr,"%s\n",e.what());
+            exit(-1);
+        }
+        _exprModels.insert(key,model);
+    }
+
+    int xcol = 0;
+    if ( x == y ) {
+        xcol = 1;
+    } else if ( x != t && !_timeNames.contains(x) ) {
+        fprintf(stderr, "koviz [error]: Expression var=%s can only be "
+                        "plotted against time, not x=%s\n",
+                y.toLatin1().constData(), x.toLatin1().constData());
+        exit(-1);
+    }
+
+    return new CurveModel(model,0,xcol,1);
+}
+
+// Extend data models with records logged since the last refresh
+// Returns number of new rows over all models
+int Runs::refresh()
+{
+    int nrows = 0;
+    foreach ( DataModel* model, _models ) {
+        nrows += model->refresh();
+    }
+    return nrows;
+}
+
 DataModel* Runs::_paramModel(const QString &param, const QString& run) const
 {
     DataModel* model = 0;
@@ -371,6 +508,19 @@ int Runs::_paramColumn(DataModel* model, const QString &param) const
     return col;
 }
 
+int Runs::runId(const QString &runDir, int runIdx)
+{
+    QString runName = QFileInfo(runDir).fileName();
+    if ( runName.startsWith("RUN_") ) {
+        bool ok;
+        int id = runName.mid(4).toInt(&ok);
+        if ( ok ) {
+            return id;
+        }
+    }
+    return runIdx;
+}
+
 // Example1:
 //
 //     names:
@@ -19,6 +19,8 @@
 #include "curvemodel.h"
 #include "numsortitem.h"
 #include "mapvalue.h"
+#include "expression.h"
+#include "expressionmodel.h"
 
 class Runs
 {
@@ -33,6 +35,8 @@ class Runs
     virtual ~Runs();
     virtual QStringList params() const { return _params; }
     virtual QStringList runDirs() const { return _runDirs; }
+    QList<DataModel*> models() const { return _models; }
+    int refresh();
     CurveModel* curveModel(int row,
                       const QString& tName,
                       const QString& xName,
@@ -42,6 +46,13 @@ class Runs
                       const QString& xName,
                       const QString& yName) const;
 
+    // Id of run in the monte inputs model, the number of a MONTE RUN_<nnnnn>
+    // dir or else the run's position in the run list (see runsInputModel)
+    static int runId(const QString& runDir, int runIdx);
+
+    // If set, run dirs are opened from the runs catalog (see RunsCatalog)
+    static bool isCatalog;
+
     static QStringList abbreviateRunNames(const QStringList& runNames);
     static QString commonPrefix(const QStringList &names, const QString &sep);
     static QString __commonPrefix(const QString &a, const QString &b,
@@ -61,10 +72,18 @@ class Runs
     QHash<QString,QList<DataModel*>* > _paramToModels;
     QList<DataModel*> _models;
     QHash<QString,int> _rundir2row;
+    QHash<QString,QString> _exprs;  // map key -> "@expr{unit}"
+    mutable QHash<QString,DataModel*> _exprModels; // per run and expression
+    mutable QStringList _exprVars;  // expression vars being built
 
     void _init();
     DataModel* _paramModel(const QString& param, const QString &run) const;
     int _paramColumn(DataModel* model, const QString& param) const;
+    CurveModel* _expressionCurve(const QString& rundir,
+                                 const QString& tName,
+                                 const QString& xName,
+                                 const QString& yName,
+                                 const QString& exprText) const;
 
     static QString _err_string;
     static QTextStream _err_stream;
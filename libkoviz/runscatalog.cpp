@@ -0,0 +1,260 @@
+#include "runscatalog.h"
+#include "datamodel_catalog.h"
+
+RunsCatalog::RunsCatalog(const QString &fileName) :
+    _fileName(fileName),
+    _isDirty(false)
+{
+    _load();
+}
+
+RunsCatalog::~RunsCatalog()
+{
+    save();
+}
+
+QString RunsCatalog::defaultFileName(const QStringList &runDirs)
+{
+    if ( runDirs.isEmpty() ) {
+        return QString();
+    }
+    QString dir = QFileInfo(runDirs.at(0)).absolutePath();
+    if ( QFileInfo(dir).isWritable() ) {
+        return dir + "/.koviz_catalog";
+    }
+
+    // E.g. a read-only MONTE dir, keyed by dir in the user's cache dir
+#if QT_VERSION >= 0x050000
+    QString cacheDir = QStandardPaths::writableLocation(
+                                             QStandardPaths::CacheLocation);
+#else
+    QString cacheDir = QDesktopServices::storageLocation(
+                                             QDesktopServices::CacheLocation);
+#endif
+    if ( cacheDir.isEmpty() || !QDir().mkpath(cacheDir) ) {
+        return QString();  // No catalog
+    }
+    QByteArray key = QCryptographicHash::hash(dir.toUtf8(),
+                                              QCryptographicHash::Md5);
+    return cacheDir + "/koviz_catalog_" + QString(key.toHex());
+}
+
+QStringList RunsCatalog::dataFiles(const QString &runDir)
+{
+    QFileInfo fi(runDir);
+    QString path = fi.absoluteFilePath();
+    qint64 mtime = fi.lastModified().toMSecsSinceEpoch();
+    _seenDirs.insert(path);
+
+    if ( _dirs.contains(path) && _dirs.value(path).mtime == mtime ) {
+        return _preferKvz(_dirs.value(path).files);
+    }
+
+    QStringList filter;
+    filter << "*.trk" << "*.csv" << "*.mot" << "*.kvz";
+    DirEntry entry;
+    entry.mtime = mtime;
+    entry.files = QDir(runDir).entryList(filter, QDir::Files);
+    _dirs.insert(path,entry);
+    _isDirty = true;
+
+    return _preferKvz(entry.files);
+}
+
+// A foo.kvz archive of foo.trk replaces it, otherwise both would load
+QStringList RunsCatalog::_preferKvz(const QStringList &files)
+{
+    QStringList kvzs = files.filter(QRegExp("\\.kvz$"));
+    if ( kvzs.isEmpty() ) {
+        return files;
+    }
+    QStringList preferred;
+    foreach ( QString f, files ) {
+        if ( f.endsWith(".trk") ) {
+            QString kvz = f.left(f.size()-4) + ".kvz";
+            if ( kvzs.contains(kvz) ) {
+                continue;
+            }
+        }
+        preferred << f;
+    }
+    return preferred;
+}
+
+DataModel *RunsCatalog::dataModel(const QStringList &timeNames,
+                                  const QString &fileName)
+{
+    QFileInfo fi(fileName);
+    QString path = fi.absoluteFilePath();
+    qint64 size = fi.size();
+    qint64 mtime = fi.lastModified().toMSecsSinceEpoch();
+    _seenFiles.insert(path);
+
+    if ( _files.contains(path) ) {
+        const FileEntry& entry = _files[path];
+        if ( entry.size == size && entry.mtime == mtime ) {
+            return new CatalogModel(timeNames,fileName,
+                                    entry.params,entry.nrows,size);
+        }
+    }
+
+    DataModel* m = DataModel::createDataModel(timeNames,fileName);
+    FileEntry entry;
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.nrows = m->rowCount();
+    for ( int col = 0; col < m->columnCount(); ++col ) {
+        Parameter param;
+        param.setName(m->param(col)->name());
+        param.setUnit(m->param(col)->unit());
+        entry.params.append(param);
+    }
+    _files.insert(path,entry);
+    _isDirty = true;
+
+    return m;
+}
+
+// Each line ends with a checksum of the line so that a line cut off by
+// a crash or a concurrent writer is dropped (and its entry rebuilt)
+static QString _lineChecksum(const QString& line)
+{
+    QByteArray bytes = line.toUtf8();
+    return QString::number(qChecksum(bytes.constData(),bytes.size()));
+}
+
+void RunsCatalog::_load()
+{
+    QFile file(_fileName);
+    if ( _fileName.isEmpty() ||
+         !file.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+        return;
+    }
+    QTextStream in(&file);
+    if ( in.readLine() != "koviz-catalog 2" ) {
+        return;  // Unknown version, will be overwritten
+    }
+
+    // D <tab> rundir <tab> mtime <tab> file1 <tab> file2 ... <tab> #sum
+    // F <tab> file <tab> size <tab> mtime <tab> nrows <tab> name1 <tab> unit1
+    //   ... <tab> #sum
+    while ( !in.atEnd() ) {
+        QString line = in.readLine();
+        int sum = line.lastIndexOf("\t#");
+        if ( sum < 0 || line.mid(sum+2) != _lineChecksum(line.left(sum)) ) {
+            _isDirty = true;  // Rewrite without the bad line
+            continue;
+        }
+        QStringList fields = line.left(sum).split('\t');
+        if ( fields.size() >= 3 && fields.at(0) == "D" ) {
+            DirEntry entry;
+            entry.mtime = fields.at(2).toLongLong();
+            entry.files = fields.mid(3);
+            _dirs.insert(fields.at(1),entry);
+        } else if ( fields.size() >= 5 && fields.size()%2 == 1 &&
+                    fields.at(0) == "F" ) {
+            FileEntry entry;
+            entry.size = fields.at(2).toLongLong();
+            entry.mtime = fields.at(3).toLongLong();
+            entry.nrows = fields.at(4).toInt();
+            for ( int i = 5; i < fields.size(); i += 2 ) {
+                Parameter param;
+                param.setName(fields.at(i));
+                param.setUnit(fields.at(i+1));
+                entry.params.append(param);
+            }
+            _files.insert(fields.at(1),entry);
+        }
+    }
+}
+
+// Runs not opened this session are kept unless they were removed, since
+// the catalog is shared by all sessions on the runs' parent dir
+void RunsCatalog::_prune()
+{
+    QHash<QString,DirEntry>::iterator d = _dirs.begin();
+    while ( d != _dirs.end() ) {
+        if ( !_seenDirs.contains(d.key()) && !QFileInfo(d.key()).exists() ) {
+            d = _dirs.erase(d);
+            _isDirty = true;
+        } else {
+            ++d;
+        }
+    }
+    QHash<QString,FileEntry>::iterator f = _files.begin();
+    while ( f != _files.end() ) {
+        if ( !_seenFiles.contains(f.key()) && !QFileInfo(f.key()).exists() ) {
+            f = _files.erase(f);
+            _isDirty = true;
+        } else {
+            ++f;
+        }
+    }
+}
+
+// Written to a temporary file which replaces the catalog when complete,
+// so a reader never sees a partial catalog
+bool RunsCatalog::save()
+{
+    if ( _fileName.isEmpty() ) {
+        return true;
+    }
+    _prune();
+    if ( !_isDirty ) {
+        return true;
+    }
+#if QT_VERSION >= 0x050100
+    QSaveFile file(_fileName);
+#else
+    QFile file(QString("%1.%2").arg(_fileName)
+                               .arg(QCoreApplication::applicationPid()));
+#endif
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                    QIODevice::Text) ) {
+        fprintf(stderr,"koviz [warning]: could not write runs catalog %s\n",
+                _fileName.toLatin1().constData());
+        _isDirty = false;  // Do not warn again
+        return false;
+    }
+    QTextStream out(&file);
+    out << "koviz-catalog 2\n";
+    QHash<QString,DirEntry>::const_iterator d = _dirs.constBegin();
+    while ( d != _dirs.constEnd() ) {
+        QString line = "D\t" + d.key() + "\t" +
+                       QString::number(d.value().mtime);
+        foreach ( QString f, d.value().files ) {
+            line += "\t" + f;
+        }
+        out << line << "\t#" << _lineChecksum(line) << "\n";
+        ++d;
+    }
+    QHash<QString,FileEntry>::const_iterator f = _files.constBegin();
+    while ( f != _files.constEnd() ) {
+        const FileEntry& entry = f.value();
+        QString line = "F\t" + f.key() + "\t" +
+                       QString::number(entry.size) + "\t" +
+                       QString::number(entry.mtime) + "\t" +
+                       QString::number(entry.nrows);
+        foreach ( Parameter param, entry.params ) {
+            line += "\t" + param.name() + "\t" + param.unit();
+        }
+        out << line << "\t#" << _lineChecksum(line) << "\n";
+        ++f;
+    }
+    out.flush();
+    _isDirty = false;
+
+#if QT_VERSION >= 0x050100
+    if ( !file.commit() ) {
+#else
+    file.close();
+    QFile::remove(_fileName);
+    if ( file.error() != QFile::NoError || !file.rename(_fileName) ) {
+        file.remove();
+#endif
+        fprintf(stderr,"koviz [warning]: could not write runs catalog %s\n",
+                _fileName.toLatin1().constData());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef RUNSCATALOG_H
+#define RUNSCATALOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QDir>
+#include <QFile>
+#if QT_VERSION >= 0x050100
+#include <QSaveFile>
+#endif
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTextStream>
+#include <QRegExp>
+#include <QCryptographicHash>
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#else
+#include <QDesktopServices>
+#endif
+
+#include "datamodel.h"
+#include "parameter.h"
+
+//
+// Catalog of RUN dirs persisted to a cache file
+//
+// Keeps the data files of each run dir and the params and row count of
+// each data file.  Entries are reused as long as the run dir or file has
+// the same modification time (and size for files), so reopening a MONTE
+// does not relist run dirs or parse headers (see CatalogModel).  Changed
+// dirs and files are relisted/reparsed and their entries updated.
+// The cache file is replaced whole on save and each line carries a
+// checksum, so a partly written catalog is never taken as valid.
+// Entries not used this session whose dir or file is gone are dropped
+// on save.
+//
+class RunsCatalog
+{
+  public:
+    RunsCatalog(const QString& fileName);
+    ~RunsCatalog();
+
+    // Cache file kept alongside the runs e.g. MONTE_dir/.koviz_catalog
+    // or, if that dir is not writable, in the user's cache dir
+    static QString defaultFileName(const QStringList& runDirs);
+
+    // *.trk, *.csv, *.mot and *.kvz files in runDir (names only)
+    // A foo.trk with a foo.kvz archive alongside is left out
+    QStringList dataFiles(const QString& runDir);
+
+    // Model of data file, a CatalogModel if the file is in the catalog
+    DataModel* dataModel(const QStringList& timeNames,
+                         const QString& fileName);
+
+    bool save();
+
+  private:
+    class DirEntry
+    {
+      public:
+        qint64 mtime;
+        QStringList files;
+    };
+
+    class FileEntry
+    {
+      public:
+        qint64 size;
+        qint64 mtime;
+        int nrows;
+        QList<Parameter> params;
+    };
+
+    QString _fileName;
+    QHash<QString,DirEntry> _dirs;     // key is absolute path
+    QHash<QString,FileEntry> _files;   // key is absolute path
+    QSet<QString> _seenDirs;           // used this session
+    QSet<QString> _seenFiles;
+    bool _isDirty;
+
+    void _load();
+    void _prune();
+    static QStringList _preferKvz(const QStringList& files);
+};
+
+#endif // RUNSCATALOG_H
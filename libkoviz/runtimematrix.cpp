@@ -0,0 +1,64 @@
+#include "runtimematrix.h"
+
+#include <QtGlobal>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <algorithm>
+
+class RuntimeMatrixColumnLoader
+{
+  public:
+    RuntimeMatrixColumnLoader(RuntimeMatrix* matrix) : _matrix(matrix) {}
+
+    void operator()(int& col)
+    {
+        double* data = &_matrix->_data[(size_t)col*(size_t)_matrix->_nrows];
+        ModelIterator* it = _matrix->_model->begin(0,col,col);
+        int row = 0;
+        while ( !it->isDone() && row < _matrix->_nrows ) {
+            data[row] = it->x();
+            ++row;
+            it->next();
+        }
+        delete it;
+    }
+
+  private:
+    RuntimeMatrix* _matrix;
+};
+
+RuntimeMatrix::RuntimeMatrix(DataModel *model) :
+    _model(model),
+    _nrows(model->rowCount()),
+    _ncols(model->columnCount())
+{
+    _data.resize((size_t)_nrows*(size_t)_ncols);
+    if ( _data.empty() ) {
+        return;
+    }
+
+    QVector<int> cols(_ncols);
+    for ( int i = 0; i < _ncols; ++i ) {
+        cols[i] = i;
+    }
+    QtConcurrent::blockingMap(cols,RuntimeMatrixColumnLoader(this));
+}
+
+int RuntimeMatrix::rowAtTime(double time) const
+{
+    if ( _nrows <= 0 ) {
+        return 0;
+    }
+
+    const double* t = times();
+    const double* it = std::lower_bound(t,t+_nrows,time);
+    int row = (int)(it-t);
+    if ( row >= _nrows ) {
+        return _nrows-1;
+    }
+    if ( row > 0 && qAbs(time-t[row-1]) < qAbs(t[row]-time) ) {
+        --row;
+    }
+
+    return row;
+}
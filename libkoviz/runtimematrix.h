@@ -0,0 +1,51 @@
+#ifndef RUNTIMEMATRIX_H
+#define RUNTIMEMATRIX_H
+
+#include <QVector>
+#include <vector>
+#include <stddef.h>
+
+#include "datamodel.h"
+
+//
+// Columnar copy of a job timing log (e.g. log_trickjobs.trk)
+//
+// Column 0 of the log is time and columns 1-N are job runtimes (microsecs).
+// Each column is copied once into one contiguous block so that
+// job stats run as tight loops over plain arrays instead of going
+// through a ModelIterator per value.  Columns are loaded in parallel.
+//
+class RuntimeMatrix
+{
+  public:
+    RuntimeMatrix(DataModel* model);
+
+    DataModel* model() const { return _model; }
+    int rowCount() const { return _nrows; }
+    int columnCount() const { return _ncols; }
+
+    const double* times() const { return column(0); }
+    const double* column(int col) const
+    {
+        if ( _data.empty() ) return 0;
+        return &_data[(size_t)col*(size_t)_nrows];
+    }
+    double value(int row, int col) const
+    {
+        return _data[(size_t)col*(size_t)_nrows+(size_t)row];
+    }
+
+    int rowAtTime(double time) const; // row with timestamp closest to time
+
+  private:
+    RuntimeMatrix() {}
+
+    DataModel* _model;
+    int _nrows;
+    int _ncols;
+    std::vector<double> _data;  // column major, column 0 is time
+
+    friend class RuntimeMatrixColumnLoader;
+};
+
+#endif // RUNTIMEMATRIX_H
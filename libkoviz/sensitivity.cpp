@@ -0,0 +1,318 @@
+#include "sensitivity.h"
+
+#include <QHash>
+#include <QtConcurrentMap>
+#include <algorithm>
+
+// Output scalars of one run
+class SensitivityRun
+{
+  public:
+    QList<CurveModel*> curves;   // one per output, null if not in run
+    QVector<double> values;
+};
+
+class SensitivityRunReducer
+{
+  public:
+    SensitivityRunReducer(Sensitivity::Metric metric, double time) :
+        _metric(metric), _time(time) {}
+
+    void operator()(SensitivityRun& run)
+    {
+        run.values.fill(NAN,run.curves.size());
+        for ( int i = 0; i < run.curves.size(); ++i ) {
+            CurveModel* curveModel = run.curves.at(i);
+            if ( curveModel ) {
+                run.values[i] = Sensitivity::curveScalar(curveModel,
+                                                         _metric,_time);
+            }
+        }
+    }
+
+  private:
+    Sensitivity::Metric _metric;
+    double _time;
+};
+
+class SensitivityPair
+{
+  public:
+    const QVector<double>* x;    // input column
+    const QVector<double>* y;    // output scalars
+    SensitivityResult result;
+};
+
+class SensitivityPairCorrelator
+{
+  public:
+    void operator()(SensitivityPair& pair)
+    {
+        SensitivityResult result = Sensitivity::correlate(*pair.x,*pair.y);
+        result.output = pair.result.output;
+        result.input = pair.result.input;
+        pair.result = result;
+    }
+};
+
+static bool _isStronger(const SensitivityResult& a, const SensitivityResult& b)
+{
+    double ra = ( a.pearson == a.pearson ) ? qAbs(a.pearson) : -1.0;
+    double rb = ( b.pearson == b.pearson ) ? qAbs(b.pearson) : -1.0;
+    return ra > rb;
+}
+
+Sensitivity::Sensitivity(Runs *runs,
+                         QStandardItemModel *inputsModel,
+                         const QStringList &outputs,
+                         const QString &timeName,
+                         Metric metric, double time)
+{
+    if ( !runs || !inputsModel || outputs.isEmpty() ) {
+        return;
+    }
+
+    // RunId (column 0) to inputs row
+    QHash<int,int> runId2row;
+    for ( int r = 0; r < inputsModel->rowCount(); ++r ) {
+        bool ok;
+        int runId = inputsModel->data(inputsModel->index(r,0)).toInt(&ok);
+        if ( ok ) {
+            runId2row.insert(runId,r);
+        }
+    }
+
+    // Curve models are created here since Runs is not thread safe
+    QStringList runDirs = runs->runDirs();
+    QList<SensitivityRun> runData;
+    QList<int> inputRows;
+    for ( int i = 0; i < runDirs.size(); ++i ) {
+        int runId = Runs::runId(runDirs.at(i),i);
+        if ( !runId2row.contains(runId) ) {
+            continue;
+        }
+        SensitivityRun run;
+        foreach ( QString output, outputs ) {
+            run.curves.append(runs->curveModel(i,timeName,timeName,output));
+        }
+        runData.append(run);
+        inputRows.append(runId2row.value(runId));
+    }
+
+    QtConcurrent::blockingMap(runData,SensitivityRunReducer(metric,time));
+
+    foreach ( SensitivityRun run, runData ) {
+        foreach ( CurveModel* curveModel, run.curves ) {
+            delete curveModel;
+        }
+    }
+
+    // Output scalars, indexed like inputRows
+    QList<QVector<double> > ys;
+    for ( int j = 0; j < outputs.size(); ++j ) {
+        QVector<double> y(runData.size());
+        for ( int k = 0; k < runData.size(); ++k ) {
+            y[k] = runData.at(k).values.at(j);
+        }
+        ys.append(y);
+    }
+
+    // Dispersed inputs i.e. numeric columns that vary across runs
+    QList<QVector<double> > xs;
+    QStringList inputNames;
+    for ( int c = 1; c < inputsModel->columnCount(); ++c ) {
+        QVector<double> x(inputRows.size());
+        bool isNumeric = true;
+        bool isDispersed = false;
+        for ( int k = 0; k < inputRows.size(); ++k ) {
+            QModelIndex idx = inputsModel->index(inputRows.at(k),c);
+            x[k] = inputsModel->data(idx).toDouble(&isNumeric);
+            if ( !isNumeric ) {
+                break;
+            }
+            if ( x.at(k) != x.at(0) ) {
+                isDispersed = true;
+            }
+        }
+        if ( isNumeric && isDispersed ) {
+            xs.append(x);
+            inputNames.append(inputsModel->headerData(c,Qt::Horizontal)
+                                                                  .toString());
+        }
+    }
+
+    QList<SensitivityPair> pairs;
+    for ( int j = 0; j < outputs.size(); ++j ) {
+        for ( int c = 0; c < xs.size(); ++c ) {
+            SensitivityPair pair;
+            pair.x = &xs.at(c);
+            pair.y = &ys.at(j);
+            pair.result.output = outputs.at(j);
+            pair.result.input = inputNames.at(c);
+            pairs.append(pair);
+        }
+    }
+
+    QtConcurrent::blockingMap(pairs,SensitivityPairCorrelator());
+
+    foreach ( SensitivityPair pair, pairs ) {
+        _results.append(pair.result);
+    }
+    std::stable_sort(_results.begin(),_results.end(),_isStronger);
+}
+
+QStandardItemModel *Sensitivity::createModel(QObject *parent) const
+{
+    QStringList labels;
+    labels << "Output" << "Input" << "Pearson" << "Spearman"
+           << "Slope" << "Intercept" << "R^2" << "N";
+
+    QStandardItemModel* m = new QStandardItemModel(_results.size(),
+                                                   labels.size(),parent);
+    m->setHorizontalHeaderLabels(labels);
+
+    int r = 0;
+    foreach ( SensitivityResult result, _results ) {
+        QList<double> vals;
+        vals << result.pearson << result.spearman << result.slope
+             << result.intercept << result.r2;
+        m->setItem(r,0,new QStandardItem(result.output));
+        m->setItem(r,1,new QStandardItem(result.input));
+        int c = 2;
+        foreach ( double val, vals ) {
+            QString s = QString("%1").arg(val,0,'g',6);
+            m->setItem(r,c,new NumSortItem(s));
+            ++c;
+        }
+        m->setItem(r,c,new NumSortItem(QString("%1").arg(result.n)));
+        ++r;
+    }
+
+    return m;
+}
+
+QStringList Sensitivity::metricNames()
+{
+    QStringList names;
+    names << "time" << "final" << "max" << "min" << "mean";
+    return names;
+}
+
+Sensitivity::Metric Sensitivity::metric(const QString &name)
+{
+    int i = metricNames().indexOf(name);
+    if ( i < 0 ) {
+        fprintf(stderr,"koviz [bad scoobs]: Sensitivity::metric() "
+                       "unknown metric \"%s\"\n",
+                       name.toLatin1().constData());
+        exit(-1);
+    }
+    return (Metric)i;
+}
+
+double Sensitivity::curveScalar(CurveModel *curveModel,
+                                Metric metric, double time)
+{
+    Feature::Kind kind = Feature::AtTime;
+    switch (metric) {
+    case AtTime: kind = Feature::AtTime; break;
+    case Final: kind = Feature::Final; break;
+    case Max: kind = Feature::Max; break;
+    case Min: kind = Feature::Min; break;
+    case Mean: kind = Feature::Mean; break;
+    }
+    Feature feature(kind,curveModel->y()->name(),time);
+    return feature.compute(curveModel);
+}
+
+static bool _isLessFirst(const QPair<double,int>& a,
+                         const QPair<double,int>& b)
+{
+    return a.first < b.first;
+}
+
+// Ranks 1..n with ties given their average rank
+static QVector<double> _ranks(const QVector<double>& v)
+{
+    int n = v.size();
+    QVector<QPair<double,int> > sorted(n);
+    for ( int i = 0; i < n; ++i ) {
+        sorted[i] = qMakePair(v.at(i),i);
+    }
+    std::sort(sorted.begin(),sorted.end(),_isLessFirst);
+
+    QVector<double> ranks(n);
+    int i = 0;
+    while ( i < n ) {
+        int j = i;
+        while ( j+1 < n && sorted.at(j+1).first == sorted.at(i).first ) {
+            ++j;
+        }
+        double rank = (i+j)/2.0 + 1.0;
+        for ( int k = i; k <= j; ++k ) {
+            ranks[sorted.at(k).second] = rank;
+        }
+        i = j+1;
+    }
+    return ranks;
+}
+
+static double _pearson(const QVector<double>& x, const QVector<double>& y,
+                       double* slope, double* intercept)
+{
+    int n = x.size();
+    double mx = 0.0;
+    double my = 0.0;
+    for ( int i = 0; i < n; ++i ) {
+        mx += x.at(i);
+        my += y.at(i);
+    }
+    mx /= n;
+    my /= n;
+
+    double sxx = 0.0;
+    double syy = 0.0;
+    double sxy = 0.0;
+    for ( int i = 0; i < n; ++i ) {
+        double dx = x.at(i)-mx;
+        double dy = y.at(i)-my;
+        sxx += dx*dx;
+        syy += dy*dy;
+        sxy += dx*dy;
+    }
+
+    if ( slope && sxx > 0.0 ) {
+        *slope = sxy/sxx;
+        *intercept = my - (*slope)*mx;
+    }
+    if ( sxx <= 0.0 || syy <= 0.0 ) {
+        return NAN;
+    }
+    return sxy/sqrt(sxx*syy);
+}
+
+SensitivityResult Sensitivity::correlate(const QVector<double> &x,
+                                         const QVector<double> &y)
+{
+    SensitivityResult result;
+
+    // Pairs where both are numbers
+    QVector<double> px;
+    QVector<double> py;
+    for ( int i = 0; i < x.size() && i < y.size(); ++i ) {
+        if ( x.at(i) == x.at(i) && y.at(i) == y.at(i) ) {
+            px.append(x.at(i));
+            py.append(y.at(i));
+        }
+    }
+    result.n = px.size();
+    if ( result.n < 3 ) {
+        return result;
+    }
+
+    result.pearson = _pearson(px,py,&result.slope,&result.intercept);
+    result.r2 = result.pearson*result.pearson;
+    result.spearman = _pearson(_ranks(px),_ranks(py),0,0);
+
+    return result;
+}
@@ -0,0 +1,75 @@
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QStandardItemModel>
+#include <math.h>
+
+#include "runs.h"
+#include "curvemodel.h"
+#include "numsortitem.h"
+#include "features.h"
+
+class SensitivityResult
+{
+  public:
+    SensitivityResult() :
+        n(0), pearson(NAN), spearman(NAN), slope(NAN), intercept(NAN),
+        r2(NAN) {}
+
+    QString output;
+    QString input;
+    int n;              // runs with both input and output
+    double pearson;
+    double spearman;    // rank correlation
+    double slope;       // output = slope*input + intercept
+    double intercept;
+    double r2;
+};
+
+//
+// Sensitivity of MONTE outputs to the dispersed monte_runs inputs
+//
+// Each output variable is reduced to one scalar per run (e.g. its value
+// at a time, or its max).  The scalars are correlated against every
+// input column whose values vary across runs.  Runs are reduced in
+// parallel (one task per run, so a run's data is mapped once for all
+// outputs) and the output/input pairs are then correlated in parallel.
+//
+// Column 0 of the inputs model is the RunId by convention.
+//
+class Sensitivity
+{
+  public:
+    enum Metric { AtTime, Final, Max, Min, Mean };
+
+    Sensitivity(Runs* runs,
+                QStandardItemModel* inputsModel,
+                const QStringList& outputs,
+                const QString& timeName,
+                Metric metric,
+                double time = 0.0);
+
+    QList<SensitivityResult> results() const { return _results; }
+
+    // Sortable table of results, strongest correlation first
+    QStandardItemModel* createModel(QObject* parent = 0) const;
+
+    static QStringList metricNames();
+    static Metric metric(const QString& name);
+
+    // Scalar of a curve's y, NAN if it has no value (e.g. time out of range)
+    static double curveScalar(CurveModel* curveModel,
+                              Metric metric, double time);
+
+    static SensitivityResult correlate(const QVector<double>& x,
+                                       const QVector<double>& y);
+
+  private:
+    QList<SensitivityResult> _results;
+};
+
+#endif // SENSITIVITY_H
@@ -0,0 +1,101 @@
+#include "sensitivitywindow.h"
+
+SensitivityWindow::SensitivityWindow(Runs *runs,
+                                     QStandardItemModel *inputsModel,
+                                     const QString &timeName,
+                                     const QStringList &outputs,
+                                     QWidget *parent) :
+    QWidget(parent,Qt::Window),
+    _runs(runs),
+    _inputsModel(inputsModel),
+    _timeName(timeName),
+    _resultsModel(0)
+{
+    setWindowTitle(tr("koviz sensitivity"));
+
+    _outputsEdit = new QLineEdit(this);
+    _outputsEdit->setText(outputs.join(","));
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+    _outputsEdit->setPlaceholderText("Output vars (comma separated)");
+#endif
+
+    _metricBox = new QComboBox(this);
+    _metricBox->addItems(Sensitivity::metricNames());
+    _metricBox->setCurrentIndex(Sensitivity::metricNames().indexOf("final"));
+
+    _timeEdit = new QLineEdit(this);
+    _timeEdit->setAlignment(Qt::AlignRight);
+    _timeEdit->setValidator(new QDoubleValidator(this));
+#if QT_VERSION >= QT_VERSION_CHECK(4,8,0)
+    _timeEdit->setPlaceholderText("Time");
+#endif
+    _timeEdit->setEnabled(false);
+
+    _computeButton = new QPushButton(tr("Compute"),this);
+
+    _tableView = new QTableView(this);
+    _tableView->setSortingEnabled(true);
+    _tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _tableView->verticalHeader()->hide();
+
+    QGridLayout* layout = new QGridLayout(this);
+    layout->addWidget(new QLabel(tr("Outputs"),this),0,0);
+    layout->addWidget(_outputsEdit,0,1,1,3);
+    layout->addWidget(new QLabel(tr("Per run"),this),1,0);
+    layout->addWidget(_metricBox,1,1);
+    layout->addWidget(_timeEdit,1,2);
+    layout->addWidget(_computeButton,1,3);
+    layout->addWidget(_tableView,2,0,1,4);
+    layout->setColumnStretch(1,1);
+
+    connect(_computeButton,SIGNAL(clicked()),this,SLOT(_compute()));
+    connect(_outputsEdit,SIGNAL(returnPressed()),this,SLOT(_compute()));
+    connect(_metricBox,SIGNAL(currentIndexChanged(QString)),
+            this,SLOT(_metricChanged(QString)));
+
+    resize(720,480);
+}
+
+SensitivityWindow::~SensitivityWindow()
+{
+}
+
+void SensitivityWindow::_metricChanged(const QString &metric)
+{
+    _timeEdit->setEnabled(metric == "time");
+}
+
+void SensitivityWindow::_compute()
+{
+    QStringList outputs;
+    foreach ( QString output, _outputsEdit->text().split(',',
+                                                   QString::SkipEmptyParts) ) {
+        outputs << output.trimmed();
+    }
+    if ( outputs.isEmpty() ) {
+        return;
+    }
+
+    Sensitivity::Metric metric = Sensitivity::metric(
+                                                   _metricBox->currentText());
+    double time = _timeEdit->text().toDouble();
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    try {
+        Sensitivity sensitivity(_runs,_inputsModel,outputs,_timeName,
+                                metric,time);
+        QStandardItemModel* m = sensitivity.createModel(this);
+        _tableView->setModel(m);
+        _tableView->resizeColumnsToContents();
+        if ( _resultsModel ) {
+            delete _resultsModel;
+        }
+        _resultsModel = m;
+    } catch (std::runtime_error &e) {
+        QApplication::restoreOverrideCursor();
+        QMessageBox::warning(this,tr("koviz"),e.what());
+        return;
+    }
+    QApplication::restoreOverrideCursor();
+}
@@ -0,0 +1,52 @@
+#ifndef SENSITIVITYWINDOW_H
+#define SENSITIVITYWINDOW_H
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QDoubleValidator>
+#include <QComboBox>
+#include <QPushButton>
+#include <QTableView>
+#include <QGridLayout>
+#include <QLabel>
+#include <QHeaderView>
+#include <QApplication>
+#include <QMessageBox>
+#include <QStandardItemModel>
+#include <stdexcept>
+
+#include "runs.h"
+#include "sensitivity.h"
+
+//
+// Table of output sensitivities to the MONTE inputs
+//
+class SensitivityWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SensitivityWindow(Runs* runs,
+                               QStandardItemModel* inputsModel,
+                               const QString& timeName,
+                               const QStringList& outputs,
+                               QWidget *parent = 0);
+    ~SensitivityWindow();
+
+private:
+    Runs* _runs;
+    QStandardItemModel* _inputsModel;
+    QString _timeName;
+    QLineEdit* _outputsEdit;
+    QComboBox* _metricBox;
+    QLineEdit* _timeEdit;
+    QPushButton* _computeButton;
+    QTableView* _tableView;
+    QStandardItemModel* _resultsModel;
+
+private slots:
+    void _compute();
+    void _metricChanged(const QString& metric);
+};
+
+#endif // SENSITIVITYWINDOW_H
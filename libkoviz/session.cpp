@@ -135,11 +135,12 @@ Session::Session(const QString &sessionFileName) :
             }
             if ( _presentation != "compare" &&
                  _presentation != "error" &&
-                 _presentation != "error+compare") {
+                 _presentation != "error+compare" &&
+                 _presentation != "envelope" ) {
                 fprintf(stderr,"koviz [error]: session file has presentation "
                                "set to \"%s\".  For now, koviz only "
-                               "supports \"compare\", \"error\" and "
-                               "\"error+compare\"\n",
+                               "supports \"compare\", \"error\", "
+                               "\"error+compare\" and \"envelope\"\n",
                                _presentation.toLatin1().constData());
                 exit(-1);
             }
@@ -7,10 +7,13 @@
 #include <cmath>
 #include <QDir>
 #include <QFile>
+#include <QtConcurrentMap>
 #include <stdexcept>
+#include <algorithm>
 
 #include "snap.h"
 #include "versionnumber.h"
+#include "trace.h"
 
 bool topThreadGreaterThan(const QPair<double,Thread*>& a,
                          const QPair<double,Thread*>& b)
@@ -22,6 +25,25 @@ bool topThreadGreaterThan(const QPair<double,Thread*>& a,
     }
 }
 
+// Functor for partially sorting frame indices by frame time (largest first)
+class FrameIdxGreaterThan
+{
+  public:
+    FrameIdxGreaterThan(const QVector<double>& frameTimes) :
+        _frameTimes(frameTimes) {}
+    bool operator()(int a, int b) const
+    {
+        return _frameTimes.at(a) > _frameTimes.at(b);
+    }
+  private:
+    const QVector<double>& _frameTimes;
+};
+
+static void jobDoStats(Job*& job)
+{
+    job->avg_runtime();  // calculates and caches all job stats
+}
+
 QString Snap::_err_string;
 QTextStream Snap::_err_stream(&Snap::_err_string);
 
@@ -57,8 +79,13 @@ void Snap::load()
 
 void Snap::_load()
 {
+    KOVIZ_TRACE("snap stats");
+
     _process_models();        // _jobs list created
 
+    // Job stats are independent of each other, so calc them across cores
+    QtConcurrent::blockingMap(_jobs,jobDoStats);
+
     qSort(_jobs.begin(), _jobs.end(), jobAvgTimeGreaterThan);
 
     _curr_sort_method = SortByJobAvgTime;
@@ -101,6 +128,9 @@ Snap::~Snap()
     foreach ( CurveModel* curve, _curves ) {
         delete curve;
     }
+    foreach ( RuntimeMatrix* matrix, _matrices ) {
+        delete matrix;
+    }
 
     if (_trickJobModel ) delete _trickJobModel;
     foreach ( DataModel* m, _userJobModels ) {
@@ -498,15 +528,22 @@ SnapTable* Snap::jobTableAtTime(double time)
     table->setHeaderData(c,Qt::Horizontal,QVariant("Thread Id")); c++;
     table->setHeaderData(c,Qt::Horizontal,QVariant("Thread Time")); c++;
 
-    Frame frame(0,0,0,0); //bogus
-    int tidx = _thread0->jobAtIndex(0)->curve()->indexAtTime(time);
-
-    for ( int ii = 0; ii < _frames.size(); ++ii) {
-        frame = _frames.at(ii);
-        if ( frame.timeidx() == tidx ) {
-            break;
-        }
+    const QVector<double>& frameTimeStamps = _thread0->frameTimeStamps();
+    const QVector<double>& frameRunTimes = _thread0->frameRunTimes();
+    int tidx = std::lower_bound(frameTimeStamps.constBegin(),
+                                frameTimeStamps.constEnd(),time) -
+               frameTimeStamps.constBegin();
+    if ( tidx >= frameTimeStamps.size() ) {
+        tidx = frameTimeStamps.size()-1;
+    }
+    if ( tidx > 0 && qAbs(time-frameTimeStamps.at(tidx-1)) <
+                     qAbs(frameTimeStamps.at(tidx)-time) ) {
+        --tidx;
+    }
+    if ( tidx < 0 ) {
+        return table;
     }
+    Frame frame(&_jobs,tidx,frameTimeStamps.at(tidx),frameRunTimes.at(tidx));
 
     double ft = _thread0->runtime(time);
 
@@ -550,12 +587,14 @@ SnapTable* Snap::jobTableAtTime(double time)
 
 double Snap::_calc_frame_avg()
 {
+    const QVector<double>& frameTimes = _thread0->frameRunTimes();
+
     double sum = 0.0 ;
-    foreach ( Frame frame, _frames ) {
-        sum += frame.frame_time();
+    for ( int i = 0; i < frameTimes.size(); ++i ) {
+        sum += frameTimes.at(i);
     }
 
-    return sum/_frames.length() ;
+    return sum/frameTimes.size() ;
 }
 
 double Snap::_calc_frame_stddev(double frameAvg)
@@ -564,25 +603,30 @@ double Snap::_calc_frame_stddev(double frameAvg)
         return 0.0;
     }
 
+    const QVector<double>& frameTimes = _thread0->frameRunTimes();
+
     double sum = 0.0 ;
-    foreach ( Frame frame, _frames ) {
-        double frametime =  frame.frame_time();
+    for ( int i = 0; i < frameTimes.size(); ++i ) {
+        double frametime = frameTimes.at(i);
         double vv = (frametime-frameAvg)*(frametime-frameAvg);
         sum += vv;
     }
 
-    return sqrt(sum/_frames.length()) ;
+    return sqrt(sum/frameTimes.size()) ;
 }
 
 bool Snap::_process_jobs(DataModel* model )
 {
     bool ret = true;
 
+    RuntimeMatrix* matrix = new RuntimeMatrix(model);
+    _matrices.append(matrix);
+
     int nParams = model->columnCount();
     for ( int i = 1 ; i < nParams; ++i ) {
         CurveModel* curve = new CurveModel(model,0,i,i);
         _curves.append(curve);
-        Job* job = new Job(curve);
+        Job* job = new Job(curve,matrix,i);
         if ( job->isFrameTimerJob() ) {
             delete job;
             continue;
@@ -599,19 +643,25 @@ QList<Frame> Snap::_process_frames()
 {
     QList<Frame> frames;
 
-    SnapTable* curve = _thread0->runtimeCurve();
-    int rc = curve->rowCount();
+    const QVector<double>& timeStamps = _thread0->frameTimeStamps();
+    const QVector<double>& frameTimes = _thread0->frameRunTimes();
+    int rc = frameTimes.size();
 
+    // Only the top spikes are reported, so partially sort frame indices
+    const int maxSpikes = 100;
+    QVector<int> idxs(rc);
     for ( int row = 0 ; row < rc ; ++row ) {
-        QModelIndex tIdx = curve->index(row,0);
-        QModelIndex ftIdx = curve->index(row,1);
-        double t = curve->data(tIdx).toDouble();   // timestamp
-        double ft = curve->data(ftIdx).toDouble(); // frame time
-        Frame frame(&_jobs,row,t,ft);
-        frames.append(frame);
+        idxs[row] = row;
     }
+    int n = qMin(maxSpikes,rc);
+    std::partial_sort(idxs.begin(),idxs.begin()+n,idxs.end(),
+                      FrameIdxGreaterThan(frameTimes));
 
-    qSort(frames.begin(), frames.end(), frameTimeGreaterThan);
+    for ( int i = 0 ; i < n ; ++i ) {
+        int row = idxs.at(i);
+        Frame frame(&_jobs,row,timeStamps.at(row),frameTimes.at(row));
+        frames.append(frame);
+    }
 
     return frames;
 }
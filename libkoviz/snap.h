@@ -23,6 +23,7 @@
 #include "snaptable.h"
 #include "datamodel.h"
 #include "curvemodel.h"
+#include "runtimematrix.h"
 
 #define TXT(X) X.toLatin1().constData()
 
@@ -79,6 +80,7 @@ public:
 
     QList<SimObject> simobjects() const { return _simobjects->list(); }
     Threads* threads() const { return _threads; }
+    // Top spike frames sorted by frame time (largest first)
     const QList<Frame>* frames() const { return &_frames; }
 
     QList<SnapTable*> tables;
@@ -108,6 +110,7 @@ private:
     SortBy _curr_sort_method;
     QList<Job*> _jobs;
     QList<CurveModel*> _curves;
+    QList<RuntimeMatrix*> _matrices;
     QString _job_logname(const Job* job) const;
     QMap<QString,Job*> _id_to_job;
 
@@ -0,0 +1,512 @@
+#include "snapmonitor.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QPair>
+#include <QHash>
+#include <float.h>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+#include "frame.h"
+#include "job.h"
+
+RingBuffer::RingBuffer(int capacity) :
+    _data(capacity > 0 ? capacity : 1),
+    _head(0),
+    _size(0)
+{
+}
+
+void RingBuffer::append(double val)
+{
+    _data[_head] = val;
+    _head = (_head+1)%_data.size();
+    if ( _size < _data.size() ) {
+        ++_size;
+    }
+}
+
+double RingBuffer::at(int i) const
+{
+    int cap = _data.size();
+    return _data.at((_head-_size+i+cap)%cap);
+}
+
+QVector<double> RingBuffer::values() const
+{
+    QVector<double> vals(_size);
+    for ( int i = 0; i < _size; ++i ) {
+        vals[i] = at(i);
+    }
+    return vals;
+}
+
+QuantileSketch::QuantileSketch(double p) :
+    _p(p),
+    _count(0)
+{
+    for ( int i = 0; i < 5; ++i ) {
+        _q[i] = 0.0;
+        _n[i] = i;
+    }
+    _np[0] = 0.0;
+    _np[1] = 2.0*p;
+    _np[2] = 4.0*p;
+    _np[3] = 2.0+2.0*p;
+    _np[4] = 4.0;
+    _dn[0] = 0.0;
+    _dn[1] = p/2.0;
+    _dn[2] = p;
+    _dn[3] = (1.0+p)/2.0;
+    _dn[4] = 1.0;
+}
+
+void QuantileSketch::add(double x)
+{
+    if ( _count < 5 ) {
+        // First five observations are kept sorted as the markers
+        int i = _count;
+        while ( i > 0 && _q[i-1] > x ) {
+            _q[i] = _q[i-1];
+            --i;
+        }
+        _q[i] = x;
+        ++_count;
+        return;
+    }
+    ++_count;
+
+    // Find cell k that x falls in, stretching end markers if needed
+    int k;
+    if ( x < _q[0] ) {
+        _q[0] = x;
+        k = 0;
+    } else if ( x >= _q[4] ) {
+        _q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while ( k < 3 && x >= _q[k+1] ) {
+            ++k;
+        }
+    }
+
+    for ( int i = k+1; i < 5; ++i ) {
+        _n[i] += 1.0;
+    }
+    for ( int i = 0; i < 5; ++i ) {
+        _np[i] += _dn[i];
+    }
+
+    // Adjust middle markers that are off their desired positions
+    for ( int i = 1; i < 4; ++i ) {
+        double d = _np[i]-_n[i];
+        if ( (d >= 1.0 && _n[i+1]-_n[i] > 1.0) ||
+             (d <= -1.0 && _n[i-1]-_n[i] < -1.0) ) {
+            int ds = ( d > 0.0 ) ? 1 : -1;
+            double q = _parabolic(i,ds);
+            if ( _q[i-1] < q && q < _q[i+1] ) {
+                _q[i] = q;
+            } else {
+                _q[i] = _linear(i,ds);
+            }
+            _n[i] += ds;
+        }
+    }
+}
+
+double QuantileSketch::value() const
+{
+    if ( _count == 0 ) {
+        return 0.0;
+    }
+    if ( _count < 5 ) {
+        int i = (int)ceil(_p*_count)-1;
+        if ( i < 0 ) i = 0;
+        return _q[i];
+    }
+    return _q[2];
+}
+
+double QuantileSketch::_parabolic(int i, double d) const
+{
+    return _q[i] + d/(_n[i+1]-_n[i-1]) *
+           ((_n[i]-_n[i-1]+d)*(_q[i+1]-_q[i])/(_n[i+1]-_n[i]) +
+            (_n[i+1]-_n[i]-d)*(_q[i]-_q[i-1])/(_n[i]-_n[i-1]));
+}
+
+double QuantileSketch::_linear(int i, int d) const
+{
+    return _q[i] + d*(_q[i+d]-_q[i])/(_n[i+d]-_n[i]);
+}
+
+// Nearest rank percentile of sorted values
+static double _percentile(const QVector<double>& sorted, double p)
+{
+    if ( sorted.isEmpty() ) {
+        return 0.0;
+    }
+    int i = (int)ceil(p*sorted.size())-1;
+    if ( i < 0 ) i = 0;
+    if ( i >= sorted.size() ) i = sorted.size()-1;
+    return sorted.at(i);
+}
+
+static QString _jsonString(const QString& str)
+{
+    QString s(str);
+    s.replace("\\","\\\\");
+    s.replace("\"","\\\"");
+    return QString("\"%1\"").arg(s);
+}
+
+QString SnapMonitor::_err_string;
+QTextStream SnapMonitor::_err_stream(&SnapMonitor::_err_string);
+
+SnapMonitor::SnapMonitor(const QString &rundir,
+                         const QStringList &timeNames,
+                         int windowSize, int topK,
+                         bool isJson, FILE *out, QObject *parent) :
+    QObject(parent),
+    _rundir(rundir),
+    _timeNames(timeNames),
+    _isJson(isJson),
+    _out(out),
+    _frameModel(0),
+    _frameSchedTimeCol(-1),
+    _frameOverrunTimeCol(-1),
+    _frameRow(0),
+    _trickJobModel(0),
+    _advanceSimTimeCol(-1),
+    _topK(topK),
+    _numFrames(0),
+    _numOverruns(0),
+    _maxFrameTime(0.0),
+    _lastTimeStamp(0.0),
+    _windowFrameTimes(windowSize),
+    _windowOverruns(windowSize),
+    _p50(0.50),
+    _p95(0.95),
+    _p99(0.99)
+{
+    QString fileNameLogFrame;
+    QString fileNameTrickJobs;
+    QStringList fileNamesUserJobs;
+    _setLogFileNames(&fileNameLogFrame,&fileNameTrickJobs,&fileNamesUserJobs);
+
+    _frameModel = _createModel(fileNameLogFrame);
+    _frameSchedTimeCol = _frameModel->paramColumn(Frame::frame_sched_time);
+    _frameOverrunTimeCol = _frameModel->paramColumn(Frame::frame_overrun_time);
+    if ( _frameSchedTimeCol < 0 || _frameOverrunTimeCol < 0 ) {
+        QString param  = ( _frameSchedTimeCol  < 0 ) ?
+                    Frame::frame_sched_time : Frame::frame_overrun_time ;
+        _err_stream << "koviz [error]: Couldn't find parameter "
+                    << param
+                    << " in file \""
+                    << _frameModel->fileName()
+                    << "\"";
+        throw std::invalid_argument(_err_string.toLatin1().constData());
+    }
+
+    if ( !fileNameTrickJobs.isEmpty() ) {
+        _trickJobModel = _createModel(fileNameTrickJobs);
+        _jobModels.append(_trickJobModel);
+    }
+    foreach ( QString userJob, fileNamesUserJobs ) {
+        _jobModels.append(_createModel(userJob));
+    }
+
+    foreach ( DataModel* model, _jobModels ) {
+        int ncols = model->columnCount();
+        for ( int col = 1; col < ncols; ++col ) {
+            QString jobId = model->param(col)->name();
+            if ( model == _trickJobModel &&
+                 jobId.contains("advance_sim_time") ) {
+                // Excluded from frame time, like snap
+                _advanceSimTimeCol = col;
+                continue;
+            }
+            Job job(jobId);
+            if ( job.isFrameTimerJob() ) {
+                continue;
+            }
+            JobStat stat;
+            stat.model = model;
+            stat.col = col;
+            stat.name = job.job_name();
+            stat.hits = 0;
+            stat.sumRuntime = 0.0;
+            stat.maxRuntime = 0.0;
+            _jobStats.append(stat);
+        }
+    }
+}
+
+SnapMonitor::~SnapMonitor()
+{
+    delete _frameModel;
+    foreach ( DataModel* model, _jobModels ) {
+        delete model;
+    }
+}
+
+void SnapMonitor::start(double refreshRate)
+{
+    if ( refreshRate <= 0.0 ) {
+        refreshRate = 1.0;
+    }
+    _timer.setInterval((int)(1000.0/refreshRate));
+    connect(&_timer,SIGNAL(timeout()),this,SLOT(_refresh()));
+    _timer.start();
+}
+
+void SnapMonitor::_refresh()
+{
+    update(true);
+}
+
+// Consume frames logged since last update and report if there were any
+//
+// If isWaitForJobs, frames later than what the job logs have logged so far
+// are left for the next update (the logs are not written in lock step).
+void SnapMonitor::update(bool isWaitForJobs)
+{
+    _frameModel->refresh();
+    foreach ( DataModel* model, _jobModels ) {
+        model->refresh();
+    }
+
+    double readyTime = isWaitForJobs ? _readyTime() : DBL_MAX;
+
+    int nNewFrames = 0;
+    ModelIterator* it = _frameModel->begin(0,_frameSchedTimeCol,
+                                           _frameOverrunTimeCol);
+    it = it->at(_frameRow);
+    while ( !it->isDone() ) {
+
+        double t = it->t();
+        if ( t > readyTime+1.0e-9 ) {
+            break;
+        }
+
+        double ft = it->x()/1000000.0;
+        if ( _trickJobModel && _advanceSimTimeCol > 0 ) {
+            int row = _trickJobModel->indexAtTime(t);
+            QModelIndex idx = _trickJobModel->index(row,_advanceSimTimeCol);
+            ft -= _trickJobModel->data(idx).toDouble()/1000000.0;
+        }
+        if ( ft < 0.0 ) ft = 0.0;
+
+        bool isOverrun = ( it->y() > 0.0 );
+        if ( isOverrun ) {
+            ++_numOverruns;
+            _attributeOverrun(t);
+        }
+
+        ++_numFrames;
+        if ( ft > _maxFrameTime ) {
+            _maxFrameTime = ft;
+        }
+        _lastTimeStamp = t;
+        _windowFrameTimes.append(ft);
+        _windowOverruns.append(isOverrun ? 1.0 : 0.0);
+        _p50.add(ft);
+        _p95.add(ft);
+        _p99.add(ft);
+
+        ++_frameRow;
+        ++nNewFrames;
+        it->next();
+    }
+    delete it;
+
+    if ( nNewFrames > 0 ) {
+        _report();
+    }
+}
+
+// Latest time that all job logs (with data) have logged
+double SnapMonitor::_readyTime() const
+{
+    double readyTime = DBL_MAX;
+    foreach ( DataModel* model, _jobModels ) {
+        int rc = model->rowCount();
+        if ( rc == 0 ) {
+            continue;
+        }
+        double t = model->data(model->index(rc-1,0)).toDouble();
+        if ( t < readyTime ) {
+            readyTime = t;
+        }
+    }
+    return readyTime;
+}
+
+// Charge the jobs with the most runtime in an overrun frame
+void SnapMonitor::_attributeOverrun(double timeStamp)
+{
+    QHash<DataModel*,int> model2row;
+    foreach ( DataModel* model, _jobModels ) {
+        if ( model->rowCount() > 0 ) {
+            model2row.insert(model,model->indexAtTime(timeStamp));
+        }
+    }
+
+    QVector<QPair<double,int> > rts;
+    for ( int i = 0; i < _jobStats.size(); ++i ) {
+        const JobStat& stat = _jobStats.at(i);
+        if ( !model2row.contains(stat.model) ) {
+            continue;
+        }
+        int row = model2row.value(stat.model);
+        double rt = stat.model->data(stat.model->index(row,stat.col))
+                                                      .toDouble()/1000000.0;
+        if ( rt > 0.0 ) {
+            rts.append(qMakePair(rt,i));
+        }
+    }
+
+    int k = qMin(_topK,rts.size());
+    std::partial_sort(rts.begin(),rts.begin()+k,rts.end(),
+                      std::greater<QPair<double,int> >());
+    for ( int i = 0; i < k; ++i ) {
+        JobStat& stat = _jobStats[rts.at(i).second];
+        double rt = rts.at(i).first;
+        stat.hits++;
+        stat.sumRuntime += rt;
+        if ( rt > stat.maxRuntime ) {
+            stat.maxRuntime = rt;
+        }
+    }
+}
+
+void SnapMonitor::_report()
+{
+    QVector<double> win = _windowFrameTimes.values();
+    std::sort(win.begin(),win.end());
+    int winOverruns = 0;
+    for ( int i = 0; i < _windowOverruns.size(); ++i ) {
+        if ( _windowOverruns.at(i) > 0.0 ) {
+            ++winOverruns;
+        }
+    }
+
+    // Top offending jobs by runtime spent in overrun frames
+    QVector<QPair<double,int> > jobs;
+    for ( int i = 0; i < _jobStats.size(); ++i ) {
+        if ( _jobStats.at(i).hits > 0 ) {
+            jobs.append(qMakePair(_jobStats.at(i).sumRuntime,i));
+        }
+    }
+    int k = qMin(_topK,jobs.size());
+    std::partial_sort(jobs.begin(),jobs.begin()+k,jobs.end(),
+                      std::greater<QPair<double,int> >());
+
+    double percentOverruns = 100.0*_numOverruns/(double)_numFrames;
+    QString rpt;
+    QString str;
+    if ( _isJson ) {
+        rpt += "{";
+        rpt += str.sprintf("\"time\":%.6f,\"frames\":%d,\"overruns\":%d,"
+                           "\"percentOverruns\":%.4f,",
+                           _lastTimeStamp,_numFrames,_numOverruns,
+                           percentOverruns);
+        rpt += str.sprintf("\"frameTime\":{\"p50\":%.9f,\"p95\":%.9f,"
+                           "\"p99\":%.9f,\"max\":%.9f},",
+                           _p50.value(),_p95.value(),_p99.value(),
+                           _maxFrameTime);
+        rpt += str.sprintf("\"window\":{\"frames\":%d,\"overruns\":%d,"
+                           "\"p50\":%.9f,\"p95\":%.9f,\"p99\":%.9f,"
+                           "\"max\":%.9f},",
+                           win.size(),winOverruns,
+                           _percentile(win,0.50),_percentile(win,0.95),
+                           _percentile(win,0.99),
+                           win.isEmpty() ? 0.0 : win.last());
+        rpt += "\"topJobs\":[";
+        for ( int i = 0; i < k; ++i ) {
+            const JobStat& stat = _jobStats.at(jobs.at(i).second);
+            if ( i > 0 ) rpt += ",";
+            rpt += "{\"name\":" + _jsonString(stat.name);
+            rpt += str.sprintf(",\"hits\":%d,\"sum\":%.9f,\"max\":%.9f}",
+                               stat.hits,stat.sumRuntime,stat.maxRuntime);
+        }
+        rpt += "]}\n";
+    } else {
+        rpt += str.sprintf("t=%.3f frames=%d overruns=%d (%.2f%%) "
+                           "ft(ms) p50=%.3f p95=%.3f p99=%.3f max=%.3f | ",
+                           _lastTimeStamp,_numFrames,_numOverruns,
+                           percentOverruns,
+                           _p50.value()*1000.0,_p95.value()*1000.0,
+                           _p99.value()*1000.0,_maxFrameTime*1000.0);
+        rpt += str.sprintf("last %d: overruns=%d "
+                           "p50=%.3f p95=%.3f p99=%.3f max=%.3f",
+                           win.size(),winOverruns,
+                           _percentile(win,0.50)*1000.0,
+                           _percentile(win,0.95)*1000.0,
+                           _percentile(win,0.99)*1000.0,
+                           (win.isEmpty() ? 0.0 : win.last())*1000.0);
+        for ( int i = 0; i < k; ++i ) {
+            const JobStat& stat = _jobStats.at(jobs.at(i).second);
+            rpt += (i == 0) ? " | top: " : ", ";
+            rpt += str.sprintf("%s(%d,%.3fms)",
+                               stat.name.toLatin1().constData(),
+                               stat.hits,stat.maxRuntime*1000.0);
+        }
+        rpt += "\n";
+    }
+
+    fprintf(_out,"%s",rpt.toLatin1().constData());
+    fflush(_out);
+}
+
+void SnapMonitor::_setLogFileNames(QString *logFrame, QString *trickJobs,
+                                   QStringList *userJobs) const
+{
+    *logFrame = _rundir + "/log_frame.trk";
+    if ( !QFileInfo(*logFrame).exists() ) {
+        *logFrame = _rundir + "/log_snap_frame.trk";
+        if ( !QFileInfo(*logFrame).exists() ) {
+            _err_stream << "koviz [error]: cannot find log_frame.trk or "
+                        << "log_snap_frame.trk files in "
+                        << "directory " << _rundir;
+            throw std::invalid_argument(_err_string.toLatin1().constData());
+        }
+    }
+
+    QStringList trickJobNames;
+    trickJobNames << "log_trickjobs.trk"
+                  << "log_frame_trickjobs.trk"
+                  << "log_snap_trickjobs.trk";
+    trickJobs->clear();
+    foreach ( QString name, trickJobNames ) {
+        if ( QFileInfo(_rundir + "/" + name).exists() ) {
+            *trickJobs = _rundir + "/" + name;
+            break;
+        }
+    }
+
+    // Trick 13 splits userjobs into separate files
+    QDir dir(_rundir);
+    QStringList filter;
+    filter << "*userjobs*.trk";
+    dir.setNameFilters(filter);
+    foreach ( QString userJob, dir.entryList(QDir::Files) ) {
+        *userJobs << _rundir + "/" + userJob;
+    }
+}
+
+DataModel* SnapMonitor::_createModel(const QString &trk) const
+{
+    DataModel* model = 0;
+    try {
+        model = DataModel::createDataModel(_timeNames,trk);
+    }
+    catch (std::range_error &e) {
+        _err_stream << e.what() << "\n\n";
+        _err_stream << "koviz [error]: SnapMonitor::_createModel()\n";
+        throw std::range_error(_err_string.toLatin1().constData());
+    }
+    return model;
+}
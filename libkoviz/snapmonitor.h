@@ -0,0 +1,151 @@
+#ifndef SNAPMONITOR_H
+#define SNAPMONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QTimer>
+#include <QTextStream>
+#include <stdio.h>
+#include <stdexcept>
+
+#include "datamodel.h"
+
+//
+// Fixed capacity buffer holding the last capacity values appended
+//
+class RingBuffer
+{
+  public:
+    RingBuffer(int capacity);
+
+    void append(double val);
+    int size() const { return _size; }
+    int capacity() const { return _data.size(); }
+    double at(int i) const;     // i=0 is oldest
+    QVector<double> values() const;
+
+  private:
+    RingBuffer() {}
+    QVector<double> _data;
+    int _head;   // next write position
+    int _size;
+};
+
+//
+// Streaming quantile estimate in constant memory (P-square algorithm)
+//
+// Jain & Chlamtac, "The P2 Algorithm for Dynamic Calculation of
+// Quantiles and Histograms Without Storing Observations", CACM 1985
+//
+class QuantileSketch
+{
+  public:
+    QuantileSketch(double p);
+
+    void add(double x);
+    double value() const;
+    int count() const { return _count; }
+
+  private:
+    QuantileSketch() {}
+    double _p;
+    int _count;
+    double _q[5];   // marker heights
+    double _n[5];   // marker positions
+    double _np[5];  // desired marker positions
+    double _dn[5];  // desired position increments
+
+    double _parabolic(int i, double d) const;
+    double _linear(int i, int d) const;
+};
+
+//
+// Realtime frame-overrun monitor for a RUN that is (maybe) still running
+//
+// Follows log_frame.trk, log_trickjobs.trk and the *userjobs*.trk logs
+// and keeps run-to-date and rolling window frame time percentiles,
+// overrun counts and the top jobs in overrun frames.  Memory is bounded
+// by the window size and the number of jobs, not the length of the run.
+//
+// Frame time is the frame scheduling time less advance_sim_time,
+// the same frame time that snap reports.  A frame is only consumed
+// once the job logs have caught up to its timestamp.
+//
+// Each update() with new frames writes one status line, as text or
+// as a JSON object (one per line) for dashboards.
+//
+class SnapMonitor : public QObject
+{
+    Q_OBJECT
+
+  public:
+    SnapMonitor(const QString& rundir,
+                const QStringList& timeNames,
+                int windowSize,
+                int topK,
+                bool isJson,
+                FILE* out=stdout,
+                QObject* parent=0);
+    ~SnapMonitor();
+
+    void start(double refreshRate);  // follow logs, refreshRate in Hz
+    void update(bool isWaitForJobs=true);
+
+  private:
+    QString _rundir;
+    QStringList _timeNames;
+    bool _isJson;
+    FILE* _out;
+
+    DataModel* _frameModel;
+    int _frameSchedTimeCol;
+    int _frameOverrunTimeCol;
+    int _frameRow;                  // next frame log row to consume
+
+    DataModel* _trickJobModel;
+    int _advanceSimTimeCol;
+
+    QList<DataModel*> _jobModels;   // trickjobs + userjobs
+
+    struct JobStat
+    {
+        DataModel* model;
+        int col;
+        QString name;
+        int hits;           // times in top of an overrun frame
+        double sumRuntime;  // runtime spent in overrun frames
+        double maxRuntime;
+    };
+    QVector<JobStat> _jobStats;
+    int _topK;
+
+    int _numFrames;
+    int _numOverruns;
+    double _maxFrameTime;
+    double _lastTimeStamp;
+    RingBuffer _windowFrameTimes;
+    RingBuffer _windowOverruns;     // 1 if frame overran, else 0
+    QuantileSketch _p50;
+    QuantileSketch _p95;
+    QuantileSketch _p99;
+
+    QTimer _timer;
+
+    void _setLogFileNames(QString* logFrame, QString* trickJobs,
+                          QStringList* userJobs) const;
+    DataModel* _createModel(const QString& trk) const;
+    double _readyTime() const;
+    void _attributeOverrun(double timeStamp);
+    void _report();
+
+    static QString _err_string;
+    static QTextStream _err_stream;
+
+  private slots:
+    void _refresh();
+};
+
+#endif // SNAPMONITOR_H
@@ -1,6 +1,7 @@
 #include "thread.h"
 
 #include <cmath>
+#include <algorithm>
 #include <QtCore/qmath.h>
 
 QString Thread::_err_string;
@@ -94,20 +95,21 @@ void Thread::_do_stats()
     int rowCount = 0 ;
     if ( _threadId == 0 && _frameModelIsRealTime ) {
 
-        CurveModel* timeToSyncWithAMFChildrenCurve = 0;
+        Job* timeToSyncWithAMFChildrenJob = 0;
         foreach ( Job* job, _jobs ) {
             if ( job->job_name().contains("advance_sim_time") ) {
-                timeToSyncWithAMFChildrenCurve = job->curve();
+                timeToSyncWithAMFChildrenJob = job;
                 break;
             }
         }
-        if ( timeToSyncWithAMFChildrenCurve == 0 ) {
+        if ( timeToSyncWithAMFChildrenJob == 0 ) {
             _err_stream << "koviz [bad scoobies]: cannot find advance_sim_time "
                         <<   " parameter for thread0 frame calculation."
                         << "  Trick may have changed the name.";
             throw std::runtime_error(_err_string.toLatin1().constData());
         }
-        ModelIterator* iamf = timeToSyncWithAMFChildrenCurve->begin();
+        const RuntimeMatrix* amfMatrix =
+                                 timeToSyncWithAMFChildrenJob->runtimeMatrix();
 
         ModelIterator* it = _frameModel->begin(0,
                                                _frameSchedTimeCol,
@@ -125,8 +127,9 @@ void Thread::_do_stats()
             // Koviz calculates frame time (ft) by excluding executive
             // time waiting to sync with wall clock but includes
             // the sync with amf children
-            int amfIdx  = timeToSyncWithAMFChildrenCurve->indexAtTime(it->t());
-            double timeToSyncWithAMFChildren = iamf->at(amfIdx)->y()/1000000.0;
+            int amfIdx  = amfMatrix->rowAtTime(it->t());
+            double timeToSyncWithAMFChildren =
+                    timeToSyncWithAMFChildrenJob->runtime(amfIdx)/1000000.0;
             double frameSchedTime = it->x()/1000000.0;
             double ft = frameSchedTime - timeToSyncWithAMFChildren;
 
@@ -135,7 +138,10 @@ void Thread::_do_stats()
                 _max_runtime = ft;
                 _tidx_max_runtime = tidx;
             }
-            _jobtimestamp2frametime[it->t()] = ft;
+            _jobTimeStamps.append(it->t());
+            _jobFrameTimes.append(ft);
+            _frameTimeStamps.append(it->t());
+            _frameRunTimes.append(ft);
             QModelIndex timeIdx = _runtimeCurve->index(rowCount,0);
             QModelIndex valIdx = _runtimeCurve->index(rowCount,1);
             ++rowCount;
@@ -148,54 +154,53 @@ void Thread::_do_stats()
             ++tidx;
         }
         delete it;
-        delete iamf;
 
     } else {
         //
         // Calc frame runtimes (sum of jobs runtimes per frame), num overruns etc.
         //
         Job* job0 = _jobs.at(0);
-        CurveModel* curve = job0->curve();
-        ModelIterator* it = curve->begin();
+        const RuntimeMatrix* matrix = job0->runtimeMatrix();
+        const double* times = matrix->times();
+        int nrows = matrix->rowCount();
         double frame_time = 0.0;
         _max_runtime = 0.0;
         int frameidx = 0 ;
         int tidx = 0 ;
 
-        double tnext = it->t() + _freq;
+        double tnext = (nrows > 0 ? times[0] : 0.0) + _freq;
         double epsilon = 1.0e-6;
 
-        _num_overruns = 0;
-        while ( !it->isDone() ) {
-
-            double frameTimeStamp = it->t();
-            QList<double> jobTimeStampsAcrossFrame;
-            while ( !it->isDone() && it->t()+epsilon < tnext ) {
-
-                jobTimeStampsAcrossFrame.append(it->t());
+        // Jobs (except frame timer jobs) whose runtimes make up a frame
+        QVector<Job*> frameJobs;
+        foreach ( Job* job, _jobs ) {
+            if ( job->isFrameTimerJob() ) {
+                // For Trick 13
+                // Do not use child frame scheduling time for frame
+                // time sum.  Koviz reports the sum of the userjobs,
+                // not the frame scheduling time since the frame
+                // scheduling time includes executive overhead
+                // (e.g. the frame logging itself).
+                continue;
+            }
+            frameJobs.append(job);
+        }
 
-                foreach ( Job* job, _jobs ) {
+        _num_overruns = 0;
+        while ( tidx < nrows ) {
 
-                    if ( job->isFrameTimerJob() ) {
-                        // For Trick 13
-                        // Do not use child frame scheduling time for frame
-                        // time sum.  Koviz reports the sum of the userjobs,
-                        // not the frame scheduling time since the frame
-                        // scheduling time includes executive overhead
-                        // (e.g. the frame logging itself).
-                        continue;
-                    }
+            double frameTimeStamp = times[tidx];
+            int tidxFrameBeg = tidx;
+            while ( tidx < nrows && times[tidx]+epsilon < tnext ) {
 
-                    ModelIterator* it2 = job->curve()->begin();
-                    double ft = it2->at(tidx)->x();
-                    delete it2;
+                foreach ( Job* job, frameJobs ) {
+                    double ft = job->runtime(tidx);
                     if ( ft < 0 ) {
                         ft = 0.0;
                     }
                     frame_time += ft;
                 }
                 ++tidx;
-                it->next();
 
                 if ( _freq < epsilon ) {
                     break;
@@ -213,9 +218,12 @@ void Thread::_do_stats()
                 _tidx_max_runtime = frameidx;
             }
 
-            foreach ( double t, jobTimeStampsAcrossFrame ) {
-                _jobtimestamp2frametime[t] = ft;
+            for ( int i = tidxFrameBeg; i < tidx; ++i ) {
+                _jobTimeStamps.append(times[i]);
+                _jobFrameTimes.append(ft);
             }
+            _frameTimeStamps.append(frameTimeStamp);
+            _frameRunTimes.append(ft);
 
             QModelIndex timeIdx = _runtimeCurve->index(rowCount,0);
             QModelIndex valIdx = _runtimeCurve->index(rowCount,1);
@@ -228,8 +236,6 @@ void Thread::_do_stats()
             frameidx++;
             tnext += _freq;
         }
-
-        delete it;
     }
 
     double ss = sum_squares;
@@ -404,27 +410,23 @@ void Thread::_frameModelCalcIsRealTime()
 
 double Thread::runtime(double timestamp) const
 {
-    if ( _jobtimestamp2frametime.empty() ) return -1.0;
-
-    double frameTime = _jobtimestamp2frametime.value(timestamp,-1.0) ;
-
-    if ( frameTime == -1.0 ) {
-        // If timestamp a bit off or if timestamp
-        // not on frame boundary, the timestamp hash key will not work.
-        // Resort to O(n) lookup.
-        double lastTime = _jobtimestamp2frametime.keys().at(0);
-        foreach ( double t, _jobtimestamp2frametime.keys() ) {
-            if ( timestamp-1.0e-9 < t && t < timestamp+1.0e-9 ) {
-                frameTime = _jobtimestamp2frametime.value(t);
-                break;
-            } else if ( t > timestamp ) {
-                frameTime = _jobtimestamp2frametime.value(lastTime);
-                break;
-            }
-            lastTime = t;
-        }
+    if ( _jobTimeStamps.isEmpty() ) return -1.0;
+
+    // If timestamp a bit off or if timestamp not on frame boundary,
+    // use the frame time of the last job timestamp before timestamp
+    QVector<double>::const_iterator it = std::lower_bound(
+                                             _jobTimeStamps.constBegin(),
+                                             _jobTimeStamps.constEnd(),
+                                             timestamp-1.0e-9);
+    int i = it - _jobTimeStamps.constBegin();
+    if ( i == _jobTimeStamps.size() ) {
+        return -1.0;
     }
-    return frameTime;
+    if ( _jobTimeStamps.at(i) >= timestamp+1.0e-9 && i > 0 ) {
+        --i;
+    }
+
+    return _jobFrameTimes.at(i);
 }
 
 int Thread::numFrames() const
@@ -14,6 +14,7 @@
 #include <QDataStream>
 #include <QRegExp>
 #include <QFileInfo>
+#include <QVector>
 
 #include "datamodel.h"
 
@@ -38,6 +39,8 @@ class Thread
     double avgRunTime()              const { return _avg_runtime; }
     double runtime(double timestamp)  const;
     SnapTable* runtimeCurve()         const { return _runtimeCurve; }
+    const QVector<double>& frameTimeStamps() const { return _frameTimeStamps; }
+    const QVector<double>& frameRunTimes()   const { return _frameRunTimes; }
     double avgLoad()                 const { return _avg_load; }
     int    timeIdxAtMaxRunTime()     const { return _tidx_max_runtime; }
     double maxRunTime()              const { return _max_runtime ; }
@@ -81,7 +84,13 @@ class Thread
     static QString _err_string;
     static QTextStream _err_stream;
 
-    QMap<double,double> _jobtimestamp2frametime;
+    // Sorted job timestamps and the frame time of the frame each falls in
+    QVector<double> _jobTimeStamps;
+    QVector<double> _jobFrameTimes;
+
+    // Contiguous copy of _runtimeCurve for vectorized spike detection
+    QVector<double> _frameTimeStamps;
+    QVector<double> _frameRunTimes;
 
     SnapTable* _runtimeCurve; // t,runtime curve
 
@@ -0,0 +1,143 @@
+#include "trace.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <stdio.h>
+
+bool Trace::_isEnabled = false;
+
+struct TraceEvent
+{
+    const char* name;
+    qint64 start;   // nanosecs
+    qint64 dur;
+    int tid;
+};
+
+struct TraceStat
+{
+    int count;
+    qint64 total;
+    qint64 max;
+};
+
+// Cap on kept events so a long session cannot eat memory
+// Summary stats keep counting after the cap is hit
+static const int _maxEvents = 1000000;
+
+static QMutex _mutex;
+static QElapsedTimer _clock;
+static QVector<TraceEvent> _events;
+static QHash<QString,TraceStat> _stats;
+static QHash<Qt::HANDLE,int> _threadIds;
+
+void Trace::setEnabled(bool isEnabled)
+{
+    QMutexLocker locker(&_mutex);
+    if ( isEnabled && !_clock.isValid() ) {
+        _clock.start();
+    }
+    _isEnabled = isEnabled;
+}
+
+qint64 Trace::nsecsElapsed()
+{
+    return _clock.nsecsElapsed();
+}
+
+void Trace::record(const char *name, qint64 startNs, qint64 durNs)
+{
+    QMutexLocker locker(&_mutex);
+
+    Qt::HANDLE thread = QThread::currentThreadId();
+    int tid = _threadIds.value(thread,-1);
+    if ( tid < 0 ) {
+        tid = _threadIds.size();
+        _threadIds.insert(thread,tid);
+    }
+
+    if ( _events.size() < _maxEvents ) {
+        TraceEvent e;
+        e.name = name;
+        e.start = startNs;
+        e.dur = durNs;
+        e.tid = tid;
+        _events.append(e);
+    }
+
+    QString key(name);
+    if ( _stats.contains(key) ) {
+        TraceStat& s = _stats[key];
+        s.count++;
+        s.total += durNs;
+        if ( durNs > s.max ) s.max = durNs;
+    } else {
+        TraceStat s;
+        s.count = 1;
+        s.total = durNs;
+        s.max = durNs;
+        _stats.insert(key,s);
+    }
+}
+
+static bool _totalGreaterThan(const QPair<qint64,QString>& a,
+                              const QPair<qint64,QString>& b)
+{
+    return a.first > b.first;
+}
+
+bool Trace::write(const QString &fileName)
+{
+    QMutexLocker locker(&_mutex);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fprintf(stderr,"koviz [error]: could not open %s\n",
+                fileName.toLatin1().constData());
+        return false;
+    }
+    QTextStream out(&file);
+    QString str;
+
+    if ( fileName.endsWith(".json") ) {
+        // Chrome trace-event format, complete ("X") events in microsecs
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for ( int i = 0; i < _events.size(); ++i ) {
+            const TraceEvent& e = _events.at(i);
+            out << str.sprintf("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+                               "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                               e.name, e.tid,
+                               e.start/1000.0, e.dur/1000.0);
+            out << ( i < _events.size()-1 ? ",\n" : "\n" );
+        }
+        out << "]}\n";
+    } else {
+        QList<QPair<qint64,QString> > totals;
+        foreach ( QString name, _stats.keys() ) {
+            totals.append(qMakePair(_stats.value(name).total,name));
+        }
+        qSort(totals.begin(),totals.end(),_totalGreaterThan);
+
+        out << str.sprintf("%-32s %10s %14s %12s %12s\n",
+                           "Phase","Count","Total(ms)","Mean(ms)","Max(ms)");
+        for ( int i = 0; i < totals.size(); ++i ) {
+            QString name = totals.at(i).second;
+            const TraceStat& s = _stats[name];
+            out << str.sprintf("%-32s %10d %14.3f %12.3f %12.3f\n",
+                               name.toLatin1().constData(), s.count,
+                               s.total/1.0e6, s.total/1.0e6/s.count,
+                               s.max/1.0e6);
+        }
+    }
+
+    file.close();
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <QtGlobal>
+
+//
+// Scoped timers for koviz -profile
+//
+// KOVIZ_TRACE("name") times the rest of the enclosing scope.  Timings are
+// only kept once Trace::setEnabled(true) is called, so an unprofiled run
+// pays one flag check per scope.  Build with DEFINES += KOVIZ_NO_TRACE to
+// compile the timers out altogether.
+//
+// Trace::write() saves a Chrome trace-event file (chrome://tracing,
+// Perfetto) if the file name ends in .json, otherwise a summary table.
+//
+class Trace
+{
+  public:
+    static void setEnabled(bool isEnabled);
+    static bool isEnabled() { return _isEnabled; }
+
+    static void record(const char* name, qint64 startNs, qint64 durNs);
+    static qint64 nsecsElapsed();    // since trace clock started
+
+    static bool write(const QString& fileName);
+
+  private:
+    static bool _isEnabled;
+};
+
+class TraceScope
+{
+  public:
+    TraceScope(const char* name) :
+        _name(name),
+        _start(Trace::isEnabled() ? Trace::nsecsElapsed() : -1)
+    {}
+    ~TraceScope()
+    {
+        if ( _start >= 0 ) {
+            Trace::record(_name,_start,Trace::nsecsElapsed()-_start);
+        }
+    }
+
+  private:
+    TraceScope() {}
+    const char* _name;
+    qint64 _start;
+};
+
+#define KOVIZ_TRACE_CAT2(a,b) a##b
+#define KOVIZ_TRACE_CAT(a,b) KOVIZ_TRACE_CAT2(a,b)
+
+#ifdef KOVIZ_NO_TRACE
+#define KOVIZ_TRACE(name)
+#else
+#define KOVIZ_TRACE(name) \
+    TraceScope KOVIZ_TRACE_CAT(_kovizTraceScope,__LINE__)(name)
+#endif
+
+#endif // TRACE_H
@@ -8,6 +8,240 @@
 QHash<QPair<QString,QString>,double> Unit::_scales = Unit::_initScales();
 QHash<QPair<QString,QString>,double> Unit::_biases = Unit::_initBiases();
 
+//
+// Units interned to ids with their scale/bias to the base unit of their
+// family, so that a conversion is two array lookups.
+//
+// Families are keyed by dimensions, the exponents of the atomic families
+// that make up the family name (e.g. "m/s2" is m^1 s^-2).  A compound
+// unit not in the tables (e.g. "km/hr") is parsed into known units the
+// same way and joins the family with its dimensions.
+//
+class UnitRegistry
+{
+  public:
+    UnitRegistry(const QHash<QPair<QString,QString>,double>& scales,
+                 const QHash<QPair<QString,QString>,double>& biases);
+
+    int id(const QString& name);
+    int family(int id);
+    UnitConversion conversion(int fromId, int toId);
+
+  private:
+    QReadWriteLock _lock;
+    QHash<QString,int> _ids;          // -1 for names that are not units
+    QVector<int> _families;           // per id
+    QVector<double> _scales;          // per id, to family base unit
+    QVector<double> _biases;          // per id
+    QHash<QString,int> _familyIds;    // dimensions signature -> family
+
+    QHash<QString,QPair<QString,double> > _tableUnits; // unit->(family,scale)
+
+    int _add(const QString& name, int family, double scale, double bias);
+    bool _parse(const QString& name, QMap<QString,int>* dims, double* scale,
+                int depth) const;
+    static bool _isAtomic(const QString& family);
+    static QString _signature(const QMap<QString,int>& dims);
+};
+
+UnitRegistry::UnitRegistry(const QHash<QPair<QString,QString>,double>& scales,
+                           const QHash<QPair<QString,QString>,double>& biases)
+{
+    // Sorted so that a unit listed in two families always gets the same one
+    QList<QPair<QString,QString> > pairs = scales.keys();
+    qSort(pairs);
+    QStringList families;
+    for ( int i = 0; i < pairs.size(); ++i ) {
+        QPair<QString,QString> pair = pairs.at(i);
+        if ( !_tableUnits.contains(pair.second) ) {
+            _tableUnits.insert(pair.second,
+                               qMakePair(pair.first,scales.value(pair)));
+        }
+        if ( families.isEmpty() || families.last() != pair.first ) {
+            families.append(pair.first);
+        }
+    }
+
+    QHash<QString,int> familyIds;  // family name -> family id
+    foreach ( QString family, families ) {
+        QMap<QString,int> dims;
+        double scale = 1.0;
+        QString sig = "=" + family;
+        if ( _parse(family,&dims,&scale,0) && !dims.isEmpty() ) {
+            sig = _signature(dims);
+        }
+        if ( _familyIds.contains(sig) ) {
+            sig = "=" + family; // same dimensions, kept apart as before
+        }
+        int familyId = _familyIds.size();
+        _familyIds.insert(sig,familyId);
+        familyIds.insert(family,familyId);
+    }
+
+    for ( int i = 0; i < pairs.size(); ++i ) {
+        QPair<QString,QString> pair = pairs.at(i);
+        if ( _ids.contains(pair.second) ||
+             _tableUnits.value(pair.second).first != pair.first ) {
+            continue;
+        }
+        _add(pair.second, familyIds.value(pair.first),
+             scales.value(pair), biases.value(pair,0.0));
+    }
+}
+
+int UnitRegistry::id(const QString &name)
+{
+    {
+        QReadLocker locker(&_lock);
+        QHash<QString,int>::const_iterator it = _ids.constFind(name);
+        if ( it != _ids.constEnd() ) {
+            return it.value();
+        }
+    }
+
+    // Not interned yet, try as compound unit
+    QMap<QString,int> dims;
+    double scale = 1.0;
+    bool isUnit = _parse(name,&dims,&scale,0) && !dims.isEmpty();
+
+    QWriteLocker locker(&_lock);
+    if ( _ids.contains(name) ) {
+        return _ids.value(name);
+    }
+    if ( !isUnit ) {
+        _ids.insert(name,-1);
+        return -1;
+    }
+    QString sig = _signature(dims);
+    int familyId = _familyIds.value(sig,-1);
+    if ( familyId < 0 ) {
+        familyId = _familyIds.size();
+        _familyIds.insert(sig,familyId);
+    }
+    return _add(name,familyId,scale,0.0);
+}
+
+int UnitRegistry::family(int id)
+{
+    if ( id < 0 ) {
+        return -1;
+    }
+    QReadLocker locker(&_lock);
+    return _families.at(id);
+}
+
+UnitConversion UnitRegistry::conversion(int fromId, int toId)
+{
+    QReadLocker locker(&_lock);
+    double scale1 = _scales.at(fromId);
+    double scale2 = _scales.at(toId);
+    double bias1 = _biases.at(fromId);
+    double bias2 = _biases.at(toId);
+    return UnitConversion(scale1/scale2, (bias1-bias2)/scale2);
+}
+
+// Caller holds write lock (or is the constructor)
+int UnitRegistry::_add(const QString &name, int family,
+                       double scale, double bias)
+{
+    int id = _families.size();
+    _ids.insert(name,id);
+    _families.append(family);
+    _scales.append(scale);
+    _biases.append(bias);
+    return id;
+}
+
+// Dimensions of name and its scale to the product of the base units
+// of its dimensions.  Units are joined by '*' with an optional single
+// '/', and may have an integer power e.g. "lbf*ft2/s".  Temperatures and
+// dimensionless units may not be part of a compound.
+bool UnitRegistry::_parse(const QString &name, QMap<QString,int> *dims,
+                          double *scale, int depth) const
+{
+    if ( depth > 4 ) {
+        return false;
+    }
+    QStringList sides = name.split('/');
+    if ( sides.size() > 2 ) {
+        return false;
+    }
+    for ( int side = 0; side < sides.size(); ++side ) {
+        int sign = ( side == 0 ) ? 1 : -1;
+        foreach ( QString tok, sides.at(side).split('*') ) {
+            if ( side == 0 && sides.size() == 2 &&
+                 (tok == "1" || tok == "one") ) {
+                continue;  // e.g. 1/s
+            }
+            QString base = tok;
+            int power = 1;
+            int i = tok.size();
+            while ( i > 0 && tok.at(i-1).isDigit() ) {
+                --i;
+            }
+            if ( i > 0 && i < tok.size() &&
+                 _tableUnits.contains(tok.left(i)) ) {
+                base = tok.left(i);
+                power = tok.mid(i).toInt();
+            }
+            if ( !_tableUnits.contains(base) ) {
+                return false;
+            }
+            QString family = _tableUnits.value(base).first;
+            double s = _tableUnits.value(base).second;
+            if ( family == "C" || family == "--" ) {
+                return false;
+            }
+            int e = sign*power;
+            if ( _isAtomic(family) ) {
+                (*dims)[family] += e;
+            } else {
+                QMap<QString,int> familyDims;
+                double familyScale = 1.0;
+                if ( !_parse(family,&familyDims,&familyScale,depth+1) ) {
+                    return false;
+                }
+                foreach ( QString key, familyDims.keys() ) {
+                    (*dims)[key] += familyDims.value(key)*e;
+                }
+                s *= familyScale;
+            }
+            *scale *= pow(s,e);
+        }
+    }
+
+    foreach ( QString key, dims->keys() ) {
+        if ( dims->value(key) == 0 ) {
+            dims->remove(key);
+        }
+    }
+
+    return true;
+}
+
+// Family name is not made of other units e.g. "m" but not "m2" or "N*m"
+bool UnitRegistry::_isAtomic(const QString &family)
+{
+    return !family.contains('*') && !family.contains('/') &&
+           !family.isEmpty() && !family.at(family.size()-1).isDigit();
+}
+
+QString UnitRegistry::_signature(const QMap<QString,int> &dims)
+{
+    QStringList factors;
+    QMap<QString,int>::const_iterator it;
+    for ( it = dims.constBegin(); it != dims.constEnd(); ++it ) {
+        factors << QString("%1^%2").arg(it.key()).arg(it.value());
+    }
+    return factors.join(" ");
+}
+
+UnitRegistry& Unit::_registry()
+{
+    static UnitRegistry registry(_scales,_biases);
+    return registry;
+}
+
 Unit::Unit() :
     _name("--")
 {
@@ -39,99 +273,64 @@ bool Unit::isEmpty() const
 
 bool Unit::canConvert(const QString& from, const QString &to)
 {
-    bool can = false;
-
-    QString fam1 = _family(from);
-    QString fam2 = _family(to);
-
-    if ( fam1 == fam2 ) {
-        can = true;
-    }
+    return canConvert(id(from),id(to));
+}
 
-    return can;
+bool Unit::canConvert(int fromId, int toId)
+{
+    return ( _registry().family(fromId) == _registry().family(toId) );
 }
 
 bool Unit::isUnit(const QString &name)
 {
-    bool ok = false;
-
-    QList<QPair<QString,QString> > pairs = _scales.keys();
-    for ( int i = 0; i < pairs.size(); ++i ) {
-        QPair<QString,QString> pair = pairs.at(i);
-        if ( pair.second == name ) {
-            ok = true;
-            break;
-        }
-    }
+    return ( id(name) >= 0 );
+}
 
-    return ok;
+int Unit::id(const QString &name)
+{
+    return _registry().id(name);
 }
 
 
 double Unit::scale(const QString &from, const QString &to)
 {
-    if ( from == to ) {
-        return 1.0;
-    }
-
-    if ( !isUnit(from) ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unsupported unit=\"%s\"\n",from.toLatin1().constData());
-        exit(-1);
-    }
-    if ( !isUnit(to) ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unsupported unit=\"%s\"\n",to.toLatin1().constData());
-        exit(-1);
-    }
+    return conversion(from,to).scale;
+}
 
-    QString fam1 = _family(from);
-    QString fam2 = _family(to);
+double Unit::bias(const QString &from, const QString &to)
+{
+    return conversion(from,to).bias;
+}
 
-    if ( fam1 != fam2 ) {
-        fprintf(stderr,"koviz [error]: Attempting to convert "
-                       "unit=\"%s\" to unit=\"%s\"; however "
-                       "these units are not in the same family.\n",
-                        from.toLatin1().constData(), to.toLatin1().constData());
-        exit(-1);
+// Ids must be valid and in the same family (see canConvert())
+UnitConversion Unit::conversion(int fromId, int toId)
+{
+    if ( fromId == toId ) {
+        return UnitConversion();
     }
-
-    QString family = fam1 = fam2;
-    double scale1 = _scales.value(qMakePair(family,from));
-    double scale2 = _scales.value(qMakePair(family,to));
-    double sf = scale1/scale2;
-
-    /*
-    fprintf(stderr,"scale factor from={%s} to={%s} is %g\n",
-                    from.toLatin1().constData(),
-                    to.toLatin1().constData(), sf);
-    */
-
-    return sf;
+    return _registry().conversion(fromId,toId);
 }
 
-double Unit::bias(const QString &from, const QString &to)
+UnitConversion Unit::conversion(const QString &from, const QString &to)
 {
     if ( from == to ) {
-        return 0.0;
+        return UnitConversion();
     }
 
-    if ( !isUnit(from) ) {
+    int fromId = id(from);
+    if ( fromId < 0 ) {
         fprintf(stderr,"koviz [error]: Attempting to convert "
                        "unsupported unit=\"%s\"\n",from.toLatin1().constData());
         exit(-1);
     }
-    if ( !isUnit(to) ) {
+    int toId = id(to);
+    if ( toId < 0 ) {
         fprintf(stderr,"koviz [error]: Attempting to convert "
                        "unsupported unit=\"%s\"\n",to.toLatin1().constData());
         exit(-1);
     }
 
-    QString fam1 = _family(from);
-    QString fam2 = _family(to);
-    QString family = fam1 = fam2;
-
-    if ( fam1 != fam2 ) {
+    if ( !canConvert(fromId,toId) ) {
         fprintf(stderr,"koviz [error]: Attempting to convert "
                        "unit=\"%s\" to unit=\"%s\"; however "
                        "these units are not in the same family.\n",
@@ -139,22 +338,7 @@ double Unit::bias(const QString &from, const QString &to)
         exit(-1);
     }
 
-    double b = 0.0;
-
-    if ( family == "C" ) {
-        double bias1 = _biases.value(qMakePair(family,from));
-        double bias2 = _biases.value(qMakePair(family,to));
-        double scale2 = _scales.value(qMakePair(family,to));
-        b = (bias1-bias2)/scale2;
-    }
-
-    /*
-    fprintf(stderr,"bias factor from={%s} to={%s} is %g\n",
-                    from.toLatin1().constData(),
-                    to.toLatin1().constData(), b);
-    */
-
-    return b;
+    return conversion(fromId,toId);
 }
 
 QString Unit::next(const QString &unit)
@@ -12,8 +12,25 @@
 #include <QStringList>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QMap>
+#include <QReadWriteLock>
+#include <QVector>
+#include <QtAlgorithms>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+
+class UnitRegistry;
+
+// Precomputed conversion between two units: to = from*scale + bias
+class UnitConversion {
+  public:
+    UnitConversion() : scale(1.0), bias(0.0) {}
+    UnitConversion(double s, double b) : scale(s), bias(b) {}
+    double convert(double v) const { return v*scale + bias; }
+    double scale;
+    double bias;
+};
 
 class Unit {
 
@@ -31,6 +48,16 @@ class Unit {
     static bool isUnit(const QString& name);
     static double scale(const QString& from, const QString& to);
     static double bias(const QString& from, const QString& to);
+
+    // Units interned to small ids (-1 if not a unit).  Compound units
+    // (e.g. "km/hr", "lbf*ft/s2") made of known units are supported and
+    // convert to units of the same dimensions.  Hot paths should get the
+    // ids/conversion once and keep them (see UnitConverter) instead of
+    // converting by name.
+    static int id(const QString& name);
+    static bool canConvert(int fromId, int toId);
+    static UnitConversion conversion(int fromId, int toId);
+    static UnitConversion conversion(const QString& from, const QString& to);
     static QString next(const QString& unit);
     static QString prev(const QString& unit);
     static Unit map(const Unit& u1, const Unit& u2);
@@ -41,6 +68,7 @@ class Unit {
   private:
 
     QString _name;
+    static UnitRegistry& _registry();
     static QHash<QPair<QString,QString>,double> _scales;
     static QHash<QPair<QString,QString>,double> _biases;
     static QHash<QPair<QString,QString>,double> _initScales();
@@ -50,4 +78,26 @@ class Unit {
     static QStringList _families();
 
 };
+
+// Conversions kept by a curve or table column so that each (from,to)
+// pair is only looked up (by name) once.  Pairs are kept since a curve's
+// y may go to more than one unit (e.g. its plot's and an error plot's).
+class UnitConverter {
+  public:
+    UnitConverter() {}
+    UnitConversion conversion(const QString& from, const QString& to)
+    {
+        QPair<QString,QString> key(from,to);
+        QHash<QPair<QString,QString>,UnitConversion>::const_iterator it =
+                                                   _conversions.constFind(key);
+        if ( it != _conversions.constEnd() ) {
+            return it.value();
+        }
+        UnitConversion uc = Unit::conversion(from,to);
+        _conversions.insert(key,uc);
+        return uc;
+    }
+  private:
+    QHash<QPair<QString,QString>,UnitConversion> _conversions;
+};
 #endif
@@ -0,0 +1,443 @@
+#include "varsmodel.h"
+
+#include <QtConcurrentRun>
+#include <iterator>
+
+static quint32 _trigram(const char* s)
+{
+    return ((quint32)(uchar)s[0] << 16) |
+           ((quint32)(uchar)s[1] << 8)  |
+            (quint32)(uchar)s[2];
+}
+
+static bool _isLessName(const QByteArray& a, const QByteArray& b)
+{
+    return qstrcmp(a,b) < 0;
+}
+
+// Literal runs that every match of rx contains e.g. "ball.*vel\[0\]" has
+// "ball" and "vel[0]".  If rx starts with ^, its leading run is the prefix.
+// Returns false when rx has alternation or groups (nothing is assumed).
+// Anything not surely literal ends a run, which only costs some narrowing.
+static bool _literals(const QString& rx, QStringList* runs, QString* prefix)
+{
+    if ( rx.contains('|') || rx.contains('(') ) {
+        return false;
+    }
+
+    bool isAnchored = rx.startsWith('^');
+    bool isLeading = true;
+    QString run;
+    int i = isAnchored ? 1 : 0;
+    while ( i < rx.size() ) {
+        QChar c = rx.at(i);
+        QChar lit;
+        int next = i+1;
+        if ( c == '\\' ) {
+            if ( next < rx.size() && !rx.at(next).isLetterOrNumber() ) {
+                lit = rx.at(next);
+            }
+            next = i+2;
+        } else if ( c == '[' ) {
+            // Skip class, ] first in class is a literal
+            next = ( i+1 < rx.size() && rx.at(i+1) == '^' ) ? i+2 : i+1;
+            if ( next < rx.size() && rx.at(next) == ']' ) {
+                ++next;
+            }
+            while ( next < rx.size() && rx.at(next) != ']' ) {
+                next += ( rx.at(next) == '\\' ) ? 2 : 1;
+            }
+            next = qMin(next+1,rx.size());
+        } else if ( c == '{' ) {
+            next = rx.indexOf('}',i+1);
+            next = ( next < 0 ) ? rx.size() : next+1;
+        } else if ( !QString(".^$*?+").contains(c) ) {
+            lit = c;
+        }
+
+        // An atom followed by * ? or {m,n} may be absent
+        bool isOptional = false;
+        bool isRepeated = false;
+        if ( next < rx.size() ) {
+            QChar q = rx.at(next);
+            isOptional = ( q == '*' || q == '?' || q == '{' );
+            isRepeated = ( q == '+' );
+        }
+
+        if ( !lit.isNull() && !isOptional ) {
+            run.append(lit);
+        }
+        if ( lit.isNull() || isOptional || isRepeated ) {
+            if ( isLeading && isAnchored ) {
+                *prefix = run;
+            }
+            isLeading = false;
+            if ( !run.isEmpty() ) {
+                runs->append(run);
+                run.clear();
+            }
+        }
+        i = next;
+    }
+    if ( isLeading && isAnchored ) {
+        *prefix = run;
+    }
+    if ( !run.isEmpty() ) {
+        runs->append(run);
+    }
+
+    return true;
+}
+
+// Sorted intersection
+static QVector<int> _intersect(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> c;
+    c.reserve(qMin(a.size(),b.size()));
+    std::set_intersection(a.constBegin(),a.constEnd(),
+                          b.constBegin(),b.constEnd(),
+                          std::back_inserter(c));
+    return c;
+}
+
+static bool _isShorter(const QVector<int>* a, const QVector<int>* b)
+{
+    return a->size() < b->size();
+}
+
+VarsModel::VarsModel(const QStringList &names, QObject *parent) :
+    QAbstractListModel(parent),
+    _isIndexed(false)
+{
+    QList<QByteArray> utf8s;
+    int poolSize = 0;
+    foreach ( QString name, names ) {
+        QByteArray utf8 = name.toUtf8();
+        poolSize += utf8.size()+1;
+        utf8s.append(utf8);
+    }
+    std::sort(utf8s.begin(),utf8s.end(),_isLessName);
+
+    _pool.reserve(poolSize);
+    _offsets.reserve(utf8s.size());
+    foreach ( QByteArray utf8, utf8s ) {
+        _offsets.append(_pool.size());
+        _pool.append(utf8);
+        _pool.append('\0');
+    }
+}
+
+int VarsModel::rowCount(const QModelIndex &pidx) const
+{
+    if ( pidx.isValid() ) {
+        return 0;
+    }
+    return _offsets.size();
+}
+
+QVariant VarsModel::data(const QModelIndex &idx, int role) const
+{
+    if ( !idx.isValid() || idx.row() >= _offsets.size() ||
+         (role != Qt::DisplayRole && role != Qt::EditRole) ) {
+        return QVariant();
+    }
+    return name(idx.row());
+}
+
+Qt::ItemFlags VarsModel::flags(const QModelIndex &idx) const
+{
+    if ( !idx.isValid() ) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+}
+
+const char *VarsModel::_name(int row) const
+{
+    return _pool.constData() + _offsets.at(row);
+}
+
+QString VarsModel::name(int row) const
+{
+    return QString::fromUtf8(_name(row));
+}
+
+void VarsModel::_index() const
+{
+    QMutexLocker locker(&_indexMutex);
+    if ( _isIndexed ) {
+        return;
+    }
+    for ( int row = 0; row < _offsets.size(); ++row ) {
+        const char* s = _name(row);
+        int len = qstrlen(s);
+        for ( int i = 0; i+3 <= len; ++i ) {
+            QVector<int>& rows = _trigrams[_trigram(s+i)];
+            if ( rows.isEmpty() || rows.last() != row ) {
+                rows.append(row);
+            }
+        }
+    }
+    _isIndexed = true;
+}
+
+// Rows [begin,end) whose names start with prefix
+void VarsModel::_prefixRange(const QByteArray &prefix,
+                             int *begin, int *end) const
+{
+    uint len = prefix.size();
+    int lo = 0;
+    int hi = _offsets.size();
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( qstrncmp(_name(mid),prefix.constData(),len) < 0 ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    *begin = lo;
+    hi = _offsets.size();
+    while ( lo < hi ) {
+        int mid = (lo+hi)/2;
+        if ( qstrncmp(_name(mid),prefix.constData(),len) <= 0 ) {
+            lo = mid+1;
+        } else {
+            hi = mid;
+        }
+    }
+    *end = lo;
+}
+
+// Rows that may match rx, isAll is set if rx says nothing about the rows
+QVector<int> VarsModel::_candidates(const QString &rx, bool *isAll) const
+{
+    QVector<int> rows;
+    *isAll = true;
+
+    QStringList runs;
+    QString prefix;
+    if ( !_literals(rx,&runs,&prefix) ) {
+        return rows;
+    }
+
+    // Posting lists of trigrams of runs, shortest first
+    QList<const QVector<int>*> postings;
+    foreach ( QString run, runs ) {
+        QByteArray utf8 = run.toUtf8();
+        if ( utf8.size() < 3 ) {
+            continue;
+        }
+        _index();
+        for ( int i = 0; i+3 <= utf8.size(); ++i ) {
+            quint32 tri = _trigram(utf8.constData()+i);
+            QHash<quint32,QVector<int> >::const_iterator it =
+                                                       _trigrams.constFind(tri);
+            if ( it == _trigrams.constEnd() ) {
+                *isAll = false;
+                return rows;   // no name has trigram
+            }
+            postings.append(&it.value());
+        }
+    }
+    std::sort(postings.begin(),postings.end(),_isShorter);
+
+    if ( !prefix.isEmpty() ) {
+        int begin;
+        int end;
+        _prefixRange(prefix.toUtf8(),&begin,&end);
+        rows.reserve(end-begin);
+        for ( int row = begin; row < end; ++row ) {
+            rows.append(row);
+        }
+        *isAll = false;
+    }
+
+    foreach ( const QVector<int>* posting, postings ) {
+        if ( *isAll ) {
+            rows = *posting;
+            *isAll = false;
+        } else {
+            rows = _intersect(rows,*posting);
+        }
+        if ( rows.isEmpty() ) {
+            break;
+        }
+    }
+
+    return rows;
+}
+
+QVector<int> VarsModel::_match(const QString &rx,
+                               const QVector<int> *rows) const
+{
+    QVector<int> matches;
+    QRegExp regexp(rx);
+    if ( !regexp.isValid() ) {
+        return matches;
+    }
+
+    bool isAll;
+    QVector<int> candidates = _candidates(rx,&isAll);
+    if ( !isAll && rows ) {
+        candidates = _intersect(candidates,*rows);
+    } else if ( isAll && rows ) {
+        candidates = *rows;
+    } else if ( isAll ) {
+        candidates.reserve(_offsets.size());
+        for ( int row = 0; row < _offsets.size(); ++row ) {
+            candidates.append(row);
+        }
+    }
+
+    if ( rx.isEmpty() ) {
+        return candidates;
+    }
+    foreach ( int row, candidates ) {
+        if ( regexp.indexIn(name(row)) >= 0 ) {
+            matches.append(row);
+        }
+    }
+    return matches;
+}
+
+QVector<int> VarsModel::match(const QString &rx) const
+{
+    return _match(rx,0);
+}
+
+QVector<int> VarsModel::narrow(const QString &rx,
+                               const QVector<int> &rows) const
+{
+    return _match(rx,&rows);
+}
+
+bool VarsModel::isNarrowing(const QString &prevRx, const QString &rx)
+{
+    if ( !rx.startsWith(prevRx) || rx.contains('|') || rx.contains('{') ) {
+        return false;
+    }
+    if ( !QRegExp(prevRx).isValid() ) {
+        return false;
+    }
+    if ( rx.size() == prevRx.size() ) {
+        return true;
+    }
+    // e.g. "ab" to "ab*" matches more
+    QChar c = rx.at(prevRx.size());
+    return ( c != '*' && c != '?' && c != '+' );
+}
+
+VarsFilterModel::VarsFilterModel(VarsModel *varsModel, QObject *parent) :
+    QAbstractListModel(parent),
+    _varsModel(varsModel)
+{
+    int nrows = _varsModel->rowCount();
+    _rows.reserve(nrows);
+    for ( int row = 0; row < nrows; ++row ) {
+        _rows.append(row);
+    }
+    connect(&_watcher,SIGNAL(finished()),this,SLOT(_searchFinished()));
+}
+
+VarsFilterModel::~VarsFilterModel()
+{
+    _watcher.waitForFinished();
+}
+
+int VarsFilterModel::rowCount(const QModelIndex &pidx) const
+{
+    if ( pidx.isValid() ) {
+        return 0;
+    }
+    return _rows.size();
+}
+
+QVariant VarsFilterModel::data(const QModelIndex &idx, int role) const
+{
+    if ( !idx.isValid() || idx.row() >= _rows.size() ||
+         (role != Qt::DisplayRole && role != Qt::EditRole) ) {
+        return QVariant();
+    }
+    return _varsModel->name(_rows.at(idx.row()));
+}
+
+Qt::ItemFlags VarsFilterModel::flags(const QModelIndex &idx) const
+{
+    if ( !idx.isValid() ) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+}
+
+void VarsFilterModel::setFilterRegExp(const QString &rx)
+{
+    _pendingRx = rx;
+    if ( _watcher.isRunning() ) {
+        return;   // Latest text is searched when running search finishes
+    }
+    _search();
+}
+
+void VarsFilterModel::_search()
+{
+    QString rx = _pendingRx;
+    bool isNarrowing = VarsModel::isNarrowing(_rx,rx);
+    int nrows = isNarrowing ? _rows.size() : _varsModel->rowCount();
+
+    if ( nrows < _asyncRowCount() ) {
+        if ( isNarrowing ) {
+            _setRows(_varsModel->narrow(rx,_rows),rx);
+        } else {
+            _setRows(_varsModel->match(rx),rx);
+        }
+        return;
+    }
+
+    QFuture<QVector<int> > future;
+    if ( isNarrowing ) {
+        future = QtConcurrent::run(_varsModel,&VarsModel::narrow,rx,_rows);
+    } else {
+        future = QtConcurrent::run(_varsModel,&VarsModel::match,rx);
+    }
+    _runningRx = rx;
+    _watcher.setFuture(future);
+}
+
+void VarsFilterModel::_searchFinished()
+{
+    _setRows(_watcher.result(),_runningRx);
+    if ( _pendingRx != _rx ) {
+        _search();
+    }
+}
+
+// Like QSortFilterProxyModel, selected vars that still match stay selected
+void VarsFilterModel::_setRows(const QVector<int> &rows, const QString &rx)
+{
+    emit layoutAboutToBeChanged();
+
+    QModelIndexList fromIdxs = persistentIndexList();
+    QList<int> fromRows;
+    foreach ( QModelIndex fromIdx, fromIdxs ) {
+        fromRows.append(_rows.at(fromIdx.row()));
+    }
+
+    _rows = rows;
+    _rx = rx;
+
+    QModelIndexList toIdxs;
+    foreach ( int row, fromRows ) {
+        QVector<int>::const_iterator it = std::lower_bound(rows.constBegin(),
+                                                           rows.constEnd(),
+                                                           row);
+        if ( it != rows.constEnd() && *it == row ) {
+            toIdxs.append(index(it-rows.constBegin(),0));
+        } else {
+            toIdxs.append(QModelIndex());
+        }
+    }
+    changePersistentIndexList(fromIdxs,toIdxs);
+
+    emit layoutChanged();
+}
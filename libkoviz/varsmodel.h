@@ -0,0 +1,103 @@
+#ifndef VARSMODEL_H
+#define VARSMODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QRegExp>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <algorithm>
+
+//
+// Read only list of variable names
+//
+// Names are kept sorted in one flat utf8 pool instead of an item per name.
+// A trigram index (built on the first search) and the sort order narrow
+// down the names a search regexp needs to be tried on e.g.
+//
+//     ball.*vel     only names with trigrams "bal" "all" and "vel"
+//     ^ball\.s      only the range of names starting with "ball.s"
+//
+// Searches only read the model, so they may be run in another thread.
+//
+class VarsModel : public QAbstractListModel
+{
+    Q_OBJECT
+  public:
+    explicit VarsModel(const QStringList& names, QObject *parent = 0);
+
+    int rowCount(const QModelIndex& pidx = QModelIndex()) const;
+    QVariant data(const QModelIndex& idx, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex& idx) const;
+
+    QString name(int row) const;
+
+    // Rows (ascending) with a name that rx matches somewhere in, like
+    // QSortFilterProxyModel::setFilterRegExp().  Narrow only tries rows.
+    QVector<int> match(const QString& rx) const;
+    QVector<int> narrow(const QString& rx, const QVector<int>& rows) const;
+
+    // True if matches of rx are surely a subset of matches of prevRx,
+    // e.g. when a char is typed at the end of a search
+    static bool isNarrowing(const QString& prevRx, const QString& rx);
+
+  private:
+    QByteArray _pool;          // names, each null terminated
+    QVector<int> _offsets;     // offset of name in pool
+
+    mutable QMutex _indexMutex;
+    mutable bool _isIndexed;
+    mutable QHash<quint32,QVector<int> > _trigrams;   // trigram -> rows
+
+    const char* _name(int row) const;
+    void _index() const;
+    QVector<int> _match(const QString& rx, const QVector<int>* rows) const;
+    QVector<int> _candidates(const QString& rx, bool* isAll) const;
+    void _prefixRange(const QByteArray& prefix, int* begin, int* end) const;
+};
+
+//
+// Rows of a vars model that match the search box
+//
+// Searches narrow the rows of the last search when they can and run
+// in another thread when there are many rows to search.  Typing during a
+// search only queues the latest text.
+//
+class VarsFilterModel : public QAbstractListModel
+{
+    Q_OBJECT
+  public:
+    explicit VarsFilterModel(VarsModel* varsModel, QObject *parent = 0);
+    ~VarsFilterModel();
+
+    int rowCount(const QModelIndex& pidx = QModelIndex()) const;
+    QVariant data(const QModelIndex& idx, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex& idx) const;
+
+    QString filterRegExp() const { return _rx; }
+
+  public slots:
+    void setFilterRegExp(const QString& rx);
+
+  private:
+    VarsModel* _varsModel;
+    QVector<int> _rows;   // rows of vars model matching _rx
+    QString _rx;
+    QString _pendingRx;   // latest text, may be ahead of _rx
+    QString _runningRx;   // text of search in other thread
+    QFutureWatcher<QVector<int> > _watcher;
+
+    static int _asyncRowCount() { return 20000; }
+
+    void _search();
+    void _setRows(const QVector<int>& rows, const QString& rx);
+
+  private slots:
+    void _searchFinished();
+};
+
+#endif // VARSMODEL_H
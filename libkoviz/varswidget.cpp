@@ -5,7 +5,7 @@
 #endif
 
 VarsWidget::VarsWidget(const QString &timeName,
-                       QStandardItemModel* varsModel,
+                       VarsModel* varsModel,
                        const QStringList& runDirs,
                        const QStringList &unitOverrides,
                        PlotBookModel *plotModel,
@@ -23,12 +23,7 @@ VarsWidget::VarsWidget(const QString &timeName,
     _qpId(0)
 {
     // Setup models
-    _varsFilterModel = new QSortFilterProxyModel;
-    _varsFilterModel->setDynamicSortFilter(true);
-    _varsFilterModel->setSourceModel(_varsModel);
-    QRegExp rx(QString(".*"));
-    _varsFilterModel->setFilterRegExp(rx);
-    _varsFilterModel->setFilterKeyColumn(0);
+    _varsFilterModel = new VarsFilterModel(_varsModel);
     _varsSelectModel = new QItemSelectionModel(_varsFilterModel);
 
     // Search box
@@ -254,14 +249,16 @@ void VarsWidget::_addPlotToPage(QStandardItem* pageItem,
     _addChild(plotItem, "PlotBackgroundColor", "#FFFFFF");
     _addChild(plotItem, "PlotForegroundColor", "#000000");
     int rc = _runDirs.count(); // a curve per run, so, rc == nCurves
+    QString presentation = _plotModel->getDataString(QModelIndex(),
+                                                     "Presentation");
     if ( rc == 2 ) {
-        QString presentation = _plotModel->getDataString(QModelIndex(),
-                                                         "Presentation");
-        if ( ! presentation.isEmpty() ) {
+        if ( ! presentation.isEmpty() && presentation != "envelope" ) {
             _addChild(plotItem, "PlotPresentation", presentation);
         } else {
             _addChild(plotItem, "PlotPresentation", "compare");
         }
+    } else if ( rc > 2 && presentation == "envelope" ) {
+        _addChild(plotItem, "PlotPresentation", "envelope");
     } else {
         _addChild(plotItem, "PlotPresentation", "compare");
     }
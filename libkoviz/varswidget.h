@@ -4,7 +4,6 @@
 #include <QWidget>
 #include <QStandardItemModel>
 #include <QItemSelectionModel>
-#include <QSortFilterProxyModel>
 #include <QGridLayout>
 #include <QLineEdit>
 #include <QListView>
@@ -17,13 +16,14 @@
 #include "dp.h"
 #include "bookmodel.h"
 #include "monteinputsview.h"
+#include "varsmodel.h"
 
 class VarsWidget : public QWidget
 {
     Q_OBJECT
 public:
     explicit VarsWidget(const QString& timeName,
-                        QStandardItemModel* varsModel,
+                        VarsModel* varsModel,
                         const QStringList& runDirs,
                         const QStringList& unitOverrides,
                         PlotBookModel* plotModel,
@@ -43,7 +43,7 @@ public slots:
 
 private:
     QString _timeName;
-    QStandardItemModel* _varsModel;
+    VarsModel* _varsModel;
     QStringList _runDirs;
     QStringList _unitOverrides;
     PlotBookModel* _plotModel;
@@ -53,7 +53,7 @@ private:
     QLineEdit* _searchBox;
     QListView* _listView ;
 
-    QSortFilterProxyModel* _varsFilterModel;
+    VarsFilterModel* _varsFilterModel;
     QItemSelectionModel* _varsSelectModel;
 
     int _qpId;